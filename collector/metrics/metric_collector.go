@@ -23,6 +23,8 @@ import (
 	"io/ioutil"
 	"math"
 	"net/http"
+	"sort"
+	"strings"
 	"time"
 
 	"github.com/prometheus/client_golang/prometheus"
@@ -44,14 +46,31 @@ type Metric struct {
 	value float64
 	// For metric type of percentile.
 	values []float64
-	mtype  string
+	// For metric type of histogram, which maps the upper bound of each bucket to the count.
+	// The buckets of the same histogram from different entities are merged by addition.
+	buckets map[uint64]uint64
+	mtype   string
 }
 
 type Metrics []Metric
 
+// The kth percentiles computed from the merged buckets of histograms, labeled by "quantile".
+var histogramQuantiles = []struct {
+	label   string
+	decimal float64
+}{
+	{"0.5", 0.5}, {"0.9", 0.9}, {"0.95", 0.95}, {"0.99", 0.99}, {"0.999", 0.999},
+}
+
 var GaugeMetricsMap map[string]prometheus.GaugeVec
 var CounterMetricsMap map[string]prometheus.CounterVec
 var SummaryMetricsMap map[string]prometheus.Summary
+var HistogramMetricsMap map[string]prometheus.GaugeVec
+
+// The buckets of each histogram at the last update, keyed by the metric name and its labels,
+// so that the kth percentiles are computed over the observations since the last update rather
+// than since the histogram is created.
+var lastHistogramBuckets map[string]map[uint64]uint64
 
 var TableNameByID map[string]string
 
@@ -66,6 +85,8 @@ func NewMetricCollector(
 	GaugeMetricsMap = make(map[string]prometheus.GaugeVec, 128)
 	CounterMetricsMap = make(map[string]prometheus.CounterVec, 128)
 	SummaryMetricsMap = make(map[string]prometheus.Summary, 128)
+	HistogramMetricsMap = make(map[string]prometheus.GaugeVec, 128)
+	lastHistogramBuckets = make(map[string]map[uint64]uint64, 1024)
 	TableNameByID = make(map[string]string, 128)
 
 	var collector = Collector{detectInterval: detectInterval, detectTimeout: detectTimeout, role: role}
@@ -173,6 +194,14 @@ func (collector *Collector) initMetrics() {
 					})
 					SummaryMetricsMap[name] = summaryMetric
 				case "Histogram":
+					if _, ok := HistogramMetricsMap[name]; ok {
+						continue
+					}
+					histogramMetric := promauto.NewGaugeVec(prometheus.GaugeOpts{
+						Name: name,
+						Help: desc,
+					}, []string{"endpoint", "role", "level", "title", "quantile"})
+					HistogramMetricsMap[name] = *histogramMetric
 				default:
 					log.Errorf("Unsupport metric type %s", mtype)
 				}
@@ -195,8 +224,7 @@ func (collector *Collector) processAllServerMetrics() {
 		}
 	}
 	metricsByTableID := make(map[string]Metrics, 128)
-	metricsByServerTableID := make(map[string]Metrics, 128)
-	var metricsOfCluster []Metric
+	var metricsOfCluster Metrics
 	metricsByAddr := make(map[string]Metrics, 128)
 	for _, addr := range addrs {
 		data, err := getOneServerMetrics(addr)
@@ -204,31 +232,33 @@ func (collector *Collector) processAllServerMetrics() {
 			log.Errorf("failed to get data from %s, err %s", addr, err)
 			return
 		}
+		metricsByServerTableID := make(map[string]Metrics, 128)
 		jsonData := gjson.Parse(data)
 		for _, entity := range jsonData.Get("entities").Array() {
 			etype := entity.Get("type").String()
 			switch etype {
-			case "replica":
-			case "partition":
+			case "replica", "table":
+				// The metrics of all replicas of a table on this server, such as the latency
+				// histograms, are merged into the server-level table metrics.
 				tableID := entity.Get("attributes").Get("table_id").String()
 				mergeIntoClusterLevelTableMetric(entity.Get("metrics").Array(),
 					tableID, &metricsByTableID)
-			case "table":
+				mergeIntoClusterLevelTableMetric(entity.Get("metrics").Array(),
+					tableID, &metricsByServerTableID)
+			case "partition":
 				tableID := entity.Get("attributes").Get("table_id").String()
 				mergeIntoClusterLevelTableMetric(entity.Get("metrics").Array(),
 					tableID, &metricsByTableID)
-				collectServerLevelTableMetric(entity.Get("metrics").Array(), tableID,
-					&metricsByServerTableID)
-				collector.updateServerLevelTableMetrics(addr, metricsByServerTableID)
 			case "server":
 				mergeIntoClusterLevelServerMetric(entity.Get("metrics").Array(),
-					metricsOfCluster)
+					&metricsOfCluster)
 				collectServerLevelServerMetrics(entity.Get("metrics").Array(),
 					addr, &metricsByAddr)
 			default:
 				log.Errorf("Unsupport entity type %s", etype)
 			}
 		}
+		collector.updateServerLevelTableMetrics(addr, metricsByServerTableID)
 	}
 
 	collector.updateClusterLevelTableMetrics(metricsByTableID)
@@ -261,7 +291,7 @@ func (collector *Collector) updateServerLevelServerMetrics(metricsByAddr map[str
 }
 
 // Update cluster level metrics. They belong to a cluster.
-func (collector *Collector) updateClusterLevelMetrics(metricsOfCluster []Metric) {
+func (collector *Collector) updateClusterLevelMetrics(metricsOfCluster Metrics) {
 	for _, metric := range metricsOfCluster {
 		collector.updateMetric(metric, "cluster", "server", metric.name)
 	}
@@ -305,151 +335,155 @@ func (collector *Collector) updateMetric(metric Metric, endpoint string, level s
 	case "Percentile":
 		log.Warnf("Todo metric type %s", metric.mtype)
 	case "Histogram":
+		if histogram, ok := HistogramMetricsMap[metric.name]; ok {
+			key := strings.Join([]string{metric.name, endpoint, level, title}, "|")
+			buckets := diffHistogramBuckets(metric.buckets, lastHistogramBuckets[key])
+			lastHistogramBuckets[key] = metric.buckets
+			for _, q := range histogramQuantiles {
+				histogram.With(
+					prometheus.Labels{"endpoint": endpoint,
+						"role": collector.role, "level": level,
+						"title": title, "quantile": q.label}).Set(
+					float64(histogramKthPercentile(buckets, q.decimal)))
+			}
+		} else {
+			log.Warnf("Unknown metric name %s", metric.name)
+		}
 	default:
 		log.Warnf("Unsupport metric type %s", metric.mtype)
 	}
 }
 
-func collectServerLevelTableMetric(metrics []gjson.Result, tableID string,
-	metricsByServerTableID *map[string]Metrics) {
-	var mts Metrics
-	for _, metric := range metrics {
-		name := metric.Get("name").String()
-		mtype := metric.Get("type").String()
-		value := metric.Get("value").Float()
-		var values []float64
-		if mtype == "percentile" {
-			values = append(values, metric.Get("p50").Float())
-			values = append(values, metric.Get("p90").Float())
-			values = append(values, metric.Get("p95").Float())
-			values = append(values, metric.Get("p99").Float())
-			values = append(values, metric.Get("p999").Float())
+// Parse the buckets of a histogram, i.e. the pairs of [upper_bound, count].
+func parseHistogramBuckets(metric gjson.Result) map[uint64]uint64 {
+	buckets := make(map[uint64]uint64)
+	for _, bucket := range metric.Get("buckets").Array() {
+		pair := bucket.Array()
+		if len(pair) != 2 {
+			log.Errorf("Invalid bucket %s of histogram %s", bucket.Raw, metric.Get("name").String())
+			continue
 		}
-		m := Metric{name: name, mtype: mtype, value: value, values: values}
-		mts = append(mts, m)
+		buckets[pair[0].Uint()] += pair[1].Uint()
 	}
-	(*metricsByServerTableID)[tableID] = mts
+	return buckets
 }
 
-func collectServerLevelServerMetrics(metrics []gjson.Result, addr string,
-	metricsByAddr *map[string]Metrics) {
-	var mts Metrics
-	for _, metric := range metrics {
-		name := metric.Get("name").String()
-		mtype := metric.Get("type").String()
-		value := metric.Get("value").Float()
-		var values []float64
-		if mtype == "percentile" {
-			values = append(values, metric.Get("p50").Float())
-			values = append(values, metric.Get("p90").Float())
-			values = append(values, metric.Get("p95").Float())
-			values = append(values, metric.Get("p99").Float())
-			values = append(values, metric.Get("p999").Float())
+// Get the observations of a histogram since the last update. Since the buckets are cumulative,
+// a bucket whose count decreases (e.g. the server restarted or the replicas moved) is taken as
+// a new one.
+func diffHistogramBuckets(current map[uint64]uint64, last map[uint64]uint64) map[uint64]uint64 {
+	diff := make(map[uint64]uint64, len(current))
+	for upperBound, count := range current {
+		if lastCount, ok := last[upperBound]; ok && lastCount <= count {
+			count -= lastCount
+		}
+		if count > 0 {
+			diff[upperBound] = count
 		}
-		m := Metric{name: name, mtype: mtype, value: value, values: values}
-		mts = append(mts, m)
 	}
-	(*metricsByAddr)[addr] = mts
+	return diff
+}
+
+// Compute the kth percentile over the buckets, i.e. the upper bound of the bucket which the
+// kth percentile falls in, in the same way as histogram_kth_percentile() of the server.
+func histogramKthPercentile(buckets map[uint64]uint64, decimal float64) uint64 {
+	var total uint64
+	upperBounds := make([]uint64, 0, len(buckets))
+	for upperBound, count := range buckets {
+		total += count
+		upperBounds = append(upperBounds, upperBound)
+	}
+	if total == 0 {
+		return 0
+	}
+
+	sort.Slice(upperBounds, func(i, j int) bool { return upperBounds[i] < upperBounds[j] })
+	nth := uint64(float64(total) * decimal)
+	var cumulative uint64
+	for _, upperBound := range upperBounds {
+		cumulative += buckets[upperBound]
+		if cumulative > nth {
+			return upperBound
+		}
+	}
+	return upperBounds[len(upperBounds)-1]
+}
+
+// Parse a metric of any type from the json.
+func parseMetric(metric gjson.Result) Metric {
+	m := Metric{
+		name:  metric.Get("name").String(),
+		mtype: metric.Get("type").String(),
+		value: metric.Get("value").Float(),
+	}
+	switch m.mtype {
+	case "Percentile":
+		m.values = append(m.values, metric.Get("p50").Float())
+		m.values = append(m.values, metric.Get("p90").Float())
+		m.values = append(m.values, metric.Get("p95").Float())
+		m.values = append(m.values, metric.Get("p99").Float())
+		m.values = append(m.values, metric.Get("p999").Float())
+	case "Histogram":
+		m.buckets = parseHistogramBuckets(metric)
+	}
+	return m
 }
 
-func mergeIntoClusterLevelServerMetric(metrics []gjson.Result, metricsOfCluster []Metric) {
+// Merge a metric of the same name from another entity into m.
+func mergeMetric(m *Metric, metric gjson.Result) {
+	switch m.mtype {
+	case "Counter", "Gauge":
+		m.value += metric.Get("value").Float()
+	case "Percentile":
+		// Percentiles could not be merged, thus take the max one as an approximation.
+		for i, kth := range []string{"p50", "p90", "p95", "p99", "p999"} {
+			m.values[i] = math.Max(m.values[i], metric.Get(kth).Float())
+		}
+	case "Histogram":
+		for upperBound, count := range parseHistogramBuckets(metric) {
+			m.buckets[upperBound] += count
+		}
+	default:
+		log.Errorf("Unsupport metric type %s", m.mtype)
+	}
+}
+
+// Merge the metrics of an entity into mts, metrics that do not exist in mts are appended.
+func mergeMetrics(metrics []gjson.Result, mts Metrics) Metrics {
 	for _, metric := range metrics {
 		name := metric.Get("name").String()
-		mtype := metric.Get("type").String()
-		value := metric.Get("value").Float()
 		isExisted := false
-		for _, m := range metricsOfCluster {
-			if m.name == name {
+		for i := range mts {
+			if mts[i].name == name {
 				isExisted = true
-				switch mtype {
-				case "Counter":
-				case "Gauge":
-					m.value += value
-				case "Percentile":
-					p50 := metric.Get("p50").Float()
-					m.values[0] = math.Max(m.values[0], p50)
-					p90 := metric.Get("p90").Float()
-					m.values[1] = math.Max(m.values[0], p90)
-					p95 := metric.Get("p95").Float()
-					m.values[2] = math.Max(m.values[0], p95)
-					p99 := metric.Get("p99").Float()
-					m.values[3] = math.Max(m.values[0], p99)
-					p999 := metric.Get("p999").Float()
-					m.values[4] = math.Max(m.values[0], p999)
-				case "Histogram":
-				default:
-					log.Errorf("Unsupport metric type %s", mtype)
-				}
+				mergeMetric(&mts[i], metric)
+				break
 			}
 		}
 		if !isExisted {
-			value := metric.Get("value").Float()
-			var values []float64
-			if mtype == "percentile" {
-				values = append(values, metric.Get("p50").Float())
-				values = append(values, metric.Get("p90").Float())
-				values = append(values, metric.Get("p95").Float())
-				values = append(values, metric.Get("p99").Float())
-				values = append(values, metric.Get("p999").Float())
-			}
-			m := Metric{name: name, mtype: mtype, value: value, values: values}
-			metricsOfCluster = append(metricsOfCluster, m)
+			mts = append(mts, parseMetric(metric))
 		}
 	}
+	return mts
+}
+
+func collectServerLevelServerMetrics(metrics []gjson.Result, addr string,
+	metricsByAddr *map[string]Metrics) {
+	var mts Metrics
+	for _, metric := range metrics {
+		mts = append(mts, parseMetric(metric))
+	}
+	(*metricsByAddr)[addr] = mts
+}
+
+func mergeIntoClusterLevelServerMetric(metrics []gjson.Result, metricsOfCluster *Metrics) {
+	*metricsOfCluster = mergeMetrics(metrics, *metricsOfCluster)
 }
 
 func mergeIntoClusterLevelTableMetric(metrics []gjson.Result, tableID string,
 	metricsByTableID *map[string]Metrics) {
-	// Find a same table id, try to merge them.
-	if _, ok := (*metricsByTableID)[tableID]; ok {
-		mts := (*metricsByTableID)[tableID]
-		for _, metric := range metrics {
-			name := metric.Get("name").String()
-			mtype := metric.Get("type").String()
-			value := metric.Get("value").Float()
-			for _, m := range mts {
-				if name == m.name {
-					switch mtype {
-					case "Counter":
-					case "Gauge":
-						m.value += value
-					case "Percentile":
-						p50 := metric.Get("p50").Float()
-						m.values[0] = math.Max(m.values[0], p50)
-						p90 := metric.Get("p90").Float()
-						m.values[1] = math.Max(m.values[0], p90)
-						p95 := metric.Get("p95").Float()
-						m.values[2] = math.Max(m.values[0], p95)
-						p99 := metric.Get("p99").Float()
-						m.values[3] = math.Max(m.values[0], p99)
-						p999 := metric.Get("p999").Float()
-						m.values[4] = math.Max(m.values[0], p999)
-					case "Histogram":
-					default:
-						log.Errorf("Unsupport metric type %s", mtype)
-					}
-				}
-			}
-		}
-	} else {
-		var mts Metrics
-		for _, metric := range metrics {
-			name := metric.Get("name").String()
-			mtype := metric.Get("type").String()
-			value := metric.Get("value").Float()
-			var values []float64
-			if mtype == "percentile" {
-				values = append(values, metric.Get("p50").Float())
-				values = append(values, metric.Get("p90").Float())
-				values = append(values, metric.Get("p95").Float())
-				values = append(values, metric.Get("p99").Float())
-				values = append(values, metric.Get("p999").Float())
-			}
-			m := Metric{name: name, mtype: mtype, value: value, values: values}
-			mts = append(mts, m)
-		}
-		(*metricsByTableID)[tableID] = mts
-	}
+	// Merge them into the metrics of the same table id if any.
+	(*metricsByTableID)[tableID] = mergeMetrics(metrics, (*metricsByTableID)[tableID])
 }
 
 func getOneServerMetrics(addr string) (string, error) {
@@ -0,0 +1,62 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+package metrics
+
+import (
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/tidwall/gjson"
+)
+
+func TestParseAndMergeHistogram(t *testing.T) {
+	replica1 := gjson.Parse(`[{"name":"get_latency_ns","type":"Histogram",` +
+		`"count":3,"sum":60,"buckets":[[10,2],[40,1]]}]`).Array()
+	replica2 := gjson.Parse(`[{"name":"get_latency_ns","type":"Histogram",` +
+		`"count":2,"sum":90,"buckets":[[40,1],[50,1]]}]`).Array()
+
+	metricsByTableID := make(map[string]Metrics)
+	mergeIntoClusterLevelTableMetric(replica1, "1", &metricsByTableID)
+	mergeIntoClusterLevelTableMetric(replica2, "1", &metricsByTableID)
+
+	mts := metricsByTableID["1"]
+	assert.Equal(t, 1, len(mts))
+	assert.Equal(t, map[uint64]uint64{10: 2, 40: 2, 50: 1}, mts[0].buckets)
+}
+
+func TestHistogramKthPercentile(t *testing.T) {
+	assert.Equal(t, uint64(0), histogramKthPercentile(map[uint64]uint64{}, 0.99))
+
+	buckets := map[uint64]uint64{10: 90, 20: 9, 30: 1}
+	assert.Equal(t, uint64(10), histogramKthPercentile(buckets, 0.5))
+	assert.Equal(t, uint64(20), histogramKthPercentile(buckets, 0.9))
+	assert.Equal(t, uint64(30), histogramKthPercentile(buckets, 0.99))
+	assert.Equal(t, uint64(30), histogramKthPercentile(buckets, 0.999))
+}
+
+func TestDiffHistogramBuckets(t *testing.T) {
+	// All observations are new without the last buckets.
+	current := map[uint64]uint64{10: 5, 20: 3}
+	assert.Equal(t, current, diffHistogramBuckets(current, nil))
+
+	// Only the observations since the last update are kept, while the bucket whose count
+	// decreases is taken as a new one.
+	last := map[uint64]uint64{10: 2, 20: 3, 30: 4}
+	current = map[uint64]uint64{10: 5, 20: 3, 30: 1}
+	assert.Equal(t, map[uint64]uint64{10: 3, 30: 1}, diffHistogramBuckets(current, last))
+}
@@ -78,6 +78,13 @@ struct configuration_update_request
     // only used when on_config_sync
     6:optional metadata.split_status      meta_split_status;
     7:optional dsn.host_port              hp_node;
+
+    // The capacity units per second the replica is allowed to serve, which are distributed by
+    // meta server from the quotas of the table (see app envs `replica.read_cu_quota` and
+    // `replica.write_cu_quota`), not set if the quota is not set.
+    // only used when on_config_sync
+    8:optional i64                        read_cu_budget;
+    9:optional i64                        write_cu_budget;
 }
 
 // meta server (config mgr) => primary | secondary (downgrade) (w/ new config)
@@ -112,4 +112,10 @@ struct replica_info
     7:string                            app_type;
     8:string                            disk_tag;
     9:optional manual_compaction_status manual_compact_status;
+    // The load of this replica, which is used by the load-aware balancer of meta server.
+    // The rates are averaged over the interval between two consecutive reports.
+    10:optional i64                     storage_mb;
+    11:optional i64                     read_cu_per_sec;
+    12:optional i64                     write_cu_per_sec;
+    13:optional i64                     qps;
 }
@@ -326,6 +326,9 @@ struct get_scanner_request
     12:optional bool    return_expire_ts;
     13:optional bool full_scan; // true means client want to build 'full scan' context with the server side, false otherwise
     14:optional bool only_return_count = false;
+    // If true, the server does not return the records but only their aggregation, see
+    // scan_response.aggregation. Implies only_return_count.
+    15:optional bool return_aggregation = false;
 }
 
 struct scan_request
@@ -333,6 +336,35 @@ struct scan_request
     1:i64           context_id;
 }
 
+// The histogram of the sizes of the scanned keys or values.
+struct scan_size_histogram
+{
+    1:i64       count;
+    2:i64       sum;
+    3:i64       min;
+    4:i64       max;
+    // buckets[0] counts the size of 0, buckets[i] (i > 0) counts the sizes in [2^(i-1), 2^i).
+    5:list<i64> buckets;
+}
+
+// The aggregation of the records scanned by a batch of get_scanner/scan.
+struct scan_aggregation
+{
+    1:i64                 kv_count;
+    // The count of the hash keys which begin in this batch, thus the count of the hash keys of
+    // a whole partition is the sum of those of all the batches.
+    2:i64                 hash_key_count;
+    3:scan_size_histogram hash_key_size;
+    4:scan_size_histogram sort_key_size;
+    5:scan_size_histogram value_size;
+    6:scan_size_histogram row_size;
+    // The count of the records with TTL, and the range of their expire_ts (in seconds
+    // since 2016-01-01 00:00:00 UTC). min_expire_ts and max_expire_ts are 0 if ttl_kv_count is 0.
+    7:i64                 ttl_kv_count;
+    8:i32                 min_expire_ts;
+    9:i32                 max_expire_ts;
+}
+
 struct scan_response
 {
     1:i32           error;
@@ -342,6 +374,7 @@ struct scan_response
     5:i32           partition_index;
     6:string        server;
     7:optional i32  kv_count;
+    8:optional scan_aggregation aggregation;
 }
 
 service rrdb
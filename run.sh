@@ -1535,6 +1535,8 @@ function usage_bench()
     echo "                             deleterandom_pegasus     --pegasus delete N entries with random keys list"
     echo "                             multisetrandom_pegasus   --pegasus write N random values with multi_count hash keys list"
     echo "                             multigetrandom_pegasus   --pegasus read N random keys with multi_count hash list"
+    echo "                             workload_load:<name>     --insert the records of the workload [pegasus.benchmark.workload.<name>] in config.ini"
+    echo "                             workload_run:<name>      --run the operations of the workload [pegasus.benchmark.workload.<name>] in config.ini"
     echo "                             Comma-separated list of operations is going to run in the specified order."
     echo "                             default is 'fillrandom_pegasus,readrandom_pegasus,deleterandom_pegasus'"
     echo "   --num <num>               number of key/value pairs, default is 10000"
@@ -74,6 +74,14 @@ public:
     virtual error_code flush(rocksdb::RandomRWFile *rwf) = 0;
     virtual error_code close(rocksdb::RandomRWFile *rwf) = 0;
 
+    // Opens a native file handle beside the rocksdb file for the providers which do disk io
+    // by themselves, the handle will be closed when the disk_file is destroyed.
+    // Returns DSN_INVALID_FILE_HANDLE if it's not needed by the provider.
+    virtual int open_native_handle(const std::string &fname, bool for_write)
+    {
+        return DSN_INVALID_FILE_HANDLE;
+    }
+
     // Submits the aio_task to the underlying disk-io executor.
     // This task may not be executed immediately, call `aio_task::wait`
     // to wait until it completes.
@@ -26,6 +26,7 @@
 
 #include "disk_engine.h"
 
+#include <unistd.h>
 #include <list>
 // IWYU pragma: no_include <string>
 #include <utility>
@@ -33,6 +34,7 @@
 
 #include "aio/aio_provider.h"
 #include "aio/aio_task.h"
+#include "io_uring_aio_provider.h"
 #include "native_linux_aio_provider.h"
 #include "task/task.h"
 #include "task/task_code.h"
@@ -40,6 +42,7 @@
 #include "runtime/tool_api.h"
 #include "utils/error_code.h"
 #include "utils/factory_store.h"
+#include "utils/flags.h"
 #include "utils/fmt_logging.h"
 #include "utils/join_point.h"
 #include "utils/link.h"
@@ -50,6 +53,15 @@ DEFINE_TASK_CODE_AIO(LPC_AIO_BATCH_WRITE, TASK_PRIORITY_COMMON, THREAD_POOL_DEFA
 
 const char *native_aio_provider = "dsn::tools::native_aio_provider";
 DSN_REGISTER_COMPONENT_PROVIDER(native_linux_aio_provider, native_aio_provider);
+const char *io_uring_aio_provider_name = "dsn::tools::io_uring_aio_provider";
+DSN_REGISTER_COMPONENT_PROVIDER(io_uring_aio_provider, io_uring_aio_provider_name);
+
+DSN_DEFINE_string(core,
+                  aio_factory_name,
+                  "dsn::tools::native_aio_provider",
+                  "The implementation class of the disk io, could be "
+                  "'dsn::tools::native_aio_provider' or 'dsn::tools::io_uring_aio_provider'. "
+                  "The latter falls back to the former if io_uring is not available.");
 
 struct disk_engine_initializer
 {
@@ -102,8 +114,22 @@ aio_task *disk_write_queue::unlink_next_workload(void *plength)
     return first;
 }
 
-disk_file::disk_file(std::unique_ptr<rocksdb::RandomAccessFile> rf) : _read_file(std::move(rf)) {}
-disk_file::disk_file(std::unique_ptr<rocksdb::RandomRWFile> wf) : _write_file(std::move(wf)) {}
+disk_file::disk_file(std::unique_ptr<rocksdb::RandomAccessFile> rf)
+    : _read_file(std::move(rf)), _native_handle(DSN_INVALID_FILE_HANDLE)
+{
+}
+
+disk_file::disk_file(std::unique_ptr<rocksdb::RandomRWFile> wf)
+    : _write_file(std::move(wf)), _native_handle(DSN_INVALID_FILE_HANDLE)
+{
+}
+
+disk_file::~disk_file()
+{
+    if (_native_handle != DSN_INVALID_FILE_HANDLE) {
+        ::close(_native_handle);
+    }
+}
 
 aio_task *disk_file::read(aio_task *tsk)
 {
@@ -161,11 +187,18 @@ aio_task *disk_file::on_write_completed(aio_task *wk, void *ctx, error_code err,
 }
 
 //----------------- disk_engine ------------------------
-disk_engine::disk_engine()
+disk_engine::disk_engine() = default;
+
+/*static*/ aio_provider &disk_engine::provider()
 {
-    aio_provider *provider = utils::factory_store<aio_provider>::create(
-        native_aio_provider, dsn::PROVIDER_TYPE_MAIN, this);
-    _provider.reset(provider);
+    auto &engine = instance();
+    std::call_once(engine._provider_once, [&engine]() {
+        aio_provider *provider = utils::factory_store<aio_provider>::create(
+            FLAGS_aio_factory_name, dsn::PROVIDER_TYPE_MAIN, &engine);
+        CHECK_NOTNULL(provider, "invalid aio provider '{}'", FLAGS_aio_factory_name);
+        engine._provider.reset(provider);
+    });
+    return *engine._provider;
 }
 
 class batch_write_io_task : public aio_task
@@ -214,7 +247,7 @@ void disk_engine::process_write(aio_task *aio, uint64_t sz)
     // no batching
     if (dio->buffer_size == sz) {
         aio->collapse();
-        _provider->submit_aio_task(aio);
+        provider().submit_aio_task(aio);
     }
 
     // batching
@@ -270,7 +303,7 @@ void disk_engine::complete_io(aio_task *aio, error_code err, uint64_t bytes)
         if (aio->get_aio_context()->type == AIO_Read) {
             auto wk = dfile->on_read_completed(aio, err, (size_t)bytes);
             if (wk) {
-                _provider->submit_aio_task(wk);
+                provider().submit_aio_task(wk);
             }
         }
 
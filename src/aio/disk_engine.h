@@ -29,6 +29,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <memory>
+#include <mutex>
 
 #include "aio/aio_task.h"
 #include "aio_provider.h"
@@ -59,6 +60,8 @@ class disk_file
 public:
     explicit disk_file(std::unique_ptr<rocksdb::RandomAccessFile> rf);
     explicit disk_file(std::unique_ptr<rocksdb::RandomRWFile> wf);
+    ~disk_file();
+
     aio_task *read(aio_task *tsk);
     aio_task *write(aio_task *tsk, void *ctx);
 
@@ -68,10 +71,15 @@ public:
     rocksdb::RandomAccessFile *rfile() const { return _read_file.get(); }
     rocksdb::RandomRWFile *wfile() const { return _write_file.get(); }
 
+    // The ownership of the native handle is transferred to the disk_file.
+    void set_native_handle(int fd) { _native_handle = fd; }
+    int native_handle() const { return _native_handle; }
+
 private:
     // TODO(yingchun): unify to use a single RandomRWFile member variable.
     std::unique_ptr<rocksdb::RandomAccessFile> _read_file;
     std::unique_ptr<rocksdb::RandomRWFile> _write_file;
+    int _native_handle;
     disk_write_queue _write_queue;
     work_queue<aio_task> _read_queue;
 };
@@ -80,7 +88,7 @@ class disk_engine : public utils::singleton<disk_engine>
 {
 public:
     void write(aio_task *aio);
-    static aio_provider &provider() { return *instance()._provider.get(); }
+    static aio_provider &provider();
 
 private:
     // the object of disk_engine must be created by `singleton::instance`
@@ -90,6 +98,9 @@ private:
     void process_write(aio_task *wk, uint64_t sz);
     void complete_io(aio_task *aio, error_code err, uint64_t bytes);
 
+    // The provider is created on first use rather than in the constructor, because the
+    // disk_engine is constructed before the config is loaded, see `disk_engine_initializer`.
+    std::once_flag _provider_once;
     std::unique_ptr<aio_provider> _provider;
 
     friend class aio_provider;
@@ -48,14 +48,18 @@ namespace file {
         if (!sf) {
             return nullptr;
         }
-        return new disk_file(std::move(sf));
+        auto *df = new disk_file(std::move(sf));
+        df->set_native_handle(disk_engine::provider().open_native_handle(fname, false));
+        return df;
     }
     case FileOpenType::kWriteOnly: {
         auto wf = disk_engine::provider().open_write_file(fname);
         if (!wf) {
             return nullptr;
         }
-        return new disk_file(std::move(wf));
+        auto *df = new disk_file(std::move(wf));
+        df->set_native_handle(disk_engine::provider().open_native_handle(fname, true));
+        return df;
     }
     default:
         CHECK(false, "");
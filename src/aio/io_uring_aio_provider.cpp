@@ -0,0 +1,533 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "io_uring_aio_provider.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "aio/aio_task.h"
+#include "aio/disk_engine.h"
+#include "runtime/service_engine.h"
+#include "task/task.h"
+#include "utils/error_code.h"
+#include "utils/flags.h"
+#include "utils/fmt_logging.h"
+#include "utils/latency_tracer.h"
+#include "utils/ports.h"
+#include "utils/safe_strerror_posix.h"
+
+#if defined(__linux__) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) &&         \
+    __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define DSN_HAS_IO_URING 1
+#endif
+
+DSN_DECLARE_bool(encrypt_data_at_rest);
+
+DSN_DEFINE_uint32(core,
+                  io_uring_entries,
+                  1024,
+                  "The submission queue size of the io_uring used by "
+                  "dsn::tools::io_uring_aio_provider, which is also the max count of the "
+                  "in-flight requests. It will be rounded up to the power of 2 by the kernel.");
+DSN_DEFINE_validator(io_uring_entries, [](uint32_t value) -> bool {
+    return value > 0 && value <= 32768;
+});
+
+namespace dsn {
+
+#ifdef DSN_HAS_IO_URING
+
+namespace {
+
+int sys_io_uring_setup(uint32_t entries, struct io_uring_params *p)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sys_io_uring_enter(int fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags)
+{
+    return static_cast<int>(
+        syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+} // anonymous namespace
+
+// The memory shared with the kernel, see 'man 2 io_uring_setup' for details.
+struct io_uring_aio_provider::ring
+{
+    int fd = -1;
+    uint32_t sq_entries = 0;
+    uint32_t cq_entries = 0;
+
+    void *sq_ptr = MAP_FAILED;
+    size_t sq_size = 0;
+    void *cq_ptr = MAP_FAILED;
+    size_t cq_size = 0;
+    struct io_uring_sqe *sqes = static_cast<struct io_uring_sqe *>(MAP_FAILED);
+    size_t sqes_size = 0;
+
+    uint32_t *sq_head = nullptr;
+    uint32_t *sq_tail = nullptr;
+    uint32_t sq_mask = 0;
+    uint32_t *sq_array = nullptr;
+
+    uint32_t *cq_head = nullptr;
+    uint32_t *cq_tail = nullptr;
+    uint32_t cq_mask = 0;
+    struct io_uring_cqe *cqes = nullptr;
+
+    ~ring()
+    {
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqes_size);
+        }
+        if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) {
+            munmap(cq_ptr, cq_size);
+        }
+        if (sq_ptr != MAP_FAILED) {
+            munmap(sq_ptr, sq_size);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    bool init(uint32_t entries)
+    {
+        struct io_uring_params p;
+        memset(&p, 0, sizeof(p));
+        fd = sys_io_uring_setup(entries, &p);
+        if (fd < 0) {
+            LOG_WARNING("io_uring_setup failed, err = {}", utils::safe_strerror(errno));
+            return false;
+        }
+
+        // IORING_OP_READ and IORING_OP_WRITE are supported since Linux 5.6, which is also the
+        // version IORING_FEAT_RW_CUR_POS is introduced. IORING_FEAT_NODROP guarantees that no
+        // completion will be lost even if the completion queue overflows.
+        if (!(p.features & IORING_FEAT_RW_CUR_POS) || !(p.features & IORING_FEAT_NODROP)) {
+            LOG_WARNING("io_uring is too old to be used, features = {:#x}", p.features);
+            return false;
+        }
+
+        sq_entries = p.sq_entries;
+        cq_entries = p.cq_entries;
+        sq_size = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+        cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+        const bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_size = cq_size = std::max(sq_size, cq_size);
+        }
+
+        sq_ptr = mmap(nullptr,
+                      sq_size,
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE,
+                      fd,
+                      IORING_OFF_SQ_RING);
+        if (sq_ptr == MAP_FAILED) {
+            LOG_WARNING("mmap io_uring sq ring failed, err = {}", utils::safe_strerror(errno));
+            return false;
+        }
+
+        if (single_mmap) {
+            cq_ptr = sq_ptr;
+        } else {
+            cq_ptr = mmap(nullptr,
+                          cq_size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE,
+                          fd,
+                          IORING_OFF_CQ_RING);
+            if (cq_ptr == MAP_FAILED) {
+                LOG_WARNING("mmap io_uring cq ring failed, err = {}",
+                            utils::safe_strerror(errno));
+                return false;
+            }
+        }
+
+        sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+        sqes = static_cast<struct io_uring_sqe *>(mmap(nullptr,
+                                                       sqes_size,
+                                                       PROT_READ | PROT_WRITE,
+                                                       MAP_SHARED | MAP_POPULATE,
+                                                       fd,
+                                                       IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) {
+            LOG_WARNING("mmap io_uring sqes failed, err = {}", utils::safe_strerror(errno));
+            return false;
+        }
+
+        auto *sq = static_cast<char *>(sq_ptr);
+        sq_head = reinterpret_cast<uint32_t *>(sq + p.sq_off.head);
+        sq_tail = reinterpret_cast<uint32_t *>(sq + p.sq_off.tail);
+        sq_mask = *reinterpret_cast<uint32_t *>(sq + p.sq_off.ring_mask);
+        sq_array = reinterpret_cast<uint32_t *>(sq + p.sq_off.array);
+
+        auto *cq = static_cast<char *>(cq_ptr);
+        cq_head = reinterpret_cast<uint32_t *>(cq + p.cq_off.head);
+        cq_tail = reinterpret_cast<uint32_t *>(cq + p.cq_off.tail);
+        cq_mask = *reinterpret_cast<uint32_t *>(cq + p.cq_off.ring_mask);
+        cqes = reinterpret_cast<struct io_uring_cqe *>(cq + p.cq_off.cqes);
+
+        // Each slot of the sq array always points to the sqe with the same index.
+        for (uint32_t i = 0; i < sq_entries; ++i) {
+            sq_array[i] = i;
+        }
+        return true;
+    }
+
+    // Return nullptr if the submission queue is full. Must be called with the sq lock held,
+    // and 'commit_sqe' must be called after the returned sqe is filled.
+    struct io_uring_sqe *get_sqe()
+    {
+        const uint32_t tail = *sq_tail;
+        const uint32_t head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+        if (tail - head >= sq_entries) {
+            return nullptr;
+        }
+        struct io_uring_sqe *sqe = &sqes[tail & sq_mask];
+        memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    void commit_sqe() { __atomic_store_n(sq_tail, *sq_tail + 1, __ATOMIC_RELEASE); }
+};
+
+#else
+
+struct io_uring_aio_provider::ring
+{
+};
+
+#endif
+
+io_uring_aio_provider::io_uring_aio_provider(disk_engine *disk)
+    : native_linux_aio_provider(disk),
+      _unsubmitted_count(0),
+      _submitting(false),
+      _inflight_count(0),
+      _stopping(false)
+{
+#ifdef DSN_HAS_IO_URING
+    std::unique_ptr<ring> r(new ring());
+    if (!r->init(FLAGS_io_uring_entries)) {
+        LOG_WARNING("io_uring is unavailable, fall back to the blocking disk io");
+        return;
+    }
+    _ring = std::move(r);
+    _reaper = std::thread([this]() { reap_completions(); });
+    LOG_INFO("io_uring_aio_provider is initialized, sq_entries = {}, cq_entries = {}",
+             _ring->sq_entries,
+             _ring->cq_entries);
+#else
+    LOG_WARNING("io_uring is not supported on this platform, fall back to the blocking disk io");
+#endif
+}
+
+io_uring_aio_provider::~io_uring_aio_provider()
+{
+    if (!available()) {
+        return;
+    }
+
+    _stopping.store(true, std::memory_order_release);
+    push_wakeup_request();
+    _reaper.join();
+    _ring.reset();
+}
+
+int io_uring_aio_provider::open_native_handle(const std::string &fname, bool for_write)
+{
+    // The data of encrypted files must go through the encrypted env of rocksdb.
+    if (!available() || FLAGS_encrypt_data_at_rest) {
+        return DSN_INVALID_FILE_HANDLE;
+    }
+
+    // The file has been created by the rocksdb env if it is opened for write.
+    int fd = ::open(fname.c_str(), (for_write ? O_WRONLY : O_RDONLY) | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_WARNING("open native handle of file '{}' failed, err = {}",
+                    fname,
+                    utils::safe_strerror(errno));
+        return DSN_INVALID_FILE_HANDLE;
+    }
+    return fd;
+}
+
+void io_uring_aio_provider::submit_aio_task(aio_task *aio_tsk)
+{
+    auto *aio_ctx = aio_tsk->get_aio_context();
+    if (!available() || dsn_unlikely(service_engine::instance().is_simulator()) ||
+        aio_ctx->dfile->native_handle() == DSN_INVALID_FILE_HANDLE ||
+        (aio_ctx->type != AIO_Read && aio_ctx->type != AIO_Write)) {
+        native_linux_aio_provider::submit_aio_task(aio_tsk);
+        return;
+    }
+
+    ADD_POINT(aio_tsk->_tracer);
+    if (!push_request(aio_tsk)) {
+        // The ring is full, execute it by the blocking way rather than waiting for the ring.
+        native_linux_aio_provider::submit_aio_task(aio_tsk);
+        return;
+    }
+    submit_pending_requests();
+}
+
+bool io_uring_aio_provider::push_request(aio_task *aio_tsk)
+{
+#ifdef DSN_HAS_IO_URING
+    // Completions would be queued in the kernel's overflow list if more requests than the
+    // completion queue size are in-flight, which is costly, so avoid it.
+    if (_inflight_count.fetch_add(1, std::memory_order_relaxed) >= _ring->cq_entries) {
+        _inflight_count.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const auto *aio_ctx = aio_tsk->get_aio_context();
+    std::lock_guard<std::mutex> l(_sq_lock);
+    struct io_uring_sqe *sqe = _ring->get_sqe();
+    if (sqe == nullptr) {
+        _inflight_count.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+    sqe->opcode = aio_ctx->type == AIO_Read ? IORING_OP_READ : IORING_OP_WRITE;
+    sqe->fd = aio_ctx->dfile->native_handle();
+    sqe->off = aio_ctx->file_offset;
+    sqe->addr = reinterpret_cast<uint64_t>(aio_ctx->buffer);
+    sqe->len = static_cast<uint32_t>(aio_ctx->buffer_size);
+    sqe->user_data = reinterpret_cast<uint64_t>(aio_tsk);
+    _ring->commit_sqe();
+    ++_unsubmitted_count;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void io_uring_aio_provider::push_wakeup_request()
+{
+#ifdef DSN_HAS_IO_URING
+    while (true) {
+        {
+            std::lock_guard<std::mutex> l(_sq_lock);
+            struct io_uring_sqe *sqe = _ring->get_sqe();
+            if (sqe != nullptr) {
+                sqe->opcode = IORING_OP_NOP;
+                sqe->user_data = 0;
+                _ring->commit_sqe();
+                ++_unsubmitted_count;
+                break;
+            }
+        }
+        submit_pending_requests();
+        std::this_thread::yield();
+    }
+    submit_pending_requests();
+#endif
+}
+
+void io_uring_aio_provider::submit_pending_requests()
+{
+#ifdef DSN_HAS_IO_URING
+    {
+        std::lock_guard<std::mutex> l(_sq_lock);
+        if (_submitting) {
+            // The requests will be submitted by the thread which is submitting.
+            return;
+        }
+        _submitting = true;
+    }
+
+    while (true) {
+        uint32_t count;
+        {
+            std::lock_guard<std::mutex> l(_sq_lock);
+            count = _unsubmitted_count;
+            if (count == 0) {
+                _submitting = false;
+                return;
+            }
+            _unsubmitted_count = 0;
+        }
+
+        while (count > 0) {
+            int ret = sys_io_uring_enter(_ring->fd, count, 0, 0);
+            if (ret >= 0) {
+                count -= std::min(count, static_cast<uint32_t>(ret));
+                continue;
+            }
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                std::this_thread::yield();
+                continue;
+            }
+            // The sqes would stay in the ring until the next submission, which may never come
+            // on an idle disk, so take them back and execute them by the blocking way.
+            LOG_ERROR("io_uring_enter failed, err = {}", utils::safe_strerror(errno));
+            std::vector<aio_task *> retracted;
+            {
+                std::lock_guard<std::mutex> l(_sq_lock);
+                retract_unsubmitted_requests(retracted);
+                _submitting = false;
+            }
+            for (auto *aio_tsk : retracted) {
+                native_linux_aio_provider::submit_aio_task(aio_tsk);
+            }
+            return;
+        }
+    }
+#endif
+}
+
+void io_uring_aio_provider::retract_unsubmitted_requests(std::vector<aio_task *> &retracted)
+{
+#ifdef DSN_HAS_IO_URING
+    // The kernel consumes the sqes synchronously in io_uring_enter, thus the unsubmitted ones
+    // are exactly those between the head and the tail of the submission queue.
+    const uint32_t head = __atomic_load_n(_ring->sq_head, __ATOMIC_ACQUIRE);
+    const uint32_t tail = *_ring->sq_tail;
+    for (uint32_t i = head; i != tail; ++i) {
+        auto *aio_tsk = reinterpret_cast<aio_task *>(_ring->sqes[i & _ring->sq_mask].user_data);
+        if (aio_tsk != nullptr) {
+            retracted.push_back(aio_tsk);
+            _inflight_count.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+    __atomic_store_n(_ring->sq_tail, head, __ATOMIC_RELEASE);
+    _unsubmitted_count = 0;
+#endif
+}
+
+void io_uring_aio_provider::reap_completions()
+{
+#ifdef DSN_HAS_IO_URING
+    task::set_tls_dsn_context(nullptr, nullptr);
+    service_node *current_node = nullptr;
+    while (true) {
+        uint32_t head = *_ring->cq_head;
+        const uint32_t tail = __atomic_load_n(_ring->cq_tail, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            if (_stopping.load(std::memory_order_acquire) &&
+                _inflight_count.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+            int ret = sys_io_uring_enter(_ring->fd, 0, 1, IORING_ENTER_GETEVENTS);
+            if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                LOG_ERROR("io_uring_enter for completions failed, err = {}",
+                          utils::safe_strerror(errno));
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            continue;
+        }
+
+        for (; head != tail; ++head) {
+            const struct io_uring_cqe *cqe = &_ring->cqes[head & _ring->cq_mask];
+            auto *aio_tsk = reinterpret_cast<aio_task *>(cqe->user_data);
+            const int res = cqe->res;
+            // Release the slot as soon as possible since the completion may submit new
+            // requests.
+            __atomic_store_n(_ring->cq_head, head + 1, __ATOMIC_RELEASE);
+            if (aio_tsk == nullptr) {
+                // The wakeup request.
+                continue;
+            }
+            _inflight_count.fetch_sub(1, std::memory_order_release);
+            // The completion may create new tasks (e.g. batch_write_io_task), which requires
+            // the thread to be attached to the service node of the aio task.
+            if (aio_tsk->node() != current_node) {
+                current_node = aio_tsk->node();
+                task::set_tls_dsn_context(current_node, nullptr);
+            }
+            on_request_completed(aio_tsk, res);
+        }
+    }
+#endif
+}
+
+void io_uring_aio_provider::on_request_completed(aio_task *aio_tsk, int res)
+{
+    ADD_CUSTOM_POINT(aio_tsk->_tracer, "completed");
+    const auto *aio_ctx = aio_tsk->get_aio_context();
+    if (res < 0) {
+        LOG_ERROR("{} file failed, err = {}",
+                  aio_ctx->type == AIO_Read ? "read" : "write",
+                  utils::safe_strerror(-res));
+        complete_io(aio_tsk, ERR_FILE_OPERATION_FAILED, 0);
+        return;
+    }
+
+    if (aio_ctx->type == AIO_Read) {
+        if (res == 0) {
+            complete_io(aio_tsk, ERR_HANDLE_EOF, 0);
+            return;
+        }
+
+        // A short read does not always mean the end of file has been reached, read the
+        // remaining part in place until the end of file like the blocking path does.
+        uint64_t read_bytes = static_cast<uint64_t>(res);
+        while (read_bytes < aio_ctx->buffer_size) {
+            ssize_t n = ::pread(aio_ctx->dfile->native_handle(),
+                                static_cast<char *>(aio_ctx->buffer) + read_bytes,
+                                aio_ctx->buffer_size - read_bytes,
+                                aio_ctx->file_offset + read_bytes);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                LOG_ERROR("read file failed, err = {}", utils::safe_strerror(errno));
+                complete_io(aio_tsk, ERR_FILE_OPERATION_FAILED, 0);
+                return;
+            }
+            if (n == 0) {
+                break;
+            }
+            read_bytes += static_cast<uint64_t>(n);
+        }
+        complete_io(aio_tsk, ERR_OK, read_bytes);
+        return;
+    }
+
+    // Short writes are rare for regular files, just finish the remaining part in place.
+    uint64_t written = static_cast<uint64_t>(res);
+    while (written < aio_ctx->buffer_size) {
+        ssize_t n = ::pwrite(aio_ctx->dfile->native_handle(),
+                             static_cast<const char *>(aio_ctx->buffer) + written,
+                             aio_ctx->buffer_size - written,
+                             aio_ctx->file_offset + written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            LOG_ERROR("write file failed, err = {}", utils::safe_strerror(errno));
+            complete_io(aio_tsk, ERR_FILE_OPERATION_FAILED, 0);
+            return;
+        }
+        written += static_cast<uint64_t>(n);
+    }
+    complete_io(aio_tsk, ERR_OK, written);
+}
+
+} // namespace dsn
@@ -0,0 +1,95 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "native_linux_aio_provider.h"
+
+namespace dsn {
+class aio_context;
+class aio_task;
+class disk_engine;
+
+// An aio_provider which submits the read/write requests to the kernel through io_uring and
+// reaps the completions on a dedicated thread, so that no worker thread is blocked while the
+// disk is busy.
+//
+// The rocksdb file abstractions are still used to open, flush and close the files. A native
+// file descriptor is opened beside each of them to be used by io_uring. In the following
+// cases the requests are executed by the blocking path of native_linux_aio_provider instead:
+// - io_uring is not supported by the kernel (or is forbidden, e.g. by seccomp);
+// - the file is encrypted (FLAGS_encrypt_data_at_rest), since io_uring bypasses the encrypted
+//   env of rocksdb;
+// - the tool is simulator;
+// - the ring is full.
+class io_uring_aio_provider : public native_linux_aio_provider
+{
+public:
+    explicit io_uring_aio_provider(disk_engine *disk);
+    ~io_uring_aio_provider() override;
+
+    int open_native_handle(const std::string &fname, bool for_write) override;
+
+    void submit_aio_task(aio_task *aio) override;
+
+    // Whether the io_uring has been set up successfully.
+    bool available() const { return _ring != nullptr; }
+
+private:
+    struct ring;
+
+    // Push the request of 'aio' into the submission queue, return false if the queue is full.
+    bool push_request(aio_task *aio);
+
+    // Submit all the pushed requests to the kernel in a batch. Only one thread is submitting
+    // at any time, the requests pushed by other threads meanwhile will be submitted together.
+    void submit_pending_requests();
+
+    // Take back the requests which have been pushed but not submitted to the kernel, must be
+    // called with the sq lock held.
+    void retract_unsubmitted_requests(std::vector<aio_task *> &retracted);
+
+    // Wake up the reaper thread with a no-op request.
+    void push_wakeup_request();
+
+    void reap_completions();
+
+    void on_request_completed(aio_task *aio, int res);
+
+    std::unique_ptr<ring> _ring;
+
+    std::mutex _sq_lock;
+    uint32_t _unsubmitted_count;
+    bool _submitting;
+
+    // The count of the requests that have been pushed but whose completions have not been
+    // reaped, used to prevent the completion queue from overflowing.
+    std::atomic<uint32_t> _inflight_count;
+
+    std::atomic<bool> _stopping;
+    std::thread _reaper;
+};
+
+} // namespace dsn
@@ -1,4 +1,4 @@
-#!/bin/sh
+#!/bin/bash
 # The MIT License (MIT)
 #
 # Copyright (c) 2015 Microsoft Corporation
@@ -28,6 +28,15 @@ if [ -z "${REPORT_DIR}" ]; then
     REPORT_DIR="."
 fi
 
-./clear.sh
-output_xml="${REPORT_DIR}/dsn_aio_test.xml"
-GTEST_OUTPUT="xml:${output_xml}" ./dsn_aio_test
+test_cases=(config.ini config-io-uring.ini)
+for test_case in ${test_cases[*]}; do
+    output_xml="${REPORT_DIR}/dsn_aio_test_${test_case/.ini/.xml}"
+    echo "============ run dsn_aio_test ${test_case} ============"
+    ./clear.sh
+    GTEST_OUTPUT="xml:${output_xml}" ./dsn_aio_test ${test_case}
+    if [ $? -ne 0 ]; then
+        echo "run dsn_aio_test ${test_case} failed"
+        exit 1
+    fi
+    echo "============ done dsn_aio_test ${test_case} ============"
+done
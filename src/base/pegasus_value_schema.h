@@ -52,13 +52,127 @@ inline uint64_t extract_timestamp_from_timetag(uint64_t timetag)
     return static_cast<uint64_t>((timetag >> 8u) & 0xFFFFFFFFFFFFFFLu);
 }
 
+/// \return true if expired
+inline bool check_if_ts_expired(uint32_t epoch_now, uint32_t expire_ts)
+{
+    return expire_ts > 0 && expire_ts <= epoch_now;
+}
+
+enum data_version
+{
+    VERSION_0 = 0,
+    VERSION_1 = 1,
+    VERSION_2 = 2,
+    VERSION_COUNT,
+    VERSION_MAX = VERSION_2,
+};
+
+/// The offsets of the fields in the rocksdb value of each data version, which are known at
+/// compile time. See value_schema_v0, value_schema_v1 and value_schema_v2 for the layouts.
+template <data_version V>
+struct value_schema_layout;
+
+template <>
+struct value_schema_layout<data_version::VERSION_0>
+{
+    static constexpr size_t expire_ts_offset = 0;
+    static constexpr bool has_time_tag = false;
+    static constexpr size_t time_tag_offset = 0;
+    static constexpr size_t user_data_offset = sizeof(uint32_t);
+};
+
+template <>
+struct value_schema_layout<data_version::VERSION_1>
+{
+    static constexpr size_t expire_ts_offset = 0;
+    static constexpr bool has_time_tag = true;
+    static constexpr size_t time_tag_offset = sizeof(uint32_t);
+    static constexpr size_t user_data_offset = sizeof(uint32_t) + sizeof(uint64_t);
+};
+
+template <>
+struct value_schema_layout<data_version::VERSION_2>
+{
+    static constexpr size_t expire_ts_offset = sizeof(uint8_t);
+    static constexpr bool has_time_tag = true;
+    static constexpr size_t time_tag_offset = sizeof(uint8_t) + sizeof(uint32_t);
+    static constexpr size_t user_data_offset =
+        sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint64_t);
+};
+
+/// A view on the rocksdb value of data version V, which decodes the header fields in place
+/// without any memory allocation. The raw value must be alive while the view is used.
+template <data_version V>
+class value_view
+{
+public:
+    using layout = value_schema_layout<V>;
+
+    explicit value_view(std::string_view raw_value) : _raw_value(raw_value) {}
+
+    /// \return expire_ts in host endian
+    uint32_t expire_ts() const { return read_unsigned<uint32_t>(layout::expire_ts_offset); }
+
+    /// \return timetag in host endian
+    uint64_t time_tag() const
+    {
+        static_assert(layout::has_time_tag, "there is no timetag in this data version");
+        return read_unsigned<uint64_t>(layout::time_tag_offset);
+    }
+
+    std::string_view user_data() const
+    {
+        CHECK_GE(_raw_value.length(), layout::user_data_offset);
+        return _raw_value.substr(layout::user_data_offset);
+    }
+
+    /// \return true if expired
+    bool is_expired(uint32_t epoch_now) const
+    {
+        return check_if_ts_expired(epoch_now, expire_ts());
+    }
+
+private:
+    template <typename T>
+    T read_unsigned(size_t offset) const
+    {
+        CHECK_GE(_raw_value.length(), offset + sizeof(T));
+
+        T val = 0;
+        memcpy(&val, _raw_value.data() + offset, sizeof(T));
+        return dsn::endian::ntoh(val);
+    }
+
+    std::string_view _raw_value;
+};
+
+/// Calls `f` with the value_view of the given data version on the raw value, e.g.
+///     visit_value_view(version, raw_value, [](auto view) { return view.expire_ts(); });
+/// `f` is instantiated for each data version, thus the decoding is dispatched only once
+/// by the switch here, and all the offsets are constants in `f`.
+template <typename F>
+inline auto visit_value_view(uint32_t version, std::string_view raw_value, F &&f)
+{
+    switch (version) {
+    case data_version::VERSION_0:
+        return f(value_view<data_version::VERSION_0>(raw_value));
+    case data_version::VERSION_1:
+        return f(value_view<data_version::VERSION_1>(raw_value));
+    case data_version::VERSION_2:
+        return f(value_view<data_version::VERSION_2>(raw_value));
+    default:
+        LOG_FATAL("unsupported value schema version: {}", version);
+        __builtin_unreachable();
+    }
+}
+
 /// Extracts expire_ts from rocksdb value with given version.
 /// The value schema must be in v0 or v1.
 /// \return expire_ts in host endian
 inline uint32_t pegasus_extract_expire_ts(uint32_t version, std::string_view value)
 {
     CHECK_LE(version, PEGASUS_DATA_VERSION_MAX);
-    return dsn::data_input(value).read_u32();
+    return visit_value_view(version, value, [](auto view) { return view.expire_ts(); });
 }
 
 /// Extracts user value from a raw rocksdb value.
@@ -71,27 +185,33 @@ pegasus_extract_user_data(uint32_t version, std::string &&raw_value, ::dsn::blob
     CHECK_LE(version, PEGASUS_DATA_VERSION_MAX);
 
     auto *s = new std::string(std::move(raw_value));
-    dsn::data_input input(*s);
-    input.skip(sizeof(uint32_t));
-    if (version == 1) {
-        input.skip(sizeof(uint64_t));
-    }
-    std::string_view view = input.read_str();
+    std::string_view view =
+        visit_value_view(version, *s, [](auto view) { return view.user_data(); });
 
     // tricky code to avoid memory copy
     std::shared_ptr<char> buf(const_cast<char *>(view.data()), [s](char *) { delete s; });
     user_data.assign(std::move(buf), 0, static_cast<unsigned int>(view.length()));
 }
 
+/// Copies user value from a raw rocksdb value which is not owned by the caller, e.g. the
+/// value of a rocksdb iterator. Only the user value is copied, into a single buffer.
+/// \param user_data: the result.
+inline void
+pegasus_copy_user_data(uint32_t version, std::string_view raw_value, ::dsn::blob &user_data)
+{
+    CHECK_LE(version, PEGASUS_DATA_VERSION_MAX);
+
+    std::string_view view =
+        visit_value_view(version, raw_value, [](auto view) { return view.user_data(); });
+    user_data = dsn::blob::create_from_bytes(view.data(), view.length());
+}
+
 /// Extracts timetag from a v1 value.
 inline uint64_t pegasus_extract_timetag(int version, std::string_view value)
 {
     CHECK_EQ(version, 1);
 
-    dsn::data_input input(value);
-    input.skip(sizeof(uint32_t));
-
-    return input.read_u64();
+    return value_view<data_version::VERSION_1>(value).time_tag();
 }
 
 /// Update expire_ts in rocksdb value with given version.
@@ -109,12 +229,6 @@ inline void pegasus_update_expire_ts(uint32_t version, std::string &value, uint3
     }
 }
 
-/// \return true if expired
-inline bool check_if_ts_expired(uint32_t epoch_now, uint32_t expire_ts)
-{
-    return expire_ts > 0 && expire_ts <= epoch_now;
-}
-
 /// \return true if expired
 inline bool check_if_record_expired(uint32_t value_schema_version,
                                     uint32_t epoch_now,
@@ -230,15 +344,6 @@ private:
     std::vector<rocksdb::Slice> _write_slices;
 };
 
-enum data_version
-{
-    VERSION_0 = 0,
-    VERSION_1 = 1,
-    VERSION_2 = 2,
-    VERSION_COUNT,
-    VERSION_MAX = VERSION_2,
-};
-
 struct value_params
 {
     value_params(std::string &buf, std::vector<rocksdb::Slice> &slices)
@@ -0,0 +1,220 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "scan_aggregator.h"
+
+#include <string.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "pegasus_value_schema.h"
+#include "utils/endians.h"
+#include "utils/fmt_logging.h"
+
+namespace pegasus {
+namespace {
+
+// Merge the expire_ts range [min_expire_ts, max_expire_ts] of 'ttl_kv_count' records into 'to'.
+// expire_ts is unsigned in fact, though it's i32 in thrift.
+void merge_expire_ts(int64_t ttl_kv_count,
+                     uint32_t min_expire_ts,
+                     uint32_t max_expire_ts,
+                     dsn::apps::scan_aggregation &to)
+{
+    if (ttl_kv_count == 0) {
+        return;
+    }
+
+    if (to.ttl_kv_count > 0) {
+        min_expire_ts = std::min(static_cast<uint32_t>(to.min_expire_ts), min_expire_ts);
+        max_expire_ts = std::max(static_cast<uint32_t>(to.max_expire_ts), max_expire_ts);
+    }
+    to.ttl_kv_count += ttl_kv_count;
+    to.min_expire_ts = static_cast<int32_t>(min_expire_ts);
+    to.max_expire_ts = static_cast<int32_t>(max_expire_ts);
+}
+
+void to_client_histogram(const dsn::apps::scan_size_histogram &from,
+                         pegasus_client::scan_size_histogram &to)
+{
+    to.count = from.count;
+    to.sum = from.sum;
+    to.min = from.min;
+    to.max = from.max;
+    to.buckets = from.buckets;
+}
+
+void from_client_histogram(const pegasus_client::scan_size_histogram &from,
+                           dsn::apps::scan_size_histogram &to)
+{
+    to.count = from.count;
+    to.sum = from.sum;
+    to.min = from.min;
+    to.max = from.max;
+    to.buckets = from.buckets;
+}
+
+} // anonymous namespace
+
+int scan_size_histogram_bucket(uint64_t size)
+{
+    int bucket = 0;
+    while (size > 0 && bucket < SCAN_SIZE_HISTOGRAM_BUCKET_COUNT - 1) {
+        size >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+void scan_size_histogram_add(dsn::apps::scan_size_histogram &histogram, int64_t size)
+{
+    if (histogram.count == 0) {
+        histogram.min = size;
+        histogram.max = size;
+    } else {
+        histogram.min = std::min(histogram.min, size);
+        histogram.max = std::max(histogram.max, size);
+    }
+    ++histogram.count;
+    histogram.sum += size;
+
+    histogram.buckets.resize(SCAN_SIZE_HISTOGRAM_BUCKET_COUNT);
+    ++histogram.buckets[scan_size_histogram_bucket(static_cast<uint64_t>(size))];
+}
+
+void scan_size_histogram_merge(const dsn::apps::scan_size_histogram &from,
+                               dsn::apps::scan_size_histogram &to)
+{
+    if (from.count == 0) {
+        return;
+    }
+
+    if (to.count == 0) {
+        to.min = from.min;
+        to.max = from.max;
+    } else {
+        to.min = std::min(to.min, from.min);
+        to.max = std::max(to.max, from.max);
+    }
+    to.count += from.count;
+    to.sum += from.sum;
+
+    if (to.buckets.size() < from.buckets.size()) {
+        to.buckets.resize(from.buckets.size());
+    }
+    for (size_t i = 0; i < from.buckets.size(); ++i) {
+        to.buckets[i] += from.buckets[i];
+    }
+}
+
+void scan_aggregation_merge(const dsn::apps::scan_aggregation &from,
+                            dsn::apps::scan_aggregation &to)
+{
+    to.kv_count += from.kv_count;
+    to.hash_key_count += from.hash_key_count;
+    scan_size_histogram_merge(from.hash_key_size, to.hash_key_size);
+    scan_size_histogram_merge(from.sort_key_size, to.sort_key_size);
+    scan_size_histogram_merge(from.value_size, to.value_size);
+    scan_size_histogram_merge(from.row_size, to.row_size);
+
+    merge_expire_ts(from.ttl_kv_count,
+                    static_cast<uint32_t>(from.min_expire_ts),
+                    static_cast<uint32_t>(from.max_expire_ts),
+                    to);
+}
+
+void scan_aggregation_to_client(const dsn::apps::scan_aggregation &from,
+                                pegasus_client::scan_aggregation &to)
+{
+    to.kv_count = from.kv_count;
+    to.hash_key_count = from.hash_key_count;
+    to_client_histogram(from.hash_key_size, to.hash_key_size);
+    to_client_histogram(from.sort_key_size, to.sort_key_size);
+    to_client_histogram(from.value_size, to.value_size);
+    to_client_histogram(from.row_size, to.row_size);
+    to.ttl_kv_count = from.ttl_kv_count;
+    to.min_expire_ts = static_cast<uint32_t>(from.min_expire_ts);
+    to.max_expire_ts = static_cast<uint32_t>(from.max_expire_ts);
+}
+
+void scan_aggregation_from_client(const pegasus_client::scan_aggregation &from,
+                                  dsn::apps::scan_aggregation &to)
+{
+    to.kv_count = from.kv_count;
+    to.hash_key_count = from.hash_key_count;
+    from_client_histogram(from.hash_key_size, to.hash_key_size);
+    from_client_histogram(from.sort_key_size, to.sort_key_size);
+    from_client_histogram(from.value_size, to.value_size);
+    from_client_histogram(from.row_size, to.row_size);
+    to.ttl_kv_count = from.ttl_kv_count;
+    to.min_expire_ts = static_cast<int32_t>(from.min_expire_ts);
+    to.max_expire_ts = static_cast<int32_t>(from.max_expire_ts);
+}
+
+scan_aggregator::scan_aggregator(uint32_t data_version)
+    : _data_version(data_version), _has_last_hash_key(false)
+{
+}
+
+void scan_aggregator::add(std::string_view raw_key, std::string_view raw_value)
+{
+    CHECK_GE(raw_key.length(), sizeof(uint16_t));
+
+    // hash_key_len is in big endian
+    uint16_t hash_key_len = 0;
+    memcpy(&hash_key_len, raw_key.data(), sizeof(uint16_t));
+    hash_key_len = dsn::endian::ntoh(hash_key_len);
+    CHECK_GE(raw_key.length(), sizeof(uint16_t) + hash_key_len);
+
+    std::string_view hash_key = raw_key.substr(sizeof(uint16_t), hash_key_len);
+    size_t sort_key_len = raw_key.length() - sizeof(uint16_t) - hash_key_len;
+
+    if (!_has_last_hash_key || hash_key != _last_hash_key) {
+        ++_aggregation.hash_key_count;
+        _has_last_hash_key = true;
+        _last_hash_key.assign(hash_key.data(), hash_key.length());
+    }
+
+    uint32_t expire_ts = 0;
+    size_t value_len = 0;
+    visit_value_view(_data_version, raw_value, [&expire_ts, &value_len](auto view) {
+        expire_ts = view.expire_ts();
+        value_len = view.user_data().length();
+    });
+
+    ++_aggregation.kv_count;
+    scan_size_histogram_add(_aggregation.hash_key_size, hash_key_len);
+    scan_size_histogram_add(_aggregation.sort_key_size, sort_key_len);
+    scan_size_histogram_add(_aggregation.value_size, value_len);
+    scan_size_histogram_add(_aggregation.row_size, hash_key_len + sort_key_len + value_len);
+
+    if (expire_ts > 0) {
+        merge_expire_ts(1, expire_ts, expire_ts, _aggregation);
+    }
+}
+
+dsn::apps::scan_aggregation scan_aggregator::take_aggregation()
+{
+    dsn::apps::scan_aggregation aggregation;
+    std::swap(aggregation, _aggregation);
+    return aggregation;
+}
+
+} // namespace pegasus
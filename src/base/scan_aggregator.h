@@ -0,0 +1,75 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+
+#include "pegasus/client.h"
+#include "rrdb/rrdb_types.h"
+
+namespace pegasus {
+
+// The bucket count of dsn::apps::scan_size_histogram. Bucket i (i > 0) counts the sizes in
+// [2^(i-1), 2^i), thus the last bucket counts all the sizes not less than 2^31.
+constexpr int SCAN_SIZE_HISTOGRAM_BUCKET_COUNT = 33;
+
+// Get the bucket which the size falls in.
+int scan_size_histogram_bucket(uint64_t size);
+
+void scan_size_histogram_add(dsn::apps::scan_size_histogram &histogram, int64_t size);
+
+// Merge 'from' into 'to', both of which could be empty (i.e. default-constructed).
+void scan_size_histogram_merge(const dsn::apps::scan_size_histogram &from,
+                               dsn::apps::scan_size_histogram &to);
+
+// Merge 'from' into 'to', both of which could be empty (i.e. default-constructed).
+void scan_aggregation_merge(const dsn::apps::scan_aggregation &from,
+                            dsn::apps::scan_aggregation &to);
+
+// Convert between the aggregation of thrift and the one of the public client API.
+void scan_aggregation_to_client(const dsn::apps::scan_aggregation &from,
+                                pegasus_client::scan_aggregation &to);
+void scan_aggregation_from_client(const pegasus_client::scan_aggregation &from,
+                                  dsn::apps::scan_aggregation &to);
+
+// Aggregates the records scanned by get_scanner/scan on the server side, see
+// get_scanner_request.return_aggregation. An aggregator lives through all the batches of a
+// scan, so that the hash keys across the batches could be counted correctly.
+class scan_aggregator
+{
+public:
+    explicit scan_aggregator(uint32_t data_version);
+
+    // Add a record read from rocksdb, which must be valid (neither expired nor filtered).
+    void add(std::string_view raw_key, std::string_view raw_value);
+
+    // Return the aggregation of the records added since the last call, i.e. of current batch.
+    dsn::apps::scan_aggregation take_aggregation();
+
+private:
+    const uint32_t _data_version;
+    bool _has_last_hash_key;
+    std::string _last_hash_key;
+    dsn::apps::scan_aggregation _aggregation;
+};
+
+} // namespace pegasus
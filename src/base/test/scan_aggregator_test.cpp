@@ -0,0 +1,139 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <rocksdb/slice.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "base/pegasus_key_schema.h"
+#include "base/pegasus_value_schema.h"
+#include "base/scan_aggregator.h"
+#include "gtest/gtest.h"
+#include "rrdb/rrdb_types.h"
+#include "utils/blob.h"
+
+namespace pegasus {
+
+std::string generate_raw_key(const std::string &hash_key, const std::string &sort_key)
+{
+    dsn::blob key;
+    pegasus_generate_key(key, hash_key, sort_key);
+    return key.to_string();
+}
+
+std::string generate_raw_value(uint32_t expire_ts, const std::string &user_data)
+{
+    pegasus_value_generator gen;
+    auto sparts = gen.generate_value(1, user_data, expire_ts, 0);
+    std::string value;
+    for (int i = 0; i < sparts.num_parts; ++i) {
+        value.append(sparts.parts[i].data(), sparts.parts[i].size());
+    }
+    return value;
+}
+
+TEST(scan_aggregator, histogram_bucket)
+{
+    ASSERT_EQ(0, scan_size_histogram_bucket(0));
+    ASSERT_EQ(1, scan_size_histogram_bucket(1));
+    ASSERT_EQ(2, scan_size_histogram_bucket(2));
+    ASSERT_EQ(2, scan_size_histogram_bucket(3));
+    ASSERT_EQ(3, scan_size_histogram_bucket(4));
+    ASSERT_EQ(11, scan_size_histogram_bucket(1024));
+    ASSERT_EQ(SCAN_SIZE_HISTOGRAM_BUCKET_COUNT - 1, scan_size_histogram_bucket(1ULL << 31));
+    ASSERT_EQ(SCAN_SIZE_HISTOGRAM_BUCKET_COUNT - 1, scan_size_histogram_bucket(UINT64_MAX));
+}
+
+TEST(scan_aggregator, aggregate)
+{
+    scan_aggregator aggregator(1);
+    aggregator.add(generate_raw_key("h1", "s1"), generate_raw_value(0, "v"));
+    aggregator.add(generate_raw_key("h1", "s22"), generate_raw_value(100, ""));
+    auto first = aggregator.take_aggregation();
+
+    // The hash key "h1" which continues from the last batch is not counted again.
+    aggregator.add(generate_raw_key("h1", "s333"), generate_raw_value(50, "vvvv"));
+    aggregator.add(generate_raw_key("h22", ""), generate_raw_value(0, "vv"));
+    auto second = aggregator.take_aggregation();
+
+    ASSERT_EQ(2, first.kv_count);
+    ASSERT_EQ(1, first.hash_key_count);
+    ASSERT_EQ(2, first.hash_key_size.count);
+    ASSERT_EQ(4, first.hash_key_size.sum);
+    ASSERT_EQ(2, first.sort_key_size.min);
+    ASSERT_EQ(3, first.sort_key_size.max);
+    ASSERT_EQ(0, first.value_size.min);
+    ASSERT_EQ(1, first.value_size.max);
+    ASSERT_EQ(SCAN_SIZE_HISTOGRAM_BUCKET_COUNT, first.value_size.buckets.size());
+    ASSERT_EQ(1, first.value_size.buckets[0]);
+    ASSERT_EQ(1, first.value_size.buckets[1]);
+    ASSERT_EQ(10, first.row_size.sum);
+    ASSERT_EQ(1, first.ttl_kv_count);
+    ASSERT_EQ(100, first.min_expire_ts);
+    ASSERT_EQ(100, first.max_expire_ts);
+
+    ASSERT_EQ(2, second.kv_count);
+    ASSERT_EQ(1, second.hash_key_count);
+    ASSERT_EQ(0, second.sort_key_size.min);
+    ASSERT_EQ(4, second.sort_key_size.max);
+    ASSERT_EQ(1, second.ttl_kv_count);
+    ASSERT_EQ(50, second.min_expire_ts);
+
+    dsn::apps::scan_aggregation total;
+    scan_aggregation_merge(first, total);
+    scan_aggregation_merge(second, total);
+    scan_aggregation_merge(dsn::apps::scan_aggregation(), total);
+    ASSERT_EQ(4, total.kv_count);
+    ASSERT_EQ(2, total.hash_key_count);
+    ASSERT_EQ(4, total.value_size.count);
+    ASSERT_EQ(7, total.value_size.sum);
+    ASSERT_EQ(0, total.value_size.min);
+    ASSERT_EQ(4, total.value_size.max);
+    ASSERT_EQ(1, total.value_size.buckets[2]);
+    ASSERT_EQ(1, total.value_size.buckets[3]);
+    ASSERT_EQ(2, total.ttl_kv_count);
+    ASSERT_EQ(50, total.min_expire_ts);
+    ASSERT_EQ(100, total.max_expire_ts);
+}
+
+TEST(scan_aggregator, convert_to_and_from_client)
+{
+    scan_aggregator aggregator(1);
+    aggregator.add(generate_raw_key("h1", "s1"), generate_raw_value(0, "v"));
+    // The expire_ts above INT32_MAX is kept unsigned by the client.
+    aggregator.add(generate_raw_key("h22", "s22"), generate_raw_value(3000000000U, "vvv"));
+    const auto aggregation = aggregator.take_aggregation();
+
+    pegasus_client::scan_aggregation client_aggregation;
+    scan_aggregation_to_client(aggregation, client_aggregation);
+    ASSERT_EQ(2, client_aggregation.kv_count);
+    ASSERT_EQ(2, client_aggregation.hash_key_count);
+    ASSERT_EQ(3, client_aggregation.hash_key_size.max);
+    ASSERT_EQ(4, client_aggregation.value_size.sum);
+    ASSERT_EQ(aggregation.row_size.buckets, client_aggregation.row_size.buckets);
+    ASSERT_EQ(1, client_aggregation.ttl_kv_count);
+    ASSERT_EQ(3000000000U, client_aggregation.min_expire_ts);
+
+    dsn::apps::scan_aggregation converted;
+    scan_aggregation_from_client(client_aggregation, converted);
+    ASSERT_EQ(aggregation, converted);
+}
+
+} // namespace pegasus
@@ -0,0 +1,218 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <fmt/core.h>
+#include <rocksdb/slice.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "base/pegasus_value_schema.h"
+#include "base/value_field.h"
+#include "base/value_schema_manager.h"
+#include "runtime/api_layer1.h"
+#include "utils/blob.h"
+#include "utils/rand.h"
+#include "utils/string_conv.h"
+#include "utils/strings.h"
+
+void print_usage(const char *cmd)
+{
+    fmt::print("USAGE: {} <num_operations> [sizes]\n", cmd);
+    fmt::print("Run a simple benchmark that compares the allocating and the in-place decoding\n"
+               "of the rocksdb values.\n\n");
+
+    fmt::print("    <num_operations>       the number of values decoded for each case.\n");
+    fmt::print("    [sizes]                the user data size list, separated by comma(,) if\n"
+               "                           more than one element, e.g., \"16,4096\"; if this arg\n"
+               "                           is missing, 16B, 256B and 4KB will be used.\n");
+}
+
+// Generate some rocksdb values of the given data version, whose user data are all of the
+// given size.
+std::vector<std::string> generate_values(uint32_t version, size_t size)
+{
+    static const size_t kNumValues = 1024;
+
+    std::vector<std::string> values;
+    values.reserve(kNumValues);
+    for (size_t i = 0; i < kNumValues; ++i) {
+        std::string user_data(size, 'a');
+        std::string buf;
+        std::vector<rocksdb::Slice> slices;
+        pegasus::value_params params(buf, slices);
+        params.fields[pegasus::value_field_type::EXPIRE_TIMESTAMP] =
+            std::make_unique<pegasus::expire_timestamp_field>(dsn::rand::next_u32());
+        params.fields[pegasus::value_field_type::TIME_TAG] =
+            std::make_unique<pegasus::time_tag_field>(dsn::rand::next_u64());
+        params.fields[pegasus::value_field_type::USER_DATA] =
+            std::make_unique<pegasus::user_data_field>(user_data);
+
+        auto *schema = pegasus::value_schema_manager::instance().get_value_schema(version);
+        auto sparts = schema->generate_value(params);
+
+        std::string value;
+        for (int j = 0; j < sparts.num_parts; ++j) {
+            value.append(sparts.parts[j].data(), sparts.parts[j].size());
+        }
+        values.emplace_back(std::move(value));
+    }
+    return values;
+}
+
+// Run `op` on each of the values in turn for `num_operations` times, and return the elapsed
+// time in nanoseconds. `op` returns some number derived from the decoded result, which is
+// accumulated into `checksum` to prevent the decoding from being optimized out.
+int64_t run_op(const std::vector<std::string> &values,
+               uint64_t num_operations,
+               const std::function<uint64_t(const std::string &)> &op,
+               uint64_t &checksum)
+{
+    checksum = 0;
+    auto start = dsn_now_ns();
+    for (uint64_t i = 0; i < num_operations; ++i) {
+        checksum += op(values[i % values.size()]);
+    }
+    auto end = dsn_now_ns();
+
+    return static_cast<int64_t>(end - start);
+}
+
+void run_bench(const std::string &name,
+               const std::vector<std::string> &values,
+               size_t size,
+               uint64_t num_operations,
+               const std::function<uint64_t(const std::string &)> &old_op,
+               const std::function<uint64_t(const std::string &)> &new_op)
+{
+    uint64_t old_checksum = 0;
+    uint64_t new_checksum = 0;
+    auto old_ns = run_op(values, num_operations, old_op, old_checksum);
+    auto new_ns = run_op(values, num_operations, new_op, new_checksum);
+    if (old_checksum != new_checksum) {
+        fmt::print(stderr,
+                   "{}: old_checksum({}) != new_checksum({})\n",
+                   name,
+                   old_checksum,
+                   new_checksum);
+        ::exit(-1);
+    }
+
+    auto ns_per_op = [num_operations](int64_t ns) {
+        return static_cast<double>(ns) / num_operations;
+    };
+    fmt::print("{:<24} {:>10} {:>14.2f} {:>14.2f} {:>10.2f}\n",
+               name,
+               size,
+               ns_per_op(old_ns),
+               ns_per_op(new_ns),
+               new_ns == 0 ? 0.0 : static_cast<double>(old_ns) / new_ns);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    uint64_t num_operations;
+    if (!dsn::buf2uint64(argv[1], num_operations) || num_operations == 0) {
+        fmt::print(stderr, "Invalid num_operations: {}\n\n", argv[1]);
+
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    std::vector<size_t> sizes;
+    if (argc >= 3) {
+        std::vector<std::string> size_strs;
+        dsn::utils::split_args(argv[2], size_strs, ',');
+        for (const auto &s : size_strs) {
+            uint64_t size;
+            if (!dsn::buf2uint64(s, size) || size == 0) {
+                fmt::print(stderr, "Invalid size: {}\n\n", s);
+
+                print_usage(argv[0]);
+                ::exit(-1);
+            }
+            sizes.push_back(size);
+        }
+    } else {
+        sizes = {16, 256, 4096};
+    }
+
+    fmt::print("{:<24} {:>10} {:>14} {:>14} {:>10}\n",
+               "case",
+               "size(B)",
+               "old(ns/op)",
+               "new(ns/op)",
+               "speedup");
+    for (auto size : sizes) {
+        for (uint32_t version = 0; version < pegasus::data_version::VERSION_COUNT; ++version) {
+            auto values = generate_values(version, size);
+            auto *schema = pegasus::value_schema_manager::instance().get_value_schema(version);
+
+            // value_schema::extract_field allocates a value_field for each call, while the
+            // value_view decodes the field in place.
+            run_bench(
+                fmt::format("expire_ts(v{})", version),
+                values,
+                size,
+                num_operations,
+                [schema](const std::string &value) -> uint64_t {
+                    auto field = schema->extract_field(
+                        value, pegasus::value_field_type::EXPIRE_TIMESTAMP);
+                    return static_cast<pegasus::expire_timestamp_field *>(field.get())
+                        ->expire_ts;
+                },
+                [version](const std::string &value) -> uint64_t {
+                    return pegasus::visit_value_view(
+                        version, value, [](auto view) { return view.expire_ts(); });
+                });
+
+            if (version > static_cast<uint32_t>(pegasus::PEGASUS_DATA_VERSION_MAX)) {
+                continue;
+            }
+
+            // The read path used to copy the whole value out of the rocksdb iterator before
+            // extracting the user data from it.
+            run_bench(
+                fmt::format("user_data(v{})", version),
+                values,
+                size,
+                num_operations,
+                [version](const std::string &value) -> uint64_t {
+                    dsn::blob user_data;
+                    pegasus::pegasus_extract_user_data(version, std::string(value), user_data);
+                    return user_data.length() + static_cast<uint8_t>(user_data.data()[0]);
+                },
+                [version](const std::string &value) -> uint64_t {
+                    dsn::blob user_data;
+                    pegasus::pegasus_copy_user_data(version, value, user_data);
+                    return user_data.length() + static_cast<uint8_t>(user_data.data()[0]);
+                });
+        }
+    }
+
+    return 0;
+}
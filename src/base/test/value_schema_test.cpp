@@ -134,3 +134,60 @@ TEST(value_schema, update_expire_ts)
         ASSERT_EQ(t.update_expire_ts, extract_expire_ts(schema, raw_value));
     }
 }
+
+TEST(value_schema, value_view)
+{
+    struct test_case
+    {
+        uint32_t data_version;
+        uint32_t expire_ts;
+        uint64_t time_tag;
+        std::string user_data;
+    } tests[] = {
+        {0, 1000, 0, ""},
+        {0, std::numeric_limits<uint32_t>::max(), 0, "pegasus"},
+        {1, 1000, 10001, ""},
+        {1, std::numeric_limits<uint32_t>::max(), std::numeric_limits<uint64_t>::max(), "pegasus"},
+        {2, 1000, 10001, ""},
+        {2, std::numeric_limits<uint32_t>::max(), std::numeric_limits<uint64_t>::max(), "pegasus"},
+    };
+
+    for (const auto &t : tests) {
+        auto schema = value_schema_manager::instance().get_value_schema(t.data_version);
+        std::string raw_value = generate_value(schema, t.expire_ts, t.time_tag, t.user_data);
+
+        ASSERT_EQ(t.expire_ts, visit_value_view(t.data_version, raw_value, [](auto view) {
+                      return view.expire_ts();
+                  }));
+        ASSERT_EQ(t.user_data, visit_value_view(t.data_version, raw_value, [](auto view) {
+                      return view.user_data();
+                  }));
+        if (t.data_version >= 1) {
+            ASSERT_EQ(t.time_tag, visit_value_view(t.data_version, raw_value, [](auto view) {
+                          if constexpr (decltype(view)::layout::has_time_tag) {
+                              return view.time_tag();
+                          } else {
+                              return uint64_t(0);
+                          }
+                      }));
+        }
+
+        ASSERT_FALSE(visit_value_view(t.data_version, raw_value, [&t](auto view) {
+            return view.is_expired(t.expire_ts - 1);
+        }));
+        ASSERT_TRUE(visit_value_view(
+            t.data_version, raw_value, [&t](auto view) { return view.is_expired(t.expire_ts); }));
+
+        if (t.data_version <= PEGASUS_DATA_VERSION_MAX) {
+            ASSERT_EQ(t.expire_ts, pegasus_extract_expire_ts(t.data_version, raw_value));
+
+            dsn::blob copied_user_data;
+            pegasus_copy_user_data(t.data_version, raw_value, copied_user_data);
+            ASSERT_EQ(t.user_data, copied_user_data.to_string());
+
+            dsn::blob moved_user_data;
+            pegasus_extract_user_data(t.data_version, std::move(raw_value), moved_user_data);
+            ASSERT_EQ(t.user_data, moved_user_data.to_string());
+        }
+    }
+}
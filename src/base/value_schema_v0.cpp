@@ -49,7 +49,7 @@ std::unique_ptr<value_field> value_schema_v0::extract_field(std::string_view val
 dsn::blob value_schema_v0::extract_user_data(std::string &&value)
 {
     auto ret = dsn::blob::create_from_bytes(std::move(value));
-    return ret.range(sizeof(uint32_t));
+    return ret.range(value_schema_layout<data_version::VERSION_0>::user_data_offset);
 }
 
 void value_schema_v0::update_field(std::string &value, std::unique_ptr<value_field> field)
@@ -89,8 +89,8 @@ rocksdb::SliceParts value_schema_v0::generate_value(const value_params &params)
 
 std::unique_ptr<value_field> value_schema_v0::extract_timestamp(std::string_view value)
 {
-    uint32_t expire_ts = dsn::data_input(value).read_u32();
-    return std::make_unique<expire_timestamp_field>(expire_ts);
+    return std::make_unique<expire_timestamp_field>(
+        value_view<data_version::VERSION_0>(value).expire_ts());
 }
 
 void value_schema_v0::update_expire_ts(std::string &value, std::unique_ptr<value_field> field)
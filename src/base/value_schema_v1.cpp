@@ -52,7 +52,7 @@ std::unique_ptr<value_field> value_schema_v1::extract_field(std::string_view val
 dsn::blob value_schema_v1::extract_user_data(std::string &&value)
 {
     auto ret = dsn::blob::create_from_bytes(std::move(value));
-    return ret.range(sizeof(uint32_t) + sizeof(uint64_t));
+    return ret.range(value_schema_layout<data_version::VERSION_1>::user_data_offset);
 }
 
 void value_schema_v1::update_field(std::string &value, std::unique_ptr<value_field> field)
@@ -97,15 +97,13 @@ rocksdb::SliceParts value_schema_v1::generate_value(const value_params &params)
 
 std::unique_ptr<value_field> value_schema_v1::extract_timestamp(std::string_view value)
 {
-    uint32_t expire_ts = dsn::data_input(value).read_u32();
-    return std::make_unique<expire_timestamp_field>(expire_ts);
+    return std::make_unique<expire_timestamp_field>(
+        value_view<data_version::VERSION_1>(value).expire_ts());
 }
 
 std::unique_ptr<value_field> value_schema_v1::extract_time_tag(std::string_view value)
 {
-    dsn::data_input input(value);
-    input.skip(sizeof(uint32_t));
-    return std::make_unique<time_tag_field>(input.read_u64());
+    return std::make_unique<time_tag_field>(value_view<data_version::VERSION_1>(value).time_tag());
 }
 
 void value_schema_v1::update_expire_ts(std::string &value, std::unique_ptr<value_field> field)
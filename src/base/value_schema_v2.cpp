@@ -53,8 +53,7 @@ std::unique_ptr<value_field> value_schema_v2::extract_field(std::string_view val
 dsn::blob value_schema_v2::extract_user_data(std::string &&value)
 {
     auto ret = dsn::blob::create_from_bytes(std::move(value));
-    static const auto USER_DATA_OFFSET = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint64_t);
-    return ret.range(USER_DATA_OFFSET);
+    return ret.range(value_schema_layout<data_version::VERSION_2>::user_data_offset);
 }
 
 void value_schema_v2::update_field(std::string &value, std::unique_ptr<value_field> field)
@@ -100,17 +99,13 @@ rocksdb::SliceParts value_schema_v2::generate_value(const value_params &params)
 
 std::unique_ptr<value_field> value_schema_v2::extract_timestamp(std::string_view value)
 {
-    dsn::data_input input(value);
-    input.skip(sizeof(uint8_t));
-    return std::make_unique<expire_timestamp_field>(input.read_u32());
+    return std::make_unique<expire_timestamp_field>(
+        value_view<data_version::VERSION_2>(value).expire_ts());
 }
 
 std::unique_ptr<value_field> value_schema_v2::extract_time_tag(std::string_view value)
 {
-    dsn::data_input input(value);
-    input.skip(sizeof(uint8_t));
-    input.skip(sizeof(uint32_t));
-    return std::make_unique<time_tag_field>(input.read_u64());
+    return std::make_unique<time_tag_field>(value_view<data_version::VERSION_2>(value).time_tag());
 }
 
 void value_schema_v2::update_expire_ts(std::string &value, std::unique_ptr<value_field> field)
@@ -76,6 +76,13 @@ void partition_resolver::call_task(const rpc_response_task_ptr &t)
             uint64_t gap = 8 << req->send_retry_count;
             if (gap > 1000)
                 gap = 1000;
+            if (req->is_bounded_staleness_read()) {
+                // retry on the primary, immediately if it's just that the secondary is stale
+                req->set_read_staleness_bound({});
+                if (err == ERR_STALE_REPLICA) {
+                    gap = 0;
+                }
+            }
             if (nms + gap < deadline_ms) {
                 req->send_retry_count++;
                 req->header->client.timeout_ms = static_cast<int>(deadline_ms - nms - gap);
@@ -132,7 +139,8 @@ void partition_resolver::call_task(const rpc_response_task_ptr &t)
             }
             dsn_rpc_call(dns_resolver::instance().resolve_address(result.hp), t.get());
         },
-        hdr.client.timeout_ms);
+        hdr.client.timeout_ms,
+        t->get_request()->is_bounded_staleness_read());
 }
 } // namespace replication
 } // namespace dsn
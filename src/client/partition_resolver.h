@@ -73,10 +73,12 @@ public:
                                        TCallback &&callback,
                                        std::chrono::milliseconds timeout,
                                        uint64_t partition_hash,
-                                       int reply_hash = 0)
+                                       int reply_hash = 0,
+                                       const read_staleness_bound &read_bound = {})
     {
         dsn::message_ex *msg = dsn::message_ex::create_request(
             code, static_cast<int>(timeout.count()), 0, partition_hash);
+        msg->set_read_staleness_bound(read_bound);
         marshall(msg, std::forward<TReq>(request));
         dsn::rpc_response_task_ptr response_task = rpc::create_rpc_response_task(
             msg, tracker, std::forward<TCallback>(callback), reply_hash);
@@ -89,10 +91,15 @@ public:
     // if got reply or error, call the callback.
     // parameters like request data, timeout, callback handler are all wrapped
     // into "task", you may want to refer to dsn::rpc_response_task for details.
+    // a read request with staleness bound may be sent to a secondary replica, and would be
+    // retried on the primary replica once the secondary could not satisfy the bound.
     void call_task(const dsn::rpc_response_task_ptr &task);
 
     std::string get_app_name() const { return _app_name; }
 
+    // -1 if the partition count is unknown yet.
+    virtual int get_partition_count() const = 0;
+
     const dsn::host_port &get_meta_server() const { return _meta_server; }
 
     const char *log_prefix() const { return _app_name.c_str(); }
@@ -121,15 +128,17 @@ protected:
     /**
      * resolve partition_hash into IP or group host_port to know what to connect next
      *
-     * \param partition_hash the partition hash
-     * \param callback       callback invoked on completion or timeout
-     * \param timeout_ms     timeout to execute the callback
+     * \param partition_hash  the partition hash
+     * \param callback        callback invoked on completion or timeout
+     * \param timeout_ms      timeout to execute the callback
+     * \param allow_secondary whether the request could be sent to a secondary replica
      *
      * \return see \ref resolve_result for details
      */
     virtual void resolve(uint64_t partition_hash,
                          std::function<void(resolve_result &&)> &&callback,
-                         int timeout_ms) = 0;
+                         int timeout_ms,
+                         bool allow_secondary) = 0;
 
     /*!
      failure handler when access failed for certain partition
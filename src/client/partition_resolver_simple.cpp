@@ -59,17 +59,18 @@ partition_resolver_simple::partition_resolver_simple(host_port meta_server, cons
 
 void partition_resolver_simple::resolve(uint64_t partition_hash,
                                         std::function<void(resolve_result &&)> &&callback,
-                                        int timeout_ms)
+                                        int timeout_ms,
+                                        bool allow_secondary)
 {
     int idx = -1;
     if (_app_partition_count != -1) {
         idx = get_partition_index(_app_partition_count, partition_hash);
         host_port target;
-        auto err = get_host_port(idx, target);
+        auto err = get_host_port(idx, allow_secondary, target);
         if (dsn_unlikely(err == ERR_CHILD_NOT_READY)) {
             // child partition is not ready, its requests should be sent to parent partition
             idx -= _app_partition_count / 2;
-            err = get_host_port(idx, target);
+            err = get_host_port(idx, allow_secondary, target);
         }
         if (dsn_likely(err == ERR_OK)) {
             callback(resolve_result{ERR_OK, target, {_app_id, idx}});
@@ -84,6 +85,7 @@ void partition_resolver_simple::resolve(uint64_t partition_hash,
     rc->timeout_timer = nullptr;
     rc->timeout_ms = timeout_ms;
     rc->timeout_ts_us = dsn_now_us() + timeout_ms * 1000;
+    rc->allow_secondary = allow_secondary;
     rc->completed = false;
 
     call(std::move(rc), false);
@@ -93,7 +95,9 @@ void partition_resolver_simple::on_access_failure(int partition_index, error_cod
 {
     // ERR_CAPACITY_EXCEEDED : no need for reconfiguration on primary
     // ERR_NOT_ENOUGH_MEMBER : primary won't change and we only r/w on primary in this provider
-    if (-1 == partition_index || err == ERR_CAPACITY_EXCEEDED || err == ERR_NOT_ENOUGH_MEMBER) {
+    // ERR_STALE_REPLICA     : the secondary is just lagging behind, the config is still valid
+    if (-1 == partition_index || err == ERR_CAPACITY_EXCEEDED || err == ERR_NOT_ENOUGH_MEMBER ||
+        err == ERR_STALE_REPLICA) {
         return;
     }
 
@@ -167,7 +171,7 @@ void partition_resolver_simple::call(request_context_ptr &&request, bool from_me
     if (-1 != pindex) {
         // fill target host_port if possible
         host_port hp;
-        auto err = get_host_port(pindex, hp);
+        auto err = get_host_port(pindex, request->allow_secondary, hp);
 
         // target host_port known
         if (err == ERR_OK) {
@@ -394,7 +398,7 @@ void partition_resolver_simple::handle_pending_requests(std::deque<request_conte
     for (auto &req : reqs) {
         if (err == ERR_OK) {
             host_port hp;
-            err = get_host_port(req->partition_index, hp);
+            err = get_host_port(req->partition_index, req->allow_secondary, hp);
             if (err == ERR_OK) {
                 end_request(std::move(req), err, hp);
             } else {
@@ -411,10 +415,17 @@ void partition_resolver_simple::handle_pending_requests(std::deque<request_conte
 }
 
 /*search in cache*/
-host_port partition_resolver_simple::get_host_port(const partition_configuration &pc) const
+host_port partition_resolver_simple::get_host_port(const partition_configuration &pc,
+                                                   bool allow_secondary) const
 {
     if (_app_is_stateful) {
-        return pc.hp_primary;
+        // spread the reads over all the members, while the primary is required to be known so
+        // that the reads could be retried on it
+        if (!allow_secondary || !pc.hp_primary || pc.hp_secondaries.empty()) {
+            return pc.hp_primary;
+        }
+        const auto idx = rand::next_u32(0, pc.hp_secondaries.size());
+        return idx == pc.hp_secondaries.size() ? pc.hp_primary : pc.hp_secondaries[idx];
     }
 
     if (pc.hp_last_drops.empty()) {
@@ -424,7 +435,9 @@ host_port partition_resolver_simple::get_host_port(const partition_configuration
     return pc.hp_last_drops[rand::next_u32(0, pc.last_drops.size() - 1)];
 }
 
-error_code partition_resolver_simple::get_host_port(int partition_index, /*out*/ host_port &hp)
+error_code partition_resolver_simple::get_host_port(int partition_index,
+                                                    bool allow_secondary,
+                                                    /*out*/ host_port &hp)
 {
     {
         zauto_read_lock l(_config_lock);
@@ -434,7 +447,7 @@ error_code partition_resolver_simple::get_host_port(int partition_index, /*out*/
                 // client query config for splitting app, child partition is not ready
                 return ERR_CHILD_NOT_READY;
             }
-            hp = get_host_port(it->second->pc);
+            hp = get_host_port(it->second->pc, allow_secondary);
             if (!hp) {
                 return ERR_IO_PENDING;
             } else {
@@ -55,11 +55,12 @@ public:
 
     virtual void resolve(uint64_t partition_hash,
                          std::function<void(resolve_result &&)> &&callback,
-                         int timeout_ms) override;
+                         int timeout_ms,
+                         bool allow_secondary) override;
 
     virtual void on_access_failure(int partition_index, error_code err) override;
 
-    int get_partition_count() const { return _app_partition_count; }
+    int get_partition_count() const override { return _app_partition_count; }
 
 private:
     struct partition_info
@@ -82,6 +83,7 @@ private:
         callback_t callback;
         int timeout_ms;         // init timeout
         uint64_t timeout_ts_us; // timeout at this timing point
+        bool allow_secondary;   // whether could be sent to a secondary replica
 
         zlock lock;             // [
         task_ptr timeout_timer; // when partition config is unknown at the first place
@@ -107,8 +109,8 @@ private:
 
 private:
     // local routines
-    host_port get_host_port(const partition_configuration &pc) const;
-    error_code get_host_port(int partition_index, /*out*/ host_port &hp);
+    host_port get_host_port(const partition_configuration &pc, bool allow_secondary) const;
+    error_code get_host_port(int partition_index, bool allow_secondary, /*out*/ host_port &hp);
     void handle_pending_requests(std::deque<request_context_ptr> &reqs, error_code err);
     void clear_all_pending_requests();
 
@@ -0,0 +1,384 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdint.h>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "client/partition_resolver.h"
+#include "pegasus/client.h"
+#include "pegasus/error.h"
+#include "pegasus_client_impl.h"
+#include "pegasus_key_schema.h"
+#include "rpc/serialization.h"
+#include "rrdb/rrdb.client.h"
+#include "rrdb/rrdb_types.h"
+#include "runtime/api_layer1.h"
+#include "utils/blob.h"
+#include "utils/error_code.h"
+#include "utils/fmt_logging.h"
+#include "utils/synchronize.h"
+#include "utils/zlocks.h"
+
+namespace dsn {
+class message_ex;
+} // namespace dsn
+
+namespace pegasus {
+namespace client {
+
+namespace {
+
+// The max rounds to retry the failed sub-requests of a batch operation, as long as it's not
+// timed out yet.
+const int kBatchMaxRetryRounds = 3;
+
+// Whether the sub-requests failed with the error are worth retrying. Note that the sub-requests
+// have been retried by the partition resolver for the network errors until timeout.
+bool is_batch_error_retriable(int err)
+{
+    switch (err) {
+    case PERR_SERVER_CHANGED:
+    case PERR_NOT_ENOUGH_MEMBER:
+    case PERR_APP_BUSY:
+    case PERR_APP_SPLITTING:
+    case PERR_BUSY:
+    case PERR_TRY_AGAIN:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// The remaining timeout of a batch operation, 0 if it's timed out.
+int get_remaining_timeout_ms(uint64_t deadline_ms)
+{
+    const uint64_t now_ms = dsn_now_ms();
+    return now_ms < deadline_ms ? static_cast<int>(deadline_ms - now_ms) : 0;
+}
+
+} // anonymous namespace
+
+struct pegasus_client_impl::batch_get_context
+{
+    async_batch_get_callback_t callback;
+    uint64_t deadline_ms = 0;
+    int round = 0;
+
+    ::dsn::zlock lock; // [
+    int pending_count = 0;
+    int error = PERR_OK;
+    std::vector<full_key_t> failed_keys;
+    std::map<full_key_t, std::string> values;
+    // ]
+};
+
+struct pegasus_client_impl::batch_write_context
+{
+    bool is_delete = false;
+    int ttl_seconds = 0;
+    uint64_t deadline_ms = 0;
+    int round = 0;
+    // hash_key -> <sort_key, value>, the values are not used by deletes.
+    std::map<std::string, std::map<std::string, std::string>> rows;
+    std::function<void(int)> callback;
+
+    ::dsn::zlock lock; // [
+    int pending_count = 0;
+    int error = PERR_OK;
+    std::vector<std::string> failed_hash_keys;
+    // ]
+};
+
+int pegasus_client_impl::batch_get(const std::set<full_key_t> &keys,
+                                   std::map<full_key_t, std::string> &values,
+                                   int timeout_milliseconds)
+{
+    ::dsn::utils::notify_event op_completed;
+    int ret = -1;
+    auto callback = [&](int err, std::map<full_key_t, std::string> &&_values) {
+        ret = err;
+        values = std::move(_values);
+        op_completed.notify();
+    };
+    async_batch_get(keys, std::move(callback), timeout_milliseconds);
+    op_completed.wait();
+    return ret;
+}
+
+void pegasus_client_impl::async_batch_get(const std::set<full_key_t> &keys,
+                                          async_batch_get_callback_t &&callback,
+                                          int timeout_milliseconds)
+{
+    // check params
+    for (const auto &key : keys) {
+        if (key.first.size() >= UINT16_MAX) {
+            LOG_ERROR("invalid hash key: hash key length should be less than UINT16_MAX, but {}",
+                      key.first.size());
+            if (callback != nullptr)
+                callback(PERR_INVALID_HASH_KEY, std::map<full_key_t, std::string>());
+            return;
+        }
+    }
+    if (keys.empty()) {
+        if (callback != nullptr)
+            callback(PERR_OK, std::map<full_key_t, std::string>());
+        return;
+    }
+
+    auto context = std::make_shared<batch_get_context>();
+    context->callback = std::move(callback);
+    context->deadline_ms = dsn_now_ms() + timeout_milliseconds;
+    batch_get_round(std::move(context), std::vector<full_key_t>(keys.begin(), keys.end()));
+}
+
+void pegasus_client_impl::batch_get_round(std::shared_ptr<batch_get_context> context,
+                                          std::vector<full_key_t> &&keys)
+{
+    // Group the keys by the partitions they belong to. If the partition count is unknown yet,
+    // group them by the partition hash instead, which is correct but less efficient.
+    struct key_group
+    {
+        uint64_t partition_hash;
+        std::vector<full_key_t> keys;
+    };
+    const int partition_count = _client->get_partition_count();
+    std::unordered_map<uint64_t, key_group> groups;
+    for (auto &key : keys) {
+        ::dsn::blob raw_key;
+        pegasus_generate_key(raw_key, key.first, key.second);
+        const auto partition_hash = pegasus_key_hash(raw_key);
+        const uint64_t group_id = partition_count > 0
+                                      ? ::dsn::replication::partition_resolver::get_partition_index(
+                                            partition_count, partition_hash)
+                                      : partition_hash;
+        auto &group = groups[group_id];
+        if (group.keys.empty()) {
+            group.partition_hash = partition_hash;
+        }
+        group.keys.emplace_back(std::move(key));
+    }
+
+    const int timeout_ms = get_remaining_timeout_ms(context->deadline_ms);
+    {
+        ::dsn::zauto_lock l(context->lock);
+        context->pending_count = static_cast<int>(groups.size());
+    }
+    for (auto &kv : groups) {
+        auto &group = kv.second;
+        ::dsn::apps::batch_get_request req;
+        req.keys.reserve(group.keys.size());
+        for (const auto &key : group.keys) {
+            ::dsn::apps::full_key req_key;
+            req_key.hash_key = ::dsn::blob(key.first.data(), 0, key.first.size());
+            req_key.sort_key = ::dsn::blob(key.second.data(), 0, key.second.size());
+            req.keys.emplace_back(std::move(req_key));
+        }
+
+        // The blobs in the request still refer to the keys moved into the callback, since the
+        // buffer of the vector is moved as a whole.
+        auto new_callback = [this, context, partition_count, keys = std::move(group.keys)](
+                                ::dsn::error_code err,
+                                dsn::message_ex *req,
+                                dsn::message_ex *resp) mutable {
+            ::dsn::apps::batch_get_response response;
+            if (err == ::dsn::ERR_OK) {
+                ::dsn::unmarshall(resp, response);
+            }
+            int ret = get_client_error(err == ::dsn::ERR_OK
+                                           ? get_rocksdb_server_error(response.error)
+                                           : int(err));
+            if (ret == PERR_OK && partition_count > 0 &&
+                _client->get_partition_count() != partition_count) {
+                // The partition count has been changed by partition split meanwhile, thus the
+                // keys might have been grouped into a wrong partition.
+                ret = PERR_APP_SPLITTING;
+            }
+
+            bool round_completed = false;
+            {
+                ::dsn::zauto_lock l(context->lock);
+                if (ret == PERR_OK) {
+                    for (auto &data : response.data) {
+                        context->values.emplace(
+                            full_key_t(data.hash_key.to_string(), data.sort_key.to_string()),
+                            data.value.to_string());
+                    }
+                } else {
+                    context->error = ret;
+                    for (auto &key : keys) {
+                        context->failed_keys.emplace_back(std::move(key));
+                    }
+                }
+                round_completed = (--context->pending_count == 0);
+            }
+            if (!round_completed) {
+                return;
+            }
+
+            // Only retry the failed keys, which would be regrouped by the latest partitions.
+            if (!context->failed_keys.empty() && is_batch_error_retriable(context->error) &&
+                context->round < kBatchMaxRetryRounds &&
+                get_remaining_timeout_ms(context->deadline_ms) > 0) {
+                ++context->round;
+                context->error = PERR_OK;
+                std::vector<full_key_t> failed_keys;
+                failed_keys.swap(context->failed_keys);
+                batch_get_round(context, std::move(failed_keys));
+                return;
+            }
+
+            if (context->callback != nullptr) {
+                context->callback(context->failed_keys.empty() ? PERR_OK : context->error,
+                                  std::move(context->values));
+            }
+        };
+        _client->batch_get(req,
+                           std::move(new_callback),
+                           std::chrono::milliseconds(timeout_ms),
+                           group.partition_hash,
+                           0,
+                           get_read_staleness_bound());
+    }
+}
+
+int pegasus_client_impl::batch_set(const std::map<full_key_t, std::string> &kvs,
+                                   int timeout_milliseconds,
+                                   int ttl_seconds)
+{
+    auto context = std::make_shared<batch_write_context>();
+    context->ttl_seconds = ttl_seconds;
+    context->deadline_ms = dsn_now_ms() + timeout_milliseconds;
+    for (const auto &kv : kvs) {
+        context->rows[kv.first.first][kv.first.second] = kv.second;
+    }
+    return batch_write(std::move(context));
+}
+
+int pegasus_client_impl::batch_del(const std::set<full_key_t> &keys, int timeout_milliseconds)
+{
+    auto context = std::make_shared<batch_write_context>();
+    context->is_delete = true;
+    context->deadline_ms = dsn_now_ms() + timeout_milliseconds;
+    for (const auto &key : keys) {
+        context->rows[key.first].emplace(key.second, std::string());
+    }
+    return batch_write(std::move(context));
+}
+
+int pegasus_client_impl::batch_write(std::shared_ptr<batch_write_context> context)
+{
+    if (context->rows.empty()) {
+        return PERR_OK;
+    }
+
+    ::dsn::utils::notify_event op_completed;
+    int ret = -1;
+    context->callback = [&](int err) {
+        ret = err;
+        op_completed.notify();
+    };
+
+    std::vector<std::string> hash_keys;
+    hash_keys.reserve(context->rows.size());
+    for (const auto &row : context->rows) {
+        hash_keys.emplace_back(row.first);
+    }
+    batch_write_round(std::move(context), std::move(hash_keys));
+    op_completed.wait();
+    return ret;
+}
+
+void pegasus_client_impl::batch_write_round(std::shared_ptr<batch_write_context> context,
+                                            std::vector<std::string> &&hash_keys)
+{
+    const int timeout_ms = get_remaining_timeout_ms(context->deadline_ms);
+    {
+        ::dsn::zauto_lock l(context->lock);
+        context->pending_count = static_cast<int>(hash_keys.size());
+    }
+
+    // The writes of different hash keys could not be packed into one request, thus they are
+    // sent by multi_set/multi_del in parallel, which would be batched into fewer mutations by
+    // the primary replicas.
+    for (auto &hash_key : hash_keys) {
+        auto on_completed = [this, context, hash_key](int err) {
+            bool round_completed = false;
+            {
+                ::dsn::zauto_lock l(context->lock);
+                if (err != PERR_OK) {
+                    context->error = err;
+                    context->failed_hash_keys.emplace_back(hash_key);
+                }
+                round_completed = (--context->pending_count == 0);
+            }
+            if (!round_completed) {
+                return;
+            }
+
+            // Only retry the failed hash keys, the writes are idempotent.
+            if (!context->failed_hash_keys.empty() && is_batch_error_retriable(context->error) &&
+                context->round < kBatchMaxRetryRounds &&
+                get_remaining_timeout_ms(context->deadline_ms) > 0) {
+                ++context->round;
+                context->error = PERR_OK;
+                std::vector<std::string> failed_hash_keys;
+                failed_hash_keys.swap(context->failed_hash_keys);
+                batch_write_round(context, std::move(failed_hash_keys));
+                return;
+            }
+
+            context->callback(context->failed_hash_keys.empty() ? PERR_OK : context->error);
+        };
+
+        const auto &row = context->rows[hash_key];
+        if (context->is_delete) {
+            std::set<std::string> sort_keys;
+            for (const auto &kv : row) {
+                sort_keys.emplace(kv.first);
+            }
+            async_multi_del(
+                hash_key,
+                sort_keys,
+                [on_completed = std::move(on_completed)](int err, int64_t, internal_info &&) {
+                    on_completed(err);
+                },
+                timeout_ms);
+        } else {
+            async_multi_set(
+                hash_key,
+                row,
+                [on_completed = std::move(on_completed)](int err, internal_info &&) {
+                    on_completed(err);
+                },
+                timeout_ms,
+                context->ttl_seconds);
+        }
+    }
+}
+
+} // namespace client
+} // namespace pegasus
@@ -79,6 +79,21 @@ const char *pegasus_client_impl::get_cluster_name() const { return _cluster_name
 
 const char *pegasus_client_impl::get_app_name() const { return _app_name.c_str(); }
 
+void pegasus_client_impl::set_read_staleness(int max_staleness_ms)
+{
+    _read_max_staleness_ms.store(std::max(max_staleness_ms, 0), std::memory_order_relaxed);
+}
+
+::dsn::read_staleness_bound pegasus_client_impl::get_read_staleness_bound() const
+{
+    const int max_staleness_ms = _read_max_staleness_ms.load(std::memory_order_relaxed);
+    if (max_staleness_ms <= 0) {
+        return {};
+    }
+    return {::dsn::read_staleness_bound_type::kMaxStalenessMs,
+            static_cast<uint64_t>(max_staleness_ms)};
+}
+
 int pegasus_client_impl::set(const std::string &hash_key,
                              const std::string &sort_key,
                              const std::string &value,
@@ -260,6 +275,57 @@ void pegasus_client_impl::async_get(const std::string &hash_key,
                                     const std::string &sort_key,
                                     async_get_callback_t &&callback,
                                     int timeout_milliseconds)
+{
+    async_get_with_bound(
+        hash_key, sort_key, std::move(callback), timeout_milliseconds, get_read_staleness_bound());
+}
+
+int pegasus_client_impl::get_after_write(const std::string &hash_key,
+                                         const std::string &sort_key,
+                                         int64_t min_committed_decree,
+                                         std::string &value,
+                                         int timeout_milliseconds,
+                                         internal_info *info)
+{
+    ::dsn::utils::notify_event op_completed;
+    int ret = -1;
+    auto callback = [&](int err, std::string &&str, internal_info &&_info) {
+        ret = err;
+        value = std::move(str);
+        if (info != nullptr)
+            (*info) = std::move(_info);
+        op_completed.notify();
+    };
+    async_get_after_write(
+        hash_key, sort_key, min_committed_decree, std::move(callback), timeout_milliseconds);
+    op_completed.wait();
+    return ret;
+}
+
+void pegasus_client_impl::async_get_after_write(const std::string &hash_key,
+                                                const std::string &sort_key,
+                                                int64_t min_committed_decree,
+                                                async_get_callback_t &&callback,
+                                                int timeout_milliseconds)
+{
+    if (min_committed_decree <= 0) {
+        async_get(hash_key, sort_key, std::move(callback), timeout_milliseconds);
+        return;
+    }
+
+    async_get_with_bound(hash_key,
+                         sort_key,
+                         std::move(callback),
+                         timeout_milliseconds,
+                         {::dsn::read_staleness_bound_type::kMinCommittedDecree,
+                          static_cast<uint64_t>(min_committed_decree)});
+}
+
+void pegasus_client_impl::async_get_with_bound(const std::string &hash_key,
+                                               const std::string &sort_key,
+                                               async_get_callback_t &&callback,
+                                               int timeout_milliseconds,
+                                               const ::dsn::read_staleness_bound &bound)
 {
     // check params
     if (hash_key.size() >= UINT16_MAX) {
@@ -296,7 +362,9 @@ void pegasus_client_impl::async_get(const std::string &hash_key,
     _client->get(req,
                  std::move(new_callback),
                  std::chrono::milliseconds(timeout_milliseconds),
-                 partition_hash);
+                 partition_hash,
+                 0,
+                 bound);
 }
 
 int pegasus_client_impl::multi_get(const std::string &hash_key,
@@ -385,7 +453,9 @@ void pegasus_client_impl::async_multi_get(const std::string &hash_key,
     _client->multi_get(req,
                        std::move(new_callback),
                        std::chrono::milliseconds(timeout_milliseconds),
-                       partition_hash);
+                       partition_hash,
+                       0,
+                       get_read_staleness_bound());
 }
 
 int pegasus_client_impl::multi_get(const std::string &hash_key,
@@ -484,7 +554,9 @@ void pegasus_client_impl::async_multi_get(const std::string &hash_key,
     _client->multi_get(req,
                        std::move(new_callback),
                        std::chrono::milliseconds(timeout_milliseconds),
-                       partition_hash);
+                       partition_hash,
+                       0,
+                       get_read_staleness_bound());
 }
 
 int pegasus_client_impl::multi_get_sortkeys(const std::string &hash_key,
@@ -561,7 +633,9 @@ void pegasus_client_impl::async_multi_get_sortkeys(const std::string &hash_key,
     _client->multi_get(req,
                        std::move(new_callback),
                        std::chrono::milliseconds(timeout_milliseconds),
-                       partition_hash);
+                       partition_hash,
+                       0,
+                       get_read_staleness_bound());
 }
 
 int pegasus_client_impl::exist(const std::string &hash_key,
@@ -594,7 +668,8 @@ int pegasus_client_impl::sortkey_count(const std::string &hash_key,
     auto partition_hash = pegasus_key_hash(tmp_key);
     auto pr = _client->sortkey_count_sync(::dsn::blob(hash_key.data(), 0, hash_key.length()),
                                           std::chrono::milliseconds(timeout_milliseconds),
-                                          partition_hash);
+                                          partition_hash,
+                                          get_read_staleness_bound());
     if (pr.first == ERR_OK && pr.second.error == 0) {
         count = pr.second.count;
     }
@@ -1099,8 +1174,10 @@ int pegasus_client_impl::ttl(const std::string &hash_key,
     ::dsn::blob req;
     pegasus_generate_key(req, hash_key, sort_key);
     auto partition_hash = pegasus_key_hash(req);
-    auto pr =
-        _client->ttl_sync(req, std::chrono::milliseconds(timeout_milliseconds), partition_hash);
+    auto pr = _client->ttl_sync(req,
+                                std::chrono::milliseconds(timeout_milliseconds),
+                                partition_hash,
+                                get_read_staleness_bound());
     if (pr.first == ERR_OK && pr.second.error == 0) {
         ttl_seconds = pr.second.ttl_seconds;
     }
@@ -22,6 +22,7 @@
 #include <pegasus/client.h>
 #include <rrdb/rrdb.client.h>
 #include <stdint.h>
+#include <atomic>
 #include <functional>
 #include <list>
 #include <map>
@@ -32,6 +33,7 @@
 #include <vector>
 
 #include "rpc/rpc_host_port.h"
+#include "rpc/rpc_message.h"
 #include "rrdb/rrdb_types.h"
 #include "utils/blob.h"
 #include "utils/zlocks.h"
@@ -55,6 +57,8 @@ public:
 
     virtual const char *get_app_name() const override;
 
+    virtual void set_read_staleness(int max_staleness_ms) override;
+
     virtual int set(const std::string &hashkey,
                     const std::string &sortkey,
                     const std::string &value,
@@ -92,6 +96,19 @@ public:
                            async_get_callback_t &&callback = nullptr,
                            int timeout_milliseconds = 5000) override;
 
+    virtual int get_after_write(const std::string &hashkey,
+                                const std::string &sortkey,
+                                int64_t min_committed_decree,
+                                std::string &value,
+                                int timeout_milliseconds = 5000,
+                                internal_info *info = nullptr) override;
+
+    virtual void async_get_after_write(const std::string &hashkey,
+                                       const std::string &sortkey,
+                                       int64_t min_committed_decree,
+                                       async_get_callback_t &&callback = nullptr,
+                                       int timeout_milliseconds = 5000) override;
+
     virtual int multi_get(const std::string &hashkey,
                           const std::set<std::string> &sortkeys,
                           std::map<std::string, std::string> &values,
@@ -170,6 +187,21 @@ public:
                                  async_multi_del_callback_t &&callback = nullptr,
                                  int timeout_milliseconds = 5000) override;
 
+    virtual int batch_get(const std::set<full_key_t> &keys,
+                          std::map<full_key_t, std::string> &values,
+                          int timeout_milliseconds = 5000) override;
+
+    virtual void async_batch_get(const std::set<full_key_t> &keys,
+                                 async_batch_get_callback_t &&callback = nullptr,
+                                 int timeout_milliseconds = 5000) override;
+
+    virtual int batch_set(const std::map<full_key_t, std::string> &kvs,
+                          int timeout_milliseconds = 5000,
+                          int ttl_seconds = 0) override;
+
+    virtual int batch_del(const std::set<full_key_t> &keys,
+                          int timeout_milliseconds = 5000) override;
+
     virtual int incr(const std::string &hashkey,
                      const std::string &sortkey,
                      int64_t increment,
@@ -275,6 +307,8 @@ public:
 
         void async_next(async_scan_next_callback_t &&) override;
 
+        int get_aggregation(scan_aggregation &aggregation) const override;
+
         bool safe_destructible() const override;
 
         pegasus_scanner_wrapper get_smart_wrapper() override;
@@ -321,6 +355,9 @@ public:
         bool _validate_partition_hash;
         bool _full_scan;
         async_scan_type _type;
+        // the aggregation of all the batches, used only if _options.return_aggregation is true
+        ::dsn::apps::scan_aggregation _aggregation;
+        bool _aggregation_supported;
 
         void _async_next_internal();
         void _start_scan();
@@ -338,6 +375,23 @@ public:
     static int get_rocksdb_server_error(int rocskdb_error);
 
 private:
+    ::dsn::read_staleness_bound get_read_staleness_bound() const;
+
+    void async_get_with_bound(const std::string &hash_key,
+                              const std::string &sort_key,
+                              async_get_callback_t &&callback,
+                              int timeout_milliseconds,
+                              const ::dsn::read_staleness_bound &bound);
+
+    // The batch operations across hash keys, see pegasus_client_batch.cpp.
+    struct batch_get_context;
+    struct batch_write_context;
+    void batch_get_round(std::shared_ptr<batch_get_context> context,
+                         std::vector<full_key_t> &&keys);
+    void batch_write_round(std::shared_ptr<batch_write_context> context,
+                           std::vector<std::string> &&hash_keys);
+    int batch_write(std::shared_ptr<batch_write_context> context);
+
     class pegasus_scanner_impl_wrapper : public abstract_pegasus_scanner
     {
         std::shared_ptr<pegasus_scanner> _p;
@@ -359,6 +413,11 @@ private:
         {
             return _p->next(hashkey, sortkey, value, info);
         }
+
+        int get_aggregation(scan_aggregation &aggregation) const override
+        {
+            return _p->get_aggregation(aggregation);
+        }
     };
 
 private:
@@ -366,6 +425,7 @@ private:
     std::string _app_name;
     ::dsn::host_port _meta_server;
     ::dsn::apps::rrdb_client *_client;
+    std::atomic<int> _read_max_staleness_ms{0};
 
     ///
     /// \brief _client_error_to_string
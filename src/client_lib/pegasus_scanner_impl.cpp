@@ -32,6 +32,7 @@
 #include "pegasus/error.h"
 #include "pegasus_client_impl.h"
 #include "pegasus_key_schema.h"
+#include "scan_aggregator.h"
 #include "rrdb/rrdb.client.h"
 #include "rrdb/rrdb_types.h"
 #include "rpc/serialization.h"
@@ -88,8 +89,12 @@ pegasus_client_impl::pegasus_scanner_impl::pegasus_scanner_impl(::dsn::apps::rrd
       _rpc_started(false),
       _validate_partition_hash(validate_partition_hash),
       _full_scan(full_scan),
-      _type(async_scan_type::NORMAL)
+      _type(async_scan_type::NORMAL),
+      _aggregation_supported(true)
 {
+    if (_options.return_aggregation) {
+        _options.only_return_count = true;
+    }
 }
 
 int pegasus_client_impl::pegasus_scanner_impl::next(int32_t &count, internal_info *info)
@@ -158,6 +163,21 @@ void pegasus_client_impl::pegasus_scanner_impl::async_next(async_scan_next_callb
     }
 }
 
+int pegasus_client_impl::pegasus_scanner_impl::get_aggregation(
+    scan_aggregation &aggregation) const
+{
+    ::dsn::zauto_lock l(_lock);
+    if (!_options.return_aggregation) {
+        return PERR_INVALID_ARGUMENT;
+    }
+    if (!_aggregation_supported) {
+        return PERR_NOT_SUPPORTED;
+    }
+
+    scan_aggregation_to_client(_aggregation, aggregation);
+    return PERR_OK;
+}
+
 bool pegasus_client_impl::pegasus_scanner_impl::safe_destructible() const
 {
     ::dsn::zauto_lock l(_lock);
@@ -299,6 +319,9 @@ void pegasus_client_impl::pegasus_scanner_impl::_start_scan()
     req.__set_return_expire_ts(_options.return_expire_ts);
     req.__set_full_scan(_full_scan);
     req.__set_only_return_count(_options.only_return_count);
+    if (_options.return_aggregation) {
+        req.__set_return_aggregation(true);
+    }
 
     CHECK(!_rpc_started, "");
     _rpc_started = true;
@@ -337,6 +360,14 @@ void pegasus_client_impl::pegasus_scanner_impl::_on_scan_response(::dsn::error_c
                 _type = async_scan_type::COUNT_ONLY;
                 _kv_count = response.kv_count;
             }
+            if (_options.return_aggregation) {
+                if (response.__isset.aggregation) {
+                    scan_aggregation_merge(response.aggregation, _aggregation);
+                } else if (response.__isset.kv_count) {
+                    // The server supports only counting size but not aggregation.
+                    _aggregation_supported = false;
+                }
+            }
             _async_next_internal();
             return;
         } else if (get_rocksdb_server_error(response.error) == PERR_NOT_FOUND) {
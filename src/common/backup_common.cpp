@@ -19,6 +19,7 @@
 
 #include "common/gpid.h"
 #include "fmt/core.h"
+#include "metadata_types.h"
 #include "rpc/rpc_host_port.h"
 #include "runtime/api_layer1.h"
 
@@ -29,6 +30,7 @@ const std::string cold_backup_constant::APP_BACKUP_STATUS("app_backup_status");
 const std::string cold_backup_constant::CURRENT_CHECKPOINT("current_checkpoint");
 const std::string cold_backup_constant::BACKUP_METADATA("backup_metadata");
 const std::string cold_backup_constant::BACKUP_INFO("backup_info");
+const std::string cold_backup_constant::SHARED_FILES("shared_files");
 const int32_t cold_backup_constant::PROGRESS_FINISHED = 1000;
 
 const std::string backup_restore_constant::FORCE_RESTORE("restore.force_restore");
@@ -123,6 +125,40 @@ std::string get_remote_chkpt_meta_file(const std::string &root,
            cold_backup_constant::BACKUP_METADATA;
 }
 
+bool is_shared_file(const std::string &file_name)
+{
+    static const std::string kSstSuffix(".sst");
+    return file_name.size() > kSstSuffix.size() &&
+           file_name.compare(file_name.size() - kSstSuffix.size(), kSstSuffix.size(), kSstSuffix) ==
+               0;
+}
+
+std::string get_policy_shared_files_dir(const std::string &root, const std::string &policy_name)
+{
+    return root + "/" + cold_backup_constant::SHARED_FILES + "/" + policy_name;
+}
+
+std::string get_shared_files_dir(const std::string &policy_name,
+                                 const std::string &app_name,
+                                 gpid pid)
+{
+    std::string str_app = app_name + "_" + std::to_string(pid.get_app_id());
+    return cold_backup_constant::SHARED_FILES + "/" + policy_name + "/" + str_app + "/" +
+           std::to_string(pid.get_partition_index());
+}
+
+std::string get_shared_file_key(const file_meta &f_meta)
+{
+    return fmt::format("{}_{}_{}", f_meta.name, f_meta.size, f_meta.md5);
+}
+
+std::string get_shared_file_dir(const std::string &root,
+                                const std::string &shared_files_dir,
+                                const file_meta &f_meta)
+{
+    return root + "/" + shared_files_dir + "/" + get_shared_file_key(f_meta);
+}
+
 } // namespace cold_backup
 } // namespace replication
 } // namespace dsn
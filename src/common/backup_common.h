@@ -19,7 +19,10 @@
 
 #include <stdint.h>
 #include <string>
+#include <vector>
 
+#include "common/json_helper.h"
+#include "metadata_types.h"
 #include "rpc/rpc_holder.h"
 
 namespace dsn {
@@ -37,9 +40,26 @@ public:
     static const std::string CURRENT_CHECKPOINT;
     static const std::string BACKUP_METADATA;
     static const std::string BACKUP_INFO;
+    static const std::string SHARED_FILES;
     static const int32_t PROGRESS_FINISHED;
 };
 
+// The metadata of a checkpoint uploaded to block service, which is written as the file named
+// cold_backup_constant::BACKUP_METADATA.
+struct cold_backup_metadata
+{
+    int64_t checkpoint_decree;
+    int64_t checkpoint_timestamp;
+    std::vector<file_meta> files;
+    int64_t checkpoint_total_size;
+    // The directory relative to the backup root where the sst files of the checkpoint are
+    // stored, see get_shared_files_dir(). It's empty if the backup is not incremental, which
+    // means all the files are stored in the checkpoint directory.
+    std::string shared_files_dir;
+    DEFINE_JSON_SERIALIZATION(
+        checkpoint_decree, checkpoint_timestamp, files, checkpoint_total_size, shared_files_dir)
+};
+
 typedef rpc_holder<backup_request, backup_response> backup_rpc;
 
 class backup_restore_constant
@@ -81,6 +101,17 @@ namespace cold_backup {
 //                                        /partition_1/current_checkpoint
 //      <root>/<backup_id>/backup_info
 //
+// For incremental backups, the sst files are not uploaded into the checkpoint directory. Since
+// they are immutable, they are stored once in a shared directory of the policy, and each one is
+// addressed by its name, size and md5:
+//
+//      <root>/shared_files/<policy_name>/<appname_appid>/<partition_index>/<key>/<name>
+//
+// where <key> is <name>_<size>_<md5>.
+//
+// A shared file is referenced by the backup_metadata of each backup that contains it, and it is
+// removed by meta server once no retained backup of the policy references it any more.
+//
 
 //
 // the purpose of some file:
@@ -187,6 +218,30 @@ std::string get_remote_chkpt_meta_file(const std::string &root,
                                        gpid pid,
                                        int64_t backup_id);
 
+// Whether the file of a checkpoint is immutable, which could be stored in the shared files
+// directory by incremental backups.
+bool is_shared_file(const std::string &file_name);
+
+// compose the shared files directory of a policy on block service
+// return: <root>/shared_files/<policy_name>
+std::string get_policy_shared_files_dir(const std::string &root, const std::string &policy_name);
+
+// compose the shared files directory of a replica, which is relative to the backup root
+// return: shared_files/<policy_name>/<appname_appid>/<partition_index>
+std::string get_shared_files_dir(const std::string &policy_name,
+                                 const std::string &app_name,
+                                 gpid pid);
+
+// compose the key which addresses a shared file by its content
+// return: <name>_<size>_<md5>
+std::string get_shared_file_key(const file_meta &f_meta);
+
+// compose the directory which holds a shared file on block service
+// return: <root>/<shared_files_dir>/<name>_<size>_<md5>
+std::string get_shared_file_dir(const std::string &root,
+                                const std::string &shared_files_dir,
+                                const file_meta &f_meta);
+
 } // namespace cold_backup
 } // namespace replication
 } // namespace dsn
@@ -213,6 +213,16 @@ struct group_check_request
     8:optional dsn.host_port         hp_node;
 }
 
+// Sent by the primary to the secondaries of an idle partition periodically, so that the
+// secondaries could know the committed decree of the primary without any prepare, which is
+// used to decide whether a bounded-staleness read could be served by a secondary.
+struct read_staleness_heartbeat
+{
+    1:dsn.gpid                      pid;
+    2:i64                           ballot;
+    3:i64                           last_committed_decree;
+}
+
 struct group_check_response
 {
     1:dsn.gpid                      pid;
@@ -40,6 +40,15 @@ DSN_DEFINE_uint32(replication,
                   "send mutation log batch bytes size per rpc");
 DSN_TAG_VARIABLE(duplicate_log_batch_bytes, FT_MUTABLE);
 
+// Writes with the same hash key are always shipped in order, while up to this number of
+// rpcs are in flight for each replica to hide the round-trip time to the remote cluster.
+DSN_DEFINE_uint32(replication,
+                  dup_max_inflight_rpcs,
+                  8,
+                  "The maximum number of in-flight DUPLICATE rpcs shipped from each replica");
+DSN_DEFINE_validator(dup_max_inflight_rpcs, [](uint32_t value) -> bool { return value > 0; });
+DSN_TAG_VARIABLE(dup_max_inflight_rpcs, FT_MUTABLE);
+
 // While many clusters are duplicated to a target cluster, we have to add many cluster
 // ids to the `*.ini` file of the target cluster, and the target cluster might be restarted
 // very frequently.
@@ -30,6 +30,7 @@
 #include "utils/fmt_utils.h"
 
 DSN_DECLARE_uint32(duplicate_log_batch_bytes);
+DSN_DECLARE_uint32(dup_max_inflight_rpcs);
 
 namespace dsn::replication {
 
@@ -20,9 +20,26 @@ include "../../idl/dsn.thrift"
 
 namespace cpp dsn.apps
 
+enum duplicate_compression_type
+{
+    DCT_NONE = 0,
+    DCT_LZ4,
+    DCT_ZSTD
+}
+
 struct duplicate_request
 {
     1: list<duplicate_entry> entries
+
+    // The algorithm by which the entries are compressed. If set to anything other than
+    // DCT_NONE, `entries` is empty and `compressed_entries` holds the compressed binary
+    // form of a duplicate_request with only `entries` set.
+    2: optional duplicate_compression_type compression_type = duplicate_compression_type.DCT_NONE
+
+    3: optional dsn.blob compressed_entries
+
+    // The size of the binary form of the entries before compression.
+    4: optional i32 uncompressed_size
 }
 
 struct duplicate_entry
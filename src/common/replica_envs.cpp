@@ -94,6 +94,10 @@ const std::string replica_envs::REPLICA_ACCESS_CONTROLLER_RANGER_POLICIES(
     "replica_access_controller.ranger_policies");
 const std::string replica_envs::READ_QPS_THROTTLING("replica.read_throttling");
 const std::string replica_envs::READ_SIZE_THROTTLING("replica.read_throttling_by_size");
+/// The capacity units per second the whole table is allowed to serve, which are distributed among
+/// the replicas by meta server according to their demands.
+const std::string replica_envs::READ_CU_QUOTA("replica.read_cu_quota");
+const std::string replica_envs::WRITE_CU_QUOTA("replica.write_cu_quota");
 
 /// true means compaction and scan will validate partition_hash, otherwise false
 const std::string
@@ -107,8 +111,36 @@ const std::string replica_envs::UPDATE_MAX_REPLICA_COUNT("max_replica_count.upda
 const std::string replica_envs::ROCKSDB_WRITE_BUFFER_SIZE("rocksdb.write_buffer_size");
 const std::string replica_envs::ROCKSDB_NUM_LEVELS("rocksdb.num_levels");
 
+// The options of the key-value separation, i.e. the integrated BlobDB of rocksdb, see
+// https://github.com/facebook/rocksdb/wiki/BlobDB.
+const std::string replica_envs::ROCKSDB_ENABLE_BLOB_FILES("rocksdb.enable_blob_files");
+const std::string replica_envs::ROCKSDB_MIN_BLOB_SIZE("rocksdb.min_blob_size");
+const std::string replica_envs::ROCKSDB_BLOB_FILE_SIZE("rocksdb.blob_file_size");
+const std::string replica_envs::ROCKSDB_BLOB_COMPRESSION_TYPE("rocksdb.blob_compression_type");
+const std::string
+    replica_envs::ROCKSDB_ENABLE_BLOB_GARBAGE_COLLECTION("rocksdb.enable_blob_garbage_collection");
+const std::string replica_envs::ROCKSDB_BLOB_GARBAGE_COLLECTION_AGE_CUTOFF(
+    "rocksdb.blob_garbage_collection_age_cutoff");
+const std::string replica_envs::ROCKSDB_BLOB_GARBAGE_COLLECTION_FORCE_THRESHOLD(
+    "rocksdb.blob_garbage_collection_force_threshold");
+
+/// The filter of the SST files built after it is updated, should be 'none', 'bloom' or 'ribbon',
+/// with `rocksdb.filter_bits_per_key` average bits allocated per key.
+const std::string replica_envs::ROCKSDB_FILTER_POLICY("rocksdb.filter_policy");
+const std::string replica_envs::ROCKSDB_FILTER_BITS_PER_KEY("rocksdb.filter_bits_per_key");
+/// Whether to filter by the hash keys for the prefix seeks, should be 'common' or 'prefix', only
+/// takes effect after the db is reopened.
+const std::string replica_envs::ROCKSDB_FILTER_TYPE("rocksdb.filter_type");
+
 const std::set<std::string> replica_envs::ROCKSDB_DYNAMIC_OPTIONS = {
     replica_envs::ROCKSDB_WRITE_BUFFER_SIZE,
+    replica_envs::ROCKSDB_ENABLE_BLOB_FILES,
+    replica_envs::ROCKSDB_MIN_BLOB_SIZE,
+    replica_envs::ROCKSDB_BLOB_FILE_SIZE,
+    replica_envs::ROCKSDB_BLOB_COMPRESSION_TYPE,
+    replica_envs::ROCKSDB_ENABLE_BLOB_GARBAGE_COLLECTION,
+    replica_envs::ROCKSDB_BLOB_GARBAGE_COLLECTION_AGE_CUTOFF,
+    replica_envs::ROCKSDB_BLOB_GARBAGE_COLLECTION_FORCE_THRESHOLD,
 };
 const std::set<std::string> replica_envs::ROCKSDB_STATIC_OPTIONS = {
     replica_envs::ROCKSDB_NUM_LEVELS,
@@ -63,6 +63,8 @@ public:
     static const std::string REPLICA_ACCESS_CONTROLLER_RANGER_POLICIES;
     static const std::string READ_QPS_THROTTLING;
     static const std::string READ_SIZE_THROTTLING;
+    static const std::string READ_CU_QUOTA;
+    static const std::string WRITE_CU_QUOTA;
     static const std::string BACKUP_REQUEST_QPS_THROTTLING;
     static const std::string SPLIT_VALIDATE_PARTITION_HASH;
     static const std::string USER_SPECIFIED_COMPACTION;
@@ -70,6 +72,16 @@ public:
     static const std::string UPDATE_MAX_REPLICA_COUNT;
     static const std::string ROCKSDB_WRITE_BUFFER_SIZE;
     static const std::string ROCKSDB_NUM_LEVELS;
+    static const std::string ROCKSDB_ENABLE_BLOB_FILES;
+    static const std::string ROCKSDB_MIN_BLOB_SIZE;
+    static const std::string ROCKSDB_BLOB_FILE_SIZE;
+    static const std::string ROCKSDB_BLOB_COMPRESSION_TYPE;
+    static const std::string ROCKSDB_ENABLE_BLOB_GARBAGE_COLLECTION;
+    static const std::string ROCKSDB_BLOB_GARBAGE_COLLECTION_AGE_CUTOFF;
+    static const std::string ROCKSDB_BLOB_GARBAGE_COLLECTION_FORCE_THRESHOLD;
+    static const std::string ROCKSDB_FILTER_POLICY;
+    static const std::string ROCKSDB_FILTER_BITS_PER_KEY;
+    static const std::string ROCKSDB_FILTER_TYPE;
 
     static const std::set<std::string> ROCKSDB_DYNAMIC_OPTIONS;
     static const std::set<std::string> ROCKSDB_STATIC_OPTIONS;
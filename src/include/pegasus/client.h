@@ -27,6 +27,7 @@
 #include <pegasus/error.h>
 #include <functional>
 #include <memory>
+#include <utility>
 
 #include "utils/fmt_utils.h"
 
@@ -256,6 +257,9 @@ public:
         bool no_value; // only fetch hash_key and sort_key, but not fetch value
         bool return_expire_ts;
         bool only_return_count;
+        // only fetch the aggregation of k-v pairs, see get_aggregation() of scanner;
+        // only_return_count is implied
+        bool return_aggregation;
         scan_options()
             : timeout_ms(5000),
               batch_size(100),
@@ -265,7 +269,8 @@ public:
               sort_key_filter_type(FT_NO_FILTER),
               no_value(false),
               return_expire_ts(false),
-              only_return_count(false)
+              only_return_count(false),
+              return_aggregation(false)
         {
         }
         scan_options(const scan_options &o)
@@ -279,13 +284,47 @@ public:
               sort_key_filter_pattern(o.sort_key_filter_pattern),
               no_value(o.no_value),
               return_expire_ts(o.return_expire_ts),
-              only_return_count(o.only_return_count)
+              only_return_count(o.only_return_count),
+              return_aggregation(o.return_aggregation)
+        {
+        }
+    };
+
+    // the histogram of the sizes of the scanned keys or values
+    struct scan_size_histogram
+    {
+        int64_t count;
+        int64_t sum;
+        int64_t min; // can be used only when count > 0
+        int64_t max; // can be used only when count > 0
+        // buckets[0] counts the size of 0, buckets[i] (i > 0) counts the sizes in [2^(i-1), 2^i)
+        std::vector<int64_t> buckets;
+        scan_size_histogram() : count(0), sum(0), min(0), max(0) {}
+    };
+
+    // the aggregation of the k-v pairs computed on the server side
+    struct scan_aggregation
+    {
+        int64_t kv_count;
+        int64_t hash_key_count;
+        scan_size_histogram hash_key_size;
+        scan_size_histogram sort_key_size;
+        scan_size_histogram value_size;
+        scan_size_histogram row_size; // hash_key_size + sort_key_size + value_size
+        int64_t ttl_kv_count;         // count of the k-v pairs with TTL
+        uint32_t min_expire_ts;       // can be used only when ttl_kv_count > 0
+        uint32_t max_expire_ts;       // can be used only when ttl_kv_count > 0
+        scan_aggregation()
+            : kv_count(0), hash_key_count(0), ttl_kv_count(0), min_expire_ts(0), max_expire_ts(0)
         {
         }
     };
 
     class pegasus_scanner;
 
+    // <hashkey, sortkey> of a k-v, used by the batch operations across hash keys.
+    typedef std::pair<std::string, std::string> full_key_t;
+
     // define callback function types for asynchronous operations.
     typedef std::function<void(int /*error_code*/, internal_info && /*info*/)> async_set_callback_t;
     typedef std::function<void(int /*error_code*/, internal_info && /*info*/)>
@@ -304,6 +343,9 @@ public:
     typedef std::function<void(
         int /*error_code*/, int64_t /*deleted_count*/, internal_info && /*info*/)>
         async_multi_del_callback_t;
+    typedef std::function<void(int /*error_code*/,
+                               std::map<full_key_t, std::string> && /*values*/)>
+        async_batch_get_callback_t;
     typedef std::function<void(
         int /*error_code*/, int64_t /*new_value*/, internal_info && /*info*/)>
         async_incr_callback_t;
@@ -376,6 +418,21 @@ public:
         ///
         virtual void async_next(async_scan_next_callback_t &&callback) = 0;
 
+        ///
+        /// \brief get the aggregation of all the k-v pairs iterated by this scanner so far
+        //  only used for scanner which option return_aggregation is true
+        /// thread-safe
+        /// \param aggregation
+        /// the aggregation
+        /// \return
+        /// int, the error indicates whether or not the operation is succeeded.
+        /// this error can be converted to a string using get_error_string()
+        /// PERR_OK means the aggregation got
+        /// PERR_NOT_SUPPORTED means the server does not support aggregation, in which case
+        /// only the kv_count of async_next() could be used
+        ///
+        virtual int get_aggregation(scan_aggregation &aggregation) const = 0;
+
         virtual ~abstract_pegasus_scanner() {}
     };
 
@@ -419,6 +476,23 @@ public:
     ///
     virtual const char *get_app_name() const = 0;
 
+    ///
+    /// \brief set_read_staleness
+    /// allow the subsequent point reads (get/multi_get/sortkey_count/exist/ttl) to be served
+    /// by the secondary replicas as well as the primary ones, which spreads the read load over
+    /// all the replicas of a partition. A secondary serves a read only if it has caught up
+    /// with the committed decree of the primary in the last max_staleness_ms milliseconds,
+    /// otherwise the read is retried on the primary automatically. The secondaries of an idle
+    /// partition catch up only by group check unless [replication]
+    /// read_staleness_heartbeat_interval_ms is enabled on the servers. Scans are always served
+    /// by the primary replicas. The default implementation ignores it, which means all the
+    /// reads are served by the primary replicas.
+    /// \param max_staleness_ms
+    /// the max staleness of the data that could be tolerated, 0 means only reading from the
+    /// primary replicas, which is the default.
+    ///
+    virtual void set_read_staleness(int max_staleness_ms) {}
+
     ///
     /// \brief set
     ///     store the k-v to the cluster.
@@ -558,6 +632,40 @@ public:
                            async_get_callback_t &&callback = nullptr,
                            int timeout_milliseconds = 5000) = 0;
 
+    ///
+    /// \brief get_after_write
+    ///     get value by key from the cluster, which reflects the write that returned
+    ///     min_committed_decree in internal_info::decree. The read could be served by a
+    ///     secondary replica which has committed this decree, otherwise it is retried on the
+    ///     primary automatically. The default implementation reads from the primary replicas.
+    /// \param min_committed_decree
+    /// the decree returned by a previous write to the same hashkey, 0 or negative means no
+    /// requirement, and the read is served as get().
+    /// the other params and the return value are the same as get().
+    ///
+    virtual int get_after_write(const std::string &hashkey,
+                                const std::string &sortkey,
+                                int64_t min_committed_decree,
+                                std::string &value,
+                                int timeout_milliseconds = 5000,
+                                internal_info *info = nullptr)
+    {
+        return get(hashkey, sortkey, value, timeout_milliseconds, info);
+    }
+
+    ///
+    /// \brief asynchronous get_after_write
+    ///     will not be blocked, return immediately, see get_after_write().
+    ///
+    virtual void async_get_after_write(const std::string &hashkey,
+                                       const std::string &sortkey,
+                                       int64_t min_committed_decree,
+                                       async_get_callback_t &&callback = nullptr,
+                                       int timeout_milliseconds = 5000)
+    {
+        async_get(hashkey, sortkey, std::move(callback), timeout_milliseconds);
+    }
+
     ///
     /// \brief multi_get
     ///     get multiple value by key from the cluster.
@@ -853,6 +961,83 @@ public:
                                  async_multi_del_callback_t &&callback = nullptr,
                                  int timeout_milliseconds = 5000) = 0;
 
+    ///
+    /// \brief batch_get
+    ///     get multiple values by keys across hash keys from the cluster.
+    ///     the keys are grouped into per-partition sub-requests which are sent in parallel,
+    ///     and only the failed sub-requests are retried before timeout.
+    /// \param keys
+    /// the <hashkey,sortkey> pairs to get, whose hashkeys could be different.
+    /// \param values
+    /// the returned <<hashkey,sortkey>,value> pairs will be put into it.
+    /// if data is not found for some <hashkey,sortkey>, then it will not appear in the map.
+    /// \param timeout_milliseconds
+    /// if wait longer than this value, will return time out error
+    /// \return
+    /// int, the error indicates whether or not the operation is succeeded.
+    /// this error can be converted to a string using get_error_string().
+    /// if some sub-requests failed finally, returns the error of one of them, and the values
+    /// got by the succeeded ones are still returned.
+    ///
+    virtual int batch_get(const std::set<full_key_t> &keys,
+                          std::map<full_key_t, std::string> &values,
+                          int timeout_milliseconds = 5000) = 0;
+
+    ///
+    /// \brief asynchronous batch_get
+    ///     get multiple values by keys across hash keys from the cluster.
+    ///     will not be blocked, return immediately.
+    /// \param keys
+    /// the <hashkey,sortkey> pairs to get, whose hashkeys could be different.
+    /// \param callback
+    /// the callback function will be invoked after operation finished or error occurred.
+    /// \param timeout_milliseconds
+    /// if wait longer than this value, will return time out error
+    /// \return
+    /// void.
+    ///
+    virtual void async_batch_get(const std::set<full_key_t> &keys,
+                                 async_batch_get_callback_t &&callback = nullptr,
+                                 int timeout_milliseconds = 5000) = 0;
+
+    ///
+    /// \brief batch_set
+    ///     set multiple values by keys across hash keys to the cluster.
+    ///     the k-vs are grouped by hashkey into multi_set sub-requests which are sent in
+    ///     parallel, and only the failed sub-requests are retried before timeout.
+    ///     the operation is not atomic: if some sub-requests failed finally, the others may
+    ///     have been written.
+    /// \param kvs
+    /// the <<hashkey,sortkey>,value> pairs to set, hashkeys should not be empty.
+    /// \param timeout_milliseconds
+    /// if wait longer than this value, will return time out error
+    /// \param ttl_seconds
+    /// time to live of the values, 0 means no ttl.
+    /// \return
+    /// int, the error indicates whether or not the operation is succeeded.
+    /// this error can be converted to a string using get_error_string().
+    ///
+    virtual int batch_set(const std::map<full_key_t, std::string> &kvs,
+                          int timeout_milliseconds = 5000,
+                          int ttl_seconds = 0) = 0;
+
+    ///
+    /// \brief batch_del
+    ///     delete multiple values by keys across hash keys from the cluster.
+    ///     the keys are grouped by hashkey into multi_del sub-requests which are sent in
+    ///     parallel, and only the failed sub-requests are retried before timeout.
+    ///     the operation is not atomic: if some sub-requests failed finally, the others may
+    ///     have been deleted.
+    /// \param keys
+    /// the <hashkey,sortkey> pairs to delete, hashkeys should not be empty.
+    /// \param timeout_milliseconds
+    /// if wait longer than this value, will return time out error
+    /// \return
+    /// int, the error indicates whether or not the operation is succeeded.
+    /// this error can be converted to a string using get_error_string().
+    ///
+    virtual int batch_del(const std::set<full_key_t> &keys, int timeout_milliseconds = 5000) = 0;
+
     ///
     /// \brief incr
     ///     atomically increment value by key from the cluster.
@@ -50,6 +50,9 @@ public:
     }
     ~rrdb_client() { _tracker.cancel_outstanding_tasks(); }
 
+    // -1 if the partition count is unknown yet.
+    int get_partition_count() const { return _resolver->get_partition_count(); }
+
     // ---------- call RPC_RRDB_RRDB_PUT ------------
     // - synchronous
     std::pair<::dsn::error_code, update_response>
@@ -257,10 +260,20 @@ public:
     // ---------- call RPC_RRDB_RRDB_GET ------------
     // - synchronous
     std::pair<::dsn::error_code, read_response>
-    get_sync(const ::dsn::blob &args, std::chrono::milliseconds timeout, uint64_t partition_hash)
+    get_sync(const ::dsn::blob &args,
+             std::chrono::milliseconds timeout,
+             uint64_t partition_hash,
+             const ::dsn::read_staleness_bound &read_bound = {})
     {
-        return ::dsn::rpc::wait_and_unwrap<read_response>(_resolver->call_op(
-            RPC_RRDB_RRDB_GET, args, &_tracker, empty_rpc_handler, timeout, partition_hash));
+        return ::dsn::rpc::wait_and_unwrap<read_response>(
+            _resolver->call_op(RPC_RRDB_RRDB_GET,
+                               args,
+                               &_tracker,
+                               empty_rpc_handler,
+                               timeout,
+                               partition_hash,
+                               0,
+                               read_bound));
     }
 
     // - asynchronous with on-stack ::dsn::blob and read_response
@@ -269,7 +282,8 @@ public:
                         TCallback &&callback,
                         std::chrono::milliseconds timeout,
                         uint64_t request_partition_hash,
-                        int reply_thread_hash = 0)
+                        int reply_thread_hash = 0,
+                        const ::dsn::read_staleness_bound &read_bound = {})
     {
         return _resolver->call_op(RPC_RRDB_RRDB_GET,
                                   args,
@@ -277,16 +291,27 @@ public:
                                   std::forward<TCallback>(callback),
                                   timeout,
                                   request_partition_hash,
-                                  reply_thread_hash);
+                                  reply_thread_hash,
+                                  read_bound);
     }
 
     // ---------- call RPC_RRDB_RRDB_MULTI_GET ------------
     // - synchronous
-    std::pair<::dsn::error_code, multi_get_response> multi_get_sync(
-        const multi_get_request &args, std::chrono::milliseconds timeout, uint64_t partition_hash)
+    std::pair<::dsn::error_code, multi_get_response>
+    multi_get_sync(const multi_get_request &args,
+                   std::chrono::milliseconds timeout,
+                   uint64_t partition_hash,
+                   const ::dsn::read_staleness_bound &read_bound = {})
     {
-        return ::dsn::rpc::wait_and_unwrap<multi_get_response>(_resolver->call_op(
-            RPC_RRDB_RRDB_MULTI_GET, args, &_tracker, empty_rpc_handler, timeout, partition_hash));
+        return ::dsn::rpc::wait_and_unwrap<multi_get_response>(
+            _resolver->call_op(RPC_RRDB_RRDB_MULTI_GET,
+                               args,
+                               &_tracker,
+                               empty_rpc_handler,
+                               timeout,
+                               partition_hash,
+                               0,
+                               read_bound));
     }
 
     // - asynchronous with on-stack multi_get_request and multi_get_response
@@ -295,7 +320,8 @@ public:
                               TCallback &&callback,
                               std::chrono::milliseconds timeout,
                               uint64_t request_partition_hash,
-                              int reply_thread_hash = 0)
+                              int reply_thread_hash = 0,
+                              const ::dsn::read_staleness_bound &read_bound = {})
     {
         return _resolver->call_op(RPC_RRDB_RRDB_MULTI_GET,
                                   args,
@@ -303,16 +329,27 @@ public:
                                   std::forward<TCallback>(callback),
                                   timeout,
                                   request_partition_hash,
-                                  reply_thread_hash);
+                                  reply_thread_hash,
+                                  read_bound);
     }
 
     // ---------- call RPC_RRDB_RRDB_BATCH_GET ------------
     // - synchronous
-    std::pair<::dsn::error_code, batch_get_response> batch_get_sync(
-        const batch_get_request &args, std::chrono::milliseconds timeout, uint64_t partition_hash)
+    std::pair<::dsn::error_code, batch_get_response>
+    batch_get_sync(const batch_get_request &args,
+                   std::chrono::milliseconds timeout,
+                   uint64_t partition_hash,
+                   const ::dsn::read_staleness_bound &read_bound = {})
     {
-        return ::dsn::rpc::wait_and_unwrap<batch_get_response>(_resolver->call_op(
-            RPC_RRDB_RRDB_BATCH_GET, args, &_tracker, empty_rpc_handler, timeout, partition_hash));
+        return ::dsn::rpc::wait_and_unwrap<batch_get_response>(
+            _resolver->call_op(RPC_RRDB_RRDB_BATCH_GET,
+                               args,
+                               &_tracker,
+                               empty_rpc_handler,
+                               timeout,
+                               partition_hash,
+                               0,
+                               read_bound));
     }
 
     // - asynchronous with on-stack BatchGetRequest and BatchGetResponse
@@ -321,7 +358,8 @@ public:
                               TCallback &&callback,
                               std::chrono::milliseconds timeout,
                               uint64_t request_partition_hash,
-                              int reply_thread_hash = 0)
+                              int reply_thread_hash = 0,
+                              const ::dsn::read_staleness_bound &read_bound = {})
     {
         return _resolver->call_op(RPC_RRDB_RRDB_BATCH_GET,
                                   args,
@@ -329,13 +367,17 @@ public:
                                   std::forward<TCallback>(callback),
                                   timeout,
                                   request_partition_hash,
-                                  reply_thread_hash);
+                                  reply_thread_hash,
+                                  read_bound);
     }
 
     // ---------- call RPC_RRDB_RRDB_SORTKEY_COUNT ------------
     // - synchronous
-    std::pair<::dsn::error_code, count_response> sortkey_count_sync(
-        const ::dsn::blob &args, std::chrono::milliseconds timeout, uint64_t partition_hash)
+    std::pair<::dsn::error_code, count_response>
+    sortkey_count_sync(const ::dsn::blob &args,
+                       std::chrono::milliseconds timeout,
+                       uint64_t partition_hash,
+                       const ::dsn::read_staleness_bound &read_bound = {})
     {
         return ::dsn::rpc::wait_and_unwrap<count_response>(
             _resolver->call_op(RPC_RRDB_RRDB_SORTKEY_COUNT,
@@ -343,7 +385,9 @@ public:
                                &_tracker,
                                empty_rpc_handler,
                                timeout,
-                               partition_hash));
+                               partition_hash,
+                               0,
+                               read_bound));
     }
 
     // - asynchronous with on-stack ::dsn::blob and count_response
@@ -352,7 +396,8 @@ public:
                                   TCallback &&callback,
                                   std::chrono::milliseconds timeout,
                                   uint64_t request_partition_hash,
-                                  int reply_thread_hash = 0)
+                                  int reply_thread_hash = 0,
+                                  const ::dsn::read_staleness_bound &read_bound = {})
     {
         return _resolver->call_op(RPC_RRDB_RRDB_SORTKEY_COUNT,
                                   args,
@@ -360,16 +405,27 @@ public:
                                   std::forward<TCallback>(callback),
                                   timeout,
                                   request_partition_hash,
-                                  reply_thread_hash);
+                                  reply_thread_hash,
+                                  read_bound);
     }
 
     // ---------- call RPC_RRDB_RRDB_TTL ------------
     // - synchronous
     std::pair<::dsn::error_code, ttl_response>
-    ttl_sync(const ::dsn::blob &args, std::chrono::milliseconds timeout, uint64_t partition_hash)
+    ttl_sync(const ::dsn::blob &args,
+             std::chrono::milliseconds timeout,
+             uint64_t partition_hash,
+             const ::dsn::read_staleness_bound &read_bound = {})
     {
-        return ::dsn::rpc::wait_and_unwrap<ttl_response>(_resolver->call_op(
-            RPC_RRDB_RRDB_TTL, args, &_tracker, empty_rpc_handler, timeout, partition_hash));
+        return ::dsn::rpc::wait_and_unwrap<ttl_response>(
+            _resolver->call_op(RPC_RRDB_RRDB_TTL,
+                               args,
+                               &_tracker,
+                               empty_rpc_handler,
+                               timeout,
+                               partition_hash,
+                               0,
+                               read_bound));
     }
 
     // - asynchronous with on-stack ::dsn::blob and ttl_response
@@ -378,7 +434,8 @@ public:
                         TCallback &&callback,
                         std::chrono::milliseconds timeout,
                         uint64_t request_partition_hash,
-                        int reply_thread_hash = 0)
+                        int reply_thread_hash = 0,
+                        const ::dsn::read_staleness_bound &read_bound = {})
     {
         return _resolver->call_op(RPC_RRDB_RRDB_TTL,
                                   args,
@@ -386,7 +443,8 @@ public:
                                   std::forward<TCallback>(callback),
                                   timeout,
                                   request_partition_hash,
-                                  reply_thread_hash);
+                                  reply_thread_hash,
+                                  read_bound);
     }
 
     // ---------- call RPC_RRDB_RRDB_GET_SCANNER ------------
@@ -225,6 +225,7 @@ void app_env_validator::register_all_validators()
     static const auto kMaxWriteBufferSize = 512 << 20;
     static const auto kMinLevel = 1;
     static const auto kMaxLevel = 10;
+    static const auto kMinBlobFileSize = 1 << 20;
     static const std::string check_throttling_limit = "<size[K|M]>*<delay|reject>*<milliseconds>";
     static const std::string check_throttling_sample = "10000*delay*100,20000*reject*100";
 
@@ -246,6 +247,80 @@ void app_env_validator::register_all_validators()
             return true;
         });
 
+    // EnvInfo for ROCKSDB_BLOB_COMPRESSION_TYPE.
+    const std::set<std::string> valid_bcts({"none", "snappy", "lz4", "zstd"});
+    const std::string bct_sample(fmt::format("{}", fmt::join(valid_bcts, " | ")));
+    const app_env_validator::EnvInfo bct(
+        app_env_validator::ValueType::kString,
+        bct_sample,
+        "lz4",
+        [=](const std::string &new_value, std::string &hint_message) {
+            if (valid_bcts.count(new_value) == 0) {
+                hint_message = bct_sample;
+                return false;
+            }
+            return true;
+        });
+
+    // EnvInfo for ROCKSDB_BLOB_GARBAGE_COLLECTION_*, which are ratios.
+    const app_env_validator::EnvInfo blob_gc_ratio(
+        app_env_validator::ValueType::kString,
+        "In range [0.0, 1.0]",
+        "0.25",
+        [](const std::string &new_value, std::string &hint_message) {
+            double ratio = 0;
+            if (!dsn::buf2double(new_value, ratio) || ratio < 0 || ratio > 1) {
+                hint_message = "In range [0.0, 1.0]";
+                return false;
+            }
+            return true;
+        });
+
+    // EnvInfo for ROCKSDB_FILTER_POLICY.
+    const std::set<std::string> valid_rfps({"none", "bloom", "ribbon"});
+    const std::string rfp_sample(fmt::format("{}", fmt::join(valid_rfps, " | ")));
+    const app_env_validator::EnvInfo rfp(
+        app_env_validator::ValueType::kString,
+        rfp_sample,
+        "bloom",
+        [=](const std::string &new_value, std::string &hint_message) {
+            if (valid_rfps.count(new_value) == 0) {
+                hint_message = rfp_sample;
+                return false;
+            }
+            return true;
+        });
+
+    // EnvInfo for ROCKSDB_FILTER_BITS_PER_KEY.
+    const app_env_validator::EnvInfo rfbpk(
+        app_env_validator::ValueType::kString,
+        "In range [1.0, 100.0]",
+        "10",
+        [](const std::string &new_value, std::string &hint_message) {
+            double bits_per_key = 0;
+            if (!dsn::buf2double(new_value, bits_per_key) || bits_per_key < 1 ||
+                bits_per_key > 100) {
+                hint_message = "In range [1.0, 100.0]";
+                return false;
+            }
+            return true;
+        });
+
+    // EnvInfo for ROCKSDB_FILTER_TYPE.
+    const std::set<std::string> valid_rfts({"common", "prefix"});
+    const std::string rft_sample(fmt::format("{}", fmt::join(valid_rfts, " | ")));
+    const app_env_validator::EnvInfo rft(
+        app_env_validator::ValueType::kString,
+        rft_sample,
+        "prefix",
+        [=](const std::string &new_value, std::string &hint_message) {
+            if (valid_rfts.count(new_value) == 0) {
+                hint_message = rft_sample;
+                return false;
+            }
+            return true;
+        });
+
     // EnvInfo for ROCKSDB_USAGE_SCENARIO.
     const std::set<std::string> valid_russ({replica_envs::ROCKSDB_ENV_USAGE_SCENARIO_NORMAL,
                                             replica_envs::ROCKSDB_ENV_USAGE_SCENARIO_PREFER_WRITE,
@@ -285,6 +360,10 @@ void app_env_validator::register_all_validators()
           "",
           "20000*delay*100,20000*reject*100",
           &utils::token_bucket_throttling_controller::validate}},
+        {replica_envs::READ_CU_QUOTA,
+         {ValueType::kInt64, "> 0", "20000", [](int64_t new_value) { return new_value > 0; }}},
+        {replica_envs::WRITE_CU_QUOTA,
+         {ValueType::kInt64, "> 0", "20000", [](int64_t new_value) { return new_value > 0; }}},
         {replica_envs::SPLIT_VALIDATE_PARTITION_HASH, {ValueType::kBool}},
         {replica_envs::USER_SPECIFIED_COMPACTION, {ValueType::kString}},
         {replica_envs::BACKUP_REQUEST_QPS_THROTTLING,
@@ -308,6 +387,21 @@ void app_env_validator::register_all_validators()
           fmt::format("In range [{}, {}]", kMinLevel, kMaxLevel),
           "6",
           [](int64_t new_value) { return kMinLevel <= new_value && new_value <= kMaxLevel; }}},
+        {replica_envs::ROCKSDB_ENABLE_BLOB_FILES, {ValueType::kBool}},
+        {replica_envs::ROCKSDB_MIN_BLOB_SIZE,
+         {ValueType::kInt64, ">= 0", "65536", [](int64_t new_value) { return new_value >= 0; }}},
+        {replica_envs::ROCKSDB_BLOB_FILE_SIZE,
+         {ValueType::kInt64,
+          fmt::format(">= {}", kMinBlobFileSize),
+          "268435456",
+          [](int64_t new_value) { return new_value >= kMinBlobFileSize; }}},
+        {replica_envs::ROCKSDB_BLOB_COMPRESSION_TYPE, bct},
+        {replica_envs::ROCKSDB_ENABLE_BLOB_GARBAGE_COLLECTION, {ValueType::kBool}},
+        {replica_envs::ROCKSDB_BLOB_GARBAGE_COLLECTION_AGE_CUTOFF, blob_gc_ratio},
+        {replica_envs::ROCKSDB_BLOB_GARBAGE_COLLECTION_FORCE_THRESHOLD, blob_gc_ratio},
+        {replica_envs::ROCKSDB_FILTER_POLICY, rfp},
+        {replica_envs::ROCKSDB_FILTER_BITS_PER_KEY, rfbpk},
+        {replica_envs::ROCKSDB_FILTER_TYPE, rft},
         {replica_envs::BUSINESS_INFO, {ValueType::kString}},
         {replica_envs::TABLE_LEVEL_DEFAULT_TTL,
          {ValueType::kInt32, ">= 0", "86400", [](int64_t new_value) { return new_value >= 0; }}},
@@ -0,0 +1,157 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "meta/cu_quota_allocator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+
+#include "common/replica_envs.h"
+#include "dsn.layer2_types.h"
+#include "meta/meta_data.h"
+#include "utils/flags.h"
+#include "utils/string_conv.h"
+
+DSN_DEFINE_double(meta_server,
+                  cu_quota_demand_headroom_ratio,
+                  0.2,
+                  "The ratio of the demand a replica is allowed to grow by each time the CU "
+                  "quotas of the tables are distributed among the replicas");
+DSN_TAG_VARIABLE(cu_quota_demand_headroom_ratio, FT_MUTABLE);
+DSN_DEFINE_validator(cu_quota_demand_headroom_ratio,
+                     [](double value) -> bool { return value >= 0; });
+
+namespace dsn {
+namespace replication {
+
+namespace {
+
+int64_t get_cu_quota(const std::map<std::string, std::string> &envs, const std::string &key)
+{
+    const auto iter = envs.find(key);
+    int64_t quota = 0;
+    if (iter == envs.end() || !buf2int64(iter->second, quota) || quota < 0) {
+        return 0;
+    }
+    return quota;
+}
+
+} // anonymous namespace
+
+std::vector<int64_t>
+allocate_cu_quota(int64_t quota, const std::vector<int64_t> &demands, double headroom_ratio)
+{
+    const auto n = static_cast<int64_t>(demands.size());
+    std::vector<int64_t> budgets(n, 0);
+    if (n == 0) {
+        return budgets;
+    }
+
+    std::vector<int64_t> wants(n);
+    for (int64_t i = 0; i < n; ++i) {
+        const auto demand = std::max<int64_t>(demands[i], 0);
+        wants[i] =
+            std::max<int64_t>(1, static_cast<int64_t>(std::ceil(demand * (1 + headroom_ratio))));
+    }
+
+    // Satisfy the units from the one wanting the least.
+    std::vector<int64_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&wants](int64_t a, int64_t b) {
+        return wants[a] < wants[b];
+    });
+    int64_t remaining = quota;
+    for (int64_t k = 0; k < n; ++k) {
+        const auto i = order[k];
+        budgets[i] = std::min(wants[i], remaining / (n - k));
+        remaining -= budgets[i];
+    }
+
+    for (int64_t i = 0; i < n; ++i) {
+        budgets[i] += remaining / n + (i < remaining % n ? 1 : 0);
+        budgets[i] = std::max<int64_t>(budgets[i], 1);
+    }
+    return budgets;
+}
+
+int64_t replica_read_cu_budget(int64_t budget, size_t replica_count, bool is_primary)
+{
+    if (budget <= 0 || replica_count == 0) {
+        return 0;
+    }
+    if (is_primary) {
+        return budget;
+    }
+    return std::max<int64_t>(1, budget / static_cast<int64_t>(replica_count));
+}
+
+std::vector<std::map<host_port, replica_cu_budget>> allocate_app_cu_budgets(const app_state &app)
+{
+    const auto read_quota = get_cu_quota(app.envs, replica_envs::READ_CU_QUOTA);
+    const auto write_quota = get_cu_quota(app.envs, replica_envs::WRITE_CU_QUOTA);
+    if (read_quota == 0 && write_quota == 0) {
+        return {};
+    }
+
+    std::vector<std::map<host_port, replica_cu_budget>> budgets(app.pcs.size());
+    std::vector<std::vector<host_port>> members(app.pcs.size());
+    std::vector<int64_t> read_demands(app.pcs.size(), 0);
+    std::vector<int64_t> write_demands(app.pcs.size(), 0);
+    for (size_t i = 0; i < app.pcs.size(); ++i) {
+        const auto &pc = app.pcs[i];
+        const auto &cc = app.helpers->contexts[i];
+        members[i] = pc.hp_secondaries;
+        if (pc.hp_primary) {
+            members[i].push_back(pc.hp_primary);
+        }
+        for (const auto &node : members[i]) {
+            budgets[i][node] = replica_cu_budget();
+            const auto iter = cc.find_from_serving(node);
+            const auto read_demand = iter == cc.serving.end() ? 0 : iter->read_cu_per_sec;
+            read_demands[i] += read_demand;
+            if (iter != cc.serving.end() && node == pc.hp_primary) {
+                write_demands[i] = iter->write_cu_per_sec;
+            }
+        }
+    }
+
+    const auto read_budgets =
+        read_quota > 0
+            ? allocate_cu_quota(read_quota, read_demands, FLAGS_cu_quota_demand_headroom_ratio)
+            : std::vector<int64_t>(budgets.size(), 0);
+    const auto write_budgets =
+        write_quota > 0
+            ? allocate_cu_quota(write_quota, write_demands, FLAGS_cu_quota_demand_headroom_ratio)
+            : std::vector<int64_t>(budgets.size(), 0);
+    for (size_t i = 0; i < budgets.size(); ++i) {
+        for (const auto &node : members[i]) {
+            budgets[i][node].read_cu_per_sec = replica_read_cu_budget(
+                read_budgets[i], members[i].size(), node == app.pcs[i].hp_primary);
+        }
+        if (app.pcs[i].hp_primary) {
+            budgets[i][app.pcs[i].hp_primary].write_cu_per_sec = write_budgets[i];
+        }
+    }
+    return budgets;
+}
+
+} // namespace replication
+} // namespace dsn
@@ -0,0 +1,71 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "rpc/rpc_host_port.h"
+
+namespace dsn {
+namespace replication {
+class app_state;
+
+// The capacity units per second a replica is allowed to serve, 0 means unlimited.
+struct replica_cu_budget
+{
+    int64_t read_cu_per_sec{0};
+    int64_t write_cu_per_sec{0};
+};
+
+// Distribute `quota` among the units by the max-min fairness of their demands. Every unit wants
+// its demand plus `headroom_ratio` of it, the units wanting less than the fair share get what
+// they want, and the others share the rest evenly. The quota left after all of the wants are
+// satisfied is shared evenly, thus a unit could grow by its headroom every time the quota is
+// distributed, while a hot unit could never take the share of the others.
+//
+// Every unit gets at least 1 unless there is no unit, since 0 means unlimited. Thus the budgets
+// add up to exactly `quota` if `quota` is not less than the number of the units, otherwise they
+// add up to the number of the units, i.e. the quota is exceeded.
+std::vector<int64_t>
+allocate_cu_quota(int64_t quota, const std::vector<int64_t> &demands, double headroom_ratio);
+
+// The read budget of a replica of a partition whose read budget is `budget`. The primary, which
+// serves almost all of the reads, is given the whole budget, while each secondary, which serves
+// only the backup-request and bounded-staleness reads, is given an even share of it (at least 1).
+// The budget of a secondary does not depend on its read rate, thus neither is a secondary capped
+// by its own throttled rate, nor is a secondary promoted to primary starved until the next config
+// sync gives it the whole budget. All of them get 0 (i.e. unlimited) if `budget` is 0.
+//
+// The reads served by a partition could exceed `budget` by the shares of its secondaries, which
+// only happens when the secondaries serve reads.
+int64_t replica_read_cu_budget(int64_t budget, size_t replica_count, bool is_primary);
+
+// Distribute the read and write CU quotas of `app` set by its envs among its partitions by the
+// loads their replicas reported by config sync, i.e. the read rates of all of the replicas and
+// the write rate of the primary. The read budget of a partition is then given to its replicas by
+// replica_read_cu_budget(), while the write budget is given to the primary only, since the
+// secondaries never serve the writes from the clients. A replica promoted to primary serves the
+// writes without limit until the next config sync.
+//
+// Returns partition_index -> node -> budget, which is empty if neither of the quotas is set.
+std::vector<std::map<host_port, replica_cu_budget>> allocate_app_cu_budgets(const app_state &app);
+
+} // namespace replication
+} // namespace dsn
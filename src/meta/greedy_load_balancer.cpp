@@ -39,6 +39,7 @@
 #include "app_balance_policy.h"
 #include "cluster_balance_policy.h"
 #include "greedy_load_balancer.h"
+#include "load_aware_balance_policy.h"
 #include "meta/load_balance_policy.h"
 #include "meta/meta_service.h"
 #include "meta/server_load_balancer.h"
@@ -56,6 +57,22 @@
 DSN_DEFINE_bool(meta_server, balance_cluster, false, "whether to enable cluster balancer");
 DSN_TAG_VARIABLE(balance_cluster, FT_MUTABLE);
 
+DSN_DEFINE_bool(meta_server,
+                balance_load_aware,
+                false,
+                "whether to balance replicas by their reported load (capacity units, qps and "
+                "storage size) instead of their count, which takes precedence over "
+                "balance_cluster");
+DSN_TAG_VARIABLE(balance_load_aware, FT_MUTABLE);
+
+DSN_DEFINE_bool(meta_server,
+                balance_load_aware_dry_run,
+                false,
+                "whether the load-aware balancer only proposes the migrations without applying "
+                "them while the count-based balancer keeps working, which could be inspected by "
+                "the remote command 'meta.lb.load_aware'");
+DSN_TAG_VARIABLE(balance_load_aware_dry_run, FT_MUTABLE);
+
 DSN_DECLARE_uint64(min_live_node_count_for_unfreeze);
 
 namespace dsn {
@@ -67,6 +84,7 @@ greedy_load_balancer::greedy_load_balancer(meta_service *_svc) : server_load_bal
 {
     _app_balance_policy = std::make_unique<app_balance_policy>(_svc);
     _cluster_balance_policy = std::make_unique<cluster_balance_policy>(_svc);
+    _load_aware_balance_policy = std::make_unique<load_aware_balance_policy>(_svc);
     _all_replca_infos_collected = false;
 
     ::memset(t_operation_counters, 0, sizeof(t_operation_counters));
@@ -161,16 +179,36 @@ void greedy_load_balancer::greedy_balancer(const bool balance_checker)
     CHECK_GE_MSG(
         t_alive_nodes, FLAGS_min_live_node_count_for_unfreeze, "too few nodes will be freezed");
 
+    _all_replca_infos_collected = true;
     for (auto &kv : *(t_global_view->nodes)) {
         node_state &ns = kv.second;
-        _all_replca_infos_collected = all_replica_infos_collected(ns);
-        if (!_all_replca_infos_collected) {
-            return;
+        if (!all_replica_infos_collected(ns)) {
+            _all_replca_infos_collected = false;
+            break;
         }
     }
 
+    // While running dry, the migrations proposed by the load-aware balancer are dropped, which
+    // could be inspected by the remote command "meta.lb.load_aware".
+    const bool dry_run = FLAGS_balance_load_aware && FLAGS_balance_load_aware_dry_run;
+    if (dry_run && !balance_checker) {
+        migration_list dry_run_result;
+        _load_aware_balance_policy->balance(false, t_global_view, &dry_run_result);
+    }
+
+    // The load-aware balancer skips the partitions whose loads have not been reported, thus it
+    // is not blocked by them.
+    const bool load_aware = FLAGS_balance_load_aware && !dry_run;
+    if (!_all_replca_infos_collected && !load_aware) {
+        return;
+    }
+
     load_balance_policy *balance_policy = nullptr;
-    if (!FLAGS_balance_cluster) {
+    if (load_aware) {
+        if (!balance_checker) {
+            balance_policy = _load_aware_balance_policy.get();
+        }
+    } else if (!FLAGS_balance_cluster) {
         balance_policy = _app_balance_policy.get();
     } else if (!balance_checker) {
         balance_policy = _cluster_balance_policy.get();
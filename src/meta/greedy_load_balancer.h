@@ -76,6 +76,7 @@ private:
 
     std::unique_ptr<load_balance_policy> _app_balance_policy;
     std::unique_ptr<load_balance_policy> _cluster_balance_policy;
+    std::unique_ptr<load_balance_policy> _load_aware_balance_policy;
 
     std::unique_ptr<command_deregister> _get_balance_operation_count;
 
@@ -0,0 +1,371 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "load_aware_balance_policy.h"
+
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+#include <nlohmann/json_fwd.hpp>
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <utility>
+
+#include "dsn.layer2_types.h"
+#include "meta_admin_types.h"
+#include "utils/command_manager.h"
+#include "utils/flags.h"
+#include "utils/fmt_logging.h"
+#include "utils/string_conv.h"
+
+DSN_DEFINE_double(meta_server,
+                  load_balance_cu_weight,
+                  1.0,
+                  "The weight of the capacity units in the load of a replica for the load-aware "
+                  "balancer");
+DSN_TAG_VARIABLE(load_balance_cu_weight, FT_MUTABLE);
+DSN_DEFINE_validator(load_balance_cu_weight, [](double value) -> bool { return value >= 0; });
+
+DSN_DEFINE_double(meta_server,
+                  load_balance_qps_weight,
+                  1.0,
+                  "The weight of the qps in the load of a replica for the load-aware balancer");
+DSN_TAG_VARIABLE(load_balance_qps_weight, FT_MUTABLE);
+DSN_DEFINE_validator(load_balance_qps_weight, [](double value) -> bool { return value >= 0; });
+
+DSN_DEFINE_double(meta_server,
+                  load_balance_disk_weight,
+                  1.0,
+                  "The weight of the storage size in the load of a replica for the load-aware "
+                  "balancer");
+DSN_TAG_VARIABLE(load_balance_disk_weight, FT_MUTABLE);
+DSN_DEFINE_validator(load_balance_disk_weight, [](double value) -> bool { return value >= 0; });
+
+DSN_DEFINE_double(meta_server,
+                  load_balance_tolerance_ratio,
+                  0.1,
+                  "The load-aware balancer stops once the load of every node is within this "
+                  "ratio above the average load");
+DSN_TAG_VARIABLE(load_balance_tolerance_ratio, FT_MUTABLE);
+DSN_DEFINE_validator(load_balance_tolerance_ratio, [](double value) -> bool { return value >= 0; });
+
+DSN_DEFINE_uint64(meta_server,
+                  load_balance_max_migration_mb_per_round,
+                  10240,
+                  "The maximum size of the replicas copied by the load-aware balancer in one "
+                  "round, 0 means only moving primaries is allowed");
+DSN_TAG_VARIABLE(load_balance_max_migration_mb_per_round, FT_MUTABLE);
+
+DSN_DECLARE_bool(balance_load_aware);
+DSN_DECLARE_bool(balance_load_aware_dry_run);
+DSN_DECLARE_uint32(balance_op_count_per_round);
+
+namespace dsn {
+namespace replication {
+
+load_aware_balance_policy::load_aware_balance_policy(meta_service *svc) : load_balance_policy(svc)
+{
+    _cmds.emplace_back(dsn::command_manager::instance().register_single_command(
+        "meta.lb.load_aware",
+        "Get the status and the latest round of the load-aware balancer, enable or disable it, "
+        "or set whether it only runs dry, i.e. proposes the migrations without applying them "
+        "while the count-based balancer keeps working",
+        "[status|enable|disable|dry_run <true|false>]",
+        [this](const std::vector<std::string> &args) { return remote_command_load_aware(args); }));
+}
+
+std::string
+load_aware_balance_policy::remote_command_load_aware(const std::vector<std::string> &args) const
+{
+    nlohmann::json info;
+    if (args.empty() || (args.size() == 1 && args[0] == "status")) {
+        info["enabled"] = FLAGS_balance_load_aware;
+        info["dry_run"] = FLAGS_balance_load_aware_dry_run;
+        zauto_lock l(_last_round_lock);
+        info["last_round"] =
+            _last_round.empty() ? nlohmann::json::object() : nlohmann::json::parse(_last_round);
+    } else if (args.size() == 1 && (args[0] == "enable" || args[0] == "disable")) {
+        FLAGS_balance_load_aware = args[0] == "enable";
+        info["enabled"] = FLAGS_balance_load_aware;
+    } else if (args.size() == 2 && args[0] == "dry_run" &&
+               buf2bool(args[1], FLAGS_balance_load_aware_dry_run)) {
+        info["dry_run"] = FLAGS_balance_load_aware_dry_run;
+    } else {
+        info["error"] = fmt::format("invalid arguments");
+    }
+    return info.dump(2);
+}
+
+void load_aware_balance_policy::balance(bool checker,
+                                        const meta_view *global_view,
+                                        migration_list *list)
+{
+    init(global_view, list);
+
+    collect_loads();
+    if (_node_loads.size() < 2) {
+        return;
+    }
+
+    double total_load = 0;
+    for (const auto &[_, load] : _node_loads) {
+        total_load += load;
+    }
+    const double average_load = total_load / _node_loads.size();
+    if (average_load <= 0) {
+        return;
+    }
+
+    nlohmann::json last_round;
+    last_round["skipped_partition_count"] = _skipped_partition_count;
+    last_round["average_load"] = average_load;
+    for (const auto &[node, load] : _node_loads) {
+        last_round["node_loads"][node.to_string()] = load;
+    }
+    last_round["migrations"] = nlohmann::json::array();
+
+    // The flags are mutable, read them once to keep the bounds consistent within the round.
+    const uint32_t max_op_count = FLAGS_balance_op_count_per_round;
+    const uint64_t max_migration_mb = FLAGS_load_balance_max_migration_mb_per_round;
+    std::vector<bool> moved(_partitions.size(), false);
+    std::set<host_port> exhausted_nodes;
+    uint32_t op_count = 0;
+    uint64_t migrated_mb = 0;
+    while (op_count < max_op_count) {
+        auto source = _node_loads.end();
+        for (auto iter = _node_loads.begin(); iter != _node_loads.end(); ++iter) {
+            if (exhausted_nodes.count(iter->first) == 0 &&
+                (source == _node_loads.end() || iter->second > source->second)) {
+                source = iter;
+            }
+        }
+        if (source == _node_loads.end() ||
+            source->second <= average_load * (1 + FLAGS_load_balance_tolerance_ratio)) {
+            break;
+        }
+
+        size_t partition_index = 0;
+        move_info move;
+        // A move is applied only if its cost is within the remaining budget, thus `migrated_mb`
+        // never exceeds `max_migration_mb`.
+        const auto remaining_mb = static_cast<int64_t>(max_migration_mb - migrated_mb);
+        if (!find_best_move(source->first, remaining_mb, moved, partition_index, move)) {
+            // No replica on this node could be moved to lower the peak, try the next one.
+            exhausted_nodes.insert(source->first);
+            continue;
+        }
+
+        apply_move(_partitions[partition_index], move);
+        moved[partition_index] = true;
+        migrated_mb += move.cost_mb;
+        ++op_count;
+        last_round["migrations"].push_back({{"gpid", move.pid.to_string()},
+                                            {"type", enum_to_string(move.type)},
+                                            {"source", move.source.to_string()},
+                                            {"target", move.target.to_string()},
+                                            {"load", move.delta},
+                                            {"cost_mb", move.cost_mb}});
+    }
+
+    LOG_INFO("load-aware balancer generated {} migrations with {} MB to copy, average load = {}, "
+             "{} partitions are skipped since their loads have not been reported",
+             op_count,
+             migrated_mb,
+             average_load,
+             _skipped_partition_count);
+
+    zauto_lock l(_last_round_lock);
+    _last_round = last_round.dump();
+}
+
+void load_aware_balance_policy::collect_loads()
+{
+    _partitions.clear();
+    _node_loads.clear();
+    _node_partitions.clear();
+    _partially_collected_nodes.clear();
+    _skipped_partition_count = 0;
+
+    for (const auto &[node, ns] : *_global_view->nodes) {
+        if (ns.alive()) {
+            _node_loads.emplace(node, 0);
+        }
+    }
+
+    int64_t total_cu = 0;
+    int64_t total_qps = 0;
+    int64_t total_storage_mb = 0;
+    for (const auto &[id, app] : *_global_view->apps) {
+        if (app->status != app_status::AS_AVAILABLE || app->is_bulk_loading || app->splitting()) {
+            continue;
+        }
+        if (is_ignored_app(id)) {
+            LOG_INFO("skip to do balance for the ignored app[{}]", app->get_logname());
+            continue;
+        }
+
+        for (const auto &pc : app->pcs) {
+            // Unhealthy partitions are left to be cured before being balanced.
+            if (!pc.hp_primary || pc.hp_secondaries.size() != pc.max_replica_count - 1) {
+                continue;
+            }
+
+            const config_context &cc = app->helpers->contexts[pc.pid.get_partition_index()];
+            partition_load partition{&pc, {}};
+            bool all_collected = true;
+            bool all_alive = true;
+            const auto collect = [&](const host_port &node, bool is_primary) {
+                if (_node_loads.count(node) == 0) {
+                    all_alive = false;
+                    return;
+                }
+                const auto iter = cc.find_from_serving(node);
+                if (iter == cc.serving.end()) {
+                    LOG_INFO(
+                        "meta server hasn't collected the load of gpid({}) on {}", pc.pid, node);
+                    all_collected = false;
+                    return;
+                }
+                partition.replicas.push_back({node,
+                                              is_primary,
+                                              iter->read_cu_per_sec + iter->write_cu_per_sec,
+                                              iter->qps,
+                                              iter->storage_mb,
+                                              0});
+            };
+            collect(pc.hp_primary, true);
+            for (const auto &secondary : pc.hp_secondaries) {
+                collect(secondary, false);
+            }
+            if (!all_alive) {
+                continue;
+            }
+            if (!all_collected) {
+                ++_skipped_partition_count;
+                _partially_collected_nodes.insert(pc.hp_primary);
+                _partially_collected_nodes.insert(pc.hp_secondaries.begin(),
+                                                  pc.hp_secondaries.end());
+                continue;
+            }
+
+            for (const auto &replica : partition.replicas) {
+                total_cu += replica.cu;
+                total_qps += replica.qps;
+                total_storage_mb += replica.storage_mb;
+            }
+            _partitions.emplace_back(std::move(partition));
+        }
+    }
+
+    const auto normalize = [](int64_t value, int64_t total) {
+        return total > 0 ? static_cast<double>(value) / total : 0.0;
+    };
+    for (size_t i = 0; i < _partitions.size(); ++i) {
+        for (auto &replica : _partitions[i].replicas) {
+            replica.load = FLAGS_load_balance_cu_weight * normalize(replica.cu, total_cu) +
+                           FLAGS_load_balance_qps_weight * normalize(replica.qps, total_qps) +
+                           FLAGS_load_balance_disk_weight *
+                               normalize(replica.storage_mb, total_storage_mb);
+            _node_loads[replica.node] += replica.load;
+            _node_partitions[replica.node].push_back(i);
+        }
+    }
+}
+
+bool load_aware_balance_policy::find_best_move(const host_port &source,
+                                               int64_t remaining_mb,
+                                               const std::vector<bool> &moved,
+                                               /*out*/ size_t &partition_index,
+                                               /*out*/ move_info &move) const
+{
+    const auto iter = _node_partitions.find(source);
+    if (iter == _node_partitions.end()) {
+        return false;
+    }
+
+    const double source_load = _node_loads.at(source);
+    bool found = false;
+    double best_gain = 0;
+    for (const auto index : iter->second) {
+        if (moved[index]) {
+            continue;
+        }
+
+        const auto &partition = _partitions[index];
+        const auto try_move =
+            [&](balance_type type, const host_port &target, double delta, int64_t cost_mb) {
+                if (delta <= 0 || cost_mb > remaining_mb ||
+                    _partially_collected_nodes.count(target) != 0) {
+                    return;
+                }
+                // The move lowers the peak of source and target only if target is left below
+                // the original load of source.
+                const double gain =
+                    source_load - std::max(source_load - delta, _node_loads.at(target) + delta);
+                if (gain > best_gain || (found && gain == best_gain && cost_mb < move.cost_mb)) {
+                    found = true;
+                    best_gain = gain;
+                    partition_index = index;
+                    move = {partition.pc->pid, type, source, target, delta, cost_mb};
+                }
+            };
+
+        const auto source_replica =
+            std::find_if(partition.replicas.begin(),
+                         partition.replicas.end(),
+                         [&source](const replica_load &r) { return r.node == source; });
+        CHECK(source_replica != partition.replicas.end(), "");
+        if (source_replica->is_primary) {
+            // The new primary is expected to take over the load of the old one.
+            for (const auto &replica : partition.replicas) {
+                if (!replica.is_primary) {
+                    try_move(balance_type::MOVE_PRIMARY,
+                             replica.node,
+                             source_replica->load - replica.load,
+                             0);
+                }
+            }
+        }
+
+        const auto type =
+            source_replica->is_primary ? balance_type::COPY_PRIMARY : balance_type::COPY_SECONDARY;
+        for (const auto &kv : _node_loads) {
+            const auto &target = kv.first;
+            const bool is_member = std::any_of(
+                partition.replicas.begin(),
+                partition.replicas.end(),
+                [&target](const replica_load &r) { return r.node == target; });
+            if (!is_member) {
+                try_move(type, target, source_replica->load, source_replica->storage_mb);
+            }
+        }
+    }
+    return found;
+}
+
+void load_aware_balance_policy::apply_move(const partition_load &partition, const move_info &move)
+{
+    _migration_result->emplace(
+        move.pid,
+        generate_balancer_request(
+            *_global_view->apps, *partition.pc, move.type, move.source, move.target));
+    _node_loads[move.source] -= move.delta;
+    _node_loads[move.target] += move.delta;
+}
+
+} // namespace replication
+} // namespace dsn
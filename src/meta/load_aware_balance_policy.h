@@ -0,0 +1,118 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "common/gpid.h"
+#include "load_balance_policy.h"
+#include "meta/meta_data.h"
+#include "rpc/rpc_host_port.h"
+#include "utils/zlocks.h"
+
+namespace dsn {
+class command_deregister;
+class partition_configuration;
+
+namespace replication {
+class meta_service;
+
+// Balances replicas by their load instead of their count. The load of a replica is the weighted
+// sum of its capacity units, qps and storage size reported by replica servers, each of which is
+// normalized by the total of the cluster. In each round the policy greedily moves primaries or
+// copies replicas from the most loaded node to less loaded ones, until every node is within the
+// tolerance of the average load or the migration cost of the round reaches its bound.
+//
+// The partitions with some replica whose load has not been reported yet are skipped, and the
+// nodes serving them are never chosen as the targets since their loads are underestimated.
+//
+// The policy could be switched, dry-run and inspected by the remote command
+// "meta.lb.load_aware".
+class load_aware_balance_policy : public load_balance_policy
+{
+public:
+    explicit load_aware_balance_policy(meta_service *svc);
+    ~load_aware_balance_policy() = default;
+
+    void balance(bool checker, const meta_view *global_view, migration_list *list) override;
+
+    // Handle the remote command "meta.lb.load_aware".
+    std::string remote_command_load_aware(const std::vector<std::string> &args) const;
+
+private:
+    struct replica_load
+    {
+        host_port node;
+        bool is_primary;
+        int64_t cu;
+        int64_t qps;
+        int64_t storage_mb;
+        double load;
+    };
+
+    struct partition_load
+    {
+        const partition_configuration *pc;
+        std::vector<replica_load> replicas;
+    };
+
+    struct move_info
+    {
+        gpid pid;
+        balance_type type;
+        host_port source;
+        host_port target;
+        // The load expected to be moved from source to target.
+        double delta;
+        // The size of the data to be copied, which is 0 for moving primary.
+        int64_t cost_mb;
+    };
+
+    // Collect the load of every replica of the healthy partitions whose replicas have all been
+    // reported.
+    void collect_loads();
+    bool find_best_move(const host_port &source,
+                        int64_t remaining_mb,
+                        const std::vector<bool> &moved,
+                        /*out*/ size_t &partition_index,
+                        /*out*/ move_info &move) const;
+    void apply_move(const partition_load &partition, const move_info &move);
+
+    std::vector<partition_load> _partitions;
+    std::map<host_port, double> _node_loads;
+    // node -> indexes of the partitions in `_partitions` served by it
+    std::map<host_port, std::vector<size_t>> _node_partitions;
+    // The nodes serving the partitions skipped for their unreported loads.
+    std::set<host_port> _partially_collected_nodes;
+    size_t _skipped_partition_count{0};
+
+    // The loads and the migrations of the latest round in json, for inspection.
+    mutable zlock _last_round_lock;
+    std::string _last_round;
+
+    std::vector<std::unique_ptr<command_deregister>> _cmds;
+};
+
+} // namespace replication
+} // namespace dsn
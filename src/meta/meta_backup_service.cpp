@@ -98,6 +98,66 @@ bool validate_backup_interval(int64_t backup_interval_seconds, std::string &hint
     return true;
 }
 
+// The following functions access block service synchronously, which are only used by the
+// background task to gc the shared files.
+error_code list_dir_sync(dist::block_service::block_filesystem *fs,
+                         const std::string &dir,
+                         std::vector<dist::block_service::ls_entry> &entries)
+{
+    dist::block_service::ls_response resp;
+    fs->list_dir(
+          dist::block_service::ls_request{dir},
+          TASK_CODE_EXEC_INLINED,
+          [&resp](const dist::block_service::ls_response &r) { resp = r; },
+          nullptr)
+        ->wait();
+    if (resp.err == ERR_OK) {
+        entries = *resp.entries;
+    }
+    return resp.err;
+}
+
+error_code read_file_sync(dist::block_service::block_filesystem *fs,
+                          const std::string &file_name,
+                          blob &value)
+{
+    dist::block_service::create_file_response create_resp;
+    fs->create_file(
+          dist::block_service::create_file_request{file_name, false},
+          TASK_CODE_EXEC_INLINED,
+          [&create_resp](const dist::block_service::create_file_response &r) { create_resp = r; },
+          nullptr)
+        ->wait();
+    if (create_resp.err != ERR_OK) {
+        return create_resp.err;
+    }
+
+    dist::block_service::read_response read_resp;
+    create_resp.file_handle
+        ->read(
+            dist::block_service::read_request{0, -1},
+            TASK_CODE_EXEC_INLINED,
+            [&read_resp](const dist::block_service::read_response &r) { read_resp = r; },
+            nullptr)
+        ->wait();
+    if (read_resp.err == ERR_OK) {
+        value = read_resp.buffer;
+    }
+    return read_resp.err;
+}
+
+error_code remove_path_sync(dist::block_service::block_filesystem *fs, const std::string &path)
+{
+    dist::block_service::remove_path_response resp;
+    fs->remove_path(
+          dist::block_service::remove_path_request{path, true},
+          TASK_CODE_EXEC_INLINED,
+          [&resp](const dist::block_service::remove_path_response &r) { resp = r; },
+          nullptr)
+        ->wait();
+    return resp.err;
+}
+
 } // anonymous namespace
 
 backup_policy_metrics::backup_policy_metrics(const std::string &policy_name)
@@ -844,7 +904,7 @@ void policy_context::issue_new_backup_unlocked()
         return;
     }
 
-    if (!should_start_backup_unlocked()) {
+    if (_is_gc_shared_files || !should_start_backup_unlocked()) {
         tasking::enqueue(
             LPC_DEFAULT_CALLBACK,
             &_tracker,
@@ -1023,6 +1083,10 @@ void policy_context::gc_backup_info_unlocked(const backup_info &info_to_gc)
                                 zauto_lock l(_lock);
                                 _backup_history.erase(info_to_gc.backup_id);
                                 issue_gc_backup_info_task_unlocked();
+                                if (_backup_history.size() <=
+                                    _policy.backup_history_count_to_keep) {
+                                    issue_gc_shared_files_unlocked();
+                                }
                             });
                         sync_remove_backup_info(info_to_gc, remove_local_backup_info_task);
                     } else { // ERR_FS_INTERNAL, ERR_TIMEOUT, ERR_DIR_NOT_EMPTY
@@ -1105,6 +1169,144 @@ void policy_context::sync_remove_backup_info(const backup_info &info, dsn::task_
         backup_info_path, true, LPC_DEFAULT_CALLBACK, callback, nullptr);
 }
 
+void policy_context::issue_gc_shared_files_unlocked()
+{
+    if (_is_gc_shared_files || _cur_backup.start_time_ms > 0) {
+        LOG_INFO("{}: skip to gc shared files since it's gc or backing up now",
+                 _policy.policy_name);
+        return;
+    }
+
+    std::vector<int64_t> backup_ids;
+    backup_ids.reserve(_backup_history.size());
+    for (const auto &kv : _backup_history) {
+        backup_ids.emplace_back(kv.first);
+    }
+    _is_gc_shared_files = true;
+    tasking::enqueue(
+        LPC_DEFAULT_CALLBACK, &_tracker, [this, policy_name = _policy.policy_name, backup_ids]() {
+            gc_shared_files(policy_name, backup_ids);
+            zauto_lock l(_lock);
+            _is_gc_shared_files = false;
+        });
+}
+
+void policy_context::gc_shared_files(const std::string &policy_name,
+                                     const std::vector<int64_t> &backup_ids)
+{
+    const std::string &root = _backup_service->backup_root();
+    const std::string policy_dir = cold_backup::get_policy_shared_files_dir(root, policy_name);
+
+    // <root>/shared_files/<policy_name>/<appname_appid>/<partition_index>
+    std::vector<dist::block_service::ls_entry> app_dirs;
+    error_code err = list_dir_sync(_block_service, policy_dir, app_dirs);
+    if (err != ERR_OK) {
+        if (err != ERR_OBJECT_NOT_FOUND) {
+            LOG_WARNING("{}: list shared files dir({}) failed, err = {}, try it later",
+                        policy_name,
+                        policy_dir,
+                        err);
+        }
+        return;
+    }
+
+    for (const auto &app_dir : app_dirs) {
+        if (!app_dir.is_directory) {
+            continue;
+        }
+        std::vector<dist::block_service::ls_entry> partition_dirs;
+        err = list_dir_sync(_block_service, policy_dir + "/" + app_dir.entry_name, partition_dirs);
+        if (err != ERR_OK) {
+            LOG_WARNING("{}: list shared files dir of {} failed, err = {}, try it later",
+                        policy_name,
+                        app_dir.entry_name,
+                        err);
+            continue;
+        }
+
+        for (const auto &partition_dir : partition_dirs) {
+            if (!partition_dir.is_directory) {
+                continue;
+            }
+            // The shared files of a replica are referenced by the backup_metadata under
+            // <root>/<backup_id>/<appname_appid>/<partition_index>.
+            const std::string relative_dir = app_dir.entry_name + "/" + partition_dir.entry_name;
+            if (!gc_shared_files_of_partition(cold_backup_constant::SHARED_FILES + "/" +
+                                                  policy_name + "/" + relative_dir,
+                                              relative_dir,
+                                              backup_ids)) {
+                LOG_WARNING("{}: gc shared files of {} failed, try it later",
+                            policy_name,
+                            relative_dir);
+            }
+        }
+    }
+}
+
+bool policy_context::gc_shared_files_of_partition(const std::string &shared_files_dir,
+                                                  const std::string &replica_dir,
+                                                  const std::vector<int64_t> &backup_ids)
+{
+    const std::string &root = _backup_service->backup_root();
+
+    // mark the files referenced by the retained backups
+    std::set<std::string> referenced_keys;
+    for (const auto backup_id : backup_ids) {
+        const std::string replica_path =
+            cold_backup::get_backup_path(root, backup_id) + "/" + replica_dir;
+        blob value;
+        error_code err = read_file_sync(
+            _block_service, replica_path + "/" + cold_backup_constant::CURRENT_CHECKPOINT, value);
+        if (err == ERR_OBJECT_NOT_FOUND) {
+            // the partition is not backed up in this backup
+            continue;
+        }
+        if (err != ERR_OK) {
+            return false;
+        }
+
+        const std::string chkpt_dirname(value.data(), value.length());
+        err = read_file_sync(_block_service,
+                             replica_path + "/" + chkpt_dirname + "/" +
+                                 cold_backup_constant::BACKUP_METADATA,
+                             value);
+        cold_backup_metadata metadata;
+        if (err != ERR_OK || !json::json_forwarder<cold_backup_metadata>::decode(value, metadata)) {
+            return false;
+        }
+        if (metadata.shared_files_dir != shared_files_dir) {
+            continue;
+        }
+        for (const auto &f_meta : metadata.files) {
+            if (cold_backup::is_shared_file(f_meta.name)) {
+                referenced_keys.emplace(cold_backup::get_shared_file_key(f_meta));
+            }
+        }
+    }
+
+    // sweep the others
+    const std::string dir = root + "/" + shared_files_dir;
+    std::vector<dist::block_service::ls_entry> entries;
+    if (list_dir_sync(_block_service, dir, entries) != ERR_OK) {
+        return false;
+    }
+    bool ok = true;
+    for (const auto &entry : entries) {
+        if (referenced_keys.count(entry.entry_name) > 0) {
+            continue;
+        }
+        const std::string path = dir + "/" + entry.entry_name;
+        error_code err = remove_path_sync(_block_service, path);
+        if (err != ERR_OK && err != ERR_OBJECT_NOT_FOUND) {
+            LOG_WARNING("remove unreferenced shared file({}) failed, err = {}", path, err);
+            ok = false;
+            continue;
+        }
+        LOG_INFO("remove unreferenced shared file({}) succeed", path);
+    }
+    return ok;
+}
+
 backup_service::backup_service(meta_service *meta_svc,
                                const std::string &policy_meta_root,
                                const std::string &backup_root,
@@ -268,7 +268,7 @@ class policy_context
 {
 public:
     explicit policy_context(backup_service *service)
-        : _backup_service(service), _block_service(nullptr)
+        : _backup_service(service), _block_service(nullptr), _is_gc_shared_files(false)
     {
     }
     mock_virtual ~policy_context() {}
@@ -332,6 +332,20 @@ mock_private :
     mock_virtual void issue_gc_backup_info_task_unlocked();
     mock_virtual void sync_remove_backup_info(const backup_info &info, dsn::task_ptr sync_callback);
 
+    // The shared files of incremental backups are garbage collected by mark-and-sweep: the files
+    // referenced by the backup_metadata of the retained backups are kept, and the others are
+    // removed. It's not issued while backing up, since the files being uploaded are not
+    // referenced yet, and new backups are delayed until it's done.
+    mock_virtual void issue_gc_shared_files_unlocked();
+    // access block service synchronously, should be called without holding the _lock
+    void gc_shared_files(const std::string &policy_name, const std::vector<int64_t> &backup_ids);
+    // returns:
+    //  - false, the files referenced by the retained backups can't be all found, nothing is
+    //    removed in this case
+    bool gc_shared_files_of_partition(const std::string &shared_files_dir,
+                                      const std::string &replica_dir,
+                                      const std::vector<int64_t> &backup_ids);
+
 mock_private :
     friend class backup_service;
     backup_service *_backup_service;
@@ -348,6 +362,7 @@ mock_private :
     bool _is_backup_failed;
     // backup_id --> backup_info
     std::map<int64_t, backup_info> _backup_history;
+    bool _is_gc_shared_files;
     backup_progress _progress;
     std::string _backup_sig; // policy_name@backup_id, used when print backup related log
 
@@ -443,13 +443,15 @@ void config_context::collect_serving_replica(const host_port &node, const replic
     auto iter = find_from_serving(node);
     auto compact_status = info.__isset.manual_compact_status ? info.manual_compact_status
                                                              : manual_compaction_status::IDLE;
-    if (iter != serving.end()) {
-        iter->disk_tag = info.disk_tag;
-        iter->storage_mb = 0;
-        iter->compact_status = compact_status;
-    } else {
-        serving.emplace_back(serving_replica{node, 0, info.disk_tag, compact_status});
+    if (iter == serving.end()) {
+        iter = serving.insert(serving.end(), serving_replica{node});
     }
+    iter->disk_tag = info.disk_tag;
+    iter->compact_status = compact_status;
+    iter->storage_mb = info.__isset.storage_mb ? info.storage_mb : 0;
+    iter->read_cu_per_sec = info.__isset.read_cu_per_sec ? info.read_cu_per_sec : 0;
+    iter->write_cu_per_sec = info.__isset.write_cu_per_sec ? info.write_cu_per_sec : 0;
+    iter->qps = info.__isset.qps ? info.qps : 0;
 }
 
 void config_context::adjust_proposal(const host_port &node, const replica_info &info)
@@ -187,10 +187,13 @@ inline int dropped_cmp(const dropped_replica &d1, const dropped_replica &d2)
 struct serving_replica
 {
     dsn::host_port node;
-    // TODO: report the storage size of replica
     int64_t storage_mb;
     std::string disk_tag;
     manual_compaction_status::type compact_status;
+    // The request rates of the replica, all of which are 0 if not reported.
+    int64_t read_cu_per_sec;
+    int64_t write_cu_per_sec;
+    int64_t qps;
 };
 
 class config_context
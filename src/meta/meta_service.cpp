@@ -51,6 +51,7 @@
 #include "meta/meta_server_failure_detector.h"
 #include "meta/meta_state_service.h"
 #include "meta/meta_state_service_utils.h"
+#include "meta/meta_state_write_batcher.h"
 #include "meta/partition_guardian.h"
 #include "meta_bulk_load_service.h"
 #include "meta_service.h"
@@ -230,6 +231,7 @@ error_code meta_service::remote_storage_initialize()
     }
     _storage.reset(storage);
     _meta_storage.reset(new mss::meta_storage(_storage.get(), &_tracker));
+    _remote_storage_batcher.reset(new meta_state_write_batcher(_storage.get(), &_tracker));
 
     std::vector<std::string> slices;
     utils::split_args(FLAGS_cluster_root, slices, '/');
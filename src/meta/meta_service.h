@@ -81,6 +81,7 @@ class backup_service;
 class bulk_load_service;
 class meta_duplication_service;
 class meta_split_service;
+class meta_state_write_batcher;
 class partition_guardian;
 class server_load_balancer;
 class server_state;
@@ -142,6 +143,10 @@ public:
     /// NOTE: prefer using mss::meta_storage instead.
     dist::meta_state_service *get_remote_storage() const { return _storage.get(); }
     mss::meta_storage *get_meta_storage() const { return _meta_storage.get(); }
+    meta_state_write_batcher *get_remote_storage_batcher() const
+    {
+        return _remote_storage_batcher.get();
+    }
 
     server_state *get_server_state() { return _state.get(); }
     security::access_controller *get_access_controller() { return _access_controller.get(); }
@@ -357,6 +362,7 @@ private:
 
     std::shared_ptr<dist::meta_state_service> _storage;
     std::unique_ptr<mss::meta_storage> _meta_storage;
+    std::unique_ptr<meta_state_write_batcher> _remote_storage_batcher;
 
     std::shared_ptr<server_load_balancer> _balancer;
     std::shared_ptr<backup_service> _backup_handler;
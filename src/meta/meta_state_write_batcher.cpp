@@ -0,0 +1,155 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "meta_state_write_batcher.h"
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include "common/replication.codes.h"
+#include "meta/meta_state_service.h"
+#include "utils/flags.h"
+#include "utils/fmt_logging.h"
+
+DSN_DEFINE_uint32(meta_server,
+                  meta_state_batch_max_ops,
+                  128,
+                  "The max number of operations coalesced into a transaction by the group-commit "
+                  "of the updates of partition configurations on remote storage, 1 means no "
+                  "group-commit");
+DSN_DEFINE_validator(meta_state_batch_max_ops, [](uint32_t value) -> bool { return value > 0; });
+DSN_TAG_VARIABLE(meta_state_batch_max_ops, FT_MUTABLE);
+
+DSN_DEFINE_uint64(meta_server,
+                  meta_state_batch_max_bytes,
+                  512 * 1024,
+                  "The max bytes of the operations coalesced into a transaction by the "
+                  "group-commit of the updates of partition configurations on remote storage, "
+                  "which should be less than the max request size of remote storage (i.e. "
+                  "jute.maxbuffer of zookeeper)");
+DSN_TAG_VARIABLE(meta_state_batch_max_bytes, FT_MUTABLE);
+
+namespace dsn {
+namespace replication {
+
+meta_state_write_batcher::meta_state_write_batcher(dist::meta_state_service *remote_storage,
+                                                   task_tracker *tracker)
+    : _remote(remote_storage), _tracker(tracker), _in_flight(false)
+{
+    CHECK_NOTNULL(tracker, "must set task tracker");
+}
+
+meta_state_write_batcher::~meta_state_write_batcher() = default;
+
+task_ptr meta_state_write_batcher::set_data(const std::string &node,
+                                            const blob &value,
+                                            task_code cb_code,
+                                            const err_callback &cb_set_data,
+                                            task_tracker *tracker)
+{
+    error_code_future_ptr callback(new error_code_future(cb_code, cb_set_data, 0));
+    callback->set_tracker(tracker);
+
+    zauto_lock l(_lock);
+    _pending.emplace_back(write_op{node, value, callback});
+    submit_batch_unlocked();
+    return callback;
+}
+
+void meta_state_write_batcher::submit_batch_unlocked()
+{
+    if (_in_flight || _pending.empty()) {
+        return;
+    }
+
+    std::vector<write_op> batch;
+    size_t batch_bytes = 0;
+    while (!_pending.empty() && batch.size() < FLAGS_meta_state_batch_max_ops) {
+        const write_op &op = _pending.front();
+        const size_t op_bytes = op.node.size() + op.value.length();
+        if (!batch.empty() && batch_bytes + op_bytes > FLAGS_meta_state_batch_max_bytes) {
+            break;
+        }
+        batch_bytes += op_bytes;
+        batch.emplace_back(std::move(_pending.front()));
+        _pending.pop_front();
+    }
+    _in_flight = true;
+
+    if (batch.size() == 1) {
+        submit_one_by_one(std::move(batch));
+        return;
+    }
+
+    auto entries = _remote->new_transaction_entries(static_cast<unsigned int>(batch.size()));
+    for (const auto &op : batch) {
+        CHECK_EQ(ERR_OK, entries->set_data(op.node, op.value));
+    }
+    LOG_DEBUG("submit a batch of {} operations with {} bytes", batch.size(), batch_bytes);
+    _remote->submit_transaction(
+        entries,
+        LPC_META_STATE_HIGH,
+        [this, batch = std::move(batch)](error_code ec) mutable {
+            on_batch_committed(ec, std::move(batch));
+        },
+        _tracker);
+}
+
+void meta_state_write_batcher::on_batch_committed(error_code ec, std::vector<write_op> &&batch)
+{
+    if (ec != ERR_OK && ec != ERR_TIMEOUT) {
+        LOG_WARNING("submit a batch of {} operations failed, err = {}, resubmit them one by one",
+                    batch.size(),
+                    ec);
+        submit_one_by_one(std::move(batch));
+        return;
+    }
+
+    for (const auto &op : batch) {
+        op.callback->enqueue_with(ec);
+    }
+    on_batch_finished();
+}
+
+void meta_state_write_batcher::submit_one_by_one(std::vector<write_op> &&batch)
+{
+    auto remaining = std::make_shared<std::atomic<size_t>>(batch.size());
+    for (const auto &op : batch) {
+        _remote->set_data(
+            op.node,
+            op.value,
+            LPC_META_STATE_HIGH,
+            [this, callback = op.callback, remaining](error_code ec) {
+                callback->enqueue_with(ec);
+                if (--(*remaining) == 0) {
+                    on_batch_finished();
+                }
+            },
+            _tracker);
+    }
+}
+
+void meta_state_write_batcher::on_batch_finished()
+{
+    zauto_lock l(_lock);
+    _in_flight = false;
+    submit_batch_unlocked();
+}
+
+} // namespace replication
+} // namespace dsn
@@ -0,0 +1,93 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <stddef.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "task/future_types.h"
+#include "task/task.h"
+#include "task/task_code.h"
+#include "utils/blob.h"
+#include "utils/error_code.h"
+#include "utils/ports.h"
+#include "utils/zlocks.h"
+
+namespace dsn {
+class task_tracker;
+
+namespace dist {
+class meta_state_service;
+} // namespace dist
+
+namespace replication {
+
+/// This class group-commits the set_data operations over meta_state_service.
+/// The operations submitted while a transaction is in flight are coalesced into the next
+/// multi-op transaction, which is bounded by FLAGS_meta_state_batch_max_ops and
+/// FLAGS_meta_state_batch_max_bytes. Therefore an operation waits for at most one transaction
+/// before it's submitted.
+/// Since there is at most one transaction in flight, the operations are applied in the order
+/// they are submitted, thus the updates of the same node keep their order.
+/// Notice: This class is thread-safe.
+///
+/// ERROR HANDLING:
+/// The result of a transaction is passed to the callbacks of all of its operations. If it fails
+/// with an error other than ERR_TIMEOUT, which may be caused by any one of the operations, the
+/// operations are resubmitted one by one to get their own results.
+class meta_state_write_batcher
+{
+public:
+    meta_state_write_batcher(dist::meta_state_service *remote_storage, task_tracker *tracker);
+
+    ~meta_state_write_batcher();
+
+    /// The same as meta_state_service::set_data, the returned task could be cancelled.
+    task_ptr set_data(const std::string &node,
+                      const blob &value,
+                      task_code cb_code,
+                      const err_callback &cb_set_data,
+                      task_tracker *tracker = nullptr);
+
+private:
+    struct write_op
+    {
+        std::string node;
+        blob value;
+        error_code_future_ptr callback;
+    };
+
+    void submit_batch_unlocked();
+    void on_batch_committed(error_code ec, std::vector<write_op> &&batch);
+    void submit_one_by_one(std::vector<write_op> &&batch);
+    void on_batch_finished();
+
+    dist::meta_state_service *_remote;
+    task_tracker *_tracker;
+
+    zlock _lock;
+    std::deque<write_op> _pending;
+    bool _in_flight;
+
+    DISALLOW_COPY_AND_ASSIGN(meta_state_write_batcher);
+};
+
+} // namespace replication
+} // namespace dsn
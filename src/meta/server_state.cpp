@@ -54,9 +54,11 @@
 #include "dsn.layer2_types.h"
 #include "dump_file.h"
 #include "meta/app_env_validator.h"
+#include "meta/cu_quota_allocator.h"
 #include "meta/meta_data.h"
 #include "meta/meta_service.h"
 #include "meta/meta_state_service.h"
+#include "meta/meta_state_write_batcher.h"
 #include "meta/partition_guardian.h"
 #include "meta/table_metrics.h"
 #include "meta_admin_types.h"
@@ -858,6 +860,8 @@ void server_state::on_config_sync(configuration_query_by_node_rpc rpc)
             response.err = ERR_OK;
             unsigned int i = 0;
             response.partitions.resize(ns->partition_count());
+            // app_id -> the CU budgets distributed from the quotas of the app
+            std::map<int32_t, std::vector<std::map<host_port, replica_cu_budget>>> cu_budgets;
             ns->for_each_partition([&, this](const gpid &pid) {
                 std::shared_ptr<app_state> app = get_app(pid.get_app_id());
                 CHECK(app, "invalid app_id, app_id = {}", pid.get_app_id());
@@ -893,6 +897,26 @@ void server_state::on_config_sync(configuration_query_by_node_rpc rpc)
                         response.partitions[i].__set_meta_split_status(iter->second);
                     }
                 }
+                // set the CU budgets of the replica
+                auto budgets_iter = cu_budgets.find(app->app_id);
+                if (budgets_iter == cu_budgets.end()) {
+                    budgets_iter =
+                        cu_budgets.emplace(app->app_id, allocate_app_cu_budgets(*app)).first;
+                }
+                if (!budgets_iter->second.empty()) {
+                    const auto &budgets = budgets_iter->second[pid.get_partition_index()];
+                    const auto budget = budgets.find(node);
+                    if (budget != budgets.end()) {
+                        if (budget->second.read_cu_per_sec > 0) {
+                            response.partitions[i].__set_read_cu_budget(
+                                budget->second.read_cu_per_sec);
+                        }
+                        if (budget->second.write_cu_per_sec > 0) {
+                            response.partitions[i].__set_write_cu_budget(
+                                budget->second.write_cu_per_sec);
+                        }
+                    }
+                }
                 ++i;
                 return true;
             });
@@ -1941,7 +1965,8 @@ task_ptr server_state::update_configuration_on_remote(
     std::string storage_path = get_partition_path(pc.pid);
 
     blob json_config = dsn::json::json_forwarder<partition_configuration>::encode(pc);
-    return _meta_svc->get_remote_storage()->set_data(
+    // The updates of many partitions, e.g. once a node is dead, are group-committed.
+    return _meta_svc->get_remote_storage_batcher()->set_data(
         storage_path,
         json_config,
         LPC_META_STATE_HIGH,
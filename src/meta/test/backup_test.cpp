@@ -30,7 +30,10 @@
 #include <vector>
 
 #include "backup_types.h"
+#include "block_service/block_service.h"
+#include "common/backup_common.h"
 #include "common/gpid.h"
+#include "common/json_helper.h"
 #include "common/replication.codes.h"
 #include "dsn.layer2_types.h"
 #include "gtest/gtest.h"
@@ -52,6 +55,7 @@
 #include "task/task.h"
 #include "task/task_code.h"
 #include "utils/autoref_ptr.h"
+#include "utils/blob.h"
 #include "utils/chrono_literals.h"
 #include "utils/error_code.h"
 #include "utils/fail_point.h"
@@ -633,6 +637,108 @@ TEST_F(policy_context_test, test_backup_failed)
     fail::teardown();
 }
 
+TEST_F(policy_context_test, test_gc_shared_files)
+{
+    auto *fs = _mp._block_service;
+    ASSERT_NE(nullptr, fs);
+    const std::string root = _service->_backup_handler->backup_root();
+    const gpid pid(1, 0);
+    const std::string shared_files_dir =
+        cold_backup::get_shared_files_dir(test_policy_name, "app1", pid);
+
+    auto write_file = [fs](const std::string &file_name, const std::string &content) {
+        dist::block_service::create_file_response create_resp;
+        fs->create_file(
+              dist::block_service::create_file_request{file_name, true},
+              TASK_CODE_EXEC_INLINED,
+              [&create_resp](const dist::block_service::create_file_response &r) {
+                  create_resp = r;
+              },
+              nullptr)
+            ->wait();
+        ASSERT_EQ(ERR_OK, create_resp.err);
+        dist::block_service::write_response write_resp;
+        create_resp.file_handle
+            ->write(
+                dist::block_service::write_request{blob::create_from_bytes(std::string(content))},
+                TASK_CODE_EXEC_INLINED,
+                [&write_resp](const dist::block_service::write_response &r) { write_resp = r; },
+                nullptr)
+            ->wait();
+        ASSERT_EQ(ERR_OK, write_resp.err);
+    };
+    auto make_file_meta = [](const std::string &name) {
+        file_meta f_meta;
+        f_meta.name = name;
+        f_meta.size = 1;
+        f_meta.md5 = name + "_md5";
+        return f_meta;
+    };
+    auto write_backup = [&](int64_t backup_id, const std::vector<std::string> &files) {
+        cold_backup_metadata metadata;
+        metadata.shared_files_dir = shared_files_dir;
+        for (const auto &file : files) {
+            metadata.files.emplace_back(make_file_meta(file));
+        }
+        const std::string replica_path =
+            cold_backup::get_replica_backup_path(root, "app1", pid, backup_id);
+        write_file(replica_path + "/" + cold_backup_constant::CURRENT_CHECKPOINT, "chkpt");
+        const blob value = json::json_forwarder<cold_backup_metadata>::encode(metadata);
+        write_file(replica_path + "/chkpt/" + cold_backup_constant::BACKUP_METADATA,
+                   value.to_string());
+    };
+
+    // Backup 1 and 2 share 2.sst, and 4.sst isn't referenced by any backup.
+    write_backup(1, {"1.sst", "2.sst", "CURRENT"});
+    write_backup(2, {"2.sst", "3.sst", "CURRENT"});
+    for (const auto &file : {"1.sst", "2.sst", "3.sst", "4.sst"}) {
+        const auto f_meta = make_file_meta(file);
+        write_file(cold_backup::get_shared_file_dir(root, shared_files_dir, f_meta) + "/" + file,
+                   "v");
+    }
+
+    auto list_shared_files = [&]() {
+        dist::block_service::ls_response resp;
+        fs->list_dir(
+              dist::block_service::ls_request{root + "/" + shared_files_dir},
+              TASK_CODE_EXEC_INLINED,
+              [&resp](const dist::block_service::ls_response &r) { resp = r; },
+              nullptr)
+            ->wait();
+        EXPECT_EQ(ERR_OK, resp.err);
+        std::set<std::string> keys;
+        for (const auto &entry : *resp.entries) {
+            keys.emplace(entry.entry_name);
+        }
+        return keys;
+    };
+
+    // Only the unreferenced file is removed while both backups are retained.
+    _mp.gc_shared_files(test_policy_name, {1, 2});
+    ASSERT_EQ(std::set<std::string>({cold_backup::get_shared_file_key(make_file_meta("1.sst")),
+                                     cold_backup::get_shared_file_key(make_file_meta("2.sst")),
+                                     cold_backup::get_shared_file_key(make_file_meta("3.sst"))}),
+              list_shared_files());
+
+    // The files only referenced by backup 1 are removed once it's gc.
+    _mp.gc_shared_files(test_policy_name, {2});
+    ASSERT_EQ(std::set<std::string>({cold_backup::get_shared_file_key(make_file_meta("2.sst")),
+                                     cold_backup::get_shared_file_key(make_file_meta("3.sst"))}),
+              list_shared_files());
+
+    // Nothing is removed if the backup_metadata of a retained backup can't be read.
+    write_file(
+        cold_backup::get_replica_backup_path(root, "app1", pid, 2) + "/" +
+            cold_backup_constant::CURRENT_CHECKPOINT,
+        "missing_chkpt");
+    _mp.gc_shared_files(test_policy_name, {2});
+    ASSERT_EQ(2, list_shared_files().size());
+
+    // All the files are removed once no backup is retained.
+    _mp.gc_shared_files(test_policy_name, {});
+    ASSERT_TRUE(list_shared_files().empty());
+}
+
 // test should_start_backup_unlock()
 TEST_F(policy_context_test, test_should_start_backup)
 {
@@ -0,0 +1,153 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include "common/replica_envs.h"
+#include "dsn.layer2_types.h"
+#include "gtest/gtest.h"
+#include "meta/cu_quota_allocator.h"
+#include "meta/meta_data.h"
+#include "rpc/rpc_host_port.h"
+
+namespace dsn {
+namespace replication {
+
+TEST(cu_quota_allocator_test, allocate_by_demands)
+{
+    struct test_case
+    {
+        int64_t quota;
+        std::vector<int64_t> demands;
+        double headroom_ratio;
+        std::vector<int64_t> expected_budgets;
+    } tests[] = {
+        // No unit.
+        {100, {}, 0.2, {}},
+        // The quota is shared evenly by the idle units.
+        {90, {0, 0, 0}, 0.2, {30, 30, 30}},
+        // The light units get what they want, and the hot unit gets the rest.
+        {100, {10, 10, 200}, 0, {10, 10, 80}},
+        // The headroom is granted to the units.
+        {100, {10, 10, 200}, 0.5, {15, 15, 70}},
+        // The quota left after all of the wants are satisfied is shared evenly.
+        {100, {10, 20, 30}, 0, {24, 33, 43}},
+        // The hot units share the quota evenly.
+        {100, {100, 200, 300}, 0, {33, 33, 34}},
+        // Every unit gets at least 1.
+        {2, {10, 10, 10}, 0, {1, 1, 1}},
+    };
+
+    for (const auto &test : tests) {
+        const auto budgets = allocate_cu_quota(test.quota, test.demands, test.headroom_ratio);
+        ASSERT_EQ(test.expected_budgets, budgets);
+    }
+}
+
+TEST(cu_quota_allocator_test, allocate_within_quota)
+{
+    const std::vector<int64_t> demands = {0, 5, 1000, 37, 2, 600, 99, 1};
+    for (const int64_t quota : {8, 100, 1000, 12345}) {
+        const auto budgets = allocate_cu_quota(quota, demands, 0.2);
+        ASSERT_EQ(demands.size(), budgets.size());
+        ASSERT_EQ(quota, std::accumulate(budgets.begin(), budgets.end(), int64_t(0)));
+    }
+}
+
+TEST(cu_quota_allocator_test, replica_read_cu_budget)
+{
+    struct test_case
+    {
+        int64_t budget;
+        size_t replica_count;
+        bool is_primary;
+        int64_t expected_budget;
+    } tests[] = {
+        // Unlimited.
+        {0, 3, true, 0},
+        {0, 3, false, 0},
+        // The primary is given the whole budget, while a secondary is given an even share.
+        {100, 3, true, 100},
+        {100, 3, false, 33},
+        {100, 1, true, 100},
+        // Every secondary gets at least 1.
+        {2, 3, false, 1},
+    };
+
+    for (const auto &test : tests) {
+        ASSERT_EQ(test.expected_budget,
+                  replica_read_cu_budget(test.budget, test.replica_count, test.is_primary));
+    }
+}
+
+TEST(cu_quota_allocator_test, allocate_app_cu_budgets)
+{
+    const host_port primary("localhost", 1);
+    const host_port secondary1("localhost", 2);
+    const host_port secondary2("localhost", 3);
+
+    app_info info;
+    info.app_id = 1;
+    info.partition_count = 1;
+    std::shared_ptr<app_state> app = app_state::create(info);
+    ASSERT_TRUE(allocate_app_cu_budgets(*app).empty());
+
+    app->envs[replica_envs::READ_CU_QUOTA] = "100";
+    app->envs[replica_envs::WRITE_CU_QUOTA] = "50";
+    SET_IP_AND_HOST_PORT_BY_DNS(app->pcs[0], primary, primary);
+    SET_IPS_AND_HOST_PORTS_BY_DNS(app->pcs[0], secondaries, secondary1, secondary2);
+    for (const auto &[node, read_cu_per_sec] :
+         std::map<host_port, int64_t>{{primary, 30}, {secondary1, 10}, {secondary2, 0}}) {
+        serving_replica sr{};
+        sr.node = node;
+        sr.read_cu_per_sec = read_cu_per_sec;
+        sr.write_cu_per_sec = 20;
+        app->helpers->contexts[0].serving.push_back(sr);
+    }
+
+    // The primary is given the whole read budget and each secondary an even share of it
+    // regardless of their read rates, while the write budget is given to the primary only.
+    auto budgets = allocate_app_cu_budgets(*app);
+    ASSERT_EQ(1, budgets.size());
+    ASSERT_EQ(3, budgets[0].size());
+    ASSERT_EQ(100, budgets[0].at(primary).read_cu_per_sec);
+    ASSERT_EQ(50, budgets[0].at(primary).write_cu_per_sec);
+    ASSERT_EQ(33, budgets[0].at(secondary1).read_cu_per_sec);
+    ASSERT_EQ(0, budgets[0].at(secondary1).write_cu_per_sec);
+    ASSERT_EQ(33, budgets[0].at(secondary2).read_cu_per_sec);
+    ASSERT_EQ(0, budgets[0].at(secondary2).write_cu_per_sec);
+
+    // The secondary which has served no read is promoted to primary after failover: it could
+    // serve its share before the config sync, and is given the whole read budget after it,
+    // even though it has not reported any read yet.
+    SET_IP_AND_HOST_PORT_BY_DNS(app->pcs[0], primary, secondary2);
+    SET_IPS_AND_HOST_PORTS_BY_DNS(app->pcs[0], secondaries, secondary1);
+    budgets = allocate_app_cu_budgets(*app);
+    ASSERT_EQ(1, budgets.size());
+    ASSERT_EQ(2, budgets[0].size());
+    ASSERT_EQ(100, budgets[0].at(secondary2).read_cu_per_sec);
+    ASSERT_EQ(50, budgets[0].at(secondary2).write_cu_per_sec);
+    ASSERT_EQ(50, budgets[0].at(secondary1).read_cu_per_sec);
+    ASSERT_EQ(0, budgets[0].at(secondary1).write_cu_per_sec);
+}
+
+} // namespace replication
+} // namespace dsn
@@ -0,0 +1,275 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <nlohmann/json.hpp>
+#include <nlohmann/json_fwd.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/gpid.h"
+#include "dsn.layer2_types.h"
+#include "gtest/gtest.h"
+#include "meta/load_aware_balance_policy.h"
+#include "meta/load_balance_policy.h"
+#include "meta/meta_data.h"
+#include "meta/meta_service.h"
+#include "meta/test/misc/misc.h"
+#include "meta_admin_types.h"
+#include "metadata_types.h"
+#include "rpc/rpc_host_port.h"
+#include "test_util/test_util.h"
+#include "utils/flags.h"
+
+DSN_DECLARE_bool(balance_load_aware);
+DSN_DECLARE_bool(balance_load_aware_dry_run);
+DSN_DECLARE_uint32(balance_op_count_per_round);
+DSN_DECLARE_uint64(load_balance_max_migration_mb_per_round);
+DSN_DECLARE_double(load_balance_tolerance_ratio);
+
+namespace dsn {
+namespace replication {
+
+namespace {
+
+const int kNodeCount = 5;
+const int kPartitionCount = 32;
+const int64_t kReplicaStorageMB = 1024;
+
+// The qps of the partitions follows the Zipf distribution.
+int64_t partition_qps(int partition_index) { return 100000 / (partition_index + 1); }
+
+// The replicas are placed round-robin, thus every node serves nearly the same count of replicas
+// and the hot partitions crowd on the first nodes.
+std::shared_ptr<app_state> create_skewed_app(const std::vector<host_port> &nodes)
+{
+    app_info info;
+    info.app_id = 1;
+    info.app_name = "skewed";
+    info.app_type = "pegasus";
+    info.status = app_status::AS_AVAILABLE;
+    info.partition_count = kPartitionCount;
+    info.max_replica_count = 3;
+    auto app = app_state::create(info);
+    for (int i = 0; i < kPartitionCount; ++i) {
+        auto &pc = app->pcs[i];
+        SET_IP_AND_HOST_PORT_BY_DNS(pc, primary, nodes[i % kNodeCount]);
+        ADD_IP_AND_HOST_PORT_BY_DNS(pc, secondaries, nodes[(i + 1) % kNodeCount]);
+        ADD_IP_AND_HOST_PORT_BY_DNS(pc, secondaries, nodes[(i + 2) % kNodeCount]);
+    }
+    return app;
+}
+
+// Report the load of every replica as replica servers do: only the primary serves the client
+// requests, while all of the replicas apply the writes.
+void report_loads(const std::shared_ptr<app_state> &app)
+{
+    for (int i = 0; i < kPartitionCount; ++i) {
+        auto &cc = app->helpers->contexts[i];
+        const auto &pc = app->pcs[i];
+        const auto qps = partition_qps(i);
+
+        replica_info info;
+        info.disk_tag = "disk1";
+        info.__set_storage_mb(kReplicaStorageMB);
+        info.__set_write_cu_per_sec(qps / 5);
+        info.__set_read_cu_per_sec(qps);
+        info.__set_qps(qps);
+        cc.collect_serving_replica(pc.hp_primary, info);
+
+        info.__set_read_cu_per_sec(0);
+        info.__set_qps(0);
+        for (const auto &secondary : pc.hp_secondaries) {
+            cc.collect_serving_replica(secondary, info);
+        }
+    }
+}
+
+// The ratio of the max load of the nodes to the average, with all of the weights being 1.
+double load_imbalance(const std::shared_ptr<app_state> &app)
+{
+    std::map<host_port, int64_t> cu, qps, storage_mb;
+    int64_t total_cu = 0, total_qps = 0, total_storage_mb = 0;
+    for (int i = 0; i < kPartitionCount; ++i) {
+        const auto &cc = app->helpers->contexts[i];
+        const auto &pc = app->pcs[i];
+        std::vector<host_port> members(pc.hp_secondaries);
+        members.push_back(pc.hp_primary);
+        for (const auto &node : members) {
+            const auto iter = cc.find_from_serving(node);
+            cu[node] += iter->read_cu_per_sec + iter->write_cu_per_sec;
+            qps[node] += iter->qps;
+            storage_mb[node] += iter->storage_mb;
+            total_cu += iter->read_cu_per_sec + iter->write_cu_per_sec;
+            total_qps += iter->qps;
+            total_storage_mb += iter->storage_mb;
+        }
+    }
+
+    double max_load = 0;
+    for (const auto &[node, _] : cu) {
+        const double load = static_cast<double>(cu[node]) / total_cu +
+                            static_cast<double>(qps[node]) / total_qps +
+                            static_cast<double>(storage_mb[node]) / total_storage_mb;
+        max_load = std::max(max_load, load);
+    }
+    return max_load / (3.0 / kNodeCount);
+}
+
+// Run the balancer round by round until it has nothing to do, applying the migrations and
+// reporting the new loads after each round.
+void simulate(std::vector<migration_list> &rounds, double &initial_imbalance, double &imbalance)
+{
+    const auto node_list = generate_node_list(kNodeCount);
+    auto app = create_skewed_app(node_list);
+    app_mapper apps;
+    apps[app->app_id] = app;
+    node_mapper nodes;
+    generate_node_mapper(nodes, apps, node_list);
+    report_loads(app);
+    initial_imbalance = load_imbalance(app);
+
+    meta_service svc;
+    load_aware_balance_policy policy(&svc);
+    meta_view view = {&apps, &nodes};
+    for (int round = 0; round < 10; ++round) {
+        migration_list ml;
+        policy.balance(false, &view, &ml);
+        if (ml.empty()) {
+            break;
+        }
+        migration_check_and_apply(apps, nodes, ml, nullptr);
+        report_loads(app);
+        rounds.emplace_back(std::move(ml));
+    }
+    imbalance = load_imbalance(app);
+}
+
+} // anonymous namespace
+
+TEST(load_aware_balance_policy, balance_skewed_load)
+{
+    PRESERVE_FLAG(load_balance_max_migration_mb_per_round);
+    FLAGS_load_balance_max_migration_mb_per_round = 10 * kReplicaStorageMB;
+
+    std::vector<migration_list> rounds;
+    double initial_imbalance = 0;
+    double imbalance = 0;
+    simulate(rounds, initial_imbalance, imbalance);
+
+    ASSERT_GT(initial_imbalance, 1.3);
+    ASSERT_FALSE(rounds.empty());
+    for (const auto &ml : rounds) {
+        ASSERT_LE(ml.size(), FLAGS_balance_op_count_per_round);
+        uint64_t copied_mb = 0;
+        for (const auto &[_, request] : ml) {
+            if (request->balance_type != balancer_request_type::move_primary) {
+                copied_mb += kReplicaStorageMB;
+            }
+        }
+        ASSERT_LE(copied_mb, FLAGS_load_balance_max_migration_mb_per_round);
+    }
+    ASSERT_LE(imbalance, 1 + FLAGS_load_balance_tolerance_ratio);
+}
+
+TEST(load_aware_balance_policy, only_move_primary_without_migration_budget)
+{
+    PRESERVE_FLAG(load_balance_max_migration_mb_per_round);
+    FLAGS_load_balance_max_migration_mb_per_round = 0;
+
+    std::vector<migration_list> rounds;
+    double initial_imbalance = 0;
+    double imbalance = 0;
+    simulate(rounds, initial_imbalance, imbalance);
+
+    ASSERT_FALSE(rounds.empty());
+    for (const auto &ml : rounds) {
+        for (const auto &[_, request] : ml) {
+            ASSERT_EQ(balancer_request_type::move_primary, request->balance_type);
+        }
+    }
+    ASSERT_LT(imbalance, initial_imbalance);
+}
+
+TEST(load_aware_balance_policy, skip_unreported_partitions)
+{
+    const auto node_list = generate_node_list(kNodeCount);
+    auto app = create_skewed_app(node_list);
+    app_mapper apps;
+    apps[app->app_id] = app;
+    node_mapper nodes;
+    generate_node_mapper(nodes, apps, node_list);
+    report_loads(app);
+
+    // The load of a secondary of the hottest partition has not been reported.
+    const auto &skipped_pc = app->pcs[0];
+    ASSERT_TRUE(app->helpers->contexts[0].remove_from_serving(skipped_pc.hp_secondaries[0]));
+
+    meta_service svc;
+    load_aware_balance_policy policy(&svc);
+    meta_view view = {&apps, &nodes};
+    migration_list ml;
+    policy.balance(false, &view, &ml);
+
+    // The other partitions are still balanced, while the skipped one is left untouched and its
+    // nodes are never chosen as the targets.
+    ASSERT_FALSE(ml.empty());
+    ASSERT_EQ(0, ml.count(skipped_pc.pid));
+    const auto last_round = nlohmann::json::parse(policy.remote_command_load_aware({}));
+    ASSERT_EQ(1, last_round["last_round"]["skipped_partition_count"]);
+    ASSERT_EQ(ml.size(), last_round["last_round"]["migrations"].size());
+    for (const auto &migration : last_round["last_round"]["migrations"]) {
+        const auto target = migration["target"].get<std::string>();
+        ASSERT_NE(skipped_pc.hp_primary.to_string(), target);
+        for (const auto &secondary : skipped_pc.hp_secondaries) {
+            ASSERT_NE(secondary.to_string(), target);
+        }
+    }
+}
+
+TEST(load_aware_balance_policy, remote_command)
+{
+    PRESERVE_FLAG(balance_load_aware);
+    PRESERVE_FLAG(balance_load_aware_dry_run);
+    FLAGS_balance_load_aware = false;
+    FLAGS_balance_load_aware_dry_run = false;
+
+    meta_service svc;
+    load_aware_balance_policy policy(&svc);
+
+    auto info = nlohmann::json::parse(policy.remote_command_load_aware({"status"}));
+    ASSERT_FALSE(info["enabled"].get<bool>());
+    ASSERT_FALSE(info["dry_run"].get<bool>());
+    ASSERT_TRUE(info["last_round"].empty());
+
+    policy.remote_command_load_aware({"enable"});
+    ASSERT_TRUE(FLAGS_balance_load_aware);
+    policy.remote_command_load_aware({"dry_run", "true"});
+    ASSERT_TRUE(FLAGS_balance_load_aware_dry_run);
+    policy.remote_command_load_aware({"disable"});
+    ASSERT_FALSE(FLAGS_balance_load_aware);
+
+    info = nlohmann::json::parse(policy.remote_command_load_aware({"dry_run", "invalid"}));
+    ASSERT_TRUE(info.contains("error"));
+    ASSERT_TRUE(FLAGS_balance_load_aware_dry_run);
+}
+
+} // namespace replication
+} // namespace dsn
@@ -63,6 +63,9 @@ TEST(meta, state_sync) { g_app->state_sync_test(); }
 
 TEST(meta, update_configuration) { g_app->update_configuration_test(); }
 
+// The benchmark is disabled by default, run it by --gtest_also_run_disabled_tests.
+TEST(meta, DISABLED_node_failure_recovery_benchmark) { g_app->node_failure_recovery_benchmark(); }
+
 TEST(meta, balancer_validator)
 {
     // TODO(yingchun): this test last too long time, optimize it!
@@ -120,6 +120,13 @@ TEST_F(meta_app_envs_test, update_app_envs_test)
          "20M*delay*100"},
         {replica_envs::WRITE_QPS_THROTTLING, "20M*reject*100", ERR_OK, "", "20M*reject*100"},
         {replica_envs::WRITE_SIZE_THROTTLING, "300*delay*100", ERR_OK, "", "300*delay*100"},
+        {replica_envs::READ_CU_QUOTA,
+         "0",
+         ERR_INVALID_PARAMETERS,
+         "invalid value '0', should be '> 0'",
+         ""},
+        {replica_envs::READ_CU_QUOTA, "20000", ERR_OK, "", "20000"},
+        {replica_envs::WRITE_CU_QUOTA, "10000", ERR_OK, "", "10000"},
         {replica_envs::SLOW_QUERY_THRESHOLD, "30", ERR_OK, "", "30"},
         {replica_envs::SLOW_QUERY_THRESHOLD, "20", ERR_OK, "", "20"},
         {replica_envs::SLOW_QUERY_THRESHOLD,
@@ -153,6 +160,47 @@ TEST_F(meta_app_envs_test, update_app_envs_test)
          "invalid value '636870912', should be 'In range [16777216, 536870912]'",
          "536870912"},
         {replica_envs::ROCKSDB_WRITE_BUFFER_SIZE, "67108864", ERR_OK, "", "67108864"},
+        {replica_envs::ROCKSDB_ENABLE_BLOB_FILES,
+         "yes",
+         ERR_INVALID_PARAMETERS,
+         "invalid value 'yes', should be a boolean",
+         ""},
+        {replica_envs::ROCKSDB_ENABLE_BLOB_FILES, "true", ERR_OK, "", "true"},
+        {replica_envs::ROCKSDB_MIN_BLOB_SIZE, "65536", ERR_OK, "", "65536"},
+        {replica_envs::ROCKSDB_BLOB_FILE_SIZE,
+         "1024",
+         ERR_INVALID_PARAMETERS,
+         "invalid value '1024', should be '>= 1048576'",
+         ""},
+        {replica_envs::ROCKSDB_BLOB_FILE_SIZE, "268435456", ERR_OK, "", "268435456"},
+        {replica_envs::ROCKSDB_BLOB_COMPRESSION_TYPE,
+         "gzip",
+         ERR_INVALID_PARAMETERS,
+         "lz4 | none | snappy | zstd",
+         ""},
+        {replica_envs::ROCKSDB_BLOB_COMPRESSION_TYPE, "zstd", ERR_OK, "", "zstd"},
+        {replica_envs::ROCKSDB_ENABLE_BLOB_GARBAGE_COLLECTION, "true", ERR_OK, "", "true"},
+        {replica_envs::ROCKSDB_BLOB_GARBAGE_COLLECTION_AGE_CUTOFF,
+         "1.5",
+         ERR_INVALID_PARAMETERS,
+         "In range [0.0, 1.0]",
+         ""},
+        {replica_envs::ROCKSDB_BLOB_GARBAGE_COLLECTION_AGE_CUTOFF, "0.5", ERR_OK, "", "0.5"},
+        {replica_envs::ROCKSDB_BLOB_GARBAGE_COLLECTION_FORCE_THRESHOLD, "0.8", ERR_OK, "", "0.8"},
+        {replica_envs::ROCKSDB_FILTER_POLICY,
+         "cuckoo",
+         ERR_INVALID_PARAMETERS,
+         "bloom | none | ribbon",
+         ""},
+        {replica_envs::ROCKSDB_FILTER_POLICY, "ribbon", ERR_OK, "", "ribbon"},
+        {replica_envs::ROCKSDB_FILTER_BITS_PER_KEY,
+         "0.5",
+         ERR_INVALID_PARAMETERS,
+         "In range [1.0, 100.0]",
+         ""},
+        {replica_envs::ROCKSDB_FILTER_BITS_PER_KEY, "6.667", ERR_OK, "", "6.667"},
+        {replica_envs::ROCKSDB_FILTER_TYPE, "hash", ERR_INVALID_PARAMETERS, "common | prefix", ""},
+        {replica_envs::ROCKSDB_FILTER_TYPE, "common", ERR_OK, "", "common"},
         {replica_envs::MANUAL_COMPACT_PERIODIC_BOTTOMMOST_LEVEL_COMPACTION,
          replica_envs::MANUAL_COMPACT_BOTTOMMOST_LEVEL_COMPACTION_SKIP,
          ERR_OK,
@@ -128,6 +128,7 @@ public:
     virtual dsn::error_code stop(bool /*cleanup*/) { return dsn::ERR_OK; }
     void state_sync_test();
     void update_configuration_test();
+    void node_failure_recovery_benchmark();
     void balancer_validator();
     void balance_config_file();
     void apply_balancer_test();
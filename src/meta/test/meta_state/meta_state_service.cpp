@@ -27,18 +27,28 @@
 #include "meta/meta_state_service.h"
 
 #include <boost/lexical_cast.hpp>
+#include <fmt/core.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <functional>
+#include <iostream>
 #include <ostream>
+#include <string>
 #include <thread>
 
 #include "gtest/gtest.h"
 #include "meta/meta_state_service_simple.h"
 #include "meta/meta_state_service_zookeeper.h"
+#include "meta/meta_state_write_batcher.h"
+#include "runtime/api_layer1.h"
 #include "runtime/service_app.h"
 #include "task/task_tracker.h"
 #include "test_util/test_util.h"
 #include "utils/binary_reader.h"
 #include "utils/binary_writer.h"
+#include "utils/blob.h"
 #include "utils/filesystem.h"
 #include "utils/flags.h"
 #include "utils/fmt_logging.h"
@@ -289,6 +299,151 @@ void provider_recursively_create_delete_test(const service_creator_func &creator
     deleter(service);
 }
 
+void create_nodes(meta_state_service *service, const std::string &root, int count)
+{
+    service->delete_node(root,
+                         true,
+                         META_STATE_SERVICE_SIMPLE_TEST_CALLBACK,
+                         [](error_code ec) { LOG_INFO("result: {}", ec); })
+        ->wait();
+    service->create_node(root, META_STATE_SERVICE_SIMPLE_TEST_CALLBACK, expect_ok)->wait();
+    for (int i = 0; i < count; i += 100) {
+        const int end = std::min(i + 100, count);
+        auto entries = service->new_transaction_entries(end - i);
+        for (int j = i; j != end; ++j) {
+            entries->create_node(root + "/" + std::to_string(j));
+        }
+        service->submit_transaction(entries, META_STATE_SERVICE_SIMPLE_TEST_CALLBACK, expect_ok)
+            ->wait();
+    }
+}
+
+void provider_batch_write_test(const service_creator_func &creator,
+                               const service_deleter_func &deleter)
+{
+    meta_state_service *service = creator();
+    dsn::task_tracker tracker;
+    replication::meta_state_write_batcher batcher(service, &tracker);
+    create_nodes(service, "/b", 10);
+
+    // The updates of the same node are applied in order.
+    std::atomic_int ok_count(0);
+    for (int round = 0; round != 3; ++round) {
+        for (int i = 0; i != 10; ++i) {
+            batcher.set_data(
+                "/b/" + std::to_string(i),
+                blob::create_from_bytes(std::to_string(round)),
+                META_STATE_SERVICE_SIMPLE_TEST_CALLBACK,
+                [&ok_count](error_code ec) {
+                    CHECK_EQ(ERR_OK, ec);
+                    ++ok_count;
+                },
+                &tracker);
+        }
+    }
+    tracker.wait_outstanding_tasks();
+    ASSERT_EQ(30, ok_count.load());
+    for (int i = 0; i != 10; ++i) {
+        service
+            ->get_data("/b/" + std::to_string(i),
+                       META_STATE_SERVICE_SIMPLE_TEST_CALLBACK,
+                       [](error_code ec, const blob &value) {
+                           CHECK_EQ(ERR_OK, ec);
+                           CHECK_EQ("2", value.to_string());
+                       })
+            ->wait();
+    }
+
+    // An invalid update doesn't fail the others coalesced with it.
+    std::atomic_int err_count(0);
+    ok_count = 0;
+    for (int i = 0; i != 10; ++i) {
+        const std::string node = i == 5 ? "/b/not_exist" : "/b/" + std::to_string(i);
+        batcher.set_data(
+            node,
+            blob::create_from_bytes("v"),
+            META_STATE_SERVICE_SIMPLE_TEST_CALLBACK,
+            [&ok_count, &err_count](error_code ec) {
+                if (ec == ERR_OK) {
+                    ++ok_count;
+                } else {
+                    ++err_count;
+                }
+            },
+            &tracker);
+    }
+    tracker.wait_outstanding_tasks();
+    ASSERT_EQ(9, ok_count.load());
+    ASSERT_EQ(1, err_count.load());
+
+    service->delete_node("/b", true, META_STATE_SERVICE_SIMPLE_TEST_CALLBACK, expect_ok)->wait();
+    deleter(service);
+}
+
+// Measure the time to persist the configurations of 10k partitions one by one and with
+// group-commit. See meta.DISABLED_node_failure_recovery_benchmark in dsn_meta_tests for the
+// recovery time of a dead node through the whole meta server.
+void provider_batch_write_benchmark(const std::string &provider,
+                                    const service_creator_func &creator,
+                                    const service_deleter_func &deleter)
+{
+    const int kPartitionCount = 10000;
+    meta_state_service *service = creator();
+    dsn::task_tracker tracker;
+    replication::meta_state_write_batcher batcher(service, &tracker);
+    create_nodes(service, "/bench", kPartitionCount);
+
+    // The size of a partition_configuration in json is about 400 bytes.
+    std::atomic_int ok_count(0);
+    auto on_set_data = [&ok_count](error_code ec) {
+        CHECK_EQ(ERR_OK, ec);
+        ++ok_count;
+    };
+    auto run = [&](const std::string &round,
+                   const std::function<void(const std::string &, const blob &)> &set_data) {
+        const blob value = blob::create_from_bytes(round + std::string(400, 'v'));
+        ok_count = 0;
+        const uint64_t start_ms = dsn_now_ms();
+        for (int i = 0; i != kPartitionCount; ++i) {
+            set_data("/bench/" + std::to_string(i), value);
+        }
+        tracker.wait_outstanding_tasks();
+        const uint64_t elapsed_ms = dsn_now_ms() - start_ms;
+
+        EXPECT_EQ(kPartitionCount, ok_count.load());
+        for (int i = 0; i != kPartitionCount; ++i) {
+            service
+                ->get_data("/bench/" + std::to_string(i),
+                           META_STATE_SERVICE_SIMPLE_TEST_CALLBACK,
+                           [&value](error_code ec, const blob &data) {
+                               CHECK_EQ(ERR_OK, ec);
+                               CHECK_EQ(value.to_string(), data.to_string());
+                           })
+                ->wait();
+        }
+        return elapsed_ms;
+    };
+    const uint64_t one_by_one_ms = run("1", [&](const std::string &node, const blob &value) {
+        service->set_data(
+            node, value, META_STATE_SERVICE_SIMPLE_TEST_CALLBACK, on_set_data, &tracker);
+    });
+    const uint64_t group_commit_ms = run("2", [&](const std::string &node, const blob &value) {
+        batcher.set_data(
+            node, value, META_STATE_SERVICE_SIMPLE_TEST_CALLBACK, on_set_data, &tracker);
+    });
+    std::cout << fmt::format("{}: update {} partitions in {}ms one by one, in {}ms with "
+                             "group-commit",
+                             provider,
+                             kPartitionCount,
+                             one_by_one_ms,
+                             group_commit_ms)
+              << std::endl;
+
+    service->delete_node("/bench", true, META_STATE_SERVICE_SIMPLE_TEST_CALLBACK, expect_ok)
+        ->wait();
+    deleter(service);
+}
+
 class meta_state_service_test : public pegasus::encrypt_data_test_base
 {
 };
@@ -307,6 +462,7 @@ TEST_P(meta_state_service_test, simple)
 
     provider_basic_test(simple_service_creator, simple_service_deleter);
     provider_recursively_create_delete_test(simple_service_creator, simple_service_deleter);
+    provider_batch_write_test(simple_service_creator, simple_service_deleter);
 
     std::string log_path = dsn::utils::filesystem::path_combine(
         service_app::current_service_app_info().data_dir, "meta_state_service.log");
@@ -327,4 +483,36 @@ TEST_P(meta_state_service_test, zookeeper)
 
     provider_basic_test(zookeeper_service_creator, zookeeper_service_deleter);
     provider_recursively_create_delete_test(zookeeper_service_creator, zookeeper_service_deleter);
+    provider_batch_write_test(zookeeper_service_creator, zookeeper_service_deleter);
+}
+
+// The benchmarks are disabled by default, run them by --gtest_also_run_disabled_tests.
+TEST_P(meta_state_service_test, DISABLED_simple_batch_write_benchmark)
+{
+    provider_batch_write_benchmark(
+        "simple",
+        [] {
+            meta_state_service_simple *svc = new meta_state_service_simple();
+            auto err = svc->initialize({});
+            CHECK_EQ(ERR_OK, err);
+            return svc;
+        },
+        [](meta_state_service *simple_svc) { delete simple_svc; });
+
+    std::string log_path = dsn::utils::filesystem::path_combine(
+        service_app::current_service_app_info().data_dir, "meta_state_service.log");
+    ASSERT_TRUE(dsn::utils::filesystem::remove_path(log_path));
+}
+
+TEST_P(meta_state_service_test, DISABLED_zookeeper_batch_write_benchmark)
+{
+    provider_batch_write_benchmark(
+        "zookeeper",
+        [] {
+            meta_state_service_zookeeper *svc = new meta_state_service_zookeeper();
+            auto err = svc->initialize({});
+            CHECK_EQ(ERR_OK, err);
+            return svc;
+        },
+        [](meta_state_service *zookeeper_svc) { ASSERT_EQ(ERR_OK, zookeeper_svc->finalize()); });
 }
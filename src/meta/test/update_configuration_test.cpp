@@ -25,10 +25,12 @@
  */
 
 // IWYU pragma: no_include <ext/alloc_traits.h>
+#include <fmt/core.h>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <iostream>
 #include <map>
 #include <memory>
 #include <string>
@@ -58,6 +60,7 @@
 #include "rpc/rpc_host_port.h"
 #include "rpc/rpc_message.h"
 #include "rpc/serialization.h"
+#include "runtime/api_layer1.h"
 #include "task/async_calls.h"
 #include "task/task.h"
 #include "utils/autoref_ptr.h"
@@ -295,6 +298,79 @@ void meta_service_test_app::update_configuration_test()
     ASSERT_TRUE(wait_state(ss, validator3, 10));
 }
 
+void meta_service_test_app::node_failure_recovery_benchmark()
+{
+    // 10k partitions on 10 nodes, thus 3000 of them are served by the dead node.
+    const int kPartitionCount = 10000;
+    const int kNodeCount = 10;
+
+    std::shared_ptr<fake_sender_meta_service> svc(new fake_sender_meta_service(this));
+    svc->_failure_detector.reset(new dsn::replication::meta_server_failure_detector(svc.get()));
+    ASSERT_EQ(dsn::ERR_OK, svc->remote_storage_initialize());
+    svc->_partition_guardian.reset(new partition_guardian(svc.get()));
+    svc->_balancer.reset(new dummy_balancer(svc.get()));
+
+    server_state *ss = svc->_state.get();
+    ss->initialize(svc.get(),
+                   utils::filesystem::concat_path_unix_style(svc->_cluster_root, "apps"));
+    dsn::app_info info;
+    info.is_stateful = true;
+    info.status = dsn::app_status::AS_CREATING;
+    info.app_id = 1;
+    info.app_name = "simple_kv.instance0";
+    info.app_type = "simple_kv";
+    info.max_replica_count = 3;
+    info.partition_count = kPartitionCount;
+    std::shared_ptr<app_state> app = app_state::create(info);
+    ss->_all_apps.emplace(1, app);
+
+    std::vector<dsn::host_port> nodes;
+    generate_node_list(nodes, kNodeCount, kNodeCount);
+    for (int i = 0; i != kPartitionCount; ++i) {
+        auto &pc = app->pcs[i];
+        SET_IP_AND_HOST_PORT_BY_DNS(pc, primary, nodes[i % kNodeCount]);
+        SET_IPS_AND_HOST_PORTS_BY_DNS(
+            pc, secondaries, nodes[(i + 1) % kNodeCount], nodes[(i + 2) % kNodeCount]);
+        pc.ballot = 3;
+    }
+
+    ss->sync_apps_to_remote_storage();
+    ASSERT_TRUE(ss->spin_wait_staging(30));
+    ss->initialize_node_state();
+    svc->set_node_state(nodes, true);
+    svc->_started = true;
+
+    // The partitions served by the dead node recover once it's removed from all of them and
+    // each of them has a primary, whose configurations have been persisted to remote storage.
+    const auto dead_node = nodes[0];
+    const auto recovered = [&dead_node](const app_mapper &apps) {
+        for (const auto &pc : apps.at(1)->pcs) {
+            if (!pc.hp_primary || pc.hp_primary == dead_node ||
+                utils::contains(pc.hp_secondaries, dead_node)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    const uint64_t start_ms = dsn_now_ms();
+    svc->set_node_state({dead_node}, false);
+    bool done = false;
+    while (!done && dsn_now_ms() - start_ms < 300000) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        dsn::zauto_read_lock l(ss->_lock);
+        done = recovered(ss->_all_apps);
+    }
+    const uint64_t recovery_ms = dsn_now_ms() - start_ms;
+    ASSERT_TRUE(done);
+
+    std::cout << fmt::format("recover {} of {} partitions from a dead node in {}ms",
+                             3 * kPartitionCount / kNodeCount,
+                             kPartitionCount,
+                             recovery_ms)
+              << std::endl;
+}
+
 void meta_service_test_app::adjust_dropped_size()
 {
     dsn::error_code ec;
@@ -41,6 +41,9 @@ struct copy_request
     9: optional string         source_disk_tag;
     10: optional dsn.gpid      pid;
     11: optional dsn.host_port hp_source;
+    // Whether the file content could be appended to the response message after the
+    // serialized copy_response, instead of being serialized as copy_response.file_content.
+    12: optional bool          attach_file_content;
 }
 
 struct copy_response
@@ -49,6 +52,8 @@ struct copy_response
     2: dsn.blob file_content;
     3: i64 offset;
     4: i32 size;
+    // Set if the file content of "size" bytes is appended after the serialized copy_response.
+    5: optional bool file_content_attached;
 }
 
 struct get_file_size_request
@@ -26,6 +26,7 @@
 
 #include "nfs_client_impl.h"
 
+#include <string.h>
 #include <cstdint>
 // IWYU pragma: no_include <ext/alloc_traits.h>
 #include <mutex>
@@ -37,12 +38,14 @@
 #include "nlohmann/json.hpp"
 #include "rpc/dns_resolver.h" // IWYU pragma: keep
 #include "rpc/rpc_host_port.h"
+#include "rpc/rpc_message.h"
 #include "utils/blob.h"
 #include "utils/command_manager.h"
 #include "utils/filesystem.h"
 #include "utils/flags.h"
 #include "utils/fmt_logging.h"
 #include "utils/token_buckets.h"
+#include "utils/utils.h"
 
 DSN_DEFINE_uint32(nfs,
                   nfs_copy_block_bytes,
@@ -86,6 +89,13 @@ DSN_DEFINE_int32(nfs,
                  "maximum concurrent remote copy requests for the same file on nfs client"
                  "to limit each file copy speed");
 DSN_DEFINE_int32(nfs, max_retry_count_per_copy_request, 2, "maximum retry count when copy failed");
+DSN_DEFINE_bool(nfs,
+                copy_with_attached_file_content,
+                true,
+                "Whether to request the nfs server to append the file content to the copy "
+                "responses directly, which saves copying the content while serializing and "
+                "deserializing the responses");
+DSN_TAG_VARIABLE(copy_with_attached_file_content, FT_MUTABLE);
 DSN_DEFINE_int32(nfs,
                  rpc_timeout_ms,
                  1e5, // 100s
@@ -117,6 +127,43 @@ namespace dsn {
 namespace service {
 static uint32_t current_max_copy_rate_megabytes = 0;
 
+bool read_attached_file_content(message_ex *msg, copy_response &resp)
+{
+    // The content is usually a slice of the receive buffer, unless the message is made up of
+    // several buffers, e.g. a local message.
+    std::vector<blob> pieces;
+    size_t total_size = 0;
+    blob data;
+    while (msg->read_next(data)) {
+        msg->read_commit(data.length());
+        if (!data.empty()) {
+            total_size += data.length();
+            pieces.emplace_back(std::move(data));
+        }
+    }
+
+    if (total_size != static_cast<size_t>(resp.size)) {
+        LOG_ERROR("[nfs_service] the size of the attached file content {} mismatches the size {}",
+                  total_size,
+                  resp.size);
+        return false;
+    }
+
+    if (pieces.size() <= 1) {
+        resp.file_content = pieces.empty() ? blob() : std::move(pieces[0]);
+        return true;
+    }
+
+    std::shared_ptr<char> buffer(utils::make_shared_array<char>(total_size));
+    char *ptr = buffer.get();
+    for (const auto &piece : pieces) {
+        memcpy(ptr, piece.data(), piece.length());
+        ptr += piece.length();
+    }
+    resp.file_content = blob(std::move(buffer), total_size);
+    return true;
+}
+
 nfs_client_impl::nfs_client_impl()
     : _concurrent_copy_request_count(0),
       _concurrent_local_write_count(0),
@@ -307,6 +354,9 @@ void nfs_client_impl::continue_copy()
                 copy_req.is_last = req->is_last;
                 copy_req.__set_source_disk_tag(ureq->file_size_req.source_disk_tag);
                 copy_req.__set_pid(ureq->file_size_req.pid);
+                if (FLAGS_copy_with_attached_file_content) {
+                    copy_req.__set_attach_file_content(true);
+                }
                 req->remote_copy_task = async_nfs_copy(
                     copy_req,
                     [=](error_code err, copy_response &&resp) {
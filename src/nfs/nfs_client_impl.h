@@ -79,6 +79,10 @@ task_ptr async_nfs_get_file_size(const get_file_size_request &request,
                      timeout);
 }
 
+// Read the file content appended after the serialized `resp` in `msg` into resp.file_content,
+// see copy_request.attach_file_content.
+bool read_attached_file_content(message_ex *msg, copy_response &resp);
+
 template <typename TCallback>
 task_ptr async_nfs_copy(const copy_request &request,
                         TCallback &&callback,
@@ -86,7 +90,23 @@ task_ptr async_nfs_copy(const copy_request &request,
                         rpc_address server_addr)
 {
     return rpc::call(
-        server_addr, RPC_NFS_COPY, request, nullptr, std::forward<TCallback>(callback), timeout);
+        server_addr,
+        RPC_NFS_COPY,
+        request,
+        nullptr,
+        [cb = std::forward<TCallback>(callback)](
+            error_code err, message_ex *, message_ex *resp_msg) mutable {
+            copy_response resp;
+            if (err == ERR_OK) {
+                unmarshall(resp_msg, resp);
+                if (resp.error == ERR_OK && resp.__isset.file_content_attached &&
+                    resp.file_content_attached && !read_attached_file_content(resp_msg, resp)) {
+                    err = ERR_INVALID_DATA;
+                }
+            }
+            cb(err, std::move(resp));
+        },
+        timeout);
 }
 
 class nfs_client_impl
@@ -27,12 +27,15 @@
 #include "nfs/nfs_server_impl.h"
 
 // IWYU pragma: no_include <ext/alloc_traits.h>
+#include <rocksdb/env.h>
+#include <rocksdb/status.h>
 #include <chrono>
 #include <cstdint>
 #include <mutex>
 #include <vector>
 
 #include <string_view>
+#include "aio/disk_engine.h"
 #include "fmt/core.h" // IWYU pragma: keep
 #include "gutil/map_util.h"
 #include "nfs/nfs_code_definition.h"
@@ -65,6 +68,14 @@ static const char *kMaxSendRateMegaBytesPerDiskDesc =
 DSN_DEFINE_int64(nfs, max_send_rate_megabytes_per_disk, 0, kMaxSendRateMegaBytesPerDiskDesc);
 DSN_TAG_VARIABLE(max_send_rate_megabytes_per_disk, FT_MUTABLE);
 
+DSN_DEFINE_uint32(nfs,
+                  readahead_bytes_on_server,
+                  8 * 1024 * 1024,
+                  "The bytes of a file following the range being copied to read ahead into the "
+                  "page cache on nfs server, since the files are usually copied sequentially. "
+                  "0 means no read ahead");
+DSN_TAG_VARIABLE(readahead_bytes_on_server, FT_MUTABLE);
+
 DSN_DECLARE_int32(file_close_timer_interval_ms_on_server);
 DSN_DECLARE_int32(file_close_expire_time_ms);
 
@@ -129,8 +140,11 @@ void nfs_service_impl::on_copy(const ::dsn::service::copy_request &request,
     cp->dst_dir = request.dst_dir;
     cp->source_disk_tag = request.source_disk_tag;
     cp->file_path = std::move(file_path);
+    cp->dfile = dfile;
     cp->offset = request.offset;
     cp->size = request.size;
+    cp->is_last = request.is_last;
+    cp->attach_file_content = request.__isset.attach_file_content && request.attach_file_content;
 
     auto buffer_save = cp->bb.buffer().get();
 
@@ -153,15 +167,6 @@ void nfs_service_impl::internal_read_callback(error_code err, size_t sz, callbac
                                        1.5 * (FLAGS_max_send_rate_megabytes_per_disk << 20));
     }
 
-    {
-        zauto_lock l(_handles_map_lock);
-        auto it = _handles_map.find(cp.file_path);
-
-        if (it != _handles_map.end()) {
-            it->second->file_access_count--;
-        }
-    }
-
     if (err != ERR_OK) {
         LOG_ERROR("[nfs_service] read file {} failed, err = {}", cp.file_path, err);
         METRIC_VAR_INCREMENT(nfs_server_copy_failed_requests);
@@ -171,11 +176,35 @@ void nfs_service_impl::internal_read_callback(error_code err, size_t sz, callbac
 
     ::dsn::service::copy_response resp;
     resp.error = err;
-    resp.file_content = std::move(cp.bb);
     resp.offset = cp.offset;
     resp.size = cp.size;
+    if (cp.attach_file_content) {
+        // Send the file content from the read buffer directly, instead of serializing it into
+        // the response.
+        resp.__set_file_content_attached(true);
+        cp.replier(resp, err == ERR_OK ? cp.bb : blob());
+    } else {
+        resp.file_content = std::move(cp.bb);
+        cp.replier(resp);
+    }
+
+    // Read ahead the following range while the client is receiving the current one, the file
+    // handle is kept open until the access count is decreased below. It is just a hint, thus the
+    // failure is ignored.
+    if (err == ERR_OK && !cp.is_last && FLAGS_readahead_bytes_on_server > 0) {
+        cp.dfile->rfile()
+            ->Prefetch(cp.offset + cp.size, FLAGS_readahead_bytes_on_server)
+            .PermitUncheckedError();
+    }
 
-    cp.replier(resp);
+    {
+        zauto_lock l(_handles_map_lock);
+        auto it = _handles_map.find(cp.file_path);
+
+        if (it != _handles_map.end()) {
+            it->second->file_access_count--;
+        }
+    }
 }
 
 // RPC_NFS_NEW_NFS_GET_FILE_SIZE
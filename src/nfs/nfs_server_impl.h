@@ -86,17 +86,32 @@ private:
         std::string file_path;
         std::string dst_dir;
         blob bb;
+        disk_file *dfile;
         uint64_t offset;
         uint32_t size;
+        bool is_last;
+        bool attach_file_content;
         rpc_replier<copy_response> replier;
 
-        callback_para(rpc_replier<copy_response> &&r) : offset(0), size(0), replier(std::move(r)) {}
+        callback_para(rpc_replier<copy_response> &&r)
+            : dfile(nullptr),
+              offset(0),
+              size(0),
+              is_last(false),
+              attach_file_content(false),
+              replier(std::move(r))
+        {
+        }
         callback_para(callback_para &&r)
-            : file_path(std::move(r.file_path)),
+            : source_disk_tag(std::move(r.source_disk_tag)),
+              file_path(std::move(r.file_path)),
               dst_dir(std::move(r.dst_dir)),
               bb(std::move(r.bb)),
+              dfile(r.dfile),
               offset(r.offset),
               size(r.size),
+              is_last(r.is_last),
+              attach_file_content(r.attach_file_content),
               replier(std::move(r.replier))
         {
             r.offset = 0;
@@ -49,7 +49,9 @@
 #include "utils/flags.h"
 #include "utils/threadpool_code.h"
 
+DSN_DECLARE_bool(copy_with_attached_file_content);
 DSN_DECLARE_bool(encrypt_data_at_rest);
+DSN_DECLARE_uint32(nfs_copy_block_bytes);
 
 using namespace dsn;
 
@@ -251,6 +253,74 @@ TEST_P(nfs_test, basic)
     nfs->stop();
 }
 
+TEST_P(nfs_test, copy_in_blocks)
+{
+    auto nfs = dsn::nfs_node::create();
+    nfs->start();
+    nfs->register_async_rpc_handler_for_test();
+
+    std::vector<std::string> src_filenames({"nfs_test_file1", "nfs_test_file2"});
+    if (FLAGS_encrypt_data_at_rest) {
+        for (auto &src_filename : src_filenames) {
+            auto s = dsn::utils::encrypt_file(src_filename, src_filename + ".encrypted");
+            ASSERT_TRUE(s.ok()) << s.ToString();
+            src_filename += ".encrypted";
+        }
+    }
+    std::vector<std::string> src_file_md5s;
+    for (const auto &src_filename : src_filenames) {
+        std::string src_file_md5;
+        ASSERT_EQ(ERR_OK, utils::filesystem::md5sum(src_filename, src_file_md5));
+        src_file_md5s.emplace_back(std::move(src_file_md5));
+    }
+
+    // Each file is copied by several requests, with the file content being attached to the
+    // responses or not.
+    PRESERVE_FLAG(nfs_copy_block_bytes);
+    PRESERVE_FLAG(copy_with_attached_file_content);
+    FLAGS_nfs_copy_block_bytes = 1000;
+    for (const bool attached : {true, false}) {
+        FLAGS_copy_with_attached_file_content = attached;
+        const std::string kDstDir = "nfs_test_dir_in_blocks";
+        ASSERT_TRUE(utils::filesystem::remove_path(kDstDir));
+        ASSERT_TRUE(utils::filesystem::create_directory(kDstDir));
+
+        aio_result r;
+        auto t = nfs->copy_remote_files(
+            dsn::host_port("localhost", 20101),
+            "default",
+            ".",
+            src_filenames,
+            "default",
+            kDstDir,
+            gpid(1, 0),
+            false,
+            false,
+            LPC_AIO_TEST_NFS,
+            nullptr,
+            [&r](dsn::error_code err, size_t sz) {
+                r.err = err;
+                r.sz = sz;
+            },
+            0);
+        ASSERT_NE(nullptr, t);
+        ASSERT_TRUE(t->wait(20000));
+        ASSERT_EQ(ERR_OK, r.err) << attached;
+
+        std::vector<std::string> dst_filenames;
+        ASSERT_TRUE(utils::filesystem::get_subfiles(kDstDir, dst_filenames, true));
+        std::sort(dst_filenames.begin(), dst_filenames.end());
+        ASSERT_EQ(src_filenames.size(), dst_filenames.size());
+        for (size_t i = 0; i < dst_filenames.size(); ++i) {
+            std::string file_md5;
+            ASSERT_EQ(ERR_OK, utils::filesystem::md5sum(dst_filenames[i], file_md5));
+            ASSERT_EQ(src_file_md5s[i], file_md5) << attached;
+        }
+    }
+
+    nfs->stop();
+}
+
 int g_test_ret = 0;
 GTEST_API_ int main(int argc, char **argv)
 {
@@ -624,6 +624,10 @@ void cold_backup_context::prepare_upload()
     _metadata.checkpoint_decree = checkpoint_decree;
     _metadata.checkpoint_timestamp = checkpoint_timestamp;
     _metadata.checkpoint_total_size = checkpoint_file_total_size;
+    if (incremental) {
+        _metadata.shared_files_dir = cold_backup::get_shared_files_dir(
+            request.policy.policy_name, request.app_name, request.pid);
+    }
     for (int32_t idx = 0; idx < checkpoint_files.size(); idx++) {
         std::string &file = checkpoint_files[idx];
         file_meta f_meta;
@@ -647,10 +651,22 @@ void cold_backup_context::prepare_upload()
 
 void cold_backup_context::upload_file(const std::string &local_filename)
 {
-    std::string remote_chkpt_dir = cold_backup::get_remote_chkpt_dir(
-        backup_root, request.app_name, request.pid, request.backup_id);
+    std::string remote_dir;
+    if (!_metadata.shared_files_dir.empty() && cold_backup::is_shared_file(local_filename)) {
+        // The file is stored once by its content, and it would be found already existed on
+        // remote if it has been uploaded by the previous backups.
+        file_meta f_meta;
+        f_meta.name = local_filename;
+        f_meta.size = _file_infos.at(local_filename).first;
+        f_meta.md5 = _file_infos.at(local_filename).second;
+        remote_dir =
+            cold_backup::get_shared_file_dir(backup_root, _metadata.shared_files_dir, f_meta);
+    } else {
+        remote_dir = cold_backup::get_remote_chkpt_dir(
+            backup_root, request.app_name, request.pid, request.backup_id);
+    }
     dist::block_service::create_file_request req;
-    req.file_name = ::dsn::utils::filesystem::path_combine(remote_chkpt_dir, local_filename);
+    req.file_name = ::dsn::utils::filesystem::path_combine(remote_dir, local_filename);
     req.ignore_metadata = false;
 
     add_ref();
@@ -88,15 +88,6 @@ enum cold_backup_status
 };
 const char *cold_backup_status_to_string(cold_backup_status status);
 
-struct cold_backup_metadata
-{
-    int64_t checkpoint_decree;
-    int64_t checkpoint_timestamp;
-    std::vector<file_meta> files;
-    int64_t checkpoint_total_size;
-    DEFINE_JSON_SERIALIZATION(checkpoint_decree, checkpoint_timestamp, files, checkpoint_total_size)
-};
-
 //
 // the process of uploading the checkpoint directory to block filesystem:
 //      1, upload all the file of the checkpoint to block filesystem
@@ -123,6 +114,7 @@ public:
                                  int max_upload_file_cnt)
         : request(request_),
           block_service(nullptr),
+          incremental(false),
           checkpoint_decree(0),
           checkpoint_timestamp(0),
           durable_decree_when_checkpoint(-1),
@@ -329,6 +321,8 @@ public:
     backup_request request;
     dist::block_service::block_filesystem *block_service;
     std::string backup_root;
+    // whether to upload the sst files into the shared files directory of the policy
+    bool incremental;
     decree checkpoint_decree;
     int64_t checkpoint_timestamp;
     decree durable_decree_when_checkpoint;
@@ -0,0 +1,568 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "replica/disk_balancer.h"
+
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <utility>
+
+#include "common/fs_manager.h"
+#include "common/replication.codes.h"
+#include "common/replication_enums.h"
+#include "dsn.layer2_types.h"
+#include "metadata_types.h"
+#include "replica/replica.h"
+#include "replica/replica_disk_migrator.h"
+#include "replica/replica_stub.h"
+#include "replica_admin_types.h"
+#include "rpc/rpc_holder.h"
+#include "runtime/api_layer1.h"
+#include "task/async_calls.h"
+#include "utils/flags.h"
+#include "utils/fmt_logging.h"
+#include "utils/time_utils.h"
+
+DSN_DEFINE_bool(replication,
+                disk_balancer_enabled,
+                false,
+                "Whether to migrate the replicas between the data dirs periodically to balance "
+                "the I/O load and the space usage of the disks");
+DSN_TAG_VARIABLE(disk_balancer_enabled, FT_MUTABLE);
+
+DSN_DEFINE_bool(replication,
+                disk_balance_dry_run,
+                false,
+                "Whether the disk balancer only plans the migrations without starting them, the "
+                "plans could be viewed by the http api 'replica/disk_balance'");
+DSN_TAG_VARIABLE(disk_balance_dry_run, FT_MUTABLE);
+
+DSN_DEFINE_uint32(replication,
+                  disk_balance_interval_seconds,
+                  300,
+                  "The interval in seconds between the rounds of the disk balancer, which is "
+                  "also the period the I/O utilization of the disks is measured over");
+DSN_DEFINE_validator(disk_balance_interval_seconds, [](uint32_t value) -> bool {
+    return value > 0;
+});
+
+DSN_DEFINE_uint32(replication,
+                  disk_balance_max_concurrent_migrations,
+                  1,
+                  "The max count of the replicas being migrated between the data dirs by the "
+                  "disk balancer at the same time");
+DSN_TAG_VARIABLE(disk_balance_max_concurrent_migrations, FT_MUTABLE);
+
+DSN_DEFINE_uint64(replication,
+                  disk_balance_max_migration_mb_per_round,
+                  20 * 1024,
+                  "The max total size in MB of the replicas migrated by the disk balancer in a "
+                  "round, which limits the disk bandwidth the migrations take");
+DSN_TAG_VARIABLE(disk_balance_max_migration_mb_per_round, FT_MUTABLE);
+
+DSN_DEFINE_double(replication,
+                  disk_balance_io_util_threshold,
+                  0.2,
+                  "The disk balancer moves the replicas off the busiest disk once its I/O "
+                  "utilization exceeds the idlest one by more than this, within [0, 1]");
+DSN_TAG_VARIABLE(disk_balance_io_util_threshold, FT_MUTABLE);
+
+DSN_DEFINE_int32(replication,
+                 disk_balance_space_ratio_threshold,
+                 10,
+                 "The disk balancer moves the replicas off the fullest disk once the available "
+                 "space ratio of the emptiest disk exceeds it by more than this percentage");
+DSN_TAG_VARIABLE(disk_balance_space_ratio_threshold, FT_MUTABLE);
+
+namespace dsn {
+namespace replication {
+
+namespace {
+
+struct disk_state
+{
+    const disk_load *load{nullptr};
+    double io_util{-1};
+    int64_t available_mb{0};
+    int64_t write_cu_per_sec{0};
+    std::vector<const replica_disk_load *> replicas;
+
+    // The available space ratio after `delta_mb` is released.
+    int32_t available_ratio(int64_t delta_mb = 0) const
+    {
+        if (load->capacity_mb <= 0) {
+            return 0;
+        }
+        return static_cast<int32_t>((available_mb + delta_mb) * 100 / load->capacity_mb);
+    }
+
+    // The I/O utilization contributed by `r`.
+    double io_util_of(const replica_disk_load &r) const
+    {
+        if (io_util <= 0 || write_cu_per_sec <= 0) {
+            return 0;
+        }
+        return io_util * r.write_cu_per_sec / write_cu_per_sec;
+    }
+};
+
+class disk_migration_planner
+{
+public:
+    disk_migration_planner(const std::vector<disk_load> &disks,
+                           const std::vector<replica_disk_load> &replicas,
+                           const disk_balance_options &options)
+        : _options(options), _remaining_mb(options.max_migration_mb)
+    {
+        for (const auto &load : disks) {
+            auto &state = _disks[load.tag];
+            state.load = &load;
+            state.io_util = load.io_util;
+            state.available_mb = load.available_mb;
+        }
+        for (const auto &r : replicas) {
+            auto iter = _disks.find(r.disk_tag);
+            if (iter == _disks.end()) {
+                continue;
+            }
+            iter->second.write_cu_per_sec += r.write_cu_per_sec;
+            iter->second.replicas.push_back(&r);
+        }
+    }
+
+    std::vector<disk_migration> plan()
+    {
+        while (_plan.size() < _options.max_migrations) {
+            if (!plan_for_io() && !plan_for_space()) {
+                break;
+            }
+        }
+        return std::move(_plan);
+    }
+
+private:
+    bool movable(const replica_disk_load &r) const
+    {
+        return r.movable && _moved.find(r.pid) == _moved.end() &&
+               static_cast<uint64_t>(r.storage_mb) <= _remaining_mb;
+    }
+
+    bool can_receive(const disk_state &target, const replica_disk_load &r) const
+    {
+        return target.available_mb > r.storage_mb &&
+               target.available_ratio(-r.storage_mb) > _options.min_available_space_ratio;
+    }
+
+    bool plan_for_io()
+    {
+        disk_state *busiest = nullptr;
+        for (auto &[_, state] : _disks) {
+            if (state.io_util >= 0 && (busiest == nullptr || state.io_util > busiest->io_util)) {
+                busiest = &state;
+            }
+        }
+        if (busiest == nullptr) {
+            return false;
+        }
+
+        disk_state *idlest = nullptr;
+        for (auto &[_, state] : _disks) {
+            if (state.io_util < 0 || state.load->device == busiest->load->device) {
+                continue;
+            }
+            if (idlest == nullptr || state.io_util < idlest->io_util) {
+                idlest = &state;
+            }
+        }
+        if (idlest == nullptr ||
+            busiest->io_util - idlest->io_util <= _options.io_util_threshold) {
+            return false;
+        }
+
+        // Move the replica contributing the most I/O utilization, as long as the idlest disk
+        // would not be busier than the busiest one after the migration.
+        const replica_disk_load *selected = nullptr;
+        double selected_io_util = 0;
+        for (const auto *r : busiest->replicas) {
+            if (!movable(*r) || !can_receive(*idlest, *r)) {
+                continue;
+            }
+            const auto io_util = busiest->io_util_of(*r);
+            if (io_util <= selected_io_util ||
+                idlest->io_util + io_util >= busiest->io_util - io_util) {
+                continue;
+            }
+            selected = r;
+            selected_io_util = io_util;
+        }
+        if (selected == nullptr) {
+            return false;
+        }
+
+        add_migration(*selected, *busiest, *idlest, "io");
+        return true;
+    }
+
+    bool plan_for_space()
+    {
+        disk_state *fullest = nullptr;
+        for (auto &[_, state] : _disks) {
+            if (state.load->capacity_mb <= 0) {
+                continue;
+            }
+            if (fullest == nullptr || state.available_ratio() < fullest->available_ratio()) {
+                fullest = &state;
+            }
+        }
+        if (fullest == nullptr) {
+            return false;
+        }
+
+        disk_state *emptiest = nullptr;
+        for (auto &[_, state] : _disks) {
+            if (state.load->capacity_mb <= 0 || state.load->device == fullest->load->device) {
+                continue;
+            }
+            if (emptiest == nullptr || state.available_ratio() > emptiest->available_ratio()) {
+                emptiest = &state;
+            }
+        }
+        if (emptiest == nullptr || emptiest->available_ratio() - fullest->available_ratio() <=
+                                       _options.space_ratio_threshold) {
+            return false;
+        }
+
+        // Move the largest replica, as long as the emptiest disk would not be fuller than the
+        // fullest one after the migration, and the I/O load would not go unbalanced.
+        const replica_disk_load *selected = nullptr;
+        for (const auto *r : fullest->replicas) {
+            if (!movable(*r) || r->storage_mb <= 0 || !can_receive(*emptiest, *r)) {
+                continue;
+            }
+            if (emptiest->available_ratio(-r->storage_mb) <
+                fullest->available_ratio(r->storage_mb)) {
+                continue;
+            }
+            if (fullest->io_util >= 0 && emptiest->io_util >= 0) {
+                const auto io_util = fullest->io_util_of(*r);
+                if (emptiest->io_util + io_util - (fullest->io_util - io_util) >
+                    _options.io_util_threshold) {
+                    continue;
+                }
+            }
+            if (selected == nullptr || r->storage_mb > selected->storage_mb ||
+                (r->storage_mb == selected->storage_mb &&
+                 r->write_cu_per_sec < selected->write_cu_per_sec)) {
+                selected = r;
+            }
+        }
+        if (selected == nullptr) {
+            return false;
+        }
+
+        add_migration(*selected, *fullest, *emptiest, "space");
+        return true;
+    }
+
+    void add_migration(const replica_disk_load &r,
+                       disk_state &origin,
+                       disk_state &target,
+                       const std::string &reason)
+    {
+        const auto io_util = origin.io_util_of(r);
+        origin.io_util -= io_util;
+        if (target.io_util >= 0) {
+            target.io_util += io_util;
+        }
+        origin.write_cu_per_sec -= r.write_cu_per_sec;
+        target.write_cu_per_sec += r.write_cu_per_sec;
+        origin.available_mb += r.storage_mb;
+        target.available_mb -= r.storage_mb;
+        target.replicas.push_back(&r);
+
+        _remaining_mb -= r.storage_mb;
+        _moved.insert(r.pid);
+        _plan.push_back({r.pid, origin.load->tag, target.load->tag, r.storage_mb, reason});
+    }
+
+    const disk_balance_options &_options;
+    uint64_t _remaining_mb;
+    std::map<std::string, disk_state> _disks;
+    std::set<gpid> _moved;
+    std::vector<disk_migration> _plan;
+};
+
+// The device the dir is placed on, in the form of "<major>:<minor>" as /proc/diskstats shows.
+std::string device_of_dir(const std::string &dir)
+{
+    struct stat st;
+    if (::stat(dir.c_str(), &st) != 0) {
+        return {};
+    }
+    return fmt::format("{}:{}", major(st.st_dev), minor(st.st_dev));
+}
+
+// Read the milliseconds each device has spent doing I/O from /proc/diskstats.
+std::map<std::string, uint64_t> read_io_ticks()
+{
+    std::map<std::string, uint64_t> io_ticks;
+    std::ifstream in("/proc/diskstats");
+    std::string line;
+    while (std::getline(in, line)) {
+        // <major> <minor> <name> <reads completed> <reads merged> <sectors read>
+        // <ms spent reading> <writes completed> <writes merged> <sectors written>
+        // <ms spent writing> <I/Os in progress> <ms spent doing I/Os> ...
+        std::istringstream fields(line);
+        unsigned int major_id = 0;
+        unsigned int minor_id = 0;
+        std::string name;
+        uint64_t values[10];
+        if (!(fields >> major_id >> minor_id >> name)) {
+            continue;
+        }
+        int count = 0;
+        while (count < 10 && fields >> values[count]) {
+            ++count;
+        }
+        if (count == 10) {
+            io_ticks[fmt::format("{}:{}", major_id, minor_id)] = values[9];
+        }
+    }
+    return io_ticks;
+}
+
+} // anonymous namespace
+
+std::vector<disk_migration> plan_disk_migrations(const std::vector<disk_load> &disks,
+                                                 const std::vector<replica_disk_load> &replicas,
+                                                 const disk_balance_options &options)
+{
+    return disk_migration_planner(disks, replicas, options).plan();
+}
+
+disk_balancer::disk_balancer(replica_stub *stub) : _stub(stub) {}
+
+disk_balancer::~disk_balancer() = default;
+
+void disk_balancer::start()
+{
+    LOG_INFO("run disk balancer periodically in {}s", FLAGS_disk_balance_interval_seconds);
+
+    // Take the first I/O samples, thus the I/O utilization is known from the first round.
+    {
+        zauto_lock l(_lock);
+        sample_disk_loads();
+    }
+
+    _timer_task = tasking::enqueue_timer(
+        LPC_DISK_BALANCE,
+        &_stub->_tracker,
+        [this]() { run(); },
+        std::chrono::seconds(FLAGS_disk_balance_interval_seconds),
+        0,
+        std::chrono::seconds(FLAGS_disk_balance_interval_seconds));
+}
+
+void disk_balancer::close()
+{
+    if (_timer_task) {
+        _timer_task->cancel(true);
+        _timer_task = nullptr;
+    }
+}
+
+void disk_balancer::run()
+{
+    if (!FLAGS_disk_balancer_enabled) {
+        return;
+    }
+
+    auto round = balance(FLAGS_disk_balance_dry_run);
+    zauto_lock l(_lock);
+    _last_round = std::move(round);
+}
+
+std::string disk_balancer::last_round() const
+{
+    zauto_lock l(_lock);
+    return _last_round;
+}
+
+std::string disk_balancer::balance(bool dry_run)
+{
+    zauto_lock l(_lock);
+
+    _stub->_fs_manager.update_disk_stat();
+    const auto disks = sample_disk_loads();
+    uint32_t running_migrations = 0;
+    const auto replicas = collect_replica_loads(running_migrations);
+
+    disk_balance_options options;
+    options.max_migrations = FLAGS_disk_balance_max_concurrent_migrations > running_migrations
+                                 ? FLAGS_disk_balance_max_concurrent_migrations -
+                                       running_migrations
+                                 : 0;
+    options.max_migration_mb = FLAGS_disk_balance_max_migration_mb_per_round;
+    options.io_util_threshold = FLAGS_disk_balance_io_util_threshold;
+    options.space_ratio_threshold = FLAGS_disk_balance_space_ratio_threshold;
+    options.min_available_space_ratio = FLAGS_disk_min_available_space_ratio;
+    const auto migrations = plan_disk_migrations(disks, replicas, options);
+
+    nlohmann::json json;
+    json["time"] = utils::time_s_to_date_time(dsn_now_s());
+    json["dry_run"] = dry_run;
+    json["running_migrations"] = running_migrations;
+    json["disks"] = nlohmann::json::array();
+    for (const auto &disk : disks) {
+        int64_t write_cu_per_sec = 0;
+        int32_t replica_count = 0;
+        for (const auto &r : replicas) {
+            if (r.disk_tag == disk.tag) {
+                write_cu_per_sec += r.write_cu_per_sec;
+                ++replica_count;
+            }
+        }
+        json["disks"].push_back(nlohmann::json{
+            {"tag", disk.tag},
+            {"device", disk.device},
+            {"io_util", disk.io_util},
+            {"capacity_mb", disk.capacity_mb},
+            {"available_mb", disk.available_mb},
+            {"write_cu_per_sec", write_cu_per_sec},
+            {"replica_count", replica_count},
+        });
+    }
+    json["migrations"] = nlohmann::json::array();
+    for (const auto &migration : migrations) {
+        LOG_INFO("{} replica({}) from disk({}) to disk({}) for {}, storage_mb = {}",
+                 dry_run ? "plan to migrate" : "start to migrate",
+                 migration.pid,
+                 migration.origin_disk,
+                 migration.target_disk,
+                 migration.reason,
+                 migration.storage_mb);
+        if (!dry_run) {
+            start_migration(migration);
+        }
+        json["migrations"].push_back(nlohmann::json{
+            {"pid", migration.pid.to_string()},
+            {"origin_disk", migration.origin_disk},
+            {"target_disk", migration.target_disk},
+            {"storage_mb", migration.storage_mb},
+            {"reason", migration.reason},
+        });
+    }
+    return json.dump();
+}
+
+std::vector<disk_load> disk_balancer::sample_disk_loads()
+{
+    const auto io_ticks = read_io_ticks();
+    const auto now_ms = dsn_now_ms();
+
+    std::vector<disk_load> disks;
+    for (const auto &dn : _stub->_fs_manager.get_dir_nodes()) {
+        if (dn->status != disk_status::NORMAL) {
+            continue;
+        }
+
+        disk_load disk;
+        disk.tag = dn->tag;
+        disk.device = device_of_dir(dn->full_dir);
+        disk.capacity_mb = dn->disk_capacity_mb;
+        disk.available_mb = dn->disk_available_mb;
+
+        const auto iter = io_ticks.find(disk.device);
+        if (disk.device.empty()) {
+            // Regard the dir as on its own device.
+            disk.device = dn->full_dir;
+        } else if (iter != io_ticks.end()) {
+            auto &sample = _io_samples[disk.device];
+            // Keep the last utilization if sampled again too soon, e.g. by a dry run just
+            // after a round, or for another dir on the same device.
+            if (sample.time_ms == 0 || iter->second < sample.io_ticks_ms) {
+                sample.io_ticks_ms = iter->second;
+                sample.time_ms = now_ms;
+            } else if (now_ms >= sample.time_ms + 1000) {
+                sample.io_util = std::min(
+                    1.0,
+                    static_cast<double>(iter->second - sample.io_ticks_ms) /
+                        (now_ms - sample.time_ms));
+                sample.io_ticks_ms = iter->second;
+                sample.time_ms = now_ms;
+            }
+            disk.io_util = sample.io_util;
+        }
+        disks.emplace_back(std::move(disk));
+    }
+    return disks;
+}
+
+std::vector<replica_disk_load>
+disk_balancer::collect_replica_loads(/*out*/ uint32_t &running_migrations)
+{
+    running_migrations = 0;
+    std::vector<replica_disk_load> replicas;
+    for (const auto &rep : _stub->get_all_replicas()) {
+        const auto migration_status = rep->disk_migrator()->status();
+        if (migration_status == disk_migration_status::MOVING ||
+            migration_status == disk_migration_status::MOVED) {
+            ++running_migrations;
+        }
+
+        replica_info info;
+        rep->get_load_stats(info);
+
+        replica_disk_load r;
+        r.pid = rep->get_gpid();
+        r.disk_tag = rep->get_dir_node()->tag;
+        r.storage_mb = info.storage_mb;
+        r.write_cu_per_sec = info.write_cu_per_sec;
+        r.movable = rep->status() == partition_status::PS_SECONDARY &&
+                    migration_status == disk_migration_status::IDLE;
+        replicas.emplace_back(std::move(r));
+    }
+    return replicas;
+}
+
+void disk_balancer::start_migration(const disk_migration &migration)
+{
+    const auto rep = _stub->get_replica(migration.pid);
+    if (rep == nullptr) {
+        LOG_WARNING("replica({}) to migrate is not found", migration.pid);
+        return;
+    }
+
+    auto request = std::make_unique<replica_disk_migrate_request>();
+    request->pid = migration.pid;
+    request->origin_disk = migration.origin_disk;
+    request->target_disk = migration.target_disk;
+    // The arguments are checked again by the migrator, and the result is logged by it.
+    replica_disk_migrate_rpc rpc(std::move(request), RPC_REPLICA_DISK_MIGRATE);
+    rep->disk_migrator()->on_migrate_replica(rpc);
+}
+
+} // namespace replication
+} // namespace dsn
@@ -0,0 +1,144 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "common/gpid.h"
+#include "task/task.h"
+#include "utils/ports.h"
+#include "utils/zlocks.h"
+
+namespace dsn {
+namespace replication {
+class replica_stub;
+
+// The load of a NORMAL data dir.
+struct disk_load
+{
+    std::string tag;
+    // The device the dir is placed on, the migrations between the dirs on the same device are
+    // useless.
+    std::string device;
+    // The ratio of the time the device was busy doing I/O during the last sampling period,
+    // within [0, 1], or negative if unknown.
+    double io_util{-1};
+    int64_t capacity_mb{0};
+    int64_t available_mb{0};
+};
+
+// The load of a replica placed on a data dir.
+struct replica_disk_load
+{
+    gpid pid;
+    std::string disk_tag;
+    int64_t storage_mb{0};
+    int64_t write_cu_per_sec{0};
+    // Only the secondary replicas which are not being migrated could be migrated.
+    bool movable{false};
+};
+
+struct disk_migration
+{
+    gpid pid;
+    std::string origin_disk;
+    std::string target_disk;
+    int64_t storage_mb{0};
+    // "io" if the replica is moved off a busy disk, or "space" if it is moved off a full disk.
+    std::string reason;
+};
+
+struct disk_balance_options
+{
+    // The max count of the migrations planned.
+    uint32_t max_migrations{0};
+    // The max total size of the replicas migrated.
+    uint64_t max_migration_mb{0};
+    // The I/O utilization of the busiest disk should exceed the idlest one by more than this to
+    // trigger the migrations for I/O load.
+    double io_util_threshold{0};
+    // The available space ratio (in percentage) of the emptiest disk should exceed the fullest
+    // one by more than this to trigger the migrations for space.
+    int32_t space_ratio_threshold{0};
+    // The available space ratio (in percentage) of a disk should stay above this after some
+    // replicas are migrated to it.
+    int32_t min_available_space_ratio{0};
+};
+
+// Plan the migrations of the replicas between the disks of a node, which first moves the
+// replicas of high write rate from the busiest disk to the idlest one while their I/O
+// utilizations differ too much, then moves the large replicas from the fullest disk to the
+// emptiest one while their available spaces differ too much.
+//
+// The I/O utilization a replica contributes to its disk is estimated by its share of the write
+// rate of the disk. A replica is migrated only if the migration makes the pair of disks more
+// balanced, and at most once in a plan.
+std::vector<disk_migration> plan_disk_migrations(const std::vector<disk_load> &disks,
+                                                 const std::vector<replica_disk_load> &replicas,
+                                                 const disk_balance_options &options);
+
+// Per-server(replica_stub)-instance. Periodically samples the loads of the data dirs and the
+// replicas on them, and migrates the replicas between the data dirs by replica_disk_migrator
+// according to the plan.
+class disk_balancer
+{
+public:
+    explicit disk_balancer(replica_stub *stub);
+    ~disk_balancer();
+
+    void start();
+    void close();
+
+    // Sample the loads and plan the migrations, which are started unless `dry_run` is true.
+    // Returns the description of the round in JSON.
+    std::string balance(bool dry_run);
+
+    // The description of the last round run periodically in JSON.
+    std::string last_round() const;
+
+private:
+    struct io_sample
+    {
+        uint64_t io_ticks_ms{0};
+        uint64_t time_ms{0};
+        double io_util{-1};
+    };
+
+    void run();
+
+    std::vector<disk_load> sample_disk_loads();
+    std::vector<replica_disk_load> collect_replica_loads(/*out*/ uint32_t &running_migrations);
+    void start_migration(const disk_migration &migration);
+
+    replica_stub *_stub{nullptr};
+    task_ptr _timer_task;
+
+    mutable zlock _lock; // [ lock
+    // device -> last sample
+    std::map<std::string, io_sample> _io_samples;
+    std::string _last_round;
+    // ] end of lock
+
+    DISALLOW_COPY_AND_ASSIGN(disk_balancer);
+};
+
+} // namespace replication
+} // namespace dsn
@@ -55,7 +55,7 @@ namespace replication {
 //                     //
 
 /*static*/ std::function<std::unique_ptr<mutation_duplicator>(
-    replica_base *, std::string_view /*remote cluster*/, std::string_view /*app*/)>
+    replica_base *, dupid_t, std::string_view /*remote cluster*/, std::string_view /*app*/)>
     mutation_duplicator::creator;
 
 //               //
@@ -133,8 +133,10 @@ ship_mutation::ship_mutation(replica_duplicator *duplicator)
       _stub(duplicator->_replica->get_replica_stub()),
       METRIC_VAR_INIT_replica(dup_shipped_bytes)
 {
-    _mutation_duplicator = new_mutation_duplicator(
-        duplicator, duplicator->remote_cluster_name(), duplicator->remote_app_name());
+    _mutation_duplicator = new_mutation_duplicator(duplicator,
+                                                   duplicator->id(),
+                                                   duplicator->remote_cluster_name(),
+                                                   duplicator->remote_app_name());
     _mutation_duplicator->set_task_environment(duplicator);
 }
 
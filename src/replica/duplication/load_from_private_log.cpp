@@ -258,7 +258,9 @@ void load_from_private_log::replay_log_block()
 
     if (err.is_ok()) {
         _start_offset = static_cast<size_t>(_current_global_end_offset - _current->start_offset());
-        if (_mutation_batch.bytes() < FLAGS_duplicate_log_batch_bytes) {
+        // Load enough mutations to fill up all the in-flight rpcs of the shipping stage.
+        if (_mutation_batch.bytes() <
+            static_cast<uint64_t>(FLAGS_duplicate_log_batch_bytes) * FLAGS_dup_max_inflight_rpcs) {
             repeat();
             return;
         }
@@ -270,7 +272,7 @@ void load_from_private_log::replay_log_block()
     }
     // update last_decree even for empty batch.
     // case1: err.is_ok(err.code() != ERR_HANDLE_EOF), but _mutation_batch.bytes() >=
-    // FLAGS_duplicate_log_batch_bytes
+    // FLAGS_duplicate_log_batch_bytes * FLAGS_dup_max_inflight_rpcs
     // case2: !err.is_ok(err.code() == ERR_HANDLE_EOF) and no next file, need commit the last
     // mutations()
     step_down_next_stage(_mutation_batch.last_decree(), _mutation_batch.move_all_mutations());
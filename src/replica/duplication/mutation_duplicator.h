@@ -18,6 +18,7 @@
 #pragma once
 
 #include "utils/errors.h"
+#include "common/duplication_common.h"
 #include "meta_admin_types.h"
 #include "partition_split_types.h"
 #include "duplication_types.h"
@@ -67,8 +68,10 @@ public:
     virtual void duplicate(mutation_tuple_set mutations, callback cb) = 0;
 
     // Singleton creator of mutation_duplicator.
-    static std::function<std::unique_ptr<mutation_duplicator>(
-        replica_base *, std::string_view /*remote cluster*/, std::string_view /*app name*/)>
+    static std::function<std::unique_ptr<mutation_duplicator>(replica_base *,
+                                                              dupid_t,
+                                                              std::string_view /*remote cluster*/,
+                                                              std::string_view /*app name*/)>
         creator;
 
     explicit mutation_duplicator(replica_base *r) : replica_base(r) {}
@@ -84,9 +87,9 @@ protected:
 };
 
 inline std::unique_ptr<mutation_duplicator> new_mutation_duplicator(
-    replica_base *r, std::string_view remote_cluster_address, std::string_view app)
+    replica_base *r, dupid_t dupid, std::string_view remote_cluster_address, std::string_view app)
 {
-    return mutation_duplicator::creator(r, remote_cluster_address, app);
+    return mutation_duplicator::creator(r, dupid, remote_cluster_address, app);
 }
 
 } // namespace replication
@@ -82,6 +82,13 @@ DSN_DEFINE_group_validator(max_mutation_count_in_prepare_list, [](std::string &m
     }
     return true;
 });
+DSN_DEFINE_uint32(replication,
+                  load_stats_min_interval_ms,
+                  10000,
+                  "The minimum interval over which the request rates reported to meta server are "
+                  "averaged, the rates of the last interval are reported if the replica info is "
+                  "collected more frequently than this");
+DSN_TAG_VARIABLE(load_stats_min_interval_ms, FT_MUTABLE);
 
 DSN_DECLARE_int32(checkpoint_max_interval_hours);
 
@@ -125,6 +132,17 @@ METRIC_DEFINE_counter(replica,
                       dsn::metric_unit::kRequests,
                       "The number of rejected backup requests by throttling");
 
+METRIC_DEFINE_counter(replica,
+                      bounded_staleness_read_requests,
+                      dsn::metric_unit::kRequests,
+                      "The number of bounded-staleness read requests served by secondary");
+
+METRIC_DEFINE_counter(replica,
+                      stale_rejected_read_requests,
+                      dsn::metric_unit::kRequests,
+                      "The number of bounded-staleness read requests rejected by secondary since "
+                      "the staleness bound could not be satisfied");
+
 METRIC_DEFINE_counter(replica,
                       splitting_rejected_write_requests,
                       dsn::metric_unit::kRequests,
@@ -293,6 +311,8 @@ replica::replica(replica_stub *stub,
       METRIC_VAR_INIT_replica(backup_requests),
       METRIC_VAR_INIT_replica(throttling_delayed_backup_requests),
       METRIC_VAR_INIT_replica(throttling_rejected_backup_requests),
+      METRIC_VAR_INIT_replica(bounded_staleness_read_requests),
+      METRIC_VAR_INIT_replica(stale_rejected_read_requests),
       METRIC_VAR_INIT_replica(splitting_rejected_write_requests),
       METRIC_VAR_INIT_replica(splitting_rejected_read_requests),
       METRIC_VAR_INIT_replica(bulk_load_ingestion_rejected_write_requests),
@@ -385,6 +405,8 @@ replica::~replica()
 
 void replica::on_client_read(dsn::message_ex *request, bool ignore_throttling)
 {
+    _client_requests.fetch_add(1, std::memory_order_relaxed);
+
     if (!_access_controller->allowed(request, ranger::access_type::kRead)) {
         response_client_read(request, ERR_ACL_DENY);
         return;
@@ -411,19 +433,27 @@ void replica::on_client_read(dsn::message_ex *request, bool ignore_throttling)
     }
 
     if (!request->is_backup_request()) {
-        // only backup request is allowed to read from a stale replica
+        // only backup request and bounded-staleness read are allowed to read from a stale
+        // replica
 
         if (!ignore_throttling && throttle_read_request(request)) {
             return;
         }
 
-        if (status() != partition_status::PS_PRIMARY) {
+        if (status() == partition_status::PS_SECONDARY && request->is_bounded_staleness_read()) {
+            // a secondary could serve the read only if the staleness bound is satisfied,
+            // otherwise the client would retry it on the primary
+            if (!is_read_staleness_bound_satisfied(request->get_read_staleness_bound())) {
+                METRIC_VAR_INCREMENT(stale_rejected_read_requests);
+                response_client_read(request, ERR_STALE_REPLICA);
+                return;
+            }
+            METRIC_VAR_INCREMENT(bounded_staleness_read_requests);
+        } else if (status() != partition_status::PS_PRIMARY) {
             response_client_read(request, ERR_INVALID_STATE);
             return;
-        }
-
-        // a small window where the state is not the latest yet
-        if (last_committed_decree() < _primary_states.last_prepare_decree_on_new_primary) {
+        } else if (last_committed_decree() < _primary_states.last_prepare_decree_on_new_primary) {
+            // a small window where the state is not the latest yet
             LOG_ERROR_PREFIX("last_committed_decree({}) < last_prepare_decree_on_new_primary({})",
                              last_committed_decree(),
                              _primary_states.last_prepare_decree_on_new_primary);
@@ -459,6 +489,20 @@ void replica::on_client_read(dsn::message_ex *request, bool ignore_throttling)
     }
 }
 
+bool replica::is_read_staleness_bound_satisfied(const read_staleness_bound &bound) const
+{
+    switch (bound.type) {
+    case read_staleness_bound_type::kMinCommittedDecree:
+        return last_committed_decree() >= static_cast<decree>(bound.value);
+    case read_staleness_bound_type::kMaxStalenessMs:
+        // The data is not staler than the primary at the time last caught up with it.
+        return _secondary_states.last_caught_up_with_primary_ms > 0 &&
+               dsn_now_ms() <= _secondary_states.last_caught_up_with_primary_ms + bound.value;
+    default:
+        return false;
+    }
+}
+
 void replica::response_client_read(dsn::message_ex *request, error_code error)
 {
     _stub->response_client(get_gpid(), true, request, status(), error);
@@ -696,6 +740,39 @@ manual_compaction_status::type replica::get_manual_compact_status() const
     return _app->query_compact_status();
 }
 
+void replica::get_load_stats(/*out*/ replica_info &info)
+{
+    CHECK_PREFIX(_app);
+    replica_load_stats stats;
+    _app->query_load_stats(stats);
+    const auto requests = _client_requests.load(std::memory_order_relaxed);
+    const auto now_ms = dsn_now_ms();
+
+    zauto_lock l(_load_stats_lock);
+    auto &last = _load_snapshot;
+    const auto elapsed_ms = now_ms - last.time_ms;
+    if (last.time_ms == 0 || elapsed_ms >= FLAGS_load_stats_min_interval_ms) {
+        if (last.time_ms != 0 && elapsed_ms > 0) {
+            // The accumulated values could go backwards after the storage engine is reopened.
+            const auto rate = [elapsed_ms](int64_t prev, int64_t cur) -> int64_t {
+                return cur > prev ? (cur - prev) * 1000 / static_cast<int64_t>(elapsed_ms) : 0;
+            };
+            last.read_cu_per_sec = rate(last.read_cu, stats.read_cu);
+            last.write_cu_per_sec = rate(last.write_cu, stats.write_cu);
+            last.qps = rate(last.requests, requests);
+        }
+        last.time_ms = now_ms;
+        last.read_cu = stats.read_cu;
+        last.write_cu = stats.write_cu;
+        last.requests = requests;
+    }
+
+    info.__set_storage_mb(stats.storage_mb);
+    info.__set_read_cu_per_sec(last.read_cu_per_sec);
+    info.__set_write_cu_per_sec(last.write_cu_per_sec);
+    info.__set_qps(last.qps);
+}
+
 void replica::on_detect_hotkey(const detect_hotkey_request &req, detect_hotkey_response &resp)
 {
     _app->on_detect_hotkey(req, resp);
@@ -62,6 +62,7 @@
 #include "utils/thread_access_checker.h"
 #include "utils/throttling_controller.h"
 #include "utils/uniq_timestamp_us.h"
+#include "utils/zlocks.h"
 #include "utils_types.h"
 
 namespace pegasus::server {
@@ -91,6 +92,7 @@ class detect_hotkey_request;
 class detect_hotkey_response;
 class group_check_request;
 class group_check_response;
+class read_staleness_heartbeat;
 class learn_notify_response;
 class learn_request;
 class learn_response;
@@ -209,6 +211,7 @@ public:
     void on_add_learner(const group_check_request &request);
     void on_remove(const replica_configuration &request);
     void on_group_check(const group_check_request &request, /*out*/ group_check_response &response);
+    void on_read_staleness_heartbeat(const read_staleness_heartbeat &heartbeat);
 
     //
     //    messsages from liveness monitor
@@ -372,6 +375,8 @@ private:
     void init_state();
     void response_client_read(dsn::message_ex *request, error_code error);
     void response_client_write(dsn::message_ex *request, error_code error);
+    // Whether this secondary replica satisfies the staleness bound of a read request.
+    bool is_read_staleness_bound_satisfied(const read_staleness_bound &bound) const;
     void execute_mutation(mutation_ptr &mu);
 
     // Create a new mutation with specified decree.
@@ -582,6 +587,10 @@ private:
     void on_group_check_reply(error_code err,
                               const std::shared_ptr<group_check_request> &req,
                               const std::shared_ptr<group_check_response> &resp);
+    void broadcast_read_staleness_heartbeat();
+    // Record the time when this secondary has committed up to the committed decree of the
+    // primary, which bounds its staleness for the bounded-staleness reads.
+    void update_caught_up_with_primary(decree primary_committed_decree);
 
     /////////////////////////////////////////////////////////////////
     // check timer for gc, checkpointing etc.
@@ -651,6 +660,10 @@ private:
 
     manual_compaction_status::type get_manual_compact_status() const;
 
+    // Fill the storage size and the request rates of this replica into `info`, which are
+    // reported to meta server for load-aware balance.
+    void get_load_stats(/*out*/ replica_info &info);
+
     void on_detect_hotkey(const detect_hotkey_request &req, /*out*/ detect_hotkey_response &resp);
 
     uint32_t query_data_version() const;
@@ -669,6 +682,8 @@ private:
     void update_throttle_env_internal(const std::map<std::string, std::string> &envs,
                                       const std::string &key,
                                       utils::throttling_controller &cntl);
+    /// update the CU budgets distributed by meta server, 0 means unlimited
+    void update_cu_budgets(int64_t read_cu_per_sec, int64_t write_cu_per_sec);
 
     // update allowed users for access controller
     void update_ac_allowed_users(const std::map<std::string, std::string> &envs);
@@ -771,6 +786,24 @@ private:
 
     std::atomic<bool> _plog_gc_enabled{true};
 
+    // The number of client requests received by this replica, including the rejected ones.
+    std::atomic<int64_t> _client_requests{0};
+
+    // The accumulated load at the last report and the rates calculated from it, protected by
+    // _load_stats_lock since the replica info could be collected concurrently.
+    struct load_snapshot
+    {
+        uint64_t time_ms{0};
+        int64_t read_cu{0};
+        int64_t write_cu{0};
+        int64_t requests{0};
+        int64_t read_cu_per_sec{0};
+        int64_t write_cu_per_sec{0};
+        int64_t qps{0};
+    };
+    zlock _load_stats_lock;
+    load_snapshot _load_snapshot;
+
     // application
     std::unique_ptr<replication_app_base> _app;
 
@@ -859,6 +892,8 @@ private:
     METRIC_VAR_DECLARE_counter(backup_requests);
     METRIC_VAR_DECLARE_counter(throttling_delayed_backup_requests);
     METRIC_VAR_DECLARE_counter(throttling_rejected_backup_requests);
+    METRIC_VAR_DECLARE_counter(bounded_staleness_read_requests);
+    METRIC_VAR_DECLARE_counter(stale_rejected_read_requests);
     METRIC_VAR_DECLARE_counter(splitting_rejected_write_requests);
     METRIC_VAR_DECLARE_counter(splitting_rejected_read_requests);
     METRIC_VAR_DECLARE_counter(bulk_load_ingestion_rejected_write_requests);
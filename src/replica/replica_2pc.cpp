@@ -113,6 +113,7 @@ namespace replication {
 void replica::on_client_write(dsn::message_ex *request, bool ignore_throttling)
 {
     _checker.only_one_thread_access();
+    _client_requests.fetch_add(1, std::memory_order_relaxed);
 
     if (!_access_controller->allowed(request, ranger::access_type::kWrite)) {
         response_client_write(request, ERR_ACL_DENY);
@@ -637,6 +638,7 @@ void replica::on_prepare(dsn::message_ex *request)
                      "last_committed_decree: {}, FLAGS_max_mutation_count_in_prepare_list: {}",
                      last_committed_decree(),
                      FLAGS_max_mutation_count_in_prepare_list);
+        update_caught_up_with_primary(mu->data.header.last_committed_decree);
     } else {
         LOG_ERROR_PREFIX("mutation {} on_prepare failed as invalid replica state, state = {}",
                          mu->name(),
@@ -696,6 +698,7 @@ void replica::on_append_log_completed(mutation_ptr &mu, error_code err, size_t s
             ack_prepare_message(err, mu);
             // all mutations with lower decree must be ready
             _prepare_list->commit(mu->data.header.last_committed_decree, COMMIT_TO_DECREE_HARD);
+            update_caught_up_with_primary(mu->data.header.last_committed_decree);
             break;
         case partition_status::PS_PARTITION_SPLIT:
             if (err != ERR_OK) {
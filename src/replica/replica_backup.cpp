@@ -64,6 +64,14 @@ DSN_DEFINE_uint64(replication,
                   10,
                   "concurrent uploading file count to block service");
 
+DSN_DEFINE_bool(replication,
+                cold_backup_incremental,
+                false,
+                "whether to store the sst files of cold backups in the shared files directory of "
+                "the policy, so that the files already uploaded by the previous backups of the "
+                "policy are not uploaded again");
+DSN_TAG_VARIABLE(cold_backup_incremental, FT_MUTABLE);
+
 DSN_DECLARE_string(cold_backup_root);
 
 namespace dsn {
@@ -115,6 +123,7 @@ void replica::on_cold_backup(const backup_request &request, /*out*/ backup_respo
                                               ? dsn::utils::filesystem::path_combine(
                                                     request.backup_path, FLAGS_cold_backup_root)
                                               : FLAGS_cold_backup_root;
+            backup_context->incremental = FLAGS_cold_backup_incremental;
         }
 
         CHECK_EQ_PREFIX(backup_context->request.policy.policy_name, policy_name);
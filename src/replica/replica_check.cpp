@@ -75,6 +75,17 @@ DSN_DEFINE_int32(
     100000,
     "The interval in milliseconds for the primary replicas to send group-check requests");
 
+DSN_DEFINE_uint32(replication,
+                  read_staleness_heartbeat_interval_ms,
+                  0,
+                  "The interval in milliseconds for the primary replicas of idle partitions to "
+                  "send their committed decree to the secondary replicas, which bounds the "
+                  "staleness of the bounded-staleness reads on the secondaries. 0 means disabled, "
+                  "in which case the secondaries of the idle partitions learn the committed "
+                  "decree only from group check. It should be enabled only after all of the "
+                  "replica servers are upgraded to support RPC_READ_STALENESS_HEARTBEAT, and "
+                  "only if the clients use bounded-staleness reads with max staleness");
+
 DSN_DECLARE_bool(empty_write_disabled);
 
 namespace dsn {
@@ -88,7 +99,20 @@ void replica::init_group_check()
 
     LOG_INFO_PREFIX("init group check");
 
-    if (partition_status::PS_PRIMARY != status() || FLAGS_group_check_disabled)
+    if (partition_status::PS_PRIMARY != status())
+        return;
+
+    if (FLAGS_read_staleness_heartbeat_interval_ms > 0) {
+        CHECK(nullptr == _primary_states.read_staleness_heartbeat_task, "");
+        _primary_states.read_staleness_heartbeat_task = tasking::enqueue_timer(
+            LPC_READ_STALENESS_HEARTBEAT,
+            &_tracker,
+            [this] { broadcast_read_staleness_heartbeat(); },
+            std::chrono::milliseconds(FLAGS_read_staleness_heartbeat_interval_ms),
+            get_gpid().thread_hash());
+    }
+
+    if (FLAGS_group_check_disabled)
         return;
 
     CHECK(nullptr == _primary_states.group_check_task, "");
@@ -100,6 +124,60 @@ void replica::init_group_check()
         get_gpid().thread_hash());
 }
 
+void replica::broadcast_read_staleness_heartbeat()
+{
+    _checker.only_one_thread_access();
+
+    if (partition_status::PS_PRIMARY != status()) {
+        return;
+    }
+
+    // The secondaries of a busy partition learn the committed decree from the prepares.
+    if (dsn_now_ms() <
+        _primary_states.last_prepare_ts_ms + FLAGS_read_staleness_heartbeat_interval_ms) {
+        return;
+    }
+
+    read_staleness_heartbeat heartbeat;
+    heartbeat.pid = get_gpid();
+    heartbeat.ballot = get_ballot();
+    heartbeat.last_committed_decree = last_committed_decree();
+    for (const auto &[hp, st] : _primary_states.statuses) {
+        if (st != partition_status::PS_SECONDARY || hp == _stub->primary_host_port()) {
+            continue;
+        }
+
+        rpc::call_one_way_typed(dsn::dns_resolver::instance().resolve_address(hp),
+                                RPC_READ_STALENESS_HEARTBEAT,
+                                heartbeat,
+                                get_gpid().thread_hash());
+    }
+}
+
+void replica::on_read_staleness_heartbeat(const read_staleness_heartbeat &heartbeat)
+{
+    _checker.only_one_thread_access();
+
+    if (partition_status::PS_SECONDARY != status() || heartbeat.ballot != get_ballot()) {
+        return;
+    }
+
+    // Unlike group check, only commit the mutations that are ready: the heartbeat may arrive
+    // before the prepares that it covers have been logged.
+    if (heartbeat.last_committed_decree > last_committed_decree()) {
+        _prepare_list->commit(heartbeat.last_committed_decree, COMMIT_TO_DECREE_SOFT);
+    }
+    update_caught_up_with_primary(heartbeat.last_committed_decree);
+}
+
+void replica::update_caught_up_with_primary(decree primary_committed_decree)
+{
+    if (partition_status::PS_SECONDARY == status() &&
+        last_committed_decree() >= primary_committed_decree) {
+        _secondary_states.last_caught_up_with_primary_ms = dsn_now_ms();
+    }
+}
+
 void replica::broadcast_group_check()
 {
     FAIL_POINT_INJECT_F("replica_broadcast_group_check", [](std::string_view) {});
@@ -212,6 +290,7 @@ void replica::on_group_check(const group_check_request &request,
         if (request.last_committed_decree > last_committed_decree()) {
             _prepare_list->commit(request.last_committed_decree, COMMIT_TO_DECREE_HARD);
         }
+        update_caught_up_with_primary(request.last_committed_decree);
         // the group check may trigger start/finish/cancel/pause a split on the secondary.
         _split_mgr->trigger_secondary_parent_split(request, response);
         response.__set_disk_status(_dir_node->status);
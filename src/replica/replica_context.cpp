@@ -46,6 +46,7 @@ void primary_context::cleanup(bool clean_pending_mutations)
 
     // clean up group check
     CLEANUP_TASK_ALWAYS(group_check_task)
+    CLEANUP_TASK_ALWAYS(read_staleness_heartbeat_task)
 
     for (auto it = group_check_pending_replies.begin(); it != group_check_pending_replies.end();
          ++it) {
@@ -199,6 +200,7 @@ bool secondary_context::cleanup(bool force)
     CLEANUP_TASK(catchup_with_private_log_task, force)
 
     checkpoint_is_running = false;
+    last_caught_up_with_primary_ms = 0;
     return true;
 }
 
@@ -135,6 +135,10 @@ public:
     node_tasks group_check_pending_replies; // group check response tasks of RPC_GROUP_CHECK for
                                             // each replica
 
+    // the repeated task of LPC_READ_STALENESS_HEARTBEAT which calls
+    // broadcast_read_staleness_heartbeat(), created in replica::init_group_check()
+    dsn::task_ptr read_staleness_heartbeat_task;
+
     // reconfiguration task of RPC_CM_UPDATE_PARTITION_CONFIGURATION
     dsn::task_ptr reconfiguration_task;
 
@@ -193,12 +197,16 @@ public:
 class secondary_context
 {
 public:
-    secondary_context() : checkpoint_is_running(false) {}
+    secondary_context() : checkpoint_is_running(false), last_caught_up_with_primary_ms(0) {}
     bool cleanup(bool force);
     bool is_cleaned();
 
 public:
     bool checkpoint_is_running;
+    // The last time that this secondary has committed all the mutations committed by the
+    // primary, as told by prepare, group check or read staleness heartbeat. The data is not
+    // staler than the primary at that time, which is used for the bounded-staleness reads.
+    uint64_t last_caught_up_with_primary_ms;
     ::dsn::task_ptr checkpoint_task;
     ::dsn::task_ptr checkpoint_completed_task;
     ::dsn::task_ptr catchup_with_private_log_task;
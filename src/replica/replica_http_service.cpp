@@ -29,6 +29,7 @@
 #include "common/duplication_common.h"
 #include "common/gpid.h"
 #include "duplication/duplication_sync_timer.h"
+#include "replica/disk_balancer.h"
 #include "http/http_server.h"
 #include "http/http_status_code.h"
 #include "replica/replica_stub.h"
@@ -166,6 +167,33 @@ void replica_http_service::query_manual_compaction_handler(const http_request &r
     resp.body = json.dump();
 }
 
+void replica_http_service::query_disk_balance_handler(const http_request &req,
+                                                      http_response &resp)
+{
+    if (!_stub->_disk_balancer) {
+        resp.body = "disk balancer is not started";
+        resp.status_code = http_status_code::kNotFound;
+        return;
+    }
+
+    bool dry_run = false;
+    auto it = req.query_args.find("dry_run");
+    if (it != req.query_args.end() && !buf2bool(it->second, dry_run)) {
+        resp.body = fmt::format("invalid dry_run={}", it->second);
+        resp.status_code = http_status_code::kBadRequest;
+        return;
+    }
+
+    resp.body =
+        dry_run ? _stub->_disk_balancer->balance(true) : _stub->_disk_balancer->last_round();
+    if (resp.body.empty()) {
+        resp.body = "no round of disk balancer has run [replication.disk_balancer_enabled]";
+        resp.status_code = http_status_code::kNotFound;
+        return;
+    }
+    resp.status_code = http_status_code::kOk;
+}
+
 void replica_http_service::update_config(const std::string &name) { _stub->update_config(name); }
 
 } // namespace replication
@@ -53,6 +53,14 @@ public:
                                    std::placeholders::_2),
                          "app_id=<app_id>",
                          "Query the manual compaction status of an app.");
+        register_handler("disk_balance",
+                         std::bind(&replica_http_service::query_disk_balance_handler,
+                                   this,
+                                   std::placeholders::_1,
+                                   std::placeholders::_2),
+                         "dry_run=<true|false>",
+                         "Query the last round of the disk balancer, or plan a round without "
+                         "starting the migrations if dry_run is true.");
     }
 
     ~replica_http_service()
@@ -60,6 +68,7 @@ public:
         deregister_http_call("replica/duplication");
         deregister_http_call("replica/data_version");
         deregister_http_call("replica/manual_compaction");
+        deregister_http_call("replica/disk_balance");
     }
 
     std::string path() const override { return replication_options::kReplicaAppType; }
@@ -67,6 +76,7 @@ public:
     void query_duplication_handler(const http_request &req, http_response &resp);
     void query_app_data_version_handler(const http_request &req, http_response &resp);
     void query_manual_compaction_handler(const http_request &req, http_response &resp);
+    void query_disk_balance_handler(const http_request &req, http_response &resp);
 
     inline const char *manual_compaction_status_to_string(manual_compaction_status::type status)
     {
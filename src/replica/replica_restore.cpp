@@ -58,6 +58,22 @@ using namespace dsn::dist::block_service;
 
 namespace dsn {
 namespace replication {
+namespace {
+
+// The root of the backups on block service, which is composed the same way when backing up.
+std::string get_restore_backup_root(const configuration_restore_request &req)
+{
+    std::string backup_root = req.cluster_name;
+    if (!req.restore_path.empty()) {
+        backup_root = dsn::utils::filesystem::path_combine(req.restore_path, backup_root);
+    }
+    if (!req.policy_name.empty()) {
+        backup_root = dsn::utils::filesystem::path_combine(backup_root, req.policy_name);
+    }
+    return backup_root;
+}
+
+} // anonymous namespace
 
 bool replica::remove_useless_file_under_chkpt(const std::string &chkpt_dir,
                                               const cold_backup_metadata &metadata)
@@ -108,15 +124,22 @@ error_code replica::download_checkpoint(const configuration_restore_request &req
     }
 
     // download checkpoint files
+    const std::string backup_root = get_restore_backup_root(req);
     task_tracker tracker;
     for (const auto &f_meta : backup_metadata.files) {
+        // the sst files of an incremental backup are stored in the shared files directory
+        std::string remote_dir = remote_chkpt_dir;
+        if (!backup_metadata.shared_files_dir.empty() && cold_backup::is_shared_file(f_meta.name)) {
+            remote_dir = cold_backup::get_shared_file_dir(
+                backup_root, backup_metadata.shared_files_dir, f_meta);
+        }
         tasking::enqueue(
             TASK_CODE_EXEC_INLINED,
             &tracker,
-            [this, &err, remote_chkpt_dir, local_chkpt_dir, f_meta, fs]() {
+            [this, &err, remote_dir, local_chkpt_dir, f_meta, fs]() {
                 uint64_t f_size = 0;
                 error_code download_err = _stub->_block_service_manager.download_file(
-                    remote_chkpt_dir, local_chkpt_dir, f_meta.name, fs, f_size);
+                    remote_dir, local_chkpt_dir, f_meta.name, fs, f_size);
                 const std::string file_name =
                     utils::filesystem::path_combine(local_chkpt_dir, f_meta.name);
                 if (download_err == ERR_OK || download_err == ERR_PATH_ALREADY_EXIST) {
@@ -226,13 +249,7 @@ dsn::error_code replica::find_valid_checkpoint(const configuration_restore_reque
     dsn::gpid old_gpid;
     old_gpid.set_app_id(req.app_id);
     old_gpid.set_partition_index(_config.pid.get_partition_index());
-    std::string backup_root = req.cluster_name;
-    if (!req.restore_path.empty()) {
-        backup_root = dsn::utils::filesystem::path_combine(req.restore_path, backup_root);
-    }
-    if (!req.policy_name.empty()) {
-        backup_root = dsn::utils::filesystem::path_combine(backup_root, req.policy_name);
-    }
+    const std::string backup_root = get_restore_backup_root(req);
     int64_t backup_id = req.time_stamp;
 
     std::string manifest_file =
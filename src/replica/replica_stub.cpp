@@ -51,6 +51,7 @@
 #include "common/json_helper.h"
 #include "common/replication.codes.h"
 #include "common/replication_enums.h"
+#include "disk_balancer.h"
 #include "disk_cleaner.h"
 #include "duplication/duplication_sync_timer.h"
 #include "meta_admin_types.h"
@@ -968,6 +969,9 @@ void replica_stub::initialize_start()
         _duplication_sync_timer->start();
     }
 
+    _disk_balancer = std::make_unique<disk_balancer>(this);
+    _disk_balancer->start();
+
     _backup_server = std::make_unique<replica_backup_server>(this);
 
     // init liveness monitor
@@ -1483,6 +1487,18 @@ void replica_stub::on_remove(const replica_configuration &request)
     }
 }
 
+void replica_stub::on_read_staleness_heartbeat(const read_staleness_heartbeat &heartbeat)
+{
+    if (!is_connected()) {
+        return;
+    }
+
+    replica_ptr rep = get_replica(heartbeat.pid);
+    if (rep != nullptr) {
+        rep->on_read_staleness_heartbeat(heartbeat);
+    }
+}
+
 void replica_stub::get_replica_info(replica_info &info, replica_ptr r)
 {
     info.pid = r->get_gpid();
@@ -1494,6 +1510,7 @@ void replica_stub::get_replica_info(replica_info &info, replica_ptr r)
     info.last_durable_decree = r->last_durable_decree();
     info.disk_tag = r->get_dir_node()->tag;
     info.__set_manual_compact_status(r->get_manual_compact_status());
+    r->get_load_stats(info);
 }
 
 void replica_stub::get_local_replicas(std::vector<replica_info> &replicas)
@@ -1699,6 +1716,8 @@ void replica_stub::on_node_query_reply_scatter(replica_stub_ptr this_,
                                 req.config,
                                 req.__isset.meta_split_status ? req.meta_split_status
                                                               : split_status::NOT_SPLIT);
+        replica->update_cu_budgets(req.__isset.read_cu_budget ? req.read_cu_budget : 0,
+                                   req.__isset.write_cu_budget ? req.write_cu_budget : 0);
     } else {
         if (req.config.hp_primary == _primary_host_port) {
             LOG_INFO("{}@{}: replica not exists on replica server, which is primary, remove it "
@@ -1819,6 +1838,14 @@ void replica_stub::response_client(gpid id,
         } else {
             METRIC_VAR_INCREMENT(write_busy_requests);
         }
+    } else if (error == ERR_STALE_REPLICA) {
+        // The bounded-staleness reads rejected by a lagging secondary are expected to be retried
+        // on the primary by the client, and have been counted by the replica.
+        LOG_DEBUG("{}@{}: reject stale read: client = {}, status = {}",
+                  id,
+                  _primary_host_port_cache,
+                  request == nullptr ? "null" : request->header->from_address.to_string(),
+                  enum_to_string(status));
     } else if (error != ERR_OK) {
         if (is_read) {
             METRIC_VAR_INCREMENT(read_failed_requests);
@@ -2494,6 +2521,9 @@ void replica_stub::open_service()
     register_rpc_handler(RPC_REMOVE_REPLICA, "remove", &replica_stub::on_remove);
     register_rpc_handler_with_rpc_holder(
         RPC_GROUP_CHECK, "GroupCheck", &replica_stub::on_group_check);
+    register_rpc_handler(RPC_READ_STALENESS_HEARTBEAT,
+                         "read_staleness_heartbeat",
+                         &replica_stub::on_read_staleness_heartbeat);
     register_rpc_handler_with_rpc_holder(
         RPC_QUERY_PN_DECREE, "query_decree", &replica_stub::on_query_decree);
     register_rpc_handler_with_rpc_holder(
@@ -2874,6 +2904,11 @@ void replica_stub::close()
         _duplication_sync_timer = nullptr;
     }
 
+    if (_disk_balancer != nullptr) {
+        _disk_balancer->close();
+        _disk_balancer = nullptr;
+    }
+
     if (_config_query_task != nullptr) {
         _config_query_task->cancel(true);
         _config_query_task = nullptr;
@@ -138,6 +138,7 @@ class replica_stub;
 
 typedef dsn::ref_ptr<replica_stub> replica_stub_ptr;
 
+class disk_balancer;
 class duplication_sync_timer;
 class replica_backup_server;
 
@@ -190,6 +191,7 @@ public:
     void on_add_learner(const group_check_request &request);
     void on_remove(const replica_configuration &request);
     void on_group_check(group_check_rpc rpc);
+    void on_read_staleness_heartbeat(const read_staleness_heartbeat &heartbeat);
     void on_group_bulk_load(group_bulk_load_rpc rpc);
 
     //
@@ -493,6 +495,7 @@ private:
     friend class replica_disk_migrator;
     friend class mock_replica_stub;
     friend class duplication_sync_timer;
+    friend class disk_balancer;
     friend class duplication_sync_timer_test;
     friend class replica_duplicator_manager_test;
     friend class duplication_test_base;
@@ -547,6 +550,7 @@ private:
     ::dsn::task_ptr _mem_release_timer_task;
 
     std::unique_ptr<duplication_sync_timer> _duplication_sync_timer;
+    std::unique_ptr<disk_balancer> _disk_balancer;
     std::unique_ptr<replica_backup_server> _backup_server;
     std::unique_ptr<dsn::security::kms_key_provider> _key_provider;
 
@@ -26,6 +26,7 @@
 #include "common/replication.codes.h"
 #include "dsn.layer2_types.h"
 #include "replica.h"
+#include "replica/replication_app_base.h"
 #include "rpc/rpc_message.h"
 #include "task/async_calls.h"
 #include "utils/autoref_ptr.h"
@@ -74,6 +75,11 @@ bool replica::throttle_write_request(message_ex *request)
 {
     THROTTLE_REQUEST(write, qps, request, 1);
     THROTTLE_REQUEST(write, size, request, request->body_size());
+    if (_app->is_write_cu_budget_exhausted()) {
+        response_client_write(request, ERR_BUSY);
+        METRIC_VAR_INCREMENT(throttling_rejected_write_requests);
+        return true;
+    }
     return false;
 }
 
@@ -118,6 +124,12 @@ void replica::update_throttle_envs(const std::map<std::string, std::string> &env
                                  _backup_request_qps_throttling_controller);
 }
 
+void replica::update_cu_budgets(int64_t read_cu_per_sec, int64_t write_cu_per_sec)
+{
+    CHECK_PREFIX(_app);
+    _app->update_cu_budgets(read_cu_per_sec, write_cu_per_sec);
+}
+
 void replica::update_throttle_env_internal(const std::map<std::string, std::string> &envs,
                                            const std::string &key,
                                            utils::throttling_controller &cntl)
@@ -106,6 +106,15 @@ struct kms_info
     }
 };
 
+// The accumulated load of a replica reported by the storage engine. Replica turns the
+// accumulated values into rates before reporting them to meta server.
+struct replica_load_stats
+{
+    int64_t storage_mb = 0;
+    int64_t read_cu = 0;
+    int64_t write_cu = 0;
+};
+
 /// The store engine interface of Pegasus.
 /// Inherited by pegasus::pegasus_server_impl
 /// Inherited by apps::rrdb_service
@@ -325,6 +334,17 @@ public:
 
     [[nodiscard]] virtual manual_compaction_status::type query_compact_status() const = 0;
 
+    // Query the storage size and the accumulated capacity units of this replica. The default
+    // implementation reports nothing, which makes the replica look idle to the balancer.
+    virtual void query_load_stats(/*out*/ replica_load_stats &stats) const {}
+
+    // Update the read and write capacity units per second this replica is allowed to serve,
+    // which are distributed by meta server from the CU quotas of the table, 0 means unlimited.
+    virtual void update_cu_budgets(int64_t read_cu_per_sec, int64_t write_cu_per_sec) {}
+
+    // Whether the write CU budget has been used up, then the write requests are rejected.
+    [[nodiscard]] virtual bool is_write_cu_budget_exhausted() const { return false; }
+
     //
     // utility functions to be used by app
     //
@@ -0,0 +1,148 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "common/gpid.h"
+#include "gtest/gtest.h"
+#include "replica/disk_balancer.h"
+
+namespace dsn {
+namespace replication {
+
+namespace {
+
+disk_load make_disk(const std::string &tag, double io_util, int64_t available_mb)
+{
+    disk_load disk;
+    disk.tag = tag;
+    disk.device = "dev_" + tag;
+    disk.io_util = io_util;
+    disk.capacity_mb = 1000;
+    disk.available_mb = available_mb;
+    return disk;
+}
+
+replica_disk_load make_replica(int32_t partition_index,
+                               const std::string &disk_tag,
+                               int64_t storage_mb,
+                               int64_t write_cu_per_sec)
+{
+    replica_disk_load r;
+    r.pid = gpid(1, partition_index);
+    r.disk_tag = disk_tag;
+    r.storage_mb = storage_mb;
+    r.write_cu_per_sec = write_cu_per_sec;
+    r.movable = true;
+    return r;
+}
+
+disk_balance_options make_options()
+{
+    disk_balance_options options;
+    options.max_migrations = 3;
+    options.max_migration_mb = 1000;
+    options.io_util_threshold = 0.2;
+    options.space_ratio_threshold = 10;
+    options.min_available_space_ratio = 10;
+    return options;
+}
+
+} // anonymous namespace
+
+TEST(disk_balancer_test, plan_for_io)
+{
+    const std::vector<disk_load> disks = {
+        make_disk("d1", 0.9, 500), make_disk("d2", 0.1, 500), make_disk("d3", 0.2, 500)};
+    const std::vector<replica_disk_load> replicas = {make_replica(0, "d1", 10, 600),
+                                                     make_replica(1, "d1", 10, 200),
+                                                     make_replica(2, "d1", 10, 100),
+                                                     make_replica(3, "d1", 10, 100)};
+    auto options = make_options();
+    options.max_migrations = 2;
+
+    // The hottest replica is not moved, which would make the idlest disk the busiest one.
+    const auto plan = plan_disk_migrations(disks, replicas, options);
+    ASSERT_EQ(2, plan.size());
+    ASSERT_EQ(gpid(1, 1), plan[0].pid);
+    ASSERT_EQ("d1", plan[0].origin_disk);
+    ASSERT_EQ("d2", plan[0].target_disk);
+    ASSERT_EQ("io", plan[0].reason);
+    ASSERT_EQ(gpid(1, 2), plan[1].pid);
+    ASSERT_EQ("d3", plan[1].target_disk);
+    ASSERT_EQ("io", plan[1].reason);
+}
+
+TEST(disk_balancer_test, plan_for_space)
+{
+    // The I/O utilization is unknown.
+    const std::vector<disk_load> disks = {make_disk("d1", -1, 100), make_disk("d2", -1, 800)};
+    const std::vector<replica_disk_load> replicas = {make_replica(0, "d1", 500, 0),
+                                                     make_replica(1, "d1", 300, 0),
+                                                     make_replica(2, "d1", 100, 0)};
+
+    // The largest replica would make d2 fuller than d1, and d1 and d2 are balanced enough after
+    // the first migration.
+    const auto plan = plan_disk_migrations(disks, replicas, make_options());
+    ASSERT_EQ(1, plan.size());
+    ASSERT_EQ(gpid(1, 1), plan[0].pid);
+    ASSERT_EQ("d1", plan[0].origin_disk);
+    ASSERT_EQ("d2", plan[0].target_disk);
+    ASSERT_EQ(300, plan[0].storage_mb);
+    ASSERT_EQ("space", plan[0].reason);
+}
+
+TEST(disk_balancer_test, plan_within_limits)
+{
+    std::vector<disk_load> disks = {make_disk("d1", 0.9, 500), make_disk("d2", 0.1, 500)};
+    std::vector<replica_disk_load> replicas = {make_replica(0, "d1", 100, 300),
+                                               make_replica(1, "d1", 100, 300),
+                                               make_replica(2, "d1", 100, 300)};
+    auto options = make_options();
+    ASSERT_EQ(1, plan_disk_migrations(disks, replicas, options).size());
+
+    // No concurrency left.
+    options.max_migrations = 0;
+    ASSERT_TRUE(plan_disk_migrations(disks, replicas, options).empty());
+
+    // The replicas are larger than the bandwidth budget.
+    options = make_options();
+    options.max_migration_mb = 50;
+    ASSERT_TRUE(plan_disk_migrations(disks, replicas, options).empty());
+
+    // The target disk would be too full.
+    options = make_options();
+    disks[1].available_mb = 150;
+    ASSERT_TRUE(plan_disk_migrations(disks, replicas, options).empty());
+
+    // The disks are on the same device.
+    disks[1].available_mb = 500;
+    disks[1].device = disks[0].device;
+    ASSERT_TRUE(plan_disk_migrations(disks, replicas, options).empty());
+
+    // The replicas could not be migrated, e.g. they are primaries.
+    disks[1].device = "dev_d2";
+    for (auto &r : replicas) {
+        r.movable = false;
+    }
+    ASSERT_TRUE(plan_disk_migrations(disks, replicas, options).empty());
+}
+
+} // namespace replication
+} // namespace dsn
@@ -37,6 +37,7 @@
 #include "common/replication_common.h"
 #include "common/replication_enums.h"
 #include "common/replication_other_types.h"
+#include "consensus_types.h"
 #include "dsn.layer2_types.h"
 #include "gtest/gtest.h"
 #include "http/http_server.h"
@@ -346,6 +347,60 @@ TEST_P(replica_test, backup_request_count)
     ASSERT_EQ(initial_backup_request_count + 1, get_backup_request_count());
 }
 
+TEST_P(replica_test, bounded_staleness_read)
+{
+    _mock_replica->as_secondary();
+    _mock_replica->set_last_committed_decree(10);
+
+    std::unique_ptr<tools::sim_network_provider> sim_net(
+        new tools::sim_network_provider(nullptr, nullptr));
+    const auto read_with_bound = [&](read_staleness_bound_type type, uint64_t bound) {
+        message_ptr request = dsn::message_ex::create_request(task_code());
+        request->set_read_staleness_bound({type, bound});
+        request->io_session = sim_net->create_client_session(rpc_address());
+        _mock_replica->on_client_read(request, false);
+    };
+
+    const auto initial_served = METRIC_VALUE(*_mock_replica, bounded_staleness_read_requests);
+    const auto initial_rejected = METRIC_VALUE(*_mock_replica, stale_rejected_read_requests);
+
+    // The secondary has not reached the min committed decree.
+    read_with_bound(read_staleness_bound_type::kMinCommittedDecree, 11);
+    ASSERT_EQ(initial_served, METRIC_VALUE(*_mock_replica, bounded_staleness_read_requests));
+    ASSERT_EQ(initial_rejected + 1, METRIC_VALUE(*_mock_replica, stale_rejected_read_requests));
+
+    read_with_bound(read_staleness_bound_type::kMinCommittedDecree, 10);
+    ASSERT_EQ(initial_served + 1, METRIC_VALUE(*_mock_replica, bounded_staleness_read_requests));
+
+    // The secondary has never caught up with the primary.
+    read_with_bound(read_staleness_bound_type::kMaxStalenessMs, 1000);
+    ASSERT_EQ(initial_rejected + 2, METRIC_VALUE(*_mock_replica, stale_rejected_read_requests));
+
+    read_staleness_heartbeat heartbeat;
+    heartbeat.pid = _mock_replica->get_gpid();
+    heartbeat.ballot = _mock_replica->get_ballot() + 1;
+    heartbeat.last_committed_decree = 10;
+
+    // The heartbeat from another ballot is ignored.
+    _mock_replica->on_read_staleness_heartbeat(heartbeat);
+    read_with_bound(read_staleness_bound_type::kMaxStalenessMs, 1000);
+    ASSERT_EQ(initial_rejected + 3, METRIC_VALUE(*_mock_replica, stale_rejected_read_requests));
+
+    // The secondary has not committed the mutations that the primary has committed.
+    heartbeat.ballot = _mock_replica->get_ballot();
+    heartbeat.last_committed_decree = 11;
+    _mock_replica->on_read_staleness_heartbeat(heartbeat);
+    ASSERT_EQ(10, _mock_replica->last_committed_decree());
+    read_with_bound(read_staleness_bound_type::kMaxStalenessMs, 1000);
+    ASSERT_EQ(initial_rejected + 4, METRIC_VALUE(*_mock_replica, stale_rejected_read_requests));
+
+    heartbeat.last_committed_decree = 10;
+    _mock_replica->on_read_staleness_heartbeat(heartbeat);
+    read_with_bound(read_staleness_bound_type::kMaxStalenessMs, 1000);
+    ASSERT_EQ(initial_served + 2, METRIC_VALUE(*_mock_replica, bounded_staleness_read_requests));
+    ASSERT_EQ(initial_rejected + 4, METRIC_VALUE(*_mock_replica, stale_rejected_read_requests));
+}
+
 TEST_P(replica_test, query_data_version_test)
 {
     replica_http_service http_svc(stub.get());
@@ -86,7 +86,8 @@
 DSN_DEFINE_uint32(network,
                   io_service_worker_count,
                   4,
-                  "The thread number of IO service (timer and boost network)");
+                  "The thread number of IO service (timer and boost network), which is also "
+                  "the number of event loops of dsn::tools::epoll_network_provider");
 
 namespace dsn {
 class rpc_engine;
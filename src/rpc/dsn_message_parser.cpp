@@ -31,6 +31,7 @@
 #include <memory>
 #include <vector>
 
+#include "rpc/rpc_compression.h"
 #include "rpc/rpc_message.h"
 #include "task/task_code.h"
 #include "task/task_spec.h"
@@ -79,6 +80,10 @@ message_ex *dsn_message_parser::get_message_on_receive(message_reader *reader,
                 read_next = -1;
                 delete msg;
                 return nullptr;
+            } else if (!decompress_message_body(msg)) {
+                read_next = -1;
+                delete msg;
+                return nullptr;
             } else {
                 reader->_buffer = buf.range(msg_sz);
                 reader->_buffer_occupied -= msg_sz;
@@ -0,0 +1,180 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "rpc/epoll_event_loop.h"
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "utils/fmt_logging.h"
+#include "utils/safe_strerror_posix.h"
+
+namespace dsn {
+namespace tools {
+namespace {
+
+// The max count of the events fetched by a single epoll_wait().
+const int kMaxEventsPerWait = 256;
+
+thread_local const epoll_event_loop *tls_current_loop = nullptr;
+
+} // anonymous namespace
+
+epoll_event_loop::epoll_event_loop()
+    : _epoll_fd(::epoll_create1(EPOLL_CLOEXEC)),
+      _wakeup_fd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+      _stopping(false)
+{
+    if (_epoll_fd < 0 || _wakeup_fd < 0) {
+        LOG_ERROR("failed to create the epoll event loop, err = {}", utils::safe_strerror(errno));
+        return;
+    }
+
+    // The wakeup fd is registered with a null handler.
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = nullptr;
+    if (::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _wakeup_fd, &ev) != 0) {
+        LOG_ERROR("failed to register the wakeup fd, err = {}", utils::safe_strerror(errno));
+        ::close(_epoll_fd);
+        _epoll_fd = -1;
+    }
+}
+
+epoll_event_loop::~epoll_event_loop()
+{
+    if (_wakeup_fd >= 0) {
+        ::close(_wakeup_fd);
+    }
+    if (_epoll_fd >= 0) {
+        ::close(_epoll_fd);
+    }
+}
+
+void epoll_event_loop::run()
+{
+    CHECK(valid(), "the epoll event loop is not created successfully");
+    tls_current_loop = this;
+
+    struct epoll_event events[kMaxEventsPerWait];
+    while (!_stopping.load(std::memory_order_acquire)) {
+        int n = ::epoll_wait(_epoll_fd, events, kMaxEventsPerWait, -1);
+        if (n < 0) {
+            CHECK_EQ_MSG(errno, EINTR, "epoll_wait failed: {}", utils::safe_strerror(errno));
+            continue;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            auto *h = static_cast<handler *>(events[i].data.ptr);
+            if (h == nullptr) {
+                uint64_t count = 0;
+                while (::read(_wakeup_fd, &count, sizeof(count)) > 0) {
+                }
+                continue;
+            }
+            h->on_events(events[i].events);
+        }
+
+        // The posted operations are run after all of the events are dispatched, thus a handler
+        // removed by them would never be seen in the events fetched above.
+        run_posted();
+    }
+
+    tls_current_loop = nullptr;
+}
+
+void epoll_event_loop::stop()
+{
+    _stopping.store(true, std::memory_order_release);
+    wakeup();
+}
+
+bool epoll_event_loop::add(int fd, handler *h)
+{
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = h;
+    if (::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        LOG_ERROR("failed to register fd {} to epoll, err = {}", fd, utils::safe_strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void epoll_event_loop::remove(int fd)
+{
+    DCHECK(in_loop_thread(), "must be called on the thread of the loop");
+    if (::epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, nullptr) != 0) {
+        LOG_WARNING(
+            "failed to unregister fd {} from epoll, err = {}", fd, utils::safe_strerror(errno));
+    }
+}
+
+void epoll_event_loop::post(handler *h, int op)
+{
+    bool need_wakeup = false;
+    {
+        std::lock_guard<std::mutex> l(_posted_lock);
+        need_wakeup = _posted.empty();
+        _posted.emplace_back(h, op);
+    }
+
+    // The loop has been woken up by the previous posting if there were pending operations.
+    if (need_wakeup) {
+        wakeup();
+    }
+}
+
+bool epoll_event_loop::in_loop_thread() const { return tls_current_loop == this; }
+
+void epoll_event_loop::wakeup()
+{
+    uint64_t one = 1;
+    if (::write(_wakeup_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        LOG_ERROR("failed to wake up the epoll event loop, err = {}", utils::safe_strerror(errno));
+    }
+}
+
+void epoll_event_loop::run_posted()
+{
+    while (true) {
+        {
+            std::lock_guard<std::mutex> l(_posted_lock);
+            if (_posted.empty()) {
+                return;
+            }
+            _running.swap(_posted);
+        }
+
+        // The operations posted while running these ones are run in the next round.
+        for (const auto &[h, op] : _running) {
+            h->on_posted(op);
+        }
+        _running.clear();
+    }
+}
+
+} // namespace tools
+} // namespace dsn
+
+#endif // defined(__linux__)
@@ -0,0 +1,95 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "utils/ports.h"
+
+namespace dsn {
+namespace tools {
+
+// An event loop which polls the registered file descriptors with edge-triggered epoll and runs
+// the operations posted from other threads, both on the single thread calling run().
+//
+// Thread-safe.
+class epoll_event_loop
+{
+public:
+    // The handler of a registered file descriptor, all of whose callbacks are called on the
+    // thread of the loop.
+    class handler
+    {
+    public:
+        virtual ~handler() = default;
+
+        // Called with the epoll events (EPOLLIN, EPOLLOUT, ...) of the file descriptor.
+        virtual void on_events(uint32_t events) = 0;
+
+        // Called with the operation passed to post().
+        virtual void on_posted(int op) {}
+    };
+
+    epoll_event_loop();
+    ~epoll_event_loop();
+
+    // Whether the epoll instance has been created successfully.
+    bool valid() const { return _epoll_fd >= 0; }
+
+    // Poll and dispatch the events until stop() is called.
+    void run();
+    void stop();
+
+    // Register `fd` to be polled for EPOLLIN, EPOLLOUT and EPOLLRDHUP in edge-triggered mode.
+    bool add(int fd, handler *h);
+
+    // Unregister `fd`, after which the handler is guaranteed not to be called with the events
+    // of `fd` any more. Must be called on the thread of the loop.
+    void remove(int fd);
+
+    // Let `h->on_posted(op)` be called on the thread of the loop, in the order of posting. The
+    // caller is responsible for keeping `h` alive until then.
+    void post(handler *h, int op);
+
+    // Whether the calling thread is the one running this loop.
+    bool in_loop_thread() const;
+
+private:
+    void wakeup();
+    void run_posted();
+
+    int _epoll_fd;
+    int _wakeup_fd;
+    std::atomic<bool> _stopping;
+
+    std::mutex _posted_lock;
+    std::vector<std::pair<handler *, int>> _posted;
+    // The posted operations are swapped here to run, to reuse the memory of both vectors.
+    std::vector<std::pair<handler *, int>> _running;
+
+    DISALLOW_COPY_AND_ASSIGN(epoll_event_loop);
+};
+
+} // namespace tools
+} // namespace dsn
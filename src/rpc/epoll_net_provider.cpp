@@ -0,0 +1,212 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "rpc/epoll_net_provider.h"
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+
+#include "rpc/epoll_rpc_session.h"
+#include "rpc/message_parser.h"
+#include "runtime/tool_api.h"
+#include "task/task.h"
+#include "task/task_worker.h"
+#include "utils/autoref_ptr.h"
+#include "utils/flags.h"
+#include "utils/fmt_logging.h"
+#include "utils/safe_strerror_posix.h"
+
+DSN_DECLARE_uint32(io_service_worker_count);
+
+namespace dsn {
+namespace tools {
+
+// Accepts the connections on the listening socket, and binds the sessions to the loops
+// round-robin.
+class epoll_network_provider::acceptor : public epoll_event_loop::handler
+{
+public:
+    acceptor(epoll_network_provider &net, int fd) : _net(net), _fd(fd) {}
+    ~acceptor() override { ::close(_fd); }
+
+    void on_events(uint32_t events) override
+    {
+        while (true) {
+            sockaddr_in addr = {};
+            socklen_t len = sizeof(addr);
+            int fd = ::accept4(
+                _fd, reinterpret_cast<sockaddr *>(&addr), &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    LOG_ERROR("accept on {} failed, error = {}",
+                              _net.address(),
+                              utils::safe_strerror(errno));
+                }
+                return;
+            }
+
+            ::dsn::rpc_address client_addr(ntohl(addr.sin_addr.s_addr), ntohs(addr.sin_port));
+            message_parser_ptr null_parser;
+            auto *session = new epoll_rpc_session(
+                _net, client_addr, fd, _net.next_loop(), null_parser, false);
+            rpc_session_ptr s(session);
+
+            // when server connection threshold is hit, close the session, otherwise accept it
+            if (_net.check_if_conn_threshold_exceeded(s->remote_address())) {
+                LOG_WARNING("close rpc connection from {} to {} due to hitting server "
+                            "connection threshold per ip",
+                            s->remote_address(),
+                            _net.address());
+                s->close();
+            } else {
+                _net.on_server_session_accepted(s);
+
+                // we should start read immediately after the rpc session is completely created.
+                session->start_polling();
+                s->start_read_next();
+            }
+        }
+    }
+
+private:
+    epoll_network_provider &_net;
+    const int _fd;
+};
+
+epoll_network_provider::epoll_network_provider(rpc_engine *srv, network *inner_provider)
+    : connection_oriented_network(srv, inner_provider), _next_loop_index(0)
+{
+    for (uint32_t i = 0; i < FLAGS_io_service_worker_count; i++) {
+        _loops.emplace_back(std::make_unique<epoll_event_loop>());
+    }
+}
+
+epoll_network_provider::~epoll_network_provider()
+{
+    for (auto &loop : _loops) {
+        loop->stop();
+    }
+    for (auto &w : _workers) {
+        w.join();
+    }
+}
+
+error_code epoll_network_provider::start(rpc_channel channel, int port, bool client_only)
+{
+    if (_acceptor != nullptr) {
+        return ERR_SERVICE_ALREADY_RUNNING;
+    }
+
+    CHECK_EQ(channel, RPC_CHANNEL_TCP);
+
+    if (_workers.empty()) {
+        for (const auto &loop : _loops) {
+            if (!loop->valid()) {
+                return ERR_NETWORK_INIT_FAILED;
+            }
+        }
+
+        for (size_t i = 0; i < _loops.size(); i++) {
+            _workers.emplace_back([this, i]() {
+                task::set_tls_dsn_context(node(), nullptr);
+
+                const char *name = ::dsn::tools::get_service_node_name(node());
+                char buffer[128];
+                sprintf(buffer, "%s.epoll.%zu", name, i);
+                task_worker::set_name(buffer);
+
+                _loops[i]->run();
+            });
+        }
+    }
+
+    _address = rpc_address(get_local_ipv4(), port);
+    _hp = ::dsn::host_port::from_address(_address);
+    LOG_WARNING_IF(!_hp, "'{}' can not be reverse resolved", _address);
+
+    if (client_only) {
+        return ERR_OK;
+    }
+
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        LOG_ERROR("tcp listening socket open failed, error = {}", utils::safe_strerror(errno));
+        return ERR_NETWORK_INIT_FAILED;
+    }
+    auto listener = std::make_unique<acceptor>(*this, fd);
+
+    const int reuse_addr = 1;
+    if (::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse_addr, sizeof(reuse_addr)) != 0) {
+        LOG_WARNING("set reuse_address failed, error = {}", utils::safe_strerror(errno));
+    }
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(_address.port());
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        LOG_ERROR("tcp listening socket bind address '{}' failed, error = {}",
+                  _address,
+                  utils::safe_strerror(errno));
+        return ERR_NETWORK_INIT_FAILED;
+    }
+
+    if (::listen(fd, SOMAXCONN) != 0) {
+        LOG_ERROR("tcp listening socket listen failed, port = {}, error = {}",
+                  _address.port(),
+                  utils::safe_strerror(errno));
+        return ERR_NETWORK_INIT_FAILED;
+    }
+
+    if (!_loops[0]->add(fd, listener.get())) {
+        return ERR_NETWORK_INIT_FAILED;
+    }
+    _acceptor = std::move(listener);
+    return ERR_OK;
+}
+
+rpc_session_ptr epoll_network_provider::create_client_session(::dsn::rpc_address server_addr)
+{
+    // The session fails to connect if the socket could not be opened.
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    LOG_ERROR_IF(fd < 0, "tcp socket open failed, error = {}", utils::safe_strerror(errno));
+
+    message_parser_ptr parser(new_message_parser(_client_hdr_format));
+    return rpc_session_ptr(
+        new epoll_rpc_session(*this, server_addr, fd, next_loop(), parser, true));
+}
+
+epoll_event_loop &epoll_network_provider::next_loop()
+{
+    return *_loops[_next_loop_index.fetch_add(1, std::memory_order_relaxed) % _loops.size()];
+}
+
+} // namespace tools
+} // namespace dsn
+
+#endif // defined(__linux__)
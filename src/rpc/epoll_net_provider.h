@@ -0,0 +1,77 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "rpc/epoll_event_loop.h"
+#include "rpc/network.h"
+#include "rpc/rpc_address.h"
+#include "rpc/rpc_host_port.h"
+#include "utils/error_code.h"
+
+namespace dsn {
+class rpc_engine;
+
+namespace tools {
+
+// epoll_network_provider is an alternative of asio_network_provider, which could be selected by
+// "dsn::tools::epoll_network_provider" in the network.client.* and network.server.* configs.
+//
+// It is built directly on non-blocking sockets and edge-triggered epoll, with the same threading
+// model as asio_network_provider: there are [network] io_service_worker_count event loops, each
+// of which is polled by a single thread, and every socket is bound to one of them round-robin.
+// Compared with asio, it saves the allocation of a completion handler on every read and write,
+// and a batch of messages is mostly written by the thread sending them without switching to the
+// thread of the loop, see epoll_rpc_session for details.
+//
+// Only available on Linux.
+class epoll_network_provider : public connection_oriented_network
+{
+public:
+    epoll_network_provider(rpc_engine *srv, network *inner_provider);
+
+    ~epoll_network_provider() override;
+
+    error_code start(rpc_channel channel, int port, bool client_only) override;
+    const ::dsn::rpc_address &address() const override { return _address; }
+    const ::dsn::host_port &host_port() const override { return _hp; }
+    rpc_session_ptr create_client_session(::dsn::rpc_address server_addr) override;
+
+private:
+    class acceptor;
+
+    epoll_event_loop &next_loop();
+
+    std::vector<std::unique_ptr<epoll_event_loop>> _loops;
+    std::vector<std::thread> _workers;
+    std::unique_ptr<acceptor> _acceptor;
+    std::atomic<uint32_t> _next_loop_index;
+    ::dsn::rpc_address _address;
+    // NOTE: '_hp' is possible to be invalid if '_address' can not be reverse resolved.
+    ::dsn::host_port _hp;
+};
+
+} // namespace tools
+} // namespace dsn
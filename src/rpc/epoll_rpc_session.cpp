@@ -0,0 +1,434 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "rpc/epoll_rpc_session.h"
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+
+#include "rpc/epoll_net_provider.h"
+#include "rpc/rpc_address.h"
+#include "utils/autoref_ptr.h"
+#include "utils/fmt_logging.h"
+#include "utils/safe_strerror_posix.h"
+
+namespace dsn {
+class message_ex;
+
+namespace tools {
+namespace {
+
+// The max count of buffers written by a single sendmsg().
+const size_t kMaxIovPerWrite = 64;
+
+const int kSocketBufferSize = 16 * 1024 * 1024;
+
+// Whether the calling thread is writing a batch inline in send(). The batches that follow
+// (started by on_send_completed() of the one written inline) are left to the loop, so that
+// send() is never called recursively.
+thread_local bool tls_in_inline_send = false;
+
+} // anonymous namespace
+
+epoll_rpc_session::epoll_rpc_session(epoll_network_provider &net,
+                                     ::dsn::rpc_address remote_addr,
+                                     int fd,
+                                     epoll_event_loop &loop,
+                                     message_parser_ptr &parser,
+                                     bool is_client)
+    : rpc_session(net, remote_addr, parser, is_client),
+      _fd(fd),
+      _loop(loop),
+      _attached(false),
+      _connecting(false),
+      _reading(false),
+      _read_armed(false),
+      _write_waiting(false),
+      _detached(false),
+      _detach_requested(false),
+      _read_next(0),
+      _write_signature(0),
+      _write_index(0),
+      _write_offset(0)
+{
+    set_options();
+}
+
+epoll_rpc_session::~epoll_rpc_session()
+{
+    // The loop holds a reference of the session while polling it, thus the socket has been
+    // unregistered from the loop once the session is destroyed.
+    ::close(_fd);
+}
+
+void epoll_rpc_session::set_options()
+{
+    if (_fd < 0) {
+        return;
+    }
+
+    if (::setsockopt(_fd, SOL_SOCKET, SO_SNDBUF, &kSocketBufferSize, sizeof(int)) != 0) {
+        LOG_WARNING("set send buffer size failed, error = {}", utils::safe_strerror(errno));
+    }
+    if (::setsockopt(_fd, SOL_SOCKET, SO_RCVBUF, &kSocketBufferSize, sizeof(int)) != 0) {
+        LOG_WARNING("set recv buffer size failed, error = {}", utils::safe_strerror(errno));
+    }
+
+    // Disable the Nagle algorithm for the same reason as asio_rpc_session.
+    const int no_delay = 1;
+    if (::setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay)) != 0) {
+        LOG_WARNING("set no_delay failed, error = {}", utils::safe_strerror(errno));
+    }
+}
+
+void epoll_rpc_session::start_polling()
+{
+    post_op(kOpAttach);
+}
+
+void epoll_rpc_session::connect()
+{
+    if (set_connecting()) {
+        post_op(kOpConnect);
+    }
+}
+
+void epoll_rpc_session::close()
+{
+    if (::shutdown(_fd, SHUT_RDWR) != 0 && errno != ENOTCONN) {
+        LOG_WARNING("socket shutdown failed, error = {}", utils::safe_strerror(errno));
+    }
+    detach();
+}
+
+void epoll_rpc_session::on_failure(bool is_write)
+{
+    rpc_session::on_failure(is_write);
+    detach();
+}
+
+void epoll_rpc_session::post_op(op o)
+{
+    add_ref(); // released in on_posted
+    _loop.post(this, o);
+}
+
+void epoll_rpc_session::detach()
+{
+    if (!_detach_requested.exchange(true)) {
+        post_op(kOpDetach);
+    }
+}
+
+void epoll_rpc_session::on_posted(int o)
+{
+    switch (o) {
+    case kOpAttach:
+        if (!attach()) {
+            on_failure(false);
+        }
+        break;
+    case kOpConnect: {
+        if (!attach()) {
+            on_failure(true);
+            break;
+        }
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(_remote_addr.ip());
+        addr.sin_port = htons(_remote_addr.port());
+        if (::connect(_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0) {
+            on_connected();
+        } else if (errno == EINPROGRESS) {
+            // Wait for the socket to be writable.
+            _connecting = true;
+        } else {
+            LOG_ERROR("client session connect to {} failed, error = {}",
+                      _remote_addr,
+                      utils::safe_strerror(errno));
+            on_failure(true);
+        }
+        break;
+    }
+    case kOpRead:
+        if (!_detached) {
+            _read_armed = true;
+            read_available();
+        }
+        break;
+    case kOpWrite:
+        _write_waiting = true;
+        continue_write();
+        break;
+    case kOpDetach:
+        _detached = true;
+        if (_attached) {
+            _loop.remove(_fd);
+            _attached = false;
+            if (_connecting || _write_waiting) {
+                _connecting = false;
+                _write_waiting = false;
+                // The batch being sent would never be completed.
+                rpc_session::on_failure(true);
+            }
+            release_ref(); // added in attach()
+        }
+        break;
+    default:
+        CHECK(false, "invalid op {}", o);
+    }
+
+    release_ref(); // added in post_op
+}
+
+bool epoll_rpc_session::attach()
+{
+    if (_detached || !_loop.add(_fd, this)) {
+        return false;
+    }
+    _attached = true;
+    add_ref(); // released while being detached
+    return true;
+}
+
+void epoll_rpc_session::on_events(uint32_t events)
+{
+    if (_connecting) {
+        if ((events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) != 0) {
+            on_connect_result();
+        }
+        return;
+    }
+
+    if (_read_armed && (events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)) != 0) {
+        read_available();
+    }
+    if (_write_waiting && (events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) != 0) {
+        continue_write();
+    }
+}
+
+void epoll_rpc_session::on_connect_result()
+{
+    _connecting = false;
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (::getsockopt(_fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0) {
+        err = errno;
+    }
+    if (err != 0) {
+        LOG_ERROR("client session connect to {} failed, error = {}",
+                  _remote_addr,
+                  utils::safe_strerror(err));
+        on_failure(true);
+        return;
+    }
+    on_connected();
+}
+
+void epoll_rpc_session::on_connected()
+{
+    LOG_DEBUG("client session {} connected", _remote_addr);
+
+    set_connected();
+    on_send_completed(0);
+    start_read_next();
+}
+
+void epoll_rpc_session::do_read(int read_next)
+{
+    _read_next = read_next;
+
+    // Keep on reading in read_available() if it is parsing the messages just read.
+    if (_loop.in_loop_thread() && _reading) {
+        _read_armed = true;
+        return;
+    }
+    post_op(kOpRead);
+}
+
+void epoll_rpc_session::read_available()
+{
+    _reading = true;
+    while (_read_armed && !_detached) {
+        void *ptr = _reader.read_buffer_ptr(_read_next);
+        int remaining = _reader.read_buffer_capacity();
+
+        ssize_t length = ::recv(_fd, ptr, remaining, 0);
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Keep armed to read on the next EPOLLIN.
+                break;
+            }
+            LOG_ERROR("read from {} failed: {}", _remote_addr, utils::safe_strerror(errno));
+            _read_armed = false;
+            on_failure(false);
+            break;
+        }
+        if (length == 0) {
+            LOG_INFO("read from {} failed: end of file", _remote_addr);
+            _read_armed = false;
+            on_failure(false);
+            break;
+        }
+
+        // Disarmed until start_read_next() is called, which may be delayed.
+        _read_armed = false;
+        _reader.mark_read(length);
+
+        int read_next = -1;
+
+        if (!_parser) {
+            read_next = prepare_parser();
+        }
+
+        if (_parser) {
+            message_ex *msg = _parser->get_message_on_receive(&_reader, read_next);
+
+            while (msg != nullptr) {
+                this->on_message_read(msg);
+                msg = _parser->get_message_on_receive(&_reader, read_next);
+            }
+        }
+
+        if (read_next == -1) {
+            LOG_ERROR("read from {} failed", _remote_addr);
+            on_failure(false);
+        } else {
+            start_read_next(read_next);
+        }
+    }
+    _reading = false;
+}
+
+void epoll_rpc_session::send(uint64_t signature)
+{
+    _write_signature = signature;
+    _write_index = 0;
+    _write_offset = 0;
+
+    if (tls_in_inline_send || _loop.in_loop_thread()) {
+        post_op(kOpWrite);
+        return;
+    }
+
+    tls_in_inline_send = true;
+    auto result = write_some();
+    switch (result) {
+    case write_result::kDone:
+        on_send_completed(signature);
+        break;
+    case write_result::kWouldBlock:
+        // Let the loop write the rest once the socket is writable.
+        post_op(kOpWrite);
+        break;
+    case write_result::kFailed:
+        on_failure(true);
+        break;
+    }
+    tls_in_inline_send = false;
+}
+
+void epoll_rpc_session::continue_write()
+{
+    if (_detached) {
+        // The batch being sent would never be completed.
+        _write_waiting = false;
+        rpc_session::on_failure(true);
+        return;
+    }
+
+    auto result = write_some();
+    if (result == write_result::kWouldBlock) {
+        // Wait for the next EPOLLOUT.
+        return;
+    }
+
+    _write_waiting = false;
+    if (result == write_result::kDone) {
+        on_send_completed(_write_signature);
+    } else {
+        on_failure(true);
+    }
+}
+
+epoll_rpc_session::write_result epoll_rpc_session::write_some()
+{
+    struct iovec iov[kMaxIovPerWrite];
+    while (_write_index < _sending_buffers.size()) {
+        size_t count = 0;
+        for (size_t i = _write_index; i < _sending_buffers.size() && count < kMaxIovPerWrite;
+             ++i, ++count) {
+            const size_t offset = (i == _write_index ? _write_offset : 0);
+            iov[count].iov_base = static_cast<char *>(_sending_buffers[i].buf) + offset;
+            iov[count].iov_len = _sending_buffers[i].sz - offset;
+        }
+
+        struct msghdr msg = {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        ssize_t written = ::sendmsg(_fd, &msg, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return write_result::kWouldBlock;
+            }
+            LOG_ERROR("write to {} failed: {}", _remote_addr, utils::safe_strerror(errno));
+            return write_result::kFailed;
+        }
+
+        // Skip the buffers written.
+        auto remaining = static_cast<size_t>(written);
+        while (remaining > 0) {
+            const size_t left = _sending_buffers[_write_index].sz - _write_offset;
+            if (remaining < left) {
+                _write_offset += remaining;
+                break;
+            }
+            remaining -= left;
+            ++_write_index;
+            _write_offset = 0;
+        }
+        // Skip the empty buffers, if any.
+        while (_write_index < _sending_buffers.size() &&
+               _sending_buffers[_write_index].sz == _write_offset) {
+            ++_write_index;
+            _write_offset = 0;
+        }
+    }
+    return write_result::kDone;
+}
+
+} // namespace tools
+} // namespace dsn
+
+#endif // defined(__linux__)
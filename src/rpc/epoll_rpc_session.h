@@ -0,0 +1,135 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#include "rpc/epoll_event_loop.h"
+#include "rpc/message_parser.h"
+#include "rpc/network.h"
+
+namespace dsn {
+class rpc_address;
+
+namespace tools {
+class epoll_network_provider;
+
+// A TCP session implementation based on the non-blocking socket polled by epoll_event_loop.
+//
+// The socket is read only on the thread of the loop, into the message_reader directly until
+// the kernel buffer is drained. A batch of messages is written by the thread calling send()
+// inline with a single sendmsg() if possible, and only the remaining part that can not be
+// written immediately is left for the loop to write once the socket is writable again.
+//
+// Thread-safe
+class epoll_rpc_session : public rpc_session, public epoll_event_loop::handler
+{
+public:
+    // `fd` is owned by the session, which will be closed while the session is destroyed.
+    epoll_rpc_session(epoll_network_provider &net,
+                      ::dsn::rpc_address remote_addr,
+                      int fd,
+                      epoll_event_loop &loop,
+                      message_parser_ptr &parser,
+                      bool is_client);
+
+    ~epoll_rpc_session() override;
+
+    void send(uint64_t signature) override;
+
+    // Shut down the socket and stop polling it, while the socket is closed lazily when the
+    // session is destroyed.
+    void close() override;
+
+    void connect() override;
+
+    void on_failure(bool is_write) override;
+
+    // Start polling the socket of an accepted session, before which it would not be read.
+    void start_polling();
+
+private:
+    enum op
+    {
+        kOpAttach,
+        kOpConnect,
+        kOpRead,
+        kOpWrite,
+        kOpDetach,
+    };
+
+    enum class write_result
+    {
+        kDone,
+        kWouldBlock,
+        kFailed,
+    };
+
+    void do_read(int read_next) override;
+
+    void on_events(uint32_t events) override;
+    void on_posted(int op) override;
+
+    void post_op(op o);
+    // Register the socket to the loop, which holds a reference of the session until it is
+    // detached.
+    bool attach();
+    void detach();
+    void on_connect_result();
+    void on_connected();
+    void read_available();
+    void continue_write();
+    // Write the rest of _sending_buffers from (_write_index, _write_offset).
+    write_result write_some();
+    void set_options();
+    void on_message_read(message_ex *msg)
+    {
+        if (!on_recv_message(msg, 0)) {
+            on_failure(false);
+        }
+    }
+
+    const int _fd;
+    epoll_event_loop &_loop;
+
+    // Accessed only on the thread of the loop.
+    bool _attached;
+    bool _connecting;
+    bool _reading;
+    bool _read_armed;
+    bool _write_waiting;
+    bool _detached;
+
+    std::atomic<bool> _detach_requested;
+
+    // Set before kOpRead is posted, or on the thread of the loop.
+    int _read_next;
+
+    // The progress of the batch being sent, owned by whoever is writing it, either the thread
+    // calling send() or the loop, since only one batch is being sent at any time.
+    uint64_t _write_signature;
+    size_t _write_index;
+    size_t _write_offset;
+};
+
+} // namespace tools
+} // namespace dsn
@@ -36,6 +36,7 @@
 
 #include "message_parser_manager.h"
 #include "rpc/message_parser.h"
+#include "rpc/read_buffer_pool.h"
 #include "task/task_spec.h"
 #include "utils/blob.h"
 #include "utils/fmt_logging.h"
@@ -148,10 +149,11 @@ char *message_reader::read_buffer_ptr(unsigned int read_next)
         unsigned int sz =
             (read_next + _buffer_occupied > _buffer_block_size ? read_next + _buffer_occupied
                                                                : _buffer_block_size);
-        // TODO(wutao1): make it a buffer queue like what sofa-pbrpc does
-        //               (https://github.com/baidu/sofa-pbrpc/blob/master/src/sofa/pbrpc/buffer.h)
-        //               to reduce memory copy.
-        _buffer.assign(dsn::utils::make_shared_array<char>(sz), 0, sz);
+        // The messages received reference the buffer directly, it is returned to the pool of
+        // this io thread once all of them are released. Since `read_next` covers the whole
+        // pending message once its header is parsed, a message is copied at most once even if
+        // it straddles two buffers.
+        _buffer = read_buffer_pool::instance().allocate(sz);
         _buffer_occupied = 0;
 
         // copy
@@ -35,6 +35,7 @@
 
 #include "message_parser_manager.h"
 #include "rpc/rpc_address.h"
+#include "rpc/rpc_compression.h"
 #include "rpc/rpc_engine.h"
 #include "runtime/api_task.h"
 #include "task/task.h"
@@ -299,6 +300,7 @@ void rpc_session::send_message(message_ex *msg)
     }
 
     CHECK_NOTNULL(_parser, "parser should not be null when send");
+    prepare_body_compression(msg);
     _parser->prepare_on_send(msg);
 
     uint64_t sig;
@@ -319,6 +321,25 @@ void rpc_session::send_message(message_ex *msg)
     this->send(sig);
 }
 
+void rpc_session::prepare_body_compression(message_ex *msg)
+{
+    // Announce that the bodies could be compressed toward this node.
+    msg->header->context.u.accept_compress = 1;
+
+    if (_peer_accept_compress.load(std::memory_order_relaxed)) {
+        compress_message_body(msg, configured_rpc_compress_type());
+        return;
+    }
+
+    // A request may be compressed for another session, and then resent through this one after
+    // timeout.
+    if (dsn_unlikely(msg->header->context.u.compress_type != 0)) {
+        CHECK(decompress_message_body(msg),
+              "failed to restore the compressed body of message {}",
+              msg->header->rpc_name);
+    }
+}
+
 bool rpc_session::cancel(message_ex *request)
 {
     if (request->io_session.get() != this)
@@ -396,7 +417,8 @@ rpc_session::rpc_session(connection_oriented_network &net,
       _parser(parser),
       _is_client(is_client),
       _matcher(_net.engine()->matcher()),
-      _delay_server_receive_ms(0)
+      _delay_server_receive_ms(0),
+      _peer_accept_compress(false)
 {
     LOG_WARNING_IF(!_remote_host_port, "'{}' can not be reverse resolved", _remote_addr);
     if (!is_client) {
@@ -450,6 +472,11 @@ bool rpc_session::on_recv_message(message_ex *msg, int delay_ms)
     msg->to_host_port = _net.host_port();
     msg->io_session = this;
 
+    if (msg->header->context.u.accept_compress &&
+        !_peer_accept_compress.load(std::memory_order_relaxed)) {
+        _peer_accept_compress.store(true, std::memory_order_relaxed);
+    }
+
     // ignore msg if join point return false
     if (dsn_unlikely(!on_rpc_recv_message.execute(msg, true))) {
         delete msg;
@@ -327,6 +327,10 @@ protected:
     void clear_send_queue(bool resend_msgs);
     bool on_disconnected(bool is_write);
 
+    // Compresses the body of `msg` if the peer accepts compressed bodies, otherwise restores the
+    // body if it has been compressed for another session.
+    void prepare_body_compression(message_ex *msg);
+
     // constant info
     connection_oriented_network &_net;
     dsn::rpc_address _remote_addr;
@@ -341,6 +345,11 @@ private:
 
     std::atomic_int _delay_server_receive_ms;
 
+    // Whether the peer has announced that it could decompress the message bodies, by setting
+    // msg_context_t::accept_compress in the messages it sent through this session. It is never
+    // set for the peers speaking the thrift protocol or running an older version.
+    std::atomic_bool _peer_accept_compress;
+
     // _client_username is only valid if it is a server rpc_session.
     // it represents the name of the corresponding client
     std::string _client_username;
@@ -0,0 +1,137 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "rpc/read_buffer_pool.h"
+
+#include <utility>
+
+#include "utils/flags.h"
+#include "utils/utils.h"
+
+METRIC_DEFINE_counter(server,
+                      rpc_read_buffer_pool_hits,
+                      dsn::metric_unit::kAllocations,
+                      "The number of rpc read buffers allocated from the cached ones of the pool");
+
+METRIC_DEFINE_counter(server,
+                      rpc_read_buffer_pool_misses,
+                      dsn::metric_unit::kAllocations,
+                      "The number of rpc read buffers allocated from heap");
+
+DSN_DEFINE_bool(network,
+                enable_read_buffer_pool,
+                true,
+                "Whether to receive messages into the buffers cached by the per-thread pools "
+                "instead of allocating new buffers for each read");
+DSN_TAG_VARIABLE(enable_read_buffer_pool, FT_MUTABLE);
+
+DSN_DEFINE_uint64(network,
+                  read_buffer_pool_max_cached_bytes,
+                  8 * 1024 * 1024,
+                  "The maximum bytes of the released buffers cached by the read buffer pool of "
+                  "each io thread, the buffers beyond it are freed");
+DSN_TAG_VARIABLE(read_buffer_pool_max_cached_bytes, FT_MUTABLE);
+
+namespace dsn {
+
+read_buffer_pool::read_buffer_pool()
+    : _cached_bytes(0),
+      METRIC_VAR_INIT_server(rpc_read_buffer_pool_hits),
+      METRIC_VAR_INIT_server(rpc_read_buffer_pool_misses)
+{
+}
+
+read_buffer_pool::~read_buffer_pool()
+{
+    for (auto &chunks : _free_chunks) {
+        for (auto *chunk : chunks) {
+            delete[] chunk;
+        }
+    }
+}
+
+/*static*/ read_buffer_pool &read_buffer_pool::instance()
+{
+    // The pool is shared with the buffers allocated from it, which may outlive the thread.
+    static thread_local std::shared_ptr<read_buffer_pool> pool =
+        std::make_shared<read_buffer_pool>();
+    return *pool;
+}
+
+/*static*/ size_t read_buffer_pool::size_class_of(size_t size)
+{
+    size_t size_class = 0;
+    while (chunk_size_of(size_class) < size) {
+        ++size_class;
+    }
+    return size_class;
+}
+
+blob read_buffer_pool::allocate(size_t size)
+{
+    if (!FLAGS_enable_read_buffer_pool || size > kMaxChunkSize) {
+        METRIC_VAR_INCREMENT(rpc_read_buffer_pool_misses);
+        return blob(utils::make_shared_array<char>(size), 0, size);
+    }
+
+    const auto size_class = size_class_of(size);
+    char *chunk = nullptr;
+    {
+        utils::auto_lock<utils::ex_lock_nr_spin> l(_lock);
+        auto &chunks = _free_chunks[size_class];
+        if (!chunks.empty()) {
+            chunk = chunks.back();
+            chunks.pop_back();
+            _cached_bytes -= chunk_size_of(size_class);
+        }
+    }
+
+    if (chunk != nullptr) {
+        METRIC_VAR_INCREMENT(rpc_read_buffer_pool_hits);
+    } else {
+        METRIC_VAR_INCREMENT(rpc_read_buffer_pool_misses);
+        chunk = new char[chunk_size_of(size_class)];
+    }
+
+    std::shared_ptr<char> buffer(
+        chunk, [pool = shared_from_this(), size_class](char *c) { pool->release(c, size_class); });
+    return blob(std::move(buffer), 0, size);
+}
+
+void read_buffer_pool::release(char *chunk, size_t size_class)
+{
+    const auto chunk_size = chunk_size_of(size_class);
+    {
+        utils::auto_lock<utils::ex_lock_nr_spin> l(_lock);
+        if (_cached_bytes + chunk_size <= FLAGS_read_buffer_pool_max_cached_bytes) {
+            _free_chunks[size_class].push_back(chunk);
+            _cached_bytes += chunk_size;
+            return;
+        }
+    }
+    delete[] chunk;
+}
+
+size_t read_buffer_pool::cached_bytes() const
+{
+    utils::auto_lock<utils::ex_lock_nr_spin> l(_lock);
+    return _cached_bytes;
+}
+
+} // namespace dsn
@@ -0,0 +1,79 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "utils/blob.h"
+#include "utils/metrics.h"
+#include "utils/ports.h"
+#include "utils/synchronize.h"
+
+namespace dsn {
+
+// A size-classed pool of the buffers that messages are received into.
+//
+// Every io thread allocates from its own pool (see instance()). The received messages reference
+// slices of the buffers directly, thus a buffer may be released by any thread once the last
+// message referencing it is destroyed. Released buffers are cached by the pool they come from
+// for the next reads of the io thread, instead of being freed.
+//
+// Thread-safe.
+class read_buffer_pool : public std::enable_shared_from_this<read_buffer_pool>
+{
+public:
+    // Buffers are rounded up to the power of 2 between kMinChunkSize and kMaxChunkSize, the
+    // larger ones are allocated from heap without being pooled.
+    static constexpr size_t kMinChunkSize = 4 * 1024;
+    static constexpr size_t kMaxChunkSize = 1024 * 1024;
+
+    read_buffer_pool();
+    ~read_buffer_pool();
+
+    // The pool of the calling thread.
+    static read_buffer_pool &instance();
+
+    // Allocate a buffer of `size` bytes.
+    blob allocate(size_t size);
+
+    size_t cached_bytes() const;
+
+private:
+    static constexpr size_t kSizeClassCount = 9; // 4KB, 8KB, ..., 1MB
+
+    static size_t size_class_of(size_t size);
+    static size_t chunk_size_of(size_t size_class) { return kMinChunkSize << size_class; }
+
+    void release(char *chunk, size_t size_class);
+
+    mutable utils::ex_lock_nr_spin _lock;
+    std::array<std::vector<char *>, kSizeClassCount> _free_chunks;
+    size_t _cached_bytes;
+
+    METRIC_VAR_DECLARE_counter(rpc_read_buffer_pool_hits);
+    METRIC_VAR_DECLARE_counter(rpc_read_buffer_pool_misses);
+
+    DISALLOW_COPY_AND_ASSIGN(read_buffer_pool);
+};
+
+} // namespace dsn
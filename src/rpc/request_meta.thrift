@@ -35,4 +35,11 @@ struct thrift_request_meta_v1
     // Whether it is a backup request. If true, this request (only if it's a read) can be handled by
     // a secondary replica, which does not guarantee strong consistency.
     5:optional bool is_backup_request;
+
+    // The bound of the data staleness that a read request could tolerate, at most one of them
+    // could be set. If set, the read can be handled by a secondary replica which satisfies the
+    // bound, i.e. whose last committed decree is not less than `min_committed_decree`, or which
+    // lags behind the primary for no more than `max_staleness_ms`.
+    6:optional i64 min_committed_decree;
+    7:optional i64 max_staleness_ms;
 }
@@ -0,0 +1,355 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "rpc/rpc_compression.h"
+
+#include <lz4.h>
+#include <string.h>
+#include <zstd.h>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "rpc/rpc_message.h"
+#include "runtime/api_layer1.h"
+#include "utils/blob.h"
+#include "utils/crc.h"
+#include "utils/flags.h"
+#include "utils/fmt_logging.h"
+#include "utils/utils.h"
+
+METRIC_DEFINE_counter(server,
+                      rpc_lz4_compressed_bytes,
+                      dsn::metric_unit::kBytes,
+                      "The number of body bytes of the sent messages compressed by lz4");
+
+METRIC_DEFINE_counter(server,
+                      rpc_lz4_compress_saved_bytes,
+                      dsn::metric_unit::kBytes,
+                      "The number of bytes saved from the network by compressing the message "
+                      "bodies with lz4");
+
+METRIC_DEFINE_counter(server,
+                      rpc_lz4_compress_duration_ns,
+                      dsn::metric_unit::kNanoSeconds,
+                      "The total cpu time spent compressing the message bodies with lz4");
+
+METRIC_DEFINE_counter(server,
+                      rpc_lz4_decompress_duration_ns,
+                      dsn::metric_unit::kNanoSeconds,
+                      "The total cpu time spent decompressing the message bodies with lz4");
+
+METRIC_DEFINE_counter(server,
+                      rpc_zstd_compressed_bytes,
+                      dsn::metric_unit::kBytes,
+                      "The number of body bytes of the sent messages compressed by zstd");
+
+METRIC_DEFINE_counter(server,
+                      rpc_zstd_compress_saved_bytes,
+                      dsn::metric_unit::kBytes,
+                      "The number of bytes saved from the network by compressing the message "
+                      "bodies with zstd");
+
+METRIC_DEFINE_counter(server,
+                      rpc_zstd_compress_duration_ns,
+                      dsn::metric_unit::kNanoSeconds,
+                      "The total cpu time spent compressing the message bodies with zstd");
+
+METRIC_DEFINE_counter(server,
+                      rpc_zstd_decompress_duration_ns,
+                      dsn::metric_unit::kNanoSeconds,
+                      "The total cpu time spent decompressing the message bodies with zstd");
+
+DSN_DEFINE_string(network,
+                  rpc_compress_type,
+                  "none",
+                  "The codec that the bodies of the dsn messages are compressed with, could be "
+                  "none, lz4 or zstd. The bodies are only compressed for the peers which have "
+                  "announced that they could decompress them, thus it is safe to enable it during "
+                  "a rolling upgrade");
+DSN_DEFINE_validator(rpc_compress_type, [](const char *value) -> bool {
+    dsn::rpc_compress_type type;
+    return dsn::parse_rpc_compress_type(value, type);
+});
+DSN_TAG_VARIABLE(rpc_compress_type, FT_MUTABLE);
+
+DSN_DEFINE_uint32(network,
+                  rpc_compress_min_body_size,
+                  4096,
+                  "The bodies of the dsn messages smaller than it are never compressed, since the "
+                  "cpu spent is hardly paid back by the bytes saved");
+DSN_TAG_VARIABLE(rpc_compress_min_body_size, FT_MUTABLE);
+
+namespace dsn {
+namespace {
+
+// Favor speed over ratio, since the compression is on the critical path of every rpc.
+const int kZstdCompressionLevel = 1;
+
+// Guard against allocating a huge buffer for a corrupted message.
+const uint32_t kMaxUncompressedSize = 1 << 30;
+
+// The uncompressed length of the body is put ahead of the compressed body.
+const size_t kRawLengthSize = sizeof(uint32_t);
+
+// Returns the size of the compressed data written into `dst`, or 0 if failed.
+size_t compress(rpc_compress_type type, const char *src, size_t src_size, char *dst, size_t bound)
+{
+    switch (type) {
+    case rpc_compress_type::kLz4: {
+        int size = LZ4_compress_default(
+            src, dst, static_cast<int>(src_size), static_cast<int>(bound));
+        return size > 0 ? static_cast<size_t>(size) : 0;
+    }
+    case rpc_compress_type::kZstd: {
+        size_t size = ZSTD_compress(dst, bound, src, src_size, kZstdCompressionLevel);
+        return ZSTD_isError(size) ? 0 : size;
+    }
+    default:
+        return 0;
+    }
+}
+
+size_t compress_bound(rpc_compress_type type, size_t src_size)
+{
+    switch (type) {
+    case rpc_compress_type::kLz4:
+        return static_cast<size_t>(LZ4_compressBound(static_cast<int>(src_size)));
+    case rpc_compress_type::kZstd:
+        return ZSTD_compressBound(src_size);
+    default:
+        return 0;
+    }
+}
+
+// Returns true if exactly `dst_size` bytes are decompressed from `src` into `dst`.
+bool decompress(
+    rpc_compress_type type, const char *src, size_t src_size, char *dst, size_t dst_size)
+{
+    switch (type) {
+    case rpc_compress_type::kLz4: {
+        int size = LZ4_decompress_safe(
+            src, dst, static_cast<int>(src_size), static_cast<int>(dst_size));
+        return size >= 0 && static_cast<size_t>(size) == dst_size;
+    }
+    case rpc_compress_type::kZstd: {
+        size_t size = ZSTD_decompress(dst, dst_size, src, src_size);
+        return !ZSTD_isError(size) && size == dst_size;
+    }
+    default:
+        return false;
+    }
+}
+
+// Whether the header of `msg` is put ahead of the body in buffers[0], which is true for the
+// messages to be sent, while the received messages only keep the body in their buffers.
+bool is_header_in_buffers(const message_ex *msg)
+{
+    return !msg->buffers.empty() &&
+           msg->buffers[0].data() == reinterpret_cast<const char *>(msg->header);
+}
+
+} // anonymous namespace
+
+bool parse_rpc_compress_type(const char *str, rpc_compress_type &type)
+{
+    if (strcmp(str, "none") == 0) {
+        type = rpc_compress_type::kNone;
+    } else if (strcmp(str, "lz4") == 0) {
+        type = rpc_compress_type::kLz4;
+    } else if (strcmp(str, "zstd") == 0) {
+        type = rpc_compress_type::kZstd;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+rpc_compress_type configured_rpc_compress_type()
+{
+    rpc_compress_type type = rpc_compress_type::kNone;
+    parse_rpc_compress_type(FLAGS_rpc_compress_type, type);
+    return type;
+}
+
+bool compress_message_body(message_ex *msg, rpc_compress_type type)
+{
+    auto *header = msg->header;
+    if (type == rpc_compress_type::kNone || header->context.u.compress_type != 0 ||
+        header->body_length < FLAGS_rpc_compress_min_body_size ||
+        !is_header_in_buffers(msg)) {
+        return false;
+    }
+
+    const uint64_t start_ns = dsn_now_ns();
+
+    // Gather the body scattered among the buffers, unless it is contiguous already.
+    const size_t raw_size = header->body_length;
+    blob raw;
+    if (msg->buffers.size() == 1) {
+        raw = msg->buffers[0].range(sizeof(message_header));
+    } else {
+        auto buffer = utils::make_shared_array<char>(raw_size);
+        size_t offset = 0;
+        for (size_t i = 0; i < msg->buffers.size(); ++i) {
+            const auto &buf = msg->buffers[i];
+            const size_t skip = (i == 0 ? sizeof(message_header) : 0);
+            memcpy(buffer.get() + offset, buf.data() + skip, buf.length() - skip);
+            offset += buf.length() - skip;
+        }
+        CHECK_EQ(offset, raw_size);
+        raw = blob(std::move(buffer), raw_size);
+    }
+
+    const size_t bound = compress_bound(type, raw_size);
+    const size_t capacity = sizeof(message_header) + kRawLengthSize + bound;
+    auto buffer = utils::make_shared_array<char>(capacity);
+    char *body = buffer.get() + sizeof(message_header);
+    const size_t compressed_size =
+        compress(type, raw.data(), raw_size, body + kRawLengthSize, bound);
+    if (compressed_size == 0 || compressed_size + kRawLengthSize >= raw_size) {
+        // Not worth compressing, send it as it was.
+        return false;
+    }
+
+    const auto raw_length = static_cast<uint32_t>(raw_size);
+    memcpy(body, &raw_length, kRawLengthSize);
+    memcpy(buffer.get(), header, sizeof(message_header));
+
+    const size_t body_size = kRawLengthSize + compressed_size;
+    msg->buffers.clear();
+    msg->buffers.emplace_back(std::move(buffer), sizeof(message_header) + body_size);
+    msg->header = reinterpret_cast<message_header *>(const_cast<char *>(msg->buffers[0].data()));
+    msg->header->body_length = static_cast<uint32_t>(body_size);
+    msg->header->body_crc32 = CRC_INVALID;
+    msg->header->context.u.compress_type = static_cast<uint8_t>(type);
+
+    rpc_compression_metrics::instance().on_compressed(
+        type, raw_size, body_size, dsn_now_ns() - start_ns);
+    return true;
+}
+
+bool decompress_message_body(message_ex *msg)
+{
+    auto *header = msg->header;
+    const auto type = static_cast<rpc_compress_type>(header->context.u.compress_type);
+    if (type == rpc_compress_type::kNone) {
+        return true;
+    }
+
+    // Both of the received and the compressed messages keep the body in a single buffer.
+    if (msg->buffers.size() != 1) {
+        LOG_ERROR("the compressed body of message should be contiguous, buffers = {}",
+                  msg->buffers.size());
+        return false;
+    }
+
+    const bool header_in_buffers = is_header_in_buffers(msg);
+    const blob body = header_in_buffers ? msg->buffers[0].range(sizeof(message_header))
+                                        : msg->buffers[0];
+    if (body.length() < kRawLengthSize) {
+        LOG_ERROR("the compressed body of message is too short, length = {}", body.length());
+        return false;
+    }
+
+    uint32_t raw_size = 0;
+    memcpy(&raw_size, body.data(), kRawLengthSize);
+    if (raw_size > kMaxUncompressedSize) {
+        LOG_ERROR("the uncompressed body of message is too large, length = {}", raw_size);
+        return false;
+    }
+
+    const uint64_t start_ns = dsn_now_ns();
+    const size_t total_size = sizeof(message_header) + raw_size;
+    auto buffer = utils::make_shared_array<char>(total_size);
+    if (!decompress(type,
+                    body.data() + kRawLengthSize,
+                    body.length() - kRawLengthSize,
+                    buffer.get() + sizeof(message_header),
+                    raw_size)) {
+        LOG_ERROR("failed to decompress the body of message, rpc_name = {}, id = {}",
+                  header->rpc_name,
+                  header->id);
+        return false;
+    }
+    memcpy(buffer.get(), header, sizeof(message_header));
+
+    // The header is hidden ahead of the body, just like the messages not compressed.
+    blob data(std::move(buffer), total_size);
+    msg->header = reinterpret_cast<message_header *>(const_cast<char *>(data.data()));
+    msg->header->body_length = raw_size;
+    msg->header->body_crc32 = CRC_INVALID;
+    msg->header->context.u.compress_type = 0;
+    msg->buffers.clear();
+    msg->buffers.emplace_back(header_in_buffers ? std::move(data)
+                                                : data.range(sizeof(message_header)));
+
+    rpc_compression_metrics::instance().on_decompressed(type, dsn_now_ns() - start_ns);
+    return true;
+}
+
+rpc_compression_metrics::rpc_compression_metrics()
+    : METRIC_VAR_INIT_server(rpc_lz4_compressed_bytes),
+      METRIC_VAR_INIT_server(rpc_lz4_compress_saved_bytes),
+      METRIC_VAR_INIT_server(rpc_lz4_compress_duration_ns),
+      METRIC_VAR_INIT_server(rpc_lz4_decompress_duration_ns),
+      METRIC_VAR_INIT_server(rpc_zstd_compressed_bytes),
+      METRIC_VAR_INIT_server(rpc_zstd_compress_saved_bytes),
+      METRIC_VAR_INIT_server(rpc_zstd_compress_duration_ns),
+      METRIC_VAR_INIT_server(rpc_zstd_decompress_duration_ns)
+{
+}
+
+void rpc_compression_metrics::on_compressed(rpc_compress_type type,
+                                            uint64_t raw_bytes,
+                                            uint64_t compressed_bytes,
+                                            uint64_t duration_ns)
+{
+    const auto saved_bytes = static_cast<int64_t>(raw_bytes - compressed_bytes);
+    switch (type) {
+    case rpc_compress_type::kLz4:
+        METRIC_VAR_INCREMENT_BY(rpc_lz4_compressed_bytes, raw_bytes);
+        METRIC_VAR_INCREMENT_BY(rpc_lz4_compress_saved_bytes, saved_bytes);
+        METRIC_VAR_INCREMENT_BY(rpc_lz4_compress_duration_ns, duration_ns);
+        break;
+    case rpc_compress_type::kZstd:
+        METRIC_VAR_INCREMENT_BY(rpc_zstd_compressed_bytes, raw_bytes);
+        METRIC_VAR_INCREMENT_BY(rpc_zstd_compress_saved_bytes, saved_bytes);
+        METRIC_VAR_INCREMENT_BY(rpc_zstd_compress_duration_ns, duration_ns);
+        break;
+    default:
+        break;
+    }
+}
+
+void rpc_compression_metrics::on_decompressed(rpc_compress_type type, uint64_t duration_ns)
+{
+    switch (type) {
+    case rpc_compress_type::kLz4:
+        METRIC_VAR_INCREMENT_BY(rpc_lz4_decompress_duration_ns, duration_ns);
+        break;
+    case rpc_compress_type::kZstd:
+        METRIC_VAR_INCREMENT_BY(rpc_zstd_decompress_duration_ns, duration_ns);
+        break;
+    default:
+        break;
+    }
+}
+
+} // namespace dsn
@@ -0,0 +1,89 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "utils/metrics.h"
+#include "utils/singleton.h"
+
+namespace dsn {
+class message_ex;
+
+// The codecs that the bodies of dsn messages could be compressed with, which are carried by
+// msg_context_t::compress_type in the message header.
+enum class rpc_compress_type : uint8_t
+{
+    kNone = 0,
+    kLz4 = 1,
+    kZstd = 2,
+};
+
+// Parses the codec from one of "none", "lz4" and "zstd".
+bool parse_rpc_compress_type(const char *str, rpc_compress_type &type);
+
+// The codec configured by [network] rpc_compress_type, which the bodies of the messages sent to
+// the peers accepting compressed bodies are compressed with.
+rpc_compress_type configured_rpc_compress_type();
+
+// Compresses the body of `msg` which is about to be sent in place: the header and the compressed
+// body are put into a single buffer, laid out as
+//
+//   message_header | uint32_t uncompressed body length | compressed body
+//
+// The message is left as it was if its body is smaller than [network] rpc_compress_min_body_size,
+// it has been compressed already, or the compressed form would not be smaller. Returns whether
+// the body is compressed.
+bool compress_message_body(message_ex *msg, rpc_compress_type type);
+
+// Restores the compressed body of `msg` in place, either received from the peer or compressed by
+// compress_message_body(). Returns false if the body could not be decompressed, where `msg` is
+// left unchanged.
+bool decompress_message_body(message_ex *msg);
+
+// The per-codec metrics of the rpc body compression of this node.
+class rpc_compression_metrics : public utils::singleton<rpc_compression_metrics>
+{
+public:
+    // `raw_bytes` and `compressed_bytes` are the lengths of the body before and after being
+    // compressed.
+    void on_compressed(rpc_compress_type type,
+                       uint64_t raw_bytes,
+                       uint64_t compressed_bytes,
+                       uint64_t duration_ns);
+    void on_decompressed(rpc_compress_type type, uint64_t duration_ns);
+
+private:
+    rpc_compression_metrics();
+    ~rpc_compression_metrics() = default;
+
+    friend class utils::singleton<rpc_compression_metrics>;
+
+    METRIC_VAR_DECLARE_counter(rpc_lz4_compressed_bytes);
+    METRIC_VAR_DECLARE_counter(rpc_lz4_compress_saved_bytes);
+    METRIC_VAR_DECLARE_counter(rpc_lz4_compress_duration_ns);
+    METRIC_VAR_DECLARE_counter(rpc_lz4_decompress_duration_ns);
+    METRIC_VAR_DECLARE_counter(rpc_zstd_compressed_bytes);
+    METRIC_VAR_DECLARE_counter(rpc_zstd_compress_saved_bytes);
+    METRIC_VAR_DECLARE_counter(rpc_zstd_compress_duration_ns);
+    METRIC_VAR_DECLARE_counter(rpc_zstd_decompress_duration_ns);
+};
+
+} // namespace dsn
@@ -420,6 +420,23 @@ void message_ex::write_commit(size_t size)
     this->header->body_length += (int)size;
 }
 
+void message_ex::write_append(const blob &data)
+{
+    CHECK(!this->_is_read && this->_rw_committed,
+          "there are pending msg write not committed"
+          ", please invoke dsn_msg_write_next and dsn_msg_write_commit in pairs");
+    if (data.empty()) {
+        return;
+    }
+
+    this->_rw_index++;
+    this->_rw_offset = static_cast<int>(data.length());
+    this->buffers.push_back(data);
+    this->header->body_length += data.length();
+
+    CHECK_EQ_MSG(_rw_index + 1, buffers.size(), "message write buffer count is not right");
+}
+
 bool message_ex::read_next(void **ptr, size_t *size)
 {
     // printf("%p %s %d\n", this, __FUNCTION__, utils::get_current_tid());
@@ -487,6 +504,31 @@ void message_ex::restore_read()
     _rw_offset = 0;
 }
 
+read_staleness_bound message_ex::get_read_staleness_bound() const
+{
+    read_staleness_bound bound;
+    const auto type = header->context.u.read_bound_type;
+    // Ignore the bound types unknown by this version.
+    if (type == static_cast<uint64_t>(read_staleness_bound_type::kMinCommittedDecree) ||
+        type == static_cast<uint64_t>(read_staleness_bound_type::kMaxStalenessMs)) {
+        bound.type = static_cast<read_staleness_bound_type>(type);
+        bound.value = header->context.u.read_bound;
+    }
+    return bound;
+}
+
+void message_ex::set_read_staleness_bound(const read_staleness_bound &bound)
+{
+    if (bound.type == read_staleness_bound_type::kNone) {
+        header->context.u.read_bound_type = 0;
+        header->context.u.read_bound = 0;
+        return;
+    }
+
+    header->context.u.read_bound_type = static_cast<uint64_t>(bound.type);
+    header->context.u.read_bound = std::min(bound.value, kMaxReadStalenessBound);
+}
+
 void *message_ex::rw_ptr(size_t offset_begin)
 {
     // printf("%p %s\n", this, __FUNCTION__);
@@ -63,17 +63,42 @@ struct fast_code
     uint32_t local_hash;
 };
 
+// The bound of the data staleness that a read request could tolerate. A read with a bound could
+// be served by a secondary replica, as long as the replica satisfies the bound.
+enum class read_staleness_bound_type : uint8_t
+{
+    kNone = 0,
+    // The bound is the minimum committed decree that the replica should have reached, e.g. the
+    // decree returned by a write, which is used as a read-after-write token.
+    kMinCommittedDecree = 1,
+    // The bound is the max milliseconds that the replica could lag behind the primary.
+    kMaxStalenessMs = 2,
+};
+
+struct read_staleness_bound
+{
+    read_staleness_bound_type type = read_staleness_bound_type::kNone;
+    uint64_t value = 0;
+};
+
+// The max value of read_staleness_bound that could be carried by message_header.
+constexpr uint64_t kMaxReadStalenessBound = (1ULL << 48) - 1;
+
 typedef union msg_context
 {
     struct
     {
         uint64_t is_request : 1;           ///< whether the RPC message is a request or response
         uint64_t is_forwarded : 1;         ///< whether the msg is forwarded or not
-        uint64_t unused : 4;               ///< not used yet
+        uint64_t accept_compress : 1;      ///< whether the sender could decompress the bodies
+        uint64_t compress_type : 2;        ///< rpc_compress_type of the body
+        uint64_t unused : 1;               ///< not used yet
         uint64_t serialize_format : 4;     ///< dsn_msg_serialize_format
         uint64_t is_forward_supported : 1; ///< whether support forwarding a message to real leader
         uint64_t is_backup_request : 1;    ///< whether the RPC is a backup request
-        uint64_t reserved : 52;
+        uint64_t read_bound_type : 2;      ///< read_staleness_bound_type of a read request
+        uint64_t read_bound : 48;          ///< the bound value of the read_bound_type
+        uint64_t reserved : 2;
     } u;
     uint64_t context; ///< msg_context is of sizeof(uint64_t)
 } msg_context_t;
@@ -235,6 +260,8 @@ public:
     //
     void write_next(void **ptr, size_t *size, size_t min_size);
     void write_commit(size_t size);
+    // Append `data` to the message as a standalone buffer, without copying it.
+    void write_append(const blob &data);
     bool read_next(void **ptr, size_t *size);
     bool read_next(blob &data);
     void read_commit(size_t size);
@@ -249,6 +276,15 @@ public:
 
     bool is_backup_request() const { return header->context.u.is_backup_request; }
 
+    // Whether the read request could be served by a secondary replica satisfying the bound.
+    bool is_bounded_staleness_read() const
+    {
+        return get_read_staleness_bound().type != read_staleness_bound_type::kNone;
+    }
+    read_staleness_bound get_read_staleness_bound() const;
+    // The bound value is clamped to kMaxReadStalenessBound. Set the type to kNone to clear it.
+    void set_read_staleness_bound(const read_staleness_bound &bound);
+
 private:
     message_ex();
     void prepare_buffer_header();
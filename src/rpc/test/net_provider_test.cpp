@@ -36,6 +36,7 @@
 #include "runtime/api_task.h"
 #include "runtime/global_config.h"
 #include "rpc/asio_net_provider.h"
+#include "rpc/epoll_net_provider.h"
 #include "rpc/network.h"
 #include "rpc/network.sim.h"
 #include "rpc/rpc_address.h"
@@ -182,6 +183,53 @@ TEST(net_provider_test, asio_net_provider)
     TEST_PORT++;
 }
 
+#if defined(__linux__)
+TEST(net_provider_test, epoll_net_provider)
+{
+    if (dsn::service_engine::instance().spec().semaphore_factory_name ==
+        "dsn::tools::sim_semaphore_provider") {
+        GTEST_SKIP() << "Skip the test in simulator mode, set 'tool = nativerun' in '[core]' "
+                        "section in config file to enable it.";
+    }
+
+    ASSERT_TRUE(dsn_rpc_register_handler(
+        RPC_TEST_NETPROVIDER, "rpc.test.netprovider", rpc_server_response));
+
+    std::unique_ptr<tools::epoll_network_provider> epoll_network(
+        new tools::epoll_network_provider(task::get_current_rpc(), nullptr));
+
+    error_code start_result;
+    start_result = epoll_network->start(RPC_CHANNEL_TCP, TEST_PORT, true);
+    ASSERT_EQ(ERR_OK, start_result);
+
+    // the same network handle, start only client is ok
+    start_result = epoll_network->start(RPC_CHANNEL_TCP, TEST_PORT, true);
+    ASSERT_EQ(ERR_OK, start_result);
+    ASSERT_EQ(TEST_PORT, epoll_network->address().port());
+
+    std::unique_ptr<tools::epoll_network_provider> epoll_network2(
+        new tools::epoll_network_provider(task::get_current_rpc(), nullptr));
+    start_result = epoll_network2->start(RPC_CHANNEL_TCP, TEST_PORT, false);
+    ASSERT_EQ(ERR_OK, start_result);
+
+    start_result = epoll_network2->start(RPC_CHANNEL_TCP, TEST_PORT, false);
+    ASSERT_EQ(ERR_SERVICE_ALREADY_RUNNING, start_result);
+
+    rpc_session_ptr client_session =
+        epoll_network->create_client_session(rpc_address::from_host_port("localhost", TEST_PORT));
+    client_session->connect();
+
+    // Send several times through the same session.
+    for (int i = 0; i < 10; ++i) {
+        rpc_client_session_send(client_session);
+    }
+
+    ASSERT_TRUE(dsn_rpc_unregiser_handler(RPC_TEST_NETPROVIDER));
+
+    TEST_PORT++;
+}
+#endif // defined(__linux__)
+
 TEST(net_provider_test, asio_udp_provider)
 {
     if (dsn::service_engine::instance().spec().semaphore_factory_name ==
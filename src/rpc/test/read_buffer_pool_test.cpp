@@ -0,0 +1,120 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <thread>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "rpc/message_parser.h"
+#include "rpc/read_buffer_pool.h"
+#include "test_util/test_util.h"
+#include "utils/blob.h"
+#include "utils/flags.h"
+
+DSN_DECLARE_bool(enable_read_buffer_pool);
+DSN_DECLARE_uint64(read_buffer_pool_max_cached_bytes);
+
+namespace dsn {
+
+TEST(read_buffer_pool_test, reuse_released_buffer)
+{
+    auto &pool = read_buffer_pool::instance();
+    const char *data = nullptr;
+    size_t cached_bytes = 0;
+    {
+        auto buffer = pool.allocate(5000);
+        ASSERT_EQ(5000, buffer.length());
+        data = buffer.data();
+        cached_bytes = pool.cached_bytes();
+
+        // A slice referencing the buffer keeps it from being released.
+        auto slice = buffer.range(100, 200);
+        buffer = blob();
+        ASSERT_EQ(cached_bytes, pool.cached_bytes());
+    }
+    ASSERT_EQ(cached_bytes + 8 * 1024, pool.cached_bytes());
+
+    // The buffers of the same size class are reused.
+    auto buffer = pool.allocate(8 * 1024);
+    ASSERT_EQ(data, buffer.data());
+    ASSERT_EQ(cached_bytes, pool.cached_bytes());
+}
+
+TEST(read_buffer_pool_test, not_pooled)
+{
+    auto &pool = read_buffer_pool::instance();
+    const auto cached_bytes = pool.cached_bytes();
+
+    // The buffers larger than the largest size class are not pooled.
+    pool.allocate(read_buffer_pool::kMaxChunkSize + 1);
+    ASSERT_EQ(cached_bytes, pool.cached_bytes());
+
+    PRESERVE_FLAG(enable_read_buffer_pool);
+    FLAGS_enable_read_buffer_pool = false;
+    pool.allocate(4096);
+    ASSERT_EQ(cached_bytes, pool.cached_bytes());
+}
+
+TEST(read_buffer_pool_test, max_cached_bytes)
+{
+    auto &pool = read_buffer_pool::instance();
+    PRESERVE_FLAG(read_buffer_pool_max_cached_bytes);
+    size_t cached_bytes = 0;
+    {
+        auto buffer1 = pool.allocate(read_buffer_pool::kMinChunkSize);
+        auto buffer2 = pool.allocate(read_buffer_pool::kMinChunkSize);
+        cached_bytes = pool.cached_bytes();
+        FLAGS_read_buffer_pool_max_cached_bytes = cached_bytes + read_buffer_pool::kMinChunkSize;
+    }
+    // Only one of the buffers is cached.
+    ASSERT_EQ(cached_bytes + read_buffer_pool::kMinChunkSize, pool.cached_bytes());
+}
+
+TEST(read_buffer_pool_test, release_on_other_thread)
+{
+    auto &pool = read_buffer_pool::instance();
+    auto buffer = pool.allocate(read_buffer_pool::kMinChunkSize);
+    const auto cached_bytes = pool.cached_bytes();
+
+    // The buffer goes back to the pool it is allocated from.
+    std::thread t([b = std::move(buffer)]() mutable { b = blob(); });
+    t.join();
+    ASSERT_EQ(cached_bytes + read_buffer_pool::kMinChunkSize, pool.cached_bytes());
+}
+
+TEST(read_buffer_pool_test, message_reader)
+{
+    auto &pool = read_buffer_pool::instance();
+    message_reader reader(4096);
+    const char *data = reader.read_buffer_ptr(10);
+    reader.mark_read(10);
+    auto received = reader.buffer();
+
+    // The buffer switched out is still referenced by the received data.
+    reader.truncate_read();
+    reader.read_buffer_ptr(8192);
+    const auto cached_bytes = pool.cached_bytes();
+    ASSERT_EQ(data, received.data());
+
+    // The buffer is returned to the pool once the received data is released.
+    received = blob();
+    ASSERT_EQ(cached_bytes + 4096, pool.cached_bytes());
+}
+
+} // namespace dsn
@@ -0,0 +1,210 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "rpc/dsn_message_parser.h"
+#include "rpc/message_parser.h"
+#include "rpc/rpc_compression.h"
+#include "rpc/rpc_message.h"
+#include "task/task_code.h"
+#include "test_util/test_util.h"
+#include "utils/blob.h"
+#include "utils/crc.h"
+#include "utils/flags.h"
+#include "utils/threadpool_code.h"
+
+DSN_DECLARE_uint32(rpc_compress_min_body_size);
+
+namespace dsn {
+
+DEFINE_TASK_CODE_RPC(RPC_CODE_FOR_COMPRESSION_TEST, TASK_PRIORITY_COMMON, THREAD_POOL_DEFAULT)
+
+namespace {
+
+// Create a request whose body is made up of `pieces`, each in its own buffer.
+message_ex *create_request(const std::vector<std::string> &pieces)
+{
+    auto *msg = message_ex::create_request(RPC_CODE_FOR_COMPRESSION_TEST);
+    for (const auto &piece : pieces) {
+        void *ptr = nullptr;
+        size_t size = 0;
+        msg->write_next(&ptr, &size, piece.size());
+        memcpy(ptr, piece.data(), piece.size());
+        msg->write_commit(piece.size());
+    }
+    return msg;
+}
+
+std::string body_of(const message_ex *msg)
+{
+    std::string body;
+    for (const auto &buf : msg->buffers) {
+        body.append(buf.data(), buf.length());
+    }
+    if (!msg->buffers.empty() &&
+        msg->buffers[0].data() == reinterpret_cast<const char *>(msg->header)) {
+        body.erase(0, sizeof(message_header));
+    }
+    return body;
+}
+
+} // anonymous namespace
+
+class rpc_compression_test : public testing::TestWithParam<rpc_compress_type>
+{
+};
+
+TEST_P(rpc_compression_test, compress_and_decompress)
+{
+    const std::vector<std::string> pieces = {
+        std::string(3000, 'a'), std::string(5000, 'b'), std::string(8000, 'c')};
+    const std::string raw = pieces[0] + pieces[1] + pieces[2];
+
+    auto *msg = create_request(pieces);
+    msg->add_ref();
+    ASSERT_TRUE(compress_message_body(msg, GetParam()));
+    ASSERT_EQ(static_cast<uint8_t>(GetParam()), msg->header->context.u.compress_type);
+    ASSERT_EQ(CRC_INVALID, msg->header->body_crc32);
+    ASSERT_EQ(1u, msg->buffers.size());
+    ASSERT_LT(msg->header->body_length, raw.size());
+    ASSERT_EQ(msg->header->body_length + sizeof(message_header), msg->buffers[0].length());
+    ASSERT_STREQ(task_code(RPC_CODE_FOR_COMPRESSION_TEST).to_string(), msg->header->rpc_name);
+
+    // A compressed body is never compressed again.
+    ASSERT_FALSE(compress_message_body(msg, GetParam()));
+
+    ASSERT_TRUE(decompress_message_body(msg));
+    ASSERT_EQ(0, msg->header->context.u.compress_type);
+    ASSERT_EQ(raw.size(), msg->header->body_length);
+    ASSERT_EQ(raw, body_of(msg));
+    msg->release_ref();
+}
+
+TEST_P(rpc_compression_test, send_and_receive)
+{
+    const std::string raw(64 * 1024, 'x');
+    auto *msg = create_request({raw});
+    msg->add_ref();
+    ASSERT_TRUE(compress_message_body(msg, GetParam()));
+
+    // Send it through the dsn parser, and then receive it from the bytes on the wire.
+    dsn_message_parser parser;
+    parser.prepare_on_send(msg);
+    std::vector<message_parser::send_buf> send_bufs(msg->buffers.size());
+    const int count = parser.get_buffers_on_send(msg, send_bufs.data());
+    std::string stream;
+    for (int i = 0; i < count; ++i) {
+        stream.append(static_cast<const char *>(send_bufs[i].buf), send_bufs[i].sz);
+    }
+    ASSERT_LT(stream.size(), raw.size());
+
+    message_reader reader(4096);
+    char *ptr = reader.read_buffer_ptr(stream.size());
+    memcpy(ptr, stream.data(), stream.size());
+    reader.mark_read(stream.size());
+
+    int read_next = 0;
+    auto *received = parser.get_message_on_receive(&reader, read_next);
+    ASSERT_NE(nullptr, received);
+    ASSERT_EQ(0, received->header->context.u.compress_type);
+    ASSERT_EQ(raw.size(), received->header->body_length);
+    ASSERT_EQ(raw, body_of(received));
+    ASSERT_EQ(reinterpret_cast<const char *>(received->header) + sizeof(message_header),
+              received->buffers[0].data());
+
+    delete received;
+    msg->release_ref();
+}
+
+TEST_P(rpc_compression_test, corrupted_body)
+{
+    auto *msg = create_request({std::string(64 * 1024, 'x')});
+    msg->add_ref();
+    ASSERT_TRUE(compress_message_body(msg, GetParam()));
+
+    // Claim a larger uncompressed length than the real one.
+    auto *body = const_cast<char *>(msg->buffers[0].data()) + sizeof(message_header);
+    uint32_t raw_size = 0;
+    memcpy(&raw_size, body, sizeof(raw_size));
+    ++raw_size;
+    memcpy(body, &raw_size, sizeof(raw_size));
+
+    const auto body_length = msg->header->body_length;
+    ASSERT_FALSE(decompress_message_body(msg));
+    ASSERT_EQ(static_cast<uint8_t>(GetParam()), msg->header->context.u.compress_type);
+    ASSERT_EQ(body_length, msg->header->body_length);
+    msg->release_ref();
+}
+
+INSTANTIATE_TEST_SUITE_P(,
+                         rpc_compression_test,
+                         ::testing::Values(rpc_compress_type::kLz4, rpc_compress_type::kZstd));
+
+TEST(rpc_compression, not_compressed)
+{
+    PRESERVE_FLAG(rpc_compress_min_body_size);
+    FLAGS_rpc_compress_min_body_size = 4096;
+
+    // The small bodies are not compressed.
+    auto *msg = create_request({std::string(4095, 'x')});
+    msg->add_ref();
+    ASSERT_FALSE(compress_message_body(msg, rpc_compress_type::kLz4));
+    ASSERT_EQ(0, msg->header->context.u.compress_type);
+    ASSERT_EQ(4095u, msg->header->body_length);
+    msg->release_ref();
+
+    // The bodies are not compressed if the compressed form would not be smaller.
+    std::string random_body;
+    uint32_t seed = 1;
+    for (int i = 0; i < 8192; ++i) {
+        seed = seed * 1103515245 + 12345;
+        random_body.push_back(static_cast<char>(seed >> 16));
+    }
+    msg = create_request({random_body});
+    msg->add_ref();
+    ASSERT_FALSE(compress_message_body(msg, rpc_compress_type::kLz4));
+    ASSERT_EQ(random_body, body_of(msg));
+    msg->release_ref();
+
+    // Nothing to do with none.
+    msg = create_request({std::string(8192, 'x')});
+    msg->add_ref();
+    ASSERT_FALSE(compress_message_body(msg, rpc_compress_type::kNone));
+    ASSERT_TRUE(decompress_message_body(msg));
+    ASSERT_EQ(8192u, msg->header->body_length);
+    msg->release_ref();
+}
+
+TEST(rpc_compression, parse_rpc_compress_type)
+{
+    rpc_compress_type type;
+    ASSERT_TRUE(parse_rpc_compress_type("none", type));
+    ASSERT_EQ(rpc_compress_type::kNone, type);
+    ASSERT_TRUE(parse_rpc_compress_type("lz4", type));
+    ASSERT_EQ(rpc_compress_type::kLz4, type);
+    ASSERT_TRUE(parse_rpc_compress_type("zstd", type));
+    ASSERT_EQ(rpc_compress_type::kZstd, type);
+    ASSERT_FALSE(parse_rpc_compress_type("snappy", type));
+}
+
+} // namespace dsn
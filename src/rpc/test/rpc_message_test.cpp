@@ -202,6 +202,59 @@ TEST(rpc_message_test, restore_read)
     }
 }
 
+TEST(rpc_message_test, write_append)
+{
+    query_cfg_request request, result;
+    request.app_name = "test_app";
+    const auto attachment = blob::create_from_bytes(std::string(1000, 'a'));
+
+    message_ptr msg = message_ex::create_request(RPC_CODE_FOR_TEST, 100, 1, 1);
+    marshall(msg, request);
+    const auto body_size = msg->body_size();
+    const auto buffer_count = msg->buffers.size();
+    msg->write_append(attachment);
+
+    // The attachment is appended without being copied.
+    ASSERT_EQ(body_size + attachment.length(), msg->body_size());
+    ASSERT_EQ(buffer_count + 1, msg->buffers.size());
+    ASSERT_EQ(attachment.data(), msg->buffers.back().data());
+
+    // The attachment follows the serialized request in the received message.
+    message_ptr received = msg->copy(true, true);
+    unmarshall(received, result);
+    ASSERT_EQ(request.app_name, result.app_name);
+    blob data;
+    ASSERT_TRUE(received->read_next(data));
+    received->read_commit(data.length());
+    ASSERT_EQ(attachment.to_string_view(), data.to_string_view());
+    ASSERT_FALSE(received->read_next(data));
+}
+
+TEST(rpc_message_test, read_staleness_bound)
+{
+    message_ptr msg = message_ex::create_request(RPC_CODE_FOR_TEST, 100, 1, 1);
+    ASSERT_FALSE(msg->is_bounded_staleness_read());
+
+    msg->set_read_staleness_bound({read_staleness_bound_type::kMinCommittedDecree, 100});
+    ASSERT_TRUE(msg->is_bounded_staleness_read());
+    ASSERT_EQ(read_staleness_bound_type::kMinCommittedDecree,
+              msg->get_read_staleness_bound().type);
+    ASSERT_EQ(100, msg->get_read_staleness_bound().value);
+
+    // The bound is clamped.
+    msg->set_read_staleness_bound({read_staleness_bound_type::kMaxStalenessMs, UINT64_MAX});
+    ASSERT_EQ(read_staleness_bound_type::kMaxStalenessMs, msg->get_read_staleness_bound().type);
+    ASSERT_EQ(kMaxReadStalenessBound, msg->get_read_staleness_bound().value);
+
+    // The bound types unknown are ignored.
+    msg->header->context.u.read_bound_type = 3;
+    ASSERT_FALSE(msg->is_bounded_staleness_read());
+
+    msg->set_read_staleness_bound({});
+    ASSERT_FALSE(msg->is_bounded_staleness_read());
+    ASSERT_EQ(0, msg->header->context.u.read_bound);
+}
+
 TEST(rpc_message_test, create_receive_message_with_standalone_header)
 {
     const auto data = blob::create_from_bytes("10086");
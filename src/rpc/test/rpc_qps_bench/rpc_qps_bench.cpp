@@ -0,0 +1,273 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <fmt/core.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rpc/rpc_address.h"
+#include "rpc/rpc_message.h"
+#include "rpc/serialization.h"
+#include "runtime/api_layer1.h"
+#include "runtime/app_model.h"
+#include "runtime/serverlet.h"
+#include "runtime/service_app.h"
+#include "task/async_calls.h"
+#include "task/task_code.h"
+#include "task/task_tracker.h"
+#include "utils/error_code.h"
+#include "utils/string_conv.h"
+#include "utils/threadpool_code.h"
+
+DEFINE_THREAD_POOL_CODE(THREAD_POOL_BENCH_SERVER)
+DEFINE_TASK_CODE_RPC(RPC_BENCH_ECHO, TASK_PRIORITY_COMMON, THREAD_POOL_BENCH_SERVER)
+
+namespace {
+
+struct bench_options
+{
+    std::string provider;
+    uint64_t duration_seconds = 10;
+    uint64_t concurrency = 64;
+    uint64_t payload_size = 32;
+} g_options;
+
+std::atomic<bool> g_finished(false);
+int g_ret = 0;
+
+void print_usage(const char *cmd)
+{
+    fmt::print("USAGE: {} <asio|epoll> [duration_seconds] [concurrency] [payload_size]\n", cmd);
+    fmt::print("Run a simple benchmark of small rpc requests, where an echo server and a client\n"
+               "run in the same process over the loopback tcp connection, and both of them use\n"
+               "the given network provider. The threads are configured in config.ini.\n\n");
+
+    fmt::print("    <asio|epoll>           the network provider, asio_network_provider or\n"
+               "                           epoll_network_provider.\n");
+    fmt::print("    [duration_seconds]     the duration of the run, 10 by default.\n");
+    fmt::print("    [concurrency]          the number of outstanding requests, 64 by default.\n");
+    fmt::print("    [payload_size]         the bytes of each request and response, 32 by\n"
+               "                           default.\n");
+}
+
+// The user and system cpu time consumed by the whole process, in seconds.
+double process_cpu_seconds()
+{
+    struct rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+}
+
+class bench_server : public dsn::serverlet<bench_server>, public dsn::service_app
+{
+public:
+    explicit bench_server(const dsn::service_app_info *info)
+        : dsn::serverlet<bench_server>("bench_server"), dsn::service_app(info)
+    {
+    }
+
+    dsn::error_code start(const std::vector<std::string> &args) override
+    {
+        register_rpc_handler(RPC_BENCH_ECHO, "bench_echo", &bench_server::on_echo);
+        return dsn::ERR_OK;
+    }
+
+    dsn::error_code stop(bool cleanup) override
+    {
+        unregister_rpc_handler(RPC_BENCH_ECHO);
+        return dsn::ERR_OK;
+    }
+
+private:
+    void on_echo(dsn::message_ex *request)
+    {
+        std::string payload;
+        dsn::unmarshall(request, payload);
+        reply(request, payload);
+    }
+};
+
+class bench_client : public dsn::service_app
+{
+public:
+    explicit bench_client(const dsn::service_app_info *info) : dsn::service_app(info) {}
+
+    // args: <app_name> <server_host> <server_port>
+    dsn::error_code start(const std::vector<std::string> &args) override
+    {
+        uint32_t port = 0;
+        if (args.size() != 3 || !dsn::buf2uint32(args[2], port)) {
+            return dsn::ERR_INVALID_PARAMETERS;
+        }
+
+        const auto server = dsn::rpc_address::from_host_port(args[1], static_cast<uint16_t>(port));
+        _runner = std::thread([this, server]() {
+            run(server);
+            g_finished.store(true);
+        });
+        return dsn::ERR_OK;
+    }
+
+    dsn::error_code stop(bool cleanup) override
+    {
+        if (_runner.joinable()) {
+            _runner.join();
+        }
+        return dsn::ERR_OK;
+    }
+
+private:
+    void run(const dsn::rpc_address &server)
+    {
+        const std::string payload(g_options.payload_size, 'x');
+
+        // The server app may be started after the client app.
+        dsn::error_code err = dsn::ERR_UNKNOWN;
+        for (int i = 0; i < 100 && err != dsn::ERR_OK; ++i) {
+            err = dsn::rpc::call_wait<std::string>(server, RPC_BENCH_ECHO, payload).first;
+            if (err != dsn::ERR_OK) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
+        if (err != dsn::ERR_OK) {
+            fmt::print(stderr, "failed to connect to the server {}: {}\n", server, err);
+            g_ret = -1;
+            return;
+        }
+
+        std::atomic<uint64_t> issued(0);
+        std::atomic<uint64_t> completed(0);
+        std::atomic<uint64_t> failed(0);
+        dsn::task_tracker tracker;
+        const uint64_t start_ns = dsn_now_ns();
+        const uint64_t deadline_ns = start_ns + g_options.duration_seconds * 1000000000;
+        const double start_cpu_seconds = process_cpu_seconds();
+
+        // Each of the outstanding requests is followed by the next one once it is completed,
+        // until the deadline. The next one is issued before the completed one is counted, so
+        // that all the requests have been completed once the counts are equal after deadline.
+        std::function<void()> send_one = [&]() {
+            issued.fetch_add(1, std::memory_order_relaxed);
+            dsn::rpc::call(server,
+                           RPC_BENCH_ECHO,
+                           payload,
+                           &tracker,
+                           [&](dsn::error_code ec, std::string &&resp) {
+                               if (dsn_now_ns() < deadline_ns) {
+                                   send_one();
+                               }
+                               if (ec == dsn::ERR_OK && resp.size() == payload.size()) {
+                                   completed.fetch_add(1, std::memory_order_relaxed);
+                               } else {
+                                   failed.fetch_add(1, std::memory_order_relaxed);
+                               }
+                           });
+        };
+        for (uint64_t i = 0; i < g_options.concurrency; ++i) {
+            send_one();
+        }
+        while (dsn_now_ns() < deadline_ns || completed.load() + failed.load() < issued.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        tracker.wait_outstanding_tasks();
+
+        const double wall_seconds = (dsn_now_ns() - start_ns) / 1000000000.0;
+        const double cpu_cores = (process_cpu_seconds() - start_cpu_seconds) / wall_seconds;
+        const double qps = completed.load() / wall_seconds;
+        fmt::print("{:<8} {:>12} {:>8} {:>12} {:>10} {:>12} {:>8}\n",
+                   "provider",
+                   "concurrency",
+                   "payload",
+                   "qps",
+                   "cpu_cores",
+                   "qps/core",
+                   "failed");
+        fmt::print("{:<8} {:>12} {:>8} {:>12.1f} {:>10.2f} {:>12.1f} {:>8}\n",
+                   g_options.provider,
+                   g_options.concurrency,
+                   g_options.payload_size,
+                   qps,
+                   cpu_cores,
+                   cpu_cores == 0 ? 0.0 : qps / cpu_cores,
+                   failed.load());
+    }
+
+    std::thread _runner;
+};
+
+bool parse_arg(const char *arg, const char *name, uint64_t &value, const char *cmd)
+{
+    if (!dsn::buf2uint64(arg, value) || value == 0) {
+        fmt::print(stderr, "Invalid {}: {}\n\n", name, arg);
+        print_usage(cmd);
+        return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    g_options.provider = argv[1];
+    std::string provider_name;
+    if (g_options.provider == "asio") {
+        provider_name = "dsn::tools::asio_network_provider";
+    } else if (g_options.provider == "epoll") {
+        provider_name = "dsn::tools::epoll_network_provider";
+    } else {
+        fmt::print(stderr, "Invalid network provider: {}\n\n", argv[1]);
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    if ((argc >= 3 &&
+         !parse_arg(argv[2], "duration_seconds", g_options.duration_seconds, argv[0])) ||
+        (argc >= 4 && !parse_arg(argv[3], "concurrency", g_options.concurrency, argv[0])) ||
+        (argc >= 5 && !parse_arg(argv[4], "payload_size", g_options.payload_size, argv[0]))) {
+        ::exit(-1);
+    }
+
+    dsn::service_app::register_factory<bench_server>("bench_server");
+    dsn::service_app::register_factory<bench_client>("bench_client");
+
+    // The network provider of both the server and the client is substituted in config.ini.
+    std::string config_file("config.ini");
+    std::string cargs_flag("-cargs");
+    std::string cargs = "network_provider=" + provider_name;
+    std::vector<char *> run_argv = {argv[0], &config_file[0], &cargs_flag[0], &cargs[0]};
+    dsn_run(static_cast<int>(run_argv.size()), run_argv.data(), false);
+
+    while (!g_finished.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    dsn_exit(g_ret);
+    return g_ret;
+}
@@ -0,0 +1,183 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <fmt/core.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <string>
+
+#include "rpc/dsn_message_parser.h"
+#include "rpc/message_parser.h"
+#include "rpc/read_buffer_pool.h"
+#include "rpc/rpc_message.h"
+#include "runtime/api_layer1.h"
+#include "utils/crc.h"
+#include "utils/flags.h"
+#include "utils/rand.h"
+#include "utils/string_conv.h"
+
+DSN_DECLARE_bool(enable_read_buffer_pool);
+
+namespace {
+
+// The max bytes returned by a single read from socket.
+const size_t kSocketReadSize = 64 * 1024;
+const int kMessageBufferBlockSize = 64 * 1024;
+
+void print_usage(const char *cmd)
+{
+    fmt::print("USAGE: {} <message_count> [min_body_size] [max_body_size] [inflight]\n", cmd);
+    fmt::print("Run a simple benchmark that feeds a stream of dsn messages through the receive\n"
+               "path of rpc sessions (message_reader + dsn_message_parser), and compares the\n"
+               "throughput with and without the read buffer pool.\n\n");
+
+    fmt::print("    <message_count>        the number of messages received in each run.\n");
+    fmt::print("    [min_body_size]        the min body size of the messages, 4096 by default.\n");
+    fmt::print("    [max_body_size]        the max body size of the messages, 65536 by default.\n");
+    fmt::print("    [inflight]             the number of received messages being processed at\n"
+               "                           the same time, which hold the read buffers, 64 by\n"
+               "                           default.\n");
+}
+
+std::string generate_stream(uint64_t message_count, uint32_t min_body_size, uint32_t max_body_size)
+{
+    std::string stream;
+    for (uint64_t i = 0; i < message_count; ++i) {
+        dsn::message_header hdr{};
+        hdr.hdr_type = 0x4e534452; // "RDSN"
+        hdr.hdr_length = sizeof(hdr);
+        hdr.hdr_crc32 = CRC_INVALID;
+        hdr.body_crc32 = CRC_INVALID;
+        hdr.body_length = dsn::rand::next_u32(min_body_size, max_body_size);
+        hdr.id = i;
+
+        stream.append(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+        stream.append(hdr.body_length, static_cast<char>('a' + i % 26));
+    }
+    return stream;
+}
+
+// Returns the elapsed nanoseconds of receiving all of the messages in `stream`.
+int64_t run_recv(const std::string &stream, uint64_t message_count, size_t inflight)
+{
+    dsn::message_reader reader(kMessageBufferBlockSize);
+    dsn::dsn_message_parser parser;
+    std::deque<dsn::message_ex *> processing;
+    uint64_t received = 0;
+    size_t offset = 0;
+    int read_next = sizeof(dsn::message_header);
+
+    auto start = dsn_now_ns();
+    while (offset < stream.size()) {
+        char *ptr = reader.read_buffer_ptr(read_next);
+        size_t length =
+            std::min({static_cast<size_t>(reader.read_buffer_capacity()),
+                      stream.size() - offset,
+                      kSocketReadSize});
+        memcpy(ptr, stream.data() + offset, length);
+        offset += length;
+        reader.mark_read(length);
+
+        dsn::message_ex *msg = nullptr;
+        while ((msg = parser.get_message_on_receive(&reader, read_next)) != nullptr) {
+            ++received;
+            processing.push_back(msg);
+            if (processing.size() > inflight) {
+                delete processing.front();
+                processing.pop_front();
+            }
+        }
+        if (read_next == -1) {
+            fmt::print(stderr, "failed to parse the message stream\n");
+            ::exit(-1);
+        }
+    }
+    for (auto *m : processing) {
+        delete m;
+    }
+    auto end = dsn_now_ns();
+
+    if (received != message_count) {
+        fmt::print(stderr, "received {} messages, expect {}\n", received, message_count);
+        ::exit(-1);
+    }
+    return static_cast<int64_t>(end - start);
+}
+
+void run_bench(const std::string &name,
+               bool enable_pool,
+               const std::string &stream,
+               uint64_t message_count,
+               size_t inflight)
+{
+    FLAGS_enable_read_buffer_pool = enable_pool;
+    // Warm up the pool, which is what a long-running io thread is like.
+    run_recv(stream, message_count, inflight);
+    auto ns = run_recv(stream, message_count, inflight);
+
+    fmt::print("{:<10} {:>16.1f} {:>16.1f} {:>12}\n",
+               name,
+               ns == 0 ? 0.0 : static_cast<double>(message_count) * 1000000000 / ns,
+               ns == 0 ? 0.0 : static_cast<double>(stream.size()) * 1000 / ns,
+               dsn::read_buffer_pool::instance().cached_bytes());
+}
+
+bool parse_arg(const char *arg, const char *name, uint64_t &value, const char *cmd)
+{
+    if (!dsn::buf2uint64(arg, value) || value == 0) {
+        fmt::print(stderr, "Invalid {}: {}\n\n", name, arg);
+        print_usage(cmd);
+        return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    uint64_t message_count = 0;
+    uint64_t min_body_size = 4096;
+    uint64_t max_body_size = 64 * 1024;
+    uint64_t inflight = 64;
+    if (!parse_arg(argv[1], "message_count", message_count, argv[0]) ||
+        (argc >= 3 && !parse_arg(argv[2], "min_body_size", min_body_size, argv[0])) ||
+        (argc >= 4 && !parse_arg(argv[3], "max_body_size", max_body_size, argv[0])) ||
+        (argc >= 5 && !parse_arg(argv[4], "inflight", inflight, argv[0]))) {
+        ::exit(-1);
+    }
+    if (min_body_size > max_body_size) {
+        fmt::print(stderr, "min_body_size should not be larger than max_body_size\n\n");
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    const auto stream = generate_stream(message_count, min_body_size, max_body_size);
+    fmt::print("{:<10} {:>16} {:>16} {:>12}\n", "pool", "msgs/s", "MB/s", "cached(B)");
+    run_bench("disabled", false, stream, message_count, inflight);
+    run_bench("enabled", true, stream, message_count, inflight);
+
+    return 0;
+}
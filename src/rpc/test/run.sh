@@ -20,6 +20,15 @@ if [ -z "${REPORT_DIR}" ]; then
     REPORT_DIR="."
 fi
 
-rm -rf data dsn_rpc_tests.xml
-output_xml="${REPORT_DIR}/dsn_rpc_tests.xml"
-GTEST_OUTPUT="xml:${output_xml}" ./dsn_rpc_tests config.ini
+# Run all the tests against both of asio_network_provider and epoll_network_provider.
+for test_case in config.ini config-epoll.ini; do
+    rm -rf data
+    output_xml="${REPORT_DIR}/dsn_rpc_tests_${test_case%.ini}.xml"
+    echo "============ run dsn_rpc_tests ${test_case} ============"
+    GTEST_OUTPUT="xml:${output_xml}" ./dsn_rpc_tests ${test_case}
+    if [ $? -ne 0 ]; then
+        echo "run dsn_rpc_tests ${test_case} failed"
+        exit 1
+    fi
+    echo "============ done dsn_rpc_tests ${test_case} ============"
+done
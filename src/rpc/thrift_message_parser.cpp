@@ -283,6 +283,14 @@ message_ex *thrift_message_parser::parse_request_body_v1(message_reader *reader,
     msg->header->client.thread_hash = gpid_to_thread_hash(msg->header->gpid);
     msg->header->client.partition_hash = _v1_specific_vars->_meta_v1->client_partition_hash;
     msg->header->context.u.is_backup_request = _v1_specific_vars->_meta_v1->is_backup_request;
+    const auto &meta = *_v1_specific_vars->_meta_v1;
+    if (meta.__isset.min_committed_decree && meta.min_committed_decree >= 0) {
+        msg->set_read_staleness_bound({read_staleness_bound_type::kMinCommittedDecree,
+                                       static_cast<uint64_t>(meta.min_committed_decree)});
+    } else if (meta.__isset.max_staleness_ms && meta.max_staleness_ms >= 0) {
+        msg->set_read_staleness_bound({read_staleness_bound_type::kMaxStalenessMs,
+                                       static_cast<uint64_t>(meta.max_staleness_ms)});
+    }
     reset();
     return msg;
 }
@@ -80,6 +80,18 @@ public:
         }
     }
 
+    // Reply `resp` followed by `attachment`, which is appended to the response message without
+    // being copied, thus could be read from the message after `resp` is unmarshalled.
+    void operator()(const TResponse &resp, const blob &attachment)
+    {
+        if (_response != nullptr) {
+            ::dsn::marshall(_response, resp);
+            _response->write_append(attachment);
+            dsn_rpc_reply(_response);
+            _response = nullptr;
+        }
+    }
+
     bool is_empty() const { return _response == nullptr; }
 
     // response message, may be nullptr
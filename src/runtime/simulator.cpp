@@ -112,6 +112,9 @@ void simulator::install(service_spec &spec)
 
         if (tspec.queue_factory_name == "")
             tspec.queue_factory_name = ("dsn::tools::sim_task_queue");
+
+        // The tasks are scheduled by the simulator itself.
+        tspec.work_stealing = false;
     }
 
     sys_exit.put_front(simulator::on_system_exit, "simulator");
@@ -82,6 +82,7 @@ meta_access_controller::meta_access_controller(
                                         "RPC_QUERY_APP_INFO",
                                         "RPC_QUERY_LAST_CHECKPOINT_INFO",
                                         "RPC_QUERY_REPLICA_INFO",
+                                        "RPC_READ_STALENESS_HEARTBEAT",
                                         "RPC_REMOVE_REPLICA",
                                         "RPC_SPLIT_NOTIFY_CATCH_UP",
                                         "RPC_SPLIT_UPDATE_CHILD_PARTITION_COUNT"});
@@ -109,7 +109,9 @@ capacity_unit_calculator::capacity_unit_calculator(
     replica_base *r,
     std::shared_ptr<hotkey_collector> read_hotkey_collector,
     std::shared_ptr<hotkey_collector> write_hotkey_collector,
-    std::shared_ptr<throttling_controller> read_size_throttling_controller)
+    std::shared_ptr<throttling_controller> read_size_throttling_controller,
+    std::shared_ptr<throttling_controller> read_cu_throttling_controller,
+    std::shared_ptr<throttling_controller> write_cu_throttling_controller)
     : replica_base(r),
       METRIC_VAR_INIT_replica(read_capacity_units),
       METRIC_VAR_INIT_replica(write_capacity_units),
@@ -124,11 +126,15 @@ capacity_unit_calculator::capacity_unit_calculator(
       METRIC_VAR_INIT_replica(backup_request_bytes),
       _read_hotkey_collector(read_hotkey_collector),
       _write_hotkey_collector(write_hotkey_collector),
-      _read_size_throttling_controller(read_size_throttling_controller)
+      _read_size_throttling_controller(read_size_throttling_controller),
+      _read_cu_throttling_controller(read_cu_throttling_controller),
+      _write_cu_throttling_controller(write_cu_throttling_controller)
 {
     CHECK(_read_hotkey_collector, "read hotkey collector is a nullptr");
     CHECK(_write_hotkey_collector, "write hotkey collector is a nullptr");
     CHECK(_read_size_throttling_controller, "_read_size_throttling_controller is a nullptr");
+    CHECK(_read_cu_throttling_controller, "_read_cu_throttling_controller is a nullptr");
+    CHECK(_write_cu_throttling_controller, "_write_cu_throttling_controller is a nullptr");
 
     _log_read_cu_size = log(FLAGS_perf_counter_read_capacity_unit_size) / log(2);
     _log_write_cu_size = log(FLAGS_perf_counter_write_capacity_unit_size) / log(2);
@@ -142,6 +148,7 @@ int64_t capacity_unit_calculator::add_read_cu(int64_t read_data_size)
             : 1;
     METRIC_VAR_INCREMENT_BY(read_capacity_units, read_cu);
     _read_size_throttling_controller->consume_token(read_data_size);
+    _read_cu_throttling_controller->consume_token(read_cu);
     return read_cu;
 }
 
@@ -152,6 +159,7 @@ int64_t capacity_unit_calculator::add_write_cu(int64_t write_data_size)
                                  _log_write_cu_size
                            : 1;
     METRIC_VAR_INCREMENT_BY(write_capacity_units, write_cu);
+    _write_cu_throttling_controller->consume_token(write_cu);
     return write_cu;
 }
 
@@ -54,10 +54,15 @@ public:
         replica_base *r,
         std::shared_ptr<hotkey_collector> read_hotkey_collector,
         std::shared_ptr<hotkey_collector> write_hotkey_collector,
-        std::shared_ptr<throttling_controller> _read_size_throttling_controller);
+        std::shared_ptr<throttling_controller> read_size_throttling_controller,
+        std::shared_ptr<throttling_controller> read_cu_throttling_controller,
+        std::shared_ptr<throttling_controller> write_cu_throttling_controller);
 
     virtual ~capacity_unit_calculator() = default;
 
+    int64_t read_capacity_units() const { return METRIC_VAR_VALUE(read_capacity_units); }
+    int64_t write_capacity_units() const { return METRIC_VAR_VALUE(write_capacity_units); }
+
     void
     add_get_cu(dsn::message_ex *req, int32_t status, const dsn::blob &key, const dsn::blob &value);
     void add_multi_get_cu(dsn::message_ex *req,
@@ -146,6 +151,9 @@ private:
     std::shared_ptr<hotkey_collector> _write_hotkey_collector;
 
     std::shared_ptr<throttling_controller> _read_size_throttling_controller;
+    // Consume the CU budgets distributed by meta server.
+    std::shared_ptr<throttling_controller> _read_cu_throttling_controller;
+    std::shared_ptr<throttling_controller> _write_cu_throttling_controller;
 };
 
 } // namespace server
@@ -0,0 +1,159 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "duplicate_compression.h"
+
+#include <lz4.h>
+#include <zstd.h>
+#include <memory>
+#include <utility>
+
+#include "runtime/message_utils.h"
+#include "utils/binary_writer.h"
+#include "utils/blob.h"
+#include "utils/utils.h"
+
+namespace pegasus {
+namespace server {
+namespace {
+
+// Favor speed over ratio, since the compression is on the shipping path of duplication.
+const int kZstdCompressionLevel = 1;
+
+// Guard against allocating a huge buffer for a corrupted request.
+const int32_t kMaxUncompressedSize = 1 << 30;
+
+// Returns the size of the compressed data written into `dst`, or 0 if failed.
+size_t compress(dsn::apps::duplicate_compression_type::type type,
+                const dsn::blob &src,
+                std::shared_ptr<char> &dst)
+{
+    switch (type) {
+    case dsn::apps::duplicate_compression_type::DCT_LZ4: {
+        int bound = LZ4_compressBound(static_cast<int>(src.length()));
+        dst = dsn::utils::make_shared_array<char>(bound);
+        int size =
+            LZ4_compress_default(src.data(), dst.get(), static_cast<int>(src.length()), bound);
+        return size > 0 ? static_cast<size_t>(size) : 0;
+    }
+    case dsn::apps::duplicate_compression_type::DCT_ZSTD: {
+        size_t bound = ZSTD_compressBound(src.length());
+        dst = dsn::utils::make_shared_array<char>(bound);
+        size_t size =
+            ZSTD_compress(dst.get(), bound, src.data(), src.length(), kZstdCompressionLevel);
+        return ZSTD_isError(size) ? 0 : size;
+    }
+    default:
+        return 0;
+    }
+}
+
+// Returns true if exactly `dst_size` bytes are decompressed from `src` into `dst`.
+bool decompress(dsn::apps::duplicate_compression_type::type type,
+                const dsn::blob &src,
+                char *dst,
+                size_t dst_size)
+{
+    switch (type) {
+    case dsn::apps::duplicate_compression_type::DCT_LZ4: {
+        int size = LZ4_decompress_safe(
+            src.data(), dst, static_cast<int>(src.length()), static_cast<int>(dst_size));
+        return size >= 0 && static_cast<size_t>(size) == dst_size;
+    }
+    case dsn::apps::duplicate_compression_type::DCT_ZSTD: {
+        size_t size = ZSTD_decompress(dst, dst_size, src.data(), src.length());
+        return !ZSTD_isError(size) && size == dst_size;
+    }
+    default:
+        return false;
+    }
+}
+
+} // anonymous namespace
+
+bool parse_duplicate_compression_type(std::string_view str,
+                                      dsn::apps::duplicate_compression_type::type &type)
+{
+    if (str == "none") {
+        type = dsn::apps::duplicate_compression_type::DCT_NONE;
+    } else if (str == "lz4") {
+        type = dsn::apps::duplicate_compression_type::DCT_LZ4;
+    } else if (str == "zstd") {
+        type = dsn::apps::duplicate_compression_type::DCT_ZSTD;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+size_t compress_duplicate_request(dsn::apps::duplicate_compression_type::type type,
+                                  dsn::apps::duplicate_request &request)
+{
+    dsn::apps::duplicate_request uncompressed;
+    uncompressed.entries = std::move(request.entries);
+
+    dsn::binary_writer writer;
+    dsn::marshall_thrift_binary(writer, uncompressed);
+    dsn::blob raw = writer.get_buffer();
+
+    std::shared_ptr<char> buffer;
+    size_t compressed_size = 0;
+    if (type != dsn::apps::duplicate_compression_type::DCT_NONE) {
+        compressed_size = compress(type, raw, buffer);
+    }
+    if (compressed_size == 0 || compressed_size >= raw.length()) {
+        // Not worth compressing, ship them as they were.
+        request.entries = std::move(uncompressed.entries);
+        return raw.length();
+    }
+
+    request.entries.clear();
+    request.__set_compression_type(type);
+    request.__set_compressed_entries(dsn::blob(std::move(buffer), compressed_size));
+    request.__set_uncompressed_size(static_cast<int32_t>(raw.length()));
+    return raw.length();
+}
+
+bool decompress_duplicate_request(dsn::apps::duplicate_request &request)
+{
+    if (!request.__isset.compression_type ||
+        request.compression_type == dsn::apps::duplicate_compression_type::DCT_NONE) {
+        return true;
+    }
+
+    if (request.uncompressed_size <= 0 || request.uncompressed_size > kMaxUncompressedSize) {
+        return false;
+    }
+
+    auto size = static_cast<size_t>(request.uncompressed_size);
+    std::shared_ptr<char> buffer = dsn::utils::make_shared_array<char>(size);
+    if (!decompress(request.compression_type, request.compressed_entries, buffer.get(), size)) {
+        return false;
+    }
+
+    dsn::apps::duplicate_request uncompressed;
+    dsn::from_blob_to_thrift(dsn::blob(std::move(buffer), size), uncompressed);
+    request.entries = std::move(uncompressed.entries);
+    request.__set_compression_type(dsn::apps::duplicate_compression_type::DCT_NONE);
+    request.compressed_entries = dsn::blob();
+    return true;
+}
+
+} // namespace server
+} // namespace pegasus
@@ -0,0 +1,45 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <string_view>
+
+#include "duplication_internal_types.h"
+
+namespace pegasus {
+namespace server {
+
+// Parses the compression type of DUPLICATE requests from one of "none", "lz4" and "zstd".
+bool parse_duplicate_compression_type(std::string_view str,
+                                      dsn::apps::duplicate_compression_type::type &type);
+
+// Compresses the entries of `request` in place with `type`. The request is left uncompressed
+// if `type` is DCT_NONE or the compressed form would not be smaller. Returns the size of the
+// entries in binary form before compression.
+size_t compress_duplicate_request(dsn::apps::duplicate_compression_type::type type,
+                                  dsn::apps::duplicate_request &request);
+
+// Restores the entries of `request` in place if they are compressed. Returns false if they
+// could not be decompressed.
+bool decompress_duplicate_request(dsn::apps::duplicate_request &request);
+
+} // namespace server
+} // namespace pegasus
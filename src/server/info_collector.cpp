@@ -38,6 +38,7 @@
 #include "task/task_code.h"
 #include "utils/flags.h"
 #include "utils/fmt_logging.h"
+#include "utils/metrics.h"
 #include "utils/strings.h"
 #include "utils/threadpool_code.h"
 
@@ -161,9 +162,20 @@ void info_collector::on_app_stat()
         row_data app_stats(app_rows.first);
         app_stats.partition_count = app_rows.second.size();
         all_stats.partition_count += app_rows.second.size();
-        for (auto partition_row : app_rows.second) {
+        for (const auto &partition_row : app_rows.second) {
             app_stats.aggregate(partition_row);
         }
+
+        // The latency buckets are cumulative since the replicas were opened, thus only the
+        // observations since the last stat are kept.
+        auto &last_latency_buckets = _last_app_latency_buckets[app_rows.first];
+        for (auto &latency : app_stats.latency_buckets) {
+            auto current = std::move(latency.second);
+            latency.second =
+                dsn::diff_histogram_buckets(last_latency_buckets[latency.first], current);
+            last_latency_buckets[latency.first] = std::move(current);
+        }
+
         get_app_counters(app_stats.row_name)->set(app_stats);
         // get row data statistics for all of the apps
         all_stats.aggregate(app_stats);
@@ -259,6 +271,17 @@ info_collector::app_stat_counters *info_collector::get_app_counters(const std::s
     INIT_COUNTER(rdb_read_memtable_hit_rate);
     INIT_COUNTER(rdb_write_amplification);
     INIT_COUNTER(rdb_read_amplification);
+    INIT_COUNTER(get_latency_p99);
+    INIT_COUNTER(multi_get_latency_p99);
+    INIT_COUNTER(batch_get_latency_p99);
+    INIT_COUNTER(scan_latency_p99);
+    INIT_COUNTER(put_latency_p99);
+    INIT_COUNTER(multi_put_latency_p99);
+    INIT_COUNTER(remove_latency_p99);
+    INIT_COUNTER(multi_remove_latency_p99);
+    INIT_COUNTER(incr_latency_p99);
+    INIT_COUNTER(check_and_set_latency_p99);
+    INIT_COUNTER(check_and_mutate_latency_p99);
     _app_stat_counters[app_name] = counters;
     return counters;
 }
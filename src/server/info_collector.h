@@ -133,6 +133,24 @@ public:
                                          row_stats.partition_count);
             rdb_read_amplification->set(row_stats.rdb_read_amplification /
                                         row_stats.partition_count);
+
+#define SET_LATENCY_P99(name)                                                                      \
+    name##_latency_p99->set(                                                                       \
+        row_stats.get_latency_percentile(#name "_latency_ns", dsn::kth_percentile_type::P99))
+
+            SET_LATENCY_P99(get);
+            SET_LATENCY_P99(multi_get);
+            SET_LATENCY_P99(batch_get);
+            SET_LATENCY_P99(scan);
+            SET_LATENCY_P99(put);
+            SET_LATENCY_P99(multi_put);
+            SET_LATENCY_P99(remove);
+            SET_LATENCY_P99(multi_remove);
+            SET_LATENCY_P99(incr);
+            SET_LATENCY_P99(check_and_set);
+            SET_LATENCY_P99(check_and_mutate);
+
+#undef SET_LATENCY_P99
         }
 
         ::dsn::perf_counter_wrapper get_qps;
@@ -195,6 +213,20 @@ public:
         ::dsn::perf_counter_wrapper rdb_read_memtable_hit_rate;
         ::dsn::perf_counter_wrapper rdb_write_amplification;
         ::dsn::perf_counter_wrapper rdb_read_amplification;
+
+        // The P99 latencies in nanoseconds, computed over the merged latency histograms of all
+        // primary replicas of the app.
+        ::dsn::perf_counter_wrapper get_latency_p99;
+        ::dsn::perf_counter_wrapper multi_get_latency_p99;
+        ::dsn::perf_counter_wrapper batch_get_latency_p99;
+        ::dsn::perf_counter_wrapper scan_latency_p99;
+        ::dsn::perf_counter_wrapper put_latency_p99;
+        ::dsn::perf_counter_wrapper multi_put_latency_p99;
+        ::dsn::perf_counter_wrapper remove_latency_p99;
+        ::dsn::perf_counter_wrapper multi_remove_latency_p99;
+        ::dsn::perf_counter_wrapper incr_latency_p99;
+        ::dsn::perf_counter_wrapper check_and_set_latency_p99;
+        ::dsn::perf_counter_wrapper check_and_mutate_latency_p99;
     };
 
     info_collector();
@@ -219,6 +251,10 @@ private:
     ::dsn::task_ptr _app_stat_timer_task;
     ::dsn::utils::ex_lock_nr _app_stat_counter_lock;
     std::map<std::string, app_stat_counters *> _app_stat_counters;
+    // The cumulative latency buckets of each app at the last stat, used to compute the latencies
+    // over the observations since then. Only accessed by on_app_stat().
+    std::map<std::string, std::map<std::string, dsn::metric_merged_histogram_buckets>>
+        _last_app_latency_buckets;
 
     // client to access server.
     pegasus_client *_client;
@@ -22,11 +22,13 @@
 #include <fmt/core.h>
 #include <pegasus/error.h>
 #include <sys/types.h>
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <set>
+#include <string>
 #include <string_view>
 #include <tuple>
 #include <utility>
@@ -34,8 +36,10 @@
 
 #include "client_lib/pegasus_client_impl.h"
 #include "common/common.h"
+#include "common/gpid.h"
 #include "common/duplication_common.h"
 #include "common/replication.codes.h"
+#include "duplicate_compression.h"
 #include "duplication_internal_types.h"
 #include "gutil/map_util.h"
 #include "pegasus/client.h"
@@ -43,6 +47,7 @@
 #include "rpc/rpc_message.h"
 #include "rrdb/rrdb.code.definition.h"
 #include "rrdb/rrdb_types.h"
+#include "runtime/api_layer1.h"
 #include "runtime/message_utils.h"
 #include "utils/autoref_ptr.h"
 #include "utils/blob.h"
@@ -55,6 +60,21 @@
 
 DSN_DECLARE_bool(dup_ignore_other_cluster_ids);
 
+DSN_DEFINE_string(replication,
+                  dup_compression_type,
+                  "none",
+                  "The compression type of the entries in DUPLICATE rpcs, could be none, lz4 or "
+                  "zstd. Only enable it once the remote cluster supports the compressed entries. "
+                  "It could only be changed by restarting the server");
+DSN_DEFINE_validator(dup_compression_type, [](const char *value) -> bool {
+    dsn::apps::duplicate_compression_type::type type;
+    return pegasus::server::parse_duplicate_compression_type(value, type);
+});
+
+// The gauges of a duplication are kept by its own entity, since a replica could have multiple
+// duplications each with different progress.
+METRIC_DEFINE_entity(duplication);
+
 METRIC_DEFINE_counter(replica,
                       dup_shipped_successful_requests,
                       dsn::metric_unit::kRequests,
@@ -65,6 +85,32 @@ METRIC_DEFINE_counter(replica,
                       dsn::metric_unit::kRequests,
                       "The number of failed DUPLICATE requests sent from client");
 
+METRIC_DEFINE_gauge_int64(duplication,
+                          dup_inflight_rpcs,
+                          dsn::metric_unit::kRequests,
+                          "The number of in-flight DUPLICATE requests sent from client");
+
+METRIC_DEFINE_gauge_int64(duplication,
+                          dup_shipping_lag_ms,
+                          dsn::metric_unit::kMilliSeconds,
+                          "The lag between the latest shipped write and now for dup");
+
+METRIC_DEFINE_counter(replica,
+                      dup_shipped_uncompressed_bytes,
+                      dsn::metric_unit::kBytes,
+                      "The size of the shipped entries before compression for dup");
+
+METRIC_DEFINE_counter(replica,
+                      dup_shipped_compressed_bytes,
+                      dsn::metric_unit::kBytes,
+                      "The size of the shipped entries after compression for dup");
+
+METRIC_DEFINE_gauge_int64(duplication,
+                          dup_compression_ratio,
+                          dsn::metric_unit::kPercent,
+                          "The ratio of the compressed size to the uncompressed size of the "
+                          "entries shipped in the latest round for dup");
+
 namespace dsn {
 namespace replication {
 struct replica_base;
@@ -80,8 +126,9 @@ DSN_TAG_VARIABLE(dup_max_allowed_write_size, FT_MUTABLE);
 /*static*/ std::function<std::unique_ptr<mutation_duplicator>(
     replica_base *, std::string_view, std::string_view)>
     mutation_duplicator::creator =
-        [](replica_base *r, std::string_view remote, std::string_view app) {
-            return std::make_unique<pegasus::server::pegasus_mutation_duplicator>(r, remote, app);
+        [](replica_base *r, dupid_t dupid, std::string_view remote, std::string_view app) {
+            return std::make_unique<pegasus::server::pegasus_mutation_duplicator>(
+                r, dupid, remote, app);
         };
 
 } // namespace replication
@@ -92,6 +139,22 @@ namespace server {
 
 using namespace dsn::literals::chrono_literals;
 
+namespace {
+
+dsn::metric_entity_ptr instantiate_duplication_metric_entity(const dsn::gpid &pid,
+                                                             dsn::replication::dupid_t dupid)
+{
+    auto entity_id = fmt::format("duplication@{}.{}", dupid, pid);
+
+    return METRIC_ENTITY_duplication.instantiate(
+        entity_id,
+        {{"table_id", std::to_string(pid.get_app_id())},
+         {"partition_id", std::to_string(pid.get_partition_index())},
+         {"dup_id", std::to_string(dupid)}});
+}
+
+} // anonymous namespace
+
 /*extern*/ uint64_t get_hash_from_request(dsn::task_code tc, const dsn::blob &data)
 {
     if (tc == dsn::apps::RPC_RRDB_RRDB_PUT) {
@@ -119,12 +182,19 @@ using namespace dsn::literals::chrono_literals;
 }
 
 pegasus_mutation_duplicator::pegasus_mutation_duplicator(dsn::replication::replica_base *r,
+                                                         dsn::replication::dupid_t dupid,
                                                          std::string_view remote_cluster,
                                                          std::string_view app)
     : mutation_duplicator(r),
       _remote_cluster(remote_cluster),
+      _duplication_metric_entity(instantiate_duplication_metric_entity(get_gpid(), dupid)),
       METRIC_VAR_INIT_replica(dup_shipped_successful_requests),
-      METRIC_VAR_INIT_replica(dup_shipped_failed_requests)
+      METRIC_VAR_INIT_replica(dup_shipped_failed_requests),
+      METRIC_VAR_INIT_duplication(dup_inflight_rpcs),
+      METRIC_VAR_INIT_duplication(dup_shipping_lag_ms),
+      METRIC_VAR_INIT_replica(dup_shipped_uncompressed_bytes),
+      METRIC_VAR_INIT_replica(dup_shipped_compressed_bytes),
+      METRIC_VAR_INIT_duplication(dup_compression_ratio)
 {
     // initialize pegasus-client when this class is first time used.
     static __attribute__((unused)) bool _dummy = pegasus_client_factory::initialize(nullptr);
@@ -138,8 +208,9 @@ pegasus_mutation_duplicator::pegasus_mutation_duplicator(dsn::replication::repli
                            remote_cluster);
 
     if (FLAGS_dup_ignore_other_cluster_ids) {
-        LOG_INFO_PREFIX("initialize mutation duplicator for local cluster [id:{}], "
+        LOG_INFO_PREFIX("initialize mutation duplicator [dupid:{}] for local cluster [id:{}], "
                         "remote cluster [id:ignored, addr:{}]",
+                        dupid,
                         dsn::replication::get_current_dup_cluster_id(),
                         remote_cluster);
         return;
@@ -152,8 +223,9 @@ pegasus_mutation_duplicator::pegasus_mutation_duplicator(dsn::replication::repli
                      ret.get_error());
     _remote_cluster_id = static_cast<uint8_t>(ret.get_value());
 
-    LOG_INFO_PREFIX("initialize mutation duplicator for local cluster [id:{}], "
+    LOG_INFO_PREFIX("initialize mutation duplicator [dupid:{}] for local cluster [id:{}], "
                     "remote cluster [id:{}, addr:{}]",
+                    dupid,
                     dsn::replication::get_current_dup_cluster_id(),
                     _remote_cluster_id,
                     remote_cluster);
@@ -165,24 +237,47 @@ pegasus_mutation_duplicator::pegasus_mutation_duplicator(dsn::replication::repli
                         remote_cluster);
 }
 
-void pegasus_mutation_duplicator::send(uint64_t hash, callback cb)
+void pegasus_mutation_duplicator::send(uint64_t lane, callback cb)
 {
     duplicate_rpc rpc;
     {
         dsn::zauto_lock _(_lock);
-        rpc = _inflights[hash].front();
-        _inflights[hash].pop_front();
+        rpc = _inflights[lane].front();
+        _inflights[lane].pop_front();
     }
 
     _client->async_duplicate(
         rpc,
-        [hash, cb, rpc, this](dsn::error_code err) mutable {
-            on_duplicate_reply(hash, std::move(cb), std::move(rpc), err);
+        [lane, cb, rpc, this](dsn::error_code err) mutable {
+            on_duplicate_reply(lane, std::move(cb), std::move(rpc), err);
         },
         _env.__conf.tracker);
 }
 
-void pegasus_mutation_duplicator::on_duplicate_reply(uint64_t hash,
+std::chrono::milliseconds pegasus_mutation_duplicator::get_retry_delay(uint64_t lane)
+{
+    const std::chrono::milliseconds kMinRetryDelay = 100_ms;
+    const std::chrono::milliseconds kMaxRetryDelay = 10_s;
+
+    auto &delay = _retry_delays[lane];
+    delay = delay.count() == 0 ? kMinRetryDelay : std::min(delay * 2, kMaxRetryDelay);
+    return delay;
+}
+
+void pegasus_mutation_duplicator::on_all_shipped(const callback &cb)
+{
+    METRIC_VAR_SET(dup_inflight_rpcs, 0);
+    if (_last_timestamp_us > 0) {
+        uint64_t now_us = dsn_now_us();
+        METRIC_VAR_SET(dup_shipping_lag_ms,
+                       now_us > _last_timestamp_us ? (now_us - _last_timestamp_us) / 1000 : 0);
+    }
+
+    // move forward to the next step.
+    cb(_total_shipped_size);
+}
+
+void pegasus_mutation_duplicator::on_duplicate_reply(uint64_t lane,
                                                      mutation_duplicator::callback cb,
                                                      duplicate_rpc rpc,
                                                      dsn::error_code err)
@@ -215,20 +310,21 @@ void pegasus_mutation_duplicator::on_duplicate_reply(uint64_t hash,
     {
         dsn::zauto_lock _(_lock);
         if (perr != PERR_OK || err != dsn::ERR_OK) {
-            // retry this rpc
-            _inflights[hash].push_front(rpc);
-            _env.schedule([hash, cb, this]() { send(hash, cb); }, 1_s);
+            // retry this rpc, backing off if the remote cluster keeps failing.
+            _inflights[lane].push_front(rpc);
+            _env.schedule([lane, cb, this]() { send(lane, cb); }, get_retry_delay(lane));
             return;
         }
-        if (_inflights[hash].empty()) {
-            _inflights.erase(hash);
+        _retry_delays.erase(lane);
+        if (_inflights[lane].empty()) {
+            _inflights.erase(lane);
+            METRIC_VAR_SET(dup_inflight_rpcs, _inflights.size());
             if (_inflights.empty()) {
-                // move forward to the next step.
-                cb(_total_shipped_size);
+                on_all_shipped(cb);
             }
         } else {
             // start next rpc immediately
-            _env.schedule([hash, cb, this]() { send(hash, cb); });
+            _env.schedule([lane, cb, this]() { send(lane, cb); });
             return;
         }
     }
@@ -238,9 +334,16 @@ void pegasus_mutation_duplicator::duplicate(mutation_tuple_set muts, callback cb
 {
     _total_shipped_size = 0;
 
-    auto batch_request = std::make_unique<dsn::apps::duplicate_request>();
-    uint batch_count = 0;
-    uint batch_bytes = 0;
+    // Snapshot FLAGS_dup_max_inflight_rpcs which is mutable, so that all the writes of this
+    // round are isolated by the same number of lanes.
+    _max_inflight_rpcs = FLAGS_dup_max_inflight_rpcs;
+
+    // FLAGS_dup_compression_type has been checked by its validator.
+    auto compression_type = dsn::apps::duplicate_compression_type::DCT_NONE;
+    CHECK_PREFIX_MSG(parse_duplicate_compression_type(FLAGS_dup_compression_type, compression_type),
+                     "invalid dup_compression_type: {}",
+                     FLAGS_dup_compression_type);
+
     // The rpc codes should be ignored:
     // - RPC_RRDB_RRDB_DUPLICATE: Now not supports duplicating the deuplicate mutations to the
     // remote cluster.
@@ -248,12 +351,41 @@ void pegasus_mutation_duplicator::duplicate(mutation_tuple_set muts, callback cb
     const static std::set<int> ingnored_rpc_code = {dsn::apps::RPC_RRDB_RRDB_DUPLICATE,
                                                     dsn::apps::RPC_RRDB_RRDB_BULK_LOAD};
 
+    struct lane_batch
+    {
+        std::unique_ptr<dsn::apps::duplicate_request> request;
+        uint bytes{0};
+        uint64_t hash{0};
+    };
+    std::map<uint64_t, lane_batch> batches; // lane -> batch being filled
+    uint64_t total_uncompressed_bytes = 0;
+    uint64_t total_compressed_bytes = 0;
+
+    auto flush = [&](uint64_t lane, lane_batch &batch) {
+        size_t uncompressed_bytes = batch.bytes;
+        if (compression_type != dsn::apps::duplicate_compression_type::DCT_NONE) {
+            uncompressed_bytes = compress_duplicate_request(compression_type, *batch.request);
+        }
+        total_uncompressed_bytes += uncompressed_bytes;
+        total_compressed_bytes += batch.request->__isset.compressed_entries
+                                      ? batch.request->compressed_entries.length()
+                                      : uncompressed_bytes;
+
+        // since all the plog's mutations of replica belong to same gpid though the hash of
+        // mutation is different, use the last mutation of one batch to get and represents the
+        // current hash value, it will still send to remote correct replica
+        duplicate_rpc rpc(std::move(batch.request),
+                          dsn::apps::RPC_RRDB_RRDB_DUPLICATE,
+                          100_s, // TODO(wutao1): configurable timeout.
+                          batch.hash);
+        _inflights[lane].push_back(std::move(rpc));
+        batch.bytes = 0;
+    };
+
     for (auto mut : muts) {
         // mut: 0=timestamp, 1=rpc_code, 2=raw_message
-        batch_count++;
         dsn::task_code rpc_code = std::get<1>(mut);
         dsn::blob raw_message = std::get<2>(mut);
-        auto dreq = std::make_unique<dsn::apps::duplicate_request>();
 
         if (gutil::ContainsKey(ingnored_rpc_code, rpc_code)) {
             // It it do not recommend to use bulkload and normal writing in the same app,
@@ -269,37 +401,58 @@ void pegasus_mutation_duplicator::duplicate(mutation_tuple_set muts, callback cb
             continue;
         }
 
+        // Writes with the same hash key always fall into the same lane, thus are shipped in order.
+        uint64_t hash = get_hash_from_request(rpc_code, raw_message);
+        uint64_t lane = hash % _max_inflight_rpcs;
+        auto &batch = batches[lane];
+        if (!batch.request) {
+            batch.request = std::make_unique<dsn::apps::duplicate_request>();
+        }
+
         dsn::apps::duplicate_entry entry;
         entry.__set_raw_message(raw_message);
         entry.__set_task_code(rpc_code);
         entry.__set_timestamp(std::get<0>(mut));
         entry.__set_cluster_id(dsn::replication::get_current_dup_cluster_id());
-        batch_request->entries.emplace_back(std::move(entry));
-        batch_bytes += raw_message.length();
-
-        if (batch_count == muts.size() || batch_bytes >= FLAGS_duplicate_log_batch_bytes ||
-            batch_bytes >= dsn::replication::FLAGS_dup_max_allowed_write_size) {
-            // since all the plog's mutations of replica belong to same gpid though the hash of
-            // mutation is different, use the last mutation of one batch to get and represents the
-            // current hash value, it will still send to remote correct replica
-            uint64_t hash = get_hash_from_request(rpc_code, raw_message);
-            duplicate_rpc rpc(std::move(batch_request),
-                              dsn::apps::RPC_RRDB_RRDB_DUPLICATE,
-                              100_s, // TODO(wutao1): configurable timeout.
-                              hash);
-            _inflights[hash].push_back(std::move(rpc));
-            batch_request = std::make_unique<dsn::apps::duplicate_request>();
-            batch_bytes = 0;
+        batch.request->entries.emplace_back(std::move(entry));
+        batch.bytes += raw_message.length();
+        batch.hash = hash;
+        _last_timestamp_us = std::max(_last_timestamp_us, static_cast<uint64_t>(std::get<0>(mut)));
+
+        if (batch.bytes >= FLAGS_duplicate_log_batch_bytes ||
+            batch.bytes >= dsn::replication::FLAGS_dup_max_allowed_write_size) {
+            flush(lane, batch);
+        }
+    }
+    for (auto &kv : batches) {
+        if (kv.second.request) {
+            flush(kv.first, kv.second);
         }
     }
 
-    if (_inflights.empty()) {
-        cb(0);
-        return;
+    if (total_uncompressed_bytes > 0) {
+        METRIC_VAR_INCREMENT_BY(dup_shipped_uncompressed_bytes, total_uncompressed_bytes);
+        METRIC_VAR_INCREMENT_BY(dup_shipped_compressed_bytes, total_compressed_bytes);
+        METRIC_VAR_SET(dup_compression_ratio,
+                       total_compressed_bytes * 100 / total_uncompressed_bytes);
+    }
+
+    std::vector<uint64_t> lanes;
+    {
+        dsn::zauto_lock _(_lock);
+        if (_inflights.empty()) {
+            // Nothing to ship means that the duplication has caught up.
+            METRIC_VAR_SET(dup_shipping_lag_ms, 0);
+            cb(0);
+            return;
+        }
+        METRIC_VAR_SET(dup_inflight_rpcs, _inflights.size());
+        for (const auto &kv : _inflights) {
+            lanes.push_back(kv.first);
+        }
     }
-    auto inflights = _inflights;
-    for (const auto &kv : inflights) {
-        send(kv.first, cb);
+    for (const auto lane : lanes) {
+        send(lane, cb);
     }
 }
 
@@ -21,6 +21,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <chrono>
 #include <deque>
 #include <map>
 #include <string>
@@ -61,6 +62,7 @@ class pegasus_mutation_duplicator : public dsn::replication::mutation_duplicator
 
 public:
     pegasus_mutation_duplicator(dsn::replication::replica_base *r,
+                                dsn::replication::dupid_t dupid,
                                 std::string_view remote_cluster,
                                 std::string_view app);
 
@@ -69,9 +71,21 @@ public:
     ~pegasus_mutation_duplicator() override { _env.__conf.tracker->cancel_outstanding_tasks(); }
 
 private:
-    void send(uint64_t hash, callback cb);
+    const dsn::metric_entity_ptr &duplication_metric_entity() const
+    {
+        return _duplication_metric_entity;
+    }
 
-    void on_duplicate_reply(uint64_t hash, callback, duplicate_rpc, dsn::error_code err);
+    void send(uint64_t lane, callback cb);
+
+    void on_duplicate_reply(uint64_t lane, callback, duplicate_rpc, dsn::error_code err);
+
+    // Returns the delay before retrying the failed rpc of `lane`, which grows exponentially
+    // on consecutive failures. Must be called under `_lock`.
+    std::chrono::milliseconds get_retry_delay(uint64_t lane);
+
+    // Called under `_lock` once all the rpcs of the current round have been shipped.
+    void on_all_shipped(const callback &cb);
 
 private:
     friend class pegasus_mutation_duplicator_test;
@@ -81,16 +95,30 @@ private:
     uint8_t _remote_cluster_id{0};
     std::string _remote_cluster;
 
-    // The duplicate_rpc are isolated by their hash value from hash key.
-    // Writes with the same hash are duplicated in mutation order to preserve data consistency,
-    // otherwise they are duplicated concurrently to improve performance.
-    std::map<uint64_t, std::deque<duplicate_rpc>> _inflights; // hash -> duplicate_rpc
+    // The writes are isolated into at most `_max_inflight_rpcs` lanes by the hash value from
+    // their hash keys. Writes in the same lane are duplicated in mutation order to preserve data
+    // consistency, while the lanes are duplicated concurrently to improve performance. Each lane
+    // has only one rpc in flight, and the rest are queued here.
+    std::map<uint64_t, std::deque<duplicate_rpc>> _inflights; // lane -> duplicate_rpc
+    std::map<uint64_t, std::chrono::milliseconds> _retry_delays; // lane -> last retry delay
     dsn::zlock _lock;
 
+    // Snapshot of FLAGS_dup_max_inflight_rpcs for the current round.
+    uint32_t _max_inflight_rpcs{1};
+
     size_t _total_shipped_size{0};
 
+    // The timestamp of the latest write in the current round, used to measure the lag.
+    uint64_t _last_timestamp_us{0};
+
+    const dsn::metric_entity_ptr _duplication_metric_entity;
     METRIC_VAR_DECLARE_counter(dup_shipped_successful_requests);
     METRIC_VAR_DECLARE_counter(dup_shipped_failed_requests);
+    METRIC_VAR_DECLARE_gauge_int64(dup_inflight_rpcs);
+    METRIC_VAR_DECLARE_gauge_int64(dup_shipping_lag_ms);
+    METRIC_VAR_DECLARE_counter(dup_shipped_uncompressed_bytes);
+    METRIC_VAR_DECLARE_counter(dup_shipped_compressed_bytes);
+    METRIC_VAR_DECLARE_gauge_int64(dup_compression_ratio);
 };
 
 // Decodes the binary `request_data` into write request in thrift struct, and
@@ -0,0 +1,210 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "pegasus_scan_context.h"
+
+#include <rocksdb/status.h>
+#include <utility>
+#include <vector>
+
+#include "runtime/api_layer1.h"
+#include "utils/rand.h"
+
+namespace pegasus {
+namespace server {
+
+pegasus_context_cache::pegasus_context_cache() : _size(0)
+{
+    // some comments:
+    // 1. we should keep the context id unique when the server restarts, so as to prevent
+    //    an old scan reuse the context id assigned to a new scan
+    // 2. we should prevent the context id mixed when primary switches.
+    // 3. we should keep context id positive, as negtive value have specical meanings.
+    //
+    // a more detailed description on the context id confliction is here:
+    //   https://github.com/apache/incubator-pegasus/issues/156
+    //
+    // however, currently the implementation is not 100% correct.
+    //
+    int64_t counter = dsn::rand::next_u64(0, 2L << 31);
+    counter <<= 32;
+    _counter = counter;
+}
+
+void pegasus_context_cache::clear()
+{
+    for (auto &s : _shards) {
+        std::unordered_map<int64_t, entry> map;
+        {
+            ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(s.lock);
+            map.swap(s.map);
+            _size -= map.size();
+        }
+        // The iterators are destroyed out of the lock.
+    }
+}
+
+int64_t pegasus_context_cache::put(std::unique_ptr<pegasus_scan_context> context)
+{
+    int64_t handle = _counter++;
+    auto &s = get_shard(handle);
+    {
+        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(s.lock);
+        s.map[handle] = {std::move(context), dsn_now_ms()};
+    }
+    ++_size;
+    return handle;
+}
+
+std::unique_ptr<pegasus_scan_context> pegasus_context_cache::fetch(int64_t handle)
+{
+    auto &s = get_shard(handle);
+    ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(s.lock);
+    auto kv = s.map.find(handle);
+    if (kv == s.map.end()) {
+        return nullptr;
+    }
+    std::unique_ptr<pegasus_scan_context> ret = std::move(kv->second.context);
+    s.map.erase(kv);
+    --_size;
+    return ret;
+}
+
+size_t pegasus_context_cache::evict_idle(uint64_t idle_timeout_ms)
+{
+    uint64_t now_ms = dsn_now_ms();
+    size_t evicted_count = 0;
+    for (auto &s : _shards) {
+        std::vector<std::unique_ptr<pegasus_scan_context>> evicted;
+        {
+            ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(s.lock);
+            for (auto it = s.map.begin(); it != s.map.end();) {
+                if (it->second.put_time_ms + idle_timeout_ms <= now_ms) {
+                    evicted.emplace_back(std::move(it->second.context));
+                    it = s.map.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            _size -= evicted.size();
+        }
+        evicted_count += evicted.size();
+    }
+    return evicted_count;
+}
+
+size_t pegasus_context_cache::evict_exceeded(size_t capacity)
+{
+    size_t evicted_count = 0;
+    while (size() > capacity) {
+        // Find the oldest context among all the shards, i.e. the one with the smallest handle
+        // since the handles are increasing. It's rare to be done since the capacity should be
+        // large enough for the normal scans.
+        int64_t oldest_handle = -1;
+        for (auto &s : _shards) {
+            ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(s.lock);
+            for (const auto &kv : s.map) {
+                if (oldest_handle < 0 || kv.first < oldest_handle) {
+                    oldest_handle = kv.first;
+                }
+            }
+        }
+        if (oldest_handle < 0) {
+            break;
+        }
+
+        // The context may have been fetched meanwhile, then just find the next one.
+        if (fetch(oldest_handle) != nullptr) {
+            ++evicted_count;
+        }
+    }
+    return evicted_count;
+}
+
+uint32_t pegasus_iterator_pool::get_options_key(const rocksdb::ReadOptions &options)
+{
+    // The other read options are all the same for a replica.
+    return static_cast<uint32_t>(options.total_order_seek) |
+           static_cast<uint32_t>(options.prefix_same_as_start) << 1 |
+           static_cast<uint32_t>(options.fill_cache) << 2;
+}
+
+std::unique_ptr<rocksdb::Iterator> pegasus_iterator_pool::take(uint32_t options_key)
+{
+    std::unique_ptr<rocksdb::Iterator> iterator;
+    {
+        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
+        // Take the latest one, which is the cheapest to be refreshed.
+        for (auto it = _entries.rbegin(); it != _entries.rend(); ++it) {
+            if (it->options_key == options_key) {
+                iterator = std::move(it->iterator);
+                _entries.erase(std::next(it).base());
+                break;
+            }
+        }
+    }
+
+    if (iterator != nullptr && !iterator->Refresh().ok()) {
+        return nullptr;
+    }
+    return iterator;
+}
+
+void pegasus_iterator_pool::put(uint32_t options_key,
+                                std::unique_ptr<rocksdb::Iterator> iterator,
+                                size_t capacity)
+{
+    if (capacity == 0 || iterator == nullptr || !iterator->status().ok()) {
+        return;
+    }
+
+    std::deque<entry> evicted;
+    {
+        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
+        _entries.push_back({options_key, std::move(iterator), dsn_now_ms()});
+        while (_entries.size() > capacity) {
+            evicted.push_back(std::move(_entries.front()));
+            _entries.pop_front();
+        }
+    }
+}
+
+size_t pegasus_iterator_pool::evict_idle(uint64_t idle_timeout_ms)
+{
+    uint64_t now_ms = dsn_now_ms();
+    std::deque<entry> evicted;
+    {
+        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
+        while (!_entries.empty() && _entries.front().put_time_ms + idle_timeout_ms <= now_ms) {
+            evicted.push_back(std::move(_entries.front()));
+            _entries.pop_front();
+        }
+    }
+    return evicted.size();
+}
+
+void pegasus_iterator_pool::clear()
+{
+    std::deque<entry> evicted;
+    ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
+    evicted.swap(_entries);
+}
+
+} // namespace server
+} // namespace pegasus
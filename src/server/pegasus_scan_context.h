@@ -19,13 +19,23 @@
 
 #pragma once
 
-#include <map>
 #include <rocksdb/db.h>
-#include "runtime/tool_api.h"
-#include "utils/rand.h"
+#include <rocksdb/options.h>
 #include <rrdb/rrdb_types.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
 
 #include "base/pegasus_utils.h"
+#include "base/scan_aggregator.h"
+#include "runtime/tool_api.h"
+#include "utils/blob.h"
+#include "utils/synchronize.h"
 
 namespace pegasus {
 namespace server {
@@ -43,7 +53,8 @@ struct pegasus_scan_context
                          bool no_value_,
                          bool validate_partition_hash_,
                          bool return_expire_ts_,
-                         bool only_return_count_)
+                         bool only_return_count_,
+                         std::unique_ptr<scan_aggregator> &&aggregator_)
         : _stop_holder(std::move(stop_)),
           _hash_key_filter_pattern_holder(std::move(hash_key_filter_pattern_)),
           _sort_key_filter_pattern_holder(std::move(sort_key_filter_pattern_)),
@@ -60,7 +71,8 @@ struct pegasus_scan_context
           no_value(no_value_),
           validate_partition_hash(validate_partition_hash_),
           return_expire_ts(return_expire_ts_),
-          only_return_count(only_return_count_)
+          only_return_count(only_return_count_),
+          aggregator(std::move(aggregator_))
     {
     }
 
@@ -86,57 +98,104 @@ public:
     bool validate_partition_hash;
     bool return_expire_ts;
     bool only_return_count;
+    // Not null if the records should be aggregated, see get_scanner_request.return_aggregation.
+    std::unique_ptr<scan_aggregator> aggregator;
+    // See pegasus_iterator_pool::get_options_key().
+    uint32_t iterator_options_key = 0;
 };
 
+// The cache of the scan contexts of a replica, which are kept between the batches of the scans.
+//
+// Each context holds a rocksdb iterator which pins the memtables and sst files, thus a context
+// should not be kept for long if its client has gone away without clear_scanner:
+// - the contexts which have been idle for a while are evicted by evict_idle();
+// - the oldest contexts are evicted by evict_exceeded() once there are too many.
+// The client would restart the scan from the last key it got once its context is evicted.
+//
+// The contexts are distributed into several shards by their handles, so that the concurrent
+// scans on a replica would not be serialized on a single lock.
 class pegasus_context_cache
 {
 public:
-    pegasus_context_cache()
-    {
-        // some comments:
-        // 1. we should keep the context id unique when the server restarts, so as to prevent
-        //    an old scan reuse the context id assigned to a new scan
-        // 2. we should prevent the context id mixed when primary switches.
-        // 3. we should keep context id positive, as negtive value have specical meanings.
-        //
-        // a more detailed description on the context id confliction is here:
-        //   https://github.com/apache/incubator-pegasus/issues/156
-        //
-        // however, currently the implementation is not 100% correct.
-        //
-        _counter = dsn::rand::next_u64(0, 2L << 31);
-        _counter <<= 32;
-    }
+    pegasus_context_cache();
 
-    void clear()
-    {
-        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
-        _map.clear();
-    }
+    void clear();
+
+    int64_t put(std::unique_ptr<pegasus_scan_context> context);
 
-    int64_t put(std::unique_ptr<pegasus_scan_context> context)
+    std::unique_ptr<pegasus_scan_context> fetch(int64_t handle);
+
+    // Evict the contexts which have been put for more than 'idle_timeout_ms', return the count
+    // of the evicted contexts.
+    size_t evict_idle(uint64_t idle_timeout_ms);
+
+    // Evict the least recently put contexts until there are no more than 'capacity' contexts,
+    // return the count of the evicted contexts.
+    size_t evict_exceeded(size_t capacity);
+
+    size_t size() const { return _size.load(std::memory_order_relaxed); }
+
+private:
+    static const int SHARD_COUNT = 16;
+
+    struct entry
     {
-        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
-        int64_t handle = _counter++;
-        _map[handle] = std::move(context);
-        return handle;
-    }
+        std::unique_ptr<pegasus_scan_context> context;
+        uint64_t put_time_ms;
+    };
 
-    std::unique_ptr<pegasus_scan_context> fetch(int64_t handle)
+    struct shard
     {
-        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
-        auto kv = _map.find(handle);
-        if (kv == _map.end())
-            return nullptr;
-        std::unique_ptr<pegasus_scan_context> ret = std::move(kv->second);
-        _map.erase(kv);
-        return ret;
-    }
+        ::dsn::utils::ex_lock_nr_spin lock;
+        std::unordered_map<int64_t, entry> map;
+    };
+
+    shard &get_shard(int64_t handle) { return _shards[handle & (SHARD_COUNT - 1)]; }
+
+    std::atomic<int64_t> _counter;
+    std::atomic<size_t> _size;
+    std::array<shard, SHARD_COUNT> _shards;
+};
+
+// The pool of the rocksdb iterators released by the finished scans, which could be reused by
+// the following scans after being refreshed by Iterator::Refresh(), instead of creating new
+// ones.
+//
+// An iterator in the pool still pins the memtables and sst files of the version it was created
+// or refreshed on, thus the pool should be small and the iterators in it are evicted as the
+// idle scan contexts.
+class pegasus_iterator_pool
+{
+public:
+    // The key of the read options which may be different between the iterators of a replica,
+    // the iterators could be reused only by the scans with the same key.
+    static uint32_t get_options_key(const rocksdb::ReadOptions &options);
+
+    // Take an iterator created with the read options of 'options_key', and refresh it to the
+    // latest version of the db. Return nullptr if there is no such iterator.
+    std::unique_ptr<rocksdb::Iterator> take(uint32_t options_key);
+
+    // Put an iterator back into the pool. The iterator would be destroyed if it's in error,
+    // and the oldest one would be destroyed if there are more than 'capacity' iterators.
+    void put(uint32_t options_key, std::unique_ptr<rocksdb::Iterator> iterator, size_t capacity);
+
+    // Evict the iterators which have been put for more than 'idle_timeout_ms', return the
+    // count of the evicted iterators.
+    size_t evict_idle(uint64_t idle_timeout_ms);
+
+    void clear();
 
 private:
-    int64_t _counter;
-    std::unordered_map<int64_t, std::unique_ptr<pegasus_scan_context>> _map;
+    struct entry
+    {
+        uint32_t options_key;
+        std::unique_ptr<rocksdb::Iterator> iterator;
+        uint64_t put_time_ms;
+    };
+
     ::dsn::utils::ex_lock_nr_spin _lock;
+    // Ordered by put_time_ms.
+    std::deque<entry> _entries;
 };
 } // namespace server
 } // namespace pegasus
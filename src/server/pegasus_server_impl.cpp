@@ -26,7 +26,9 @@
 #include <rocksdb/convenience.h>
 #include <rocksdb/db.h>
 #include <rocksdb/iterator.h>
+#include <rocksdb/metadata.h>
 #include <rocksdb/rate_limiter.h>
+#include <rocksdb/secondary_cache.h>
 #include <rocksdb/statistics.h>
 #include <rocksdb/status.h>
 #include <rocksdb/utilities/checkpoint.h>
@@ -41,6 +43,7 @@
 #include <functional>
 #include <limits>
 #include <list>
+#include <map>
 #include <mutex>
 #include <ostream>
 #include <set>
@@ -51,12 +54,14 @@
 #include "base/pegasus_key_schema.h"
 #include "base/pegasus_utils.h"
 #include "base/pegasus_value_schema.h"
+#include "base/scan_aggregator.h"
 #include "capacity_unit_calculator.h"
 #include "common/replica_envs.h"
 #include "common/replication.codes.h"
 #include "common/replication_enums.h"
 #include "consensus_types.h"
 #include "dsn.layer2_types.h"
+#include "hashkey_transform.h"
 #include "hotkey_collector.h"
 #include "pegasus_rpc_types.h"
 #include "pegasus_server_write.h"
@@ -70,9 +75,12 @@
 #include "server/pegasus_read_service.h"
 #include "server/pegasus_scan_context.h"
 #include "server/range_read_limiter.h"
+#include "server/table_filter_policy.h"
 #include "task/async_calls.h"
 #include "task/task_code.h"
 #include "utils/autoref_ptr.h"
+#include "utils/binary_reader.h"
+#include "utils/binary_writer.h"
 #include "utils/blob.h"
 #include "utils/defer.h"
 #include "utils/env.h"
@@ -103,12 +111,37 @@ DSN_DEFINE_int32(pegasus.server,
                  0,
                  "Which error code to inject in read path, 0 means no error. Only for test.");
 DSN_TAG_VARIABLE(inject_read_error_for_test, FT_MUTABLE);
+DSN_DEFINE_uint32(pegasus.server,
+                  scan_context_idle_timeout_s,
+                  300,
+                  "The scan context of a replica, which holds a RocksDB iterator pinning the "
+                  "memtables and SST files, would be evicted if it has not been used for this "
+                  "many seconds, e.g. its client has gone away without clearing it, in seconds.");
+DSN_DEFINE_validator(scan_context_idle_timeout_s, [](uint32_t value) -> bool { return value > 0; });
+DSN_TAG_VARIABLE(scan_context_idle_timeout_s, FT_MUTABLE);
+DSN_DEFINE_uint32(pegasus.server,
+                  max_scan_contexts_per_replica,
+                  1000,
+                  "The max count of the scan contexts of a replica, the least recently used ones "
+                  "would be evicted once exceeded. 0 means no limit.");
+DSN_TAG_VARIABLE(max_scan_contexts_per_replica, FT_MUTABLE);
+DSN_DEFINE_uint32(pegasus.server,
+                  scan_iterator_pool_size,
+                  4,
+                  "The max count of the RocksDB iterators of the finished scans kept by a replica, "
+                  "which would be refreshed and reused by the following scans. 0 means no reuse.");
+DSN_TAG_VARIABLE(scan_iterator_pool_size, FT_MUTABLE);
 
 DSN_DECLARE_int32(read_amp_bytes_per_bit);
 DSN_DECLARE_uint32(checkpoint_reserve_min_count);
 DSN_DECLARE_uint32(checkpoint_reserve_time_seconds);
+DSN_DECLARE_bool(learn_reuse_local_sst_files);
+DSN_DECLARE_uint64(rocksdb_block_cache_compressed_secondary_capacity);
 DSN_DECLARE_uint64(rocksdb_iteration_threshold_time_ms);
+DSN_DECLARE_uint64(rocksdb_row_cache_capacity);
 DSN_DECLARE_uint64(rocksdb_slow_query_threshold_ns);
+DSN_DECLARE_double(rocksdb_bloom_filter_bits_per_key);
+DSN_DECLARE_string(rocksdb_filter_type);
 
 namespace pegasus::server {
 
@@ -127,23 +160,169 @@ static bool chkpt_init_from_dir(const char *name, int64_t &decree)
            std::string(name) == chkpt_get_dir_name(decree);
 }
 
+// The identity of an SST file, the SST files with the same name of different replicas are
+// considered to be the same one only if their identities are equal.
+struct sst_file_identity
+{
+    int64_t size = 0;
+    std::string checksum_func_name;
+    std::string checksum;
+
+    bool operator==(const sst_file_identity &other) const
+    {
+        return size == other.size && checksum_func_name == other.checksum_func_name &&
+               checksum == other.checksum;
+    }
+};
+
+// Get the identities of the live SST files of the db, keyed by the file names.
+static std::map<std::string, sst_file_identity> get_live_sst_files(rocksdb::DB *db)
+{
+    std::vector<rocksdb::LiveFileMetaData> metas;
+    db->GetLiveFilesMetaData(&metas);
+
+    std::map<std::string, sst_file_identity> files;
+    for (const auto &meta : metas) {
+        // The SST files generated without checksum could not be identified.
+        if (meta.file_checksum.empty()) {
+            continue;
+        }
+        files.emplace(meta.relative_filename,
+                      sst_file_identity{static_cast<int64_t>(meta.size),
+                                        meta.file_checksum_func_name,
+                                        meta.file_checksum});
+    }
+    return files;
+}
+
+// binary_reader asserts while reading beyond the end, thus the data from the remote replicas
+// is checked before being read.
+template <typename T>
+static bool read_pod_checked(dsn::binary_reader &reader, T &val)
+{
+    if (reader.get_remaining_size() < static_cast<int>(sizeof(T))) {
+        return false;
+    }
+    reader.read(val);
+    return true;
+}
+
+static bool read_string_checked(dsn::binary_reader &reader, std::string &str)
+{
+    int32_t len = 0;
+    if (!read_pod_checked(reader, len) || len < 0 || reader.get_remaining_size() < len) {
+        return false;
+    }
+    str.resize(len);
+    if (len > 0) {
+        reader.read(&str[0], len);
+    }
+    return true;
+}
+
+static dsn::blob encode_sst_files(const std::map<std::string, sst_file_identity> &files)
+{
+    dsn::binary_writer writer;
+    writer.write(static_cast<int32_t>(files.size()));
+    for (const auto &[name, identity] : files) {
+        writer.write(name);
+        writer.write(identity.size);
+        writer.write(identity.checksum_func_name);
+        writer.write(identity.checksum);
+    }
+    return writer.get_buffer();
+}
+
+static bool decode_sst_files(const dsn::blob &data,
+                             std::map<std::string, sst_file_identity> &files)
+{
+    dsn::binary_reader reader(data);
+    int32_t count = 0;
+    if (!read_pod_checked(reader, count)) {
+        return false;
+    }
+    for (int32_t i = 0; i < count; ++i) {
+        std::string name;
+        sst_file_identity identity;
+        if (!read_string_checked(reader, name) || !read_pod_checked(reader, identity.size) ||
+            !read_string_checked(reader, identity.checksum_func_name) ||
+            !read_string_checked(reader, identity.checksum)) {
+            return false;
+        }
+        files.emplace(std::move(name), std::move(identity));
+    }
+    return true;
+}
+
+static dsn::blob encode_file_names(const std::vector<std::string> &names)
+{
+    dsn::binary_writer writer;
+    writer.write(static_cast<int32_t>(names.size()));
+    for (const auto &name : names) {
+        writer.write(name);
+    }
+    return writer.get_buffer();
+}
+
+static bool decode_file_names(const dsn::blob &data, std::vector<std::string> &names)
+{
+    dsn::binary_reader reader(data);
+    int32_t count = 0;
+    if (!read_pod_checked(reader, count)) {
+        return false;
+    }
+    for (int32_t i = 0; i < count; ++i) {
+        std::string name;
+        if (!read_string_checked(reader, name)) {
+            return false;
+        }
+        names.emplace_back(std::move(name));
+    }
+    return true;
+}
+
 std::shared_ptr<rocksdb::RateLimiter> pegasus_server_impl::_s_rate_limiter;
 int64_t pegasus_server_impl::_rocksdb_limiter_last_total_through;
 std::shared_ptr<rocksdb::Cache> pegasus_server_impl::_s_block_cache;
+std::shared_ptr<rocksdb::SecondaryCache> pegasus_server_impl::_s_secondary_cache;
+std::shared_ptr<rocksdb::Cache> pegasus_server_impl::_s_row_cache;
 std::shared_ptr<rocksdb::WriteBufferManager> pegasus_server_impl::_s_write_buffer_manager;
 ::dsn::task_ptr pegasus_server_impl::_update_server_rdb_stat;
 METRIC_VAR_DEFINE_gauge_int64(rdb_block_cache_mem_usage_bytes, pegasus_server_impl);
+METRIC_VAR_DEFINE_gauge_int64(rdb_row_cache_mem_usage_bytes, pegasus_server_impl);
 METRIC_VAR_DEFINE_gauge_int64(rdb_wbm_total_mem_usage_bytes, pegasus_server_impl);
 METRIC_VAR_DEFINE_gauge_int64(rdb_wbm_mutable_mem_usage_bytes, pegasus_server_impl);
 METRIC_VAR_DEFINE_gauge_int64(rdb_write_rate_limiter_through_bytes_per_sec, pegasus_server_impl);
 const std::string pegasus_server_impl::COMPRESSION_HEADER = "per_level:";
 const std::chrono::seconds pegasus_server_impl::kServerStatUpdateTimeSec = std::chrono::seconds(10);
+const std::chrono::seconds pegasus_server_impl::kScanContextEvictIntervalSec =
+    std::chrono::seconds(10);
 
 // should be same with items in dsn::backup_restore_constant
 const std::string ROCKSDB_ENV_RESTORE_FORCE_RESTORE("restore.force_restore");
 const std::string ROCKSDB_ENV_RESTORE_POLICY_NAME("restore.policy_name");
 const std::string ROCKSDB_ENV_RESTORE_BACKUP_ID("restore.backup_id");
 
+// The compression types supported by the blob files, which are named the same as
+// [pegasus.server]rocksdb_compression_type.
+struct blob_compression
+{
+    rocksdb::CompressionType type;
+    // The name accepted by rocksdb::DB::SetOptions().
+    std::string rocksdb_name;
+};
+const std::map<std::string, blob_compression> blob_compressions = {
+    {"none", {rocksdb::kNoCompression, "kNoCompression"}},
+    {"snappy", {rocksdb::kSnappyCompression, "kSnappyCompression"}},
+    {"lz4", {rocksdb::kLZ4Compression, "kLZ4Compression"}},
+    {"zstd", {rocksdb::kZSTD, "kZSTD"}},
+};
+
+static bool parse_blob_gc_ratio(const std::string &str, double &ratio)
+{
+    return dsn::buf2double(str, ratio) && ratio >= 0 && ratio <= 1;
+}
+
 using cf_opts_setter = std::function<bool(const std::string &, rocksdb::ColumnFamilyOptions &)>;
 const std::unordered_map<std::string, cf_opts_setter> cf_opts_setters = {
     {dsn::replica_envs::ROCKSDB_WRITE_BUFFER_SIZE,
@@ -164,6 +343,39 @@ const std::unordered_map<std::string, cf_opts_setter> cf_opts_setters = {
          option.num_levels = val;
          return true;
      }},
+    {dsn::replica_envs::ROCKSDB_ENABLE_BLOB_FILES,
+     [](const std::string &str, rocksdb::ColumnFamilyOptions &option) -> bool {
+         return dsn::buf2bool(str, option.enable_blob_files);
+     }},
+    {dsn::replica_envs::ROCKSDB_MIN_BLOB_SIZE,
+     [](const std::string &str, rocksdb::ColumnFamilyOptions &option) -> bool {
+         return dsn::buf2uint64(str, option.min_blob_size);
+     }},
+    {dsn::replica_envs::ROCKSDB_BLOB_FILE_SIZE,
+     [](const std::string &str, rocksdb::ColumnFamilyOptions &option) -> bool {
+         return dsn::buf2uint64(str, option.blob_file_size);
+     }},
+    {dsn::replica_envs::ROCKSDB_BLOB_COMPRESSION_TYPE,
+     [](const std::string &str, rocksdb::ColumnFamilyOptions &option) -> bool {
+         const auto &find = blob_compressions.find(str);
+         if (find == blob_compressions.end()) {
+             return false;
+         }
+         option.blob_compression_type = find->second.type;
+         return true;
+     }},
+    {dsn::replica_envs::ROCKSDB_ENABLE_BLOB_GARBAGE_COLLECTION,
+     [](const std::string &str, rocksdb::ColumnFamilyOptions &option) -> bool {
+         return dsn::buf2bool(str, option.enable_blob_garbage_collection);
+     }},
+    {dsn::replica_envs::ROCKSDB_BLOB_GARBAGE_COLLECTION_AGE_CUTOFF,
+     [](const std::string &str, rocksdb::ColumnFamilyOptions &option) -> bool {
+         return parse_blob_gc_ratio(str, option.blob_garbage_collection_age_cutoff);
+     }},
+    {dsn::replica_envs::ROCKSDB_BLOB_GARBAGE_COLLECTION_FORCE_THRESHOLD,
+     [](const std::string &str, rocksdb::ColumnFamilyOptions &option) -> bool {
+         return parse_blob_gc_ratio(str, option.blob_garbage_collection_force_threshold);
+     }},
 };
 
 using cf_opts_getter =
@@ -177,6 +389,65 @@ const std::unordered_map<std::string, cf_opts_getter> cf_opts_getters = {
      [](const rocksdb::ColumnFamilyOptions &option, /*out*/ std::string &str) {
          str = std::to_string(option.num_levels);
      }},
+    {dsn::replica_envs::ROCKSDB_ENABLE_BLOB_FILES,
+     [](const rocksdb::ColumnFamilyOptions &option, /*out*/ std::string &str) {
+         str = option.enable_blob_files ? "true" : "false";
+     }},
+    {dsn::replica_envs::ROCKSDB_MIN_BLOB_SIZE,
+     [](const rocksdb::ColumnFamilyOptions &option, /*out*/ std::string &str) {
+         str = std::to_string(option.min_blob_size);
+     }},
+    {dsn::replica_envs::ROCKSDB_BLOB_FILE_SIZE,
+     [](const rocksdb::ColumnFamilyOptions &option, /*out*/ std::string &str) {
+         str = std::to_string(option.blob_file_size);
+     }},
+    {dsn::replica_envs::ROCKSDB_BLOB_COMPRESSION_TYPE,
+     [](const rocksdb::ColumnFamilyOptions &option, /*out*/ std::string &str) {
+         str = "unknown";
+         for (const auto &kv : blob_compressions) {
+             if (kv.second.type == option.blob_compression_type) {
+                 str = kv.first;
+                 break;
+             }
+         }
+     }},
+    {dsn::replica_envs::ROCKSDB_ENABLE_BLOB_GARBAGE_COLLECTION,
+     [](const rocksdb::ColumnFamilyOptions &option, /*out*/ std::string &str) {
+         str = option.enable_blob_garbage_collection ? "true" : "false";
+     }},
+    {dsn::replica_envs::ROCKSDB_BLOB_GARBAGE_COLLECTION_AGE_CUTOFF,
+     [](const rocksdb::ColumnFamilyOptions &option, /*out*/ std::string &str) {
+         str = fmt::format("{}", option.blob_garbage_collection_age_cutoff);
+     }},
+    {dsn::replica_envs::ROCKSDB_BLOB_GARBAGE_COLLECTION_FORCE_THRESHOLD,
+     [](const rocksdb::ColumnFamilyOptions &option, /*out*/ std::string &str) {
+         str = fmt::format("{}", option.blob_garbage_collection_force_threshold);
+     }},
+};
+
+// Convert the value of an app env to the format accepted by rocksdb::DB::SetOptions(), only for
+// the options whose formats are different.
+using cf_opts_formatter = std::function<bool(const std::string &, /*out*/ std::string &)>;
+const cf_opts_formatter bool_cf_opts_formatter = [](const std::string &str, std::string &value) {
+    bool val = false;
+    if (!dsn::buf2bool(str, val)) {
+        return false;
+    }
+    value = val ? "true" : "false";
+    return true;
+};
+const std::unordered_map<std::string, cf_opts_formatter> cf_opts_formatters = {
+    {dsn::replica_envs::ROCKSDB_ENABLE_BLOB_FILES, bool_cf_opts_formatter},
+    {dsn::replica_envs::ROCKSDB_ENABLE_BLOB_GARBAGE_COLLECTION, bool_cf_opts_formatter},
+    {dsn::replica_envs::ROCKSDB_BLOB_COMPRESSION_TYPE,
+     [](const std::string &str, /*out*/ std::string &value) {
+         const auto &find = blob_compressions.find(str);
+         if (find == blob_compressions.end()) {
+             return false;
+         }
+         value = find->second.rocksdb_name;
+         return true;
+     }},
 };
 
 void pegasus_server_impl::parse_checkpoints()
@@ -405,7 +676,8 @@ void pegasus_server_impl::log_expired_data(const char *op,
 
 #define CHECK_READ_THROTTLING()                                                                    \
     do {                                                                                           \
-        if (dsn_unlikely(!_read_size_throttling_controller->available())) {                        \
+        if (dsn_unlikely(!_read_size_throttling_controller->available() ||                         \
+                         !_read_cu_throttling_controller->available())) {                          \
             rpc.error() = dsn::ERR_BUSY;                                                           \
             METRIC_VAR_INCREMENT(throttling_rejected_read_requests);                               \
             return;                                                                                \
@@ -1237,7 +1509,13 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
         return;
     }
 
-    std::unique_ptr<rocksdb::Iterator> it(_db->NewIterator(rd_opts, _data_cf));
+    uint32_t iterator_options_key = pegasus_iterator_pool::get_options_key(rd_opts);
+    std::unique_ptr<rocksdb::Iterator> it = _iterator_pool.take(iterator_options_key);
+    if (it) {
+        METRIC_VAR_INCREMENT(reused_scan_iterators);
+    } else {
+        it.reset(_db->NewIterator(rd_opts, _data_cf));
+    }
     it->Seek(start);
     bool complete = false;
     bool first_exclusive = !start_inclusive;
@@ -1254,6 +1532,11 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
 
     bool return_expire_ts = request.__isset.return_expire_ts ? request.return_expire_ts : false;
     bool only_return_count = request.__isset.only_return_count ? request.only_return_count : false;
+    std::unique_ptr<scan_aggregator> aggregator;
+    if (request.__isset.return_aggregation && request.return_aggregation) {
+        aggregator = std::make_unique<scan_aggregator>(_pegasus_data_version);
+        only_return_count = true;
+    }
 
     std::unique_ptr<range_read_limiter> limiter =
         std::make_unique<range_read_limiter>(_rng_rd_opts.rocksdb_max_iteration_count,
@@ -1292,7 +1575,10 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
         switch (state) {
         case range_iteration_state::kNormal:
             count++;
-            if (!only_return_count) {
+            if (aggregator) {
+                aggregator->add(utils::to_string_view(it->key()),
+                                utils::to_string_view(it->value()));
+            } else if (!only_return_count) {
                 append_key_value(
                     resp.kvs, it->key(), it->value(), request.no_value, return_expire_ts);
             }
@@ -1318,6 +1604,9 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
     if (only_return_count) {
         resp.__set_kv_count(count);
     }
+    if (aggregator) {
+        resp.__set_aggregation(aggregator->take_aggregation());
+    }
 
     // check iteration time whether exceed limit
     if (!complete) {
@@ -1370,23 +1659,20 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
             request.no_value,
             request.__isset.validate_partition_hash ? request.validate_partition_hash : true,
             return_expire_ts,
-            only_return_count));
-        int64_t handle = _context_cache.put(std::move(context));
-        resp.context_id = handle;
+            only_return_count,
+            std::move(aggregator)));
+        context->iterator_options_key = iterator_options_key;
         // if the context is used, it will be fetched and re-put into cache,
-        // which will change the handle,
-        // then the delayed task will fetch null context by old handle, and do nothing.
-        ::dsn::tasking::enqueue(
-            LPC_PEGASUS_SERVER_DELAY,
-            &_tracker,
-            [this, handle]() { _context_cache.fetch(handle); },
-            0,
-            std::chrono::minutes(5));
+        // which will change the handle.
+        resp.context_id = put_scan_context(std::move(context));
     } else {
         // scan completed
         resp.context_id = pegasus_scan_context::SCAN_CONTEXT_ID_COMPLETED;
     }
 
+    // 'it' is still here if it has not been moved into the context, i.e. the scan is over.
+    release_scan_iterator(iterator_options_key, std::move(it));
+
     METRIC_VAR_INCREMENT_BY(read_expired_values, expire_count);
     METRIC_VAR_INCREMENT_BY(read_filtered_values, filter_count);
 
@@ -1458,7 +1744,10 @@ void pegasus_server_impl::on_scan(scan_rpc rpc)
             switch (state) {
             case range_iteration_state::kNormal:
                 count++;
-                if (!context->only_return_count) {
+                if (context->aggregator) {
+                    context->aggregator->add(utils::to_string_view(it->key()),
+                                             utils::to_string_view(it->value()));
+                } else if (!context->only_return_count) {
                     append_key_value(resp.kvs, it->key(), it->value(), no_value, return_expire_ts);
                 }
                 break;
@@ -1484,6 +1773,9 @@ void pegasus_server_impl::on_scan(scan_rpc rpc)
         if (context->only_return_count) {
             resp.__set_kv_count(count);
         }
+        if (context->aggregator) {
+            resp.__set_aggregation(context->aggregator->take_aggregation());
+        }
 
         // check iteration time whether exceed limit
         if (!complete) {
@@ -1520,19 +1812,18 @@ void pegasus_server_impl::on_scan(scan_rpc rpc)
                                limiter->max_duration_time());
         } else if (it->Valid() && !complete) {
             // scan not completed
-            int64_t handle = _context_cache.put(std::move(context));
-            resp.context_id = handle;
-            ::dsn::tasking::enqueue(
-                LPC_PEGASUS_SERVER_DELAY,
-                &_tracker,
-                [this, handle]() { _context_cache.fetch(handle); },
-                0,
-                std::chrono::minutes(5));
+            resp.context_id = put_scan_context(std::move(context));
         } else {
             // scan completed
             resp.context_id = pegasus_scan_context::SCAN_CONTEXT_ID_COMPLETED;
         }
 
+        // 'context' is still here if it has not been put back into the cache, i.e. the scan
+        // is over.
+        if (context) {
+            release_scan_iterator(context->iterator_options_key, std::move(context->iterator));
+        }
+
         METRIC_VAR_INCREMENT_BY(read_expired_values, expire_count);
         METRIC_VAR_INCREMENT_BY(read_filtered_values, filter_count);
 
@@ -1543,7 +1834,50 @@ void pegasus_server_impl::on_scan(scan_rpc rpc)
     _cu_calculator->add_scan_cu(req, resp.error, resp.kvs);
 }
 
-void pegasus_server_impl::on_clear_scanner(const int64_t &args) { _context_cache.fetch(args); }
+void pegasus_server_impl::on_clear_scanner(const int64_t &args)
+{
+    std::unique_ptr<pegasus_scan_context> context = _context_cache.fetch(args);
+    if (context) {
+        release_scan_iterator(context->iterator_options_key, std::move(context->iterator));
+    }
+}
+
+int64_t pegasus_server_impl::put_scan_context(std::unique_ptr<pegasus_scan_context> context)
+{
+    int64_t handle = _context_cache.put(std::move(context));
+    if (FLAGS_max_scan_contexts_per_replica > 0) {
+        size_t evicted_count =
+            _context_cache.evict_exceeded(FLAGS_max_scan_contexts_per_replica);
+        if (evicted_count > 0) {
+            LOG_WARNING_PREFIX("{} scan contexts are evicted since there are more than {}",
+                               evicted_count,
+                               FLAGS_max_scan_contexts_per_replica);
+            METRIC_VAR_INCREMENT_BY(capacity_evicted_scan_contexts, evicted_count);
+        }
+    }
+    METRIC_VAR_SET(scan_contexts, _context_cache.size());
+    return handle;
+}
+
+void pegasus_server_impl::release_scan_iterator(uint32_t options_key,
+                                                std::unique_ptr<rocksdb::Iterator> iterator)
+{
+    _iterator_pool.put(options_key, std::move(iterator), FLAGS_scan_iterator_pool_size);
+}
+
+void pegasus_server_impl::evict_idle_scan_contexts()
+{
+    uint64_t idle_timeout_ms = FLAGS_scan_context_idle_timeout_s * 1000ULL;
+    size_t evicted_count = _context_cache.evict_idle(idle_timeout_ms);
+    if (evicted_count > 0) {
+        LOG_INFO_PREFIX("{} scan contexts are evicted since they have been idle for {} seconds",
+                        evicted_count,
+                        FLAGS_scan_context_idle_timeout_s);
+        METRIC_VAR_INCREMENT_BY(idle_evicted_scan_contexts, evicted_count);
+    }
+    _iterator_pool.evict_idle(idle_timeout_ms);
+    METRIC_VAR_SET(scan_contexts, _context_cache.size());
+}
 
 dsn::error_code pegasus_server_impl::start(int argc, char **argv)
 {
@@ -1838,7 +2172,12 @@ dsn::error_code pegasus_server_impl::start(int argc, char **argv)
 
     // initialize cu calculator and write service after server being initialized.
     _cu_calculator = std::make_unique<capacity_unit_calculator>(
-        this, _read_hotkey_collector, _write_hotkey_collector, _read_size_throttling_controller);
+        this,
+        _read_hotkey_collector,
+        _write_hotkey_collector,
+        _read_size_throttling_controller,
+        _read_cu_throttling_controller,
+        _write_cu_throttling_controller);
     _server_write = std::make_unique<pegasus_server_write>(this);
 
     dsn::tasking::enqueue_timer(
@@ -1853,6 +2192,11 @@ dsn::error_code pegasus_server_impl::start(int argc, char **argv)
         [this]() { _write_hotkey_collector->analyse_data(); },
         std::chrono::seconds(FLAGS_hotkey_analyse_time_interval_s));
 
+    dsn::tasking::enqueue_timer(LPC_PEGASUS_SERVER_DELAY,
+                                &_tracker,
+                                [this]() { evict_idle_scan_contexts(); },
+                                kScanContextEvictIntervalSec);
+
     return dsn::ERR_OK;
 }
 
@@ -1887,6 +2231,8 @@ void pegasus_server_impl::cancel_background_work(bool wait)
     _tracker.cancel_outstanding_tasks();
 
     _context_cache.clear();
+    _iterator_pool.clear();
+    METRIC_VAR_SET(scan_contexts, 0);
 
     _is_open = false;
     release_db();
@@ -1915,10 +2261,16 @@ void pegasus_server_impl::cancel_background_work(bool wait)
         }
         METRIC_VAR_SET(rdb_total_sst_files, 0);
         METRIC_VAR_SET(rdb_total_sst_size_mb, 0);
+        METRIC_VAR_SET(rdb_total_blob_files, 0);
+        METRIC_VAR_SET(rdb_total_blob_file_size_mb, 0);
+        METRIC_VAR_SET(rdb_blob_file_garbage_size_mb, 0);
         METRIC_VAR_SET(rdb_index_and_filter_blocks_mem_usage_bytes, 0);
         METRIC_VAR_SET(rdb_memtable_mem_usage_bytes, 0);
         METRIC_VAR_SET(rdb_block_cache_hit_count, 0);
         METRIC_VAR_SET(rdb_block_cache_total_count, 0);
+        METRIC_VAR_SET(rdb_secondary_cache_hit_count, 0);
+        METRIC_VAR_SET(rdb_row_cache_hit_count, 0);
+        METRIC_VAR_SET(rdb_row_cache_total_count, 0);
     }
 
     LOG_INFO_PREFIX("close app succeed, clear_state = {}", clear_state ? "true" : "false");
@@ -2226,6 +2578,21 @@ private:
     return ::dsn::ERR_OK;
 }
 
+::dsn::error_code pegasus_server_impl::prepare_get_checkpoint(dsn::blob &learn_req)
+{
+    learn_req = dsn::blob();
+    if (!FLAGS_learn_reuse_local_sst_files || !_is_open) {
+        return ::dsn::ERR_OK;
+    }
+
+    const auto files = get_live_sst_files(_db);
+    if (!files.empty()) {
+        learn_req = encode_sst_files(files);
+    }
+    LOG_INFO_PREFIX("prepare to learn with {} local SST files", files.size());
+    return ::dsn::ERR_OK;
+}
+
 ::dsn::error_code pegasus_server_impl::get_checkpoint(int64_t learn_start,
                                                       const dsn::blob &learn_request,
                                                       dsn::replication::learn_state &state)
@@ -2246,11 +2613,41 @@ private:
         return ::dsn::ERR_FILE_OPERATION_FAILED;
     }
 
+    // Exclude the SST files which the learner already has. The file numbers are never reused
+    // by a db, thus the SST files in the checkpoint are the same as the live ones with the same
+    // names, and the files compacted after the checkpoint are just copied.
+    std::vector<std::string> reused_files;
+    if (FLAGS_learn_reuse_local_sst_files && !learn_request.empty()) {
+        std::map<std::string, sst_file_identity> learner_files;
+        if (!decode_sst_files(learn_request, learner_files)) {
+            LOG_WARNING_PREFIX("decode the SST files of the learner failed, copy all files");
+        } else {
+            const auto local_files = get_live_sst_files(_db);
+            std::vector<std::string> copied_files;
+            for (auto &file : state.files) {
+                auto name = ::dsn::utils::filesystem::get_file_name(file);
+                const auto local = local_files.find(name);
+                const auto learner = learner_files.find(name);
+                if (local != local_files.end() && learner != learner_files.end() &&
+                    local->second == learner->second) {
+                    reused_files.emplace_back(std::move(name));
+                } else {
+                    copied_files.emplace_back(std::move(file));
+                }
+            }
+            state.files = std::move(copied_files);
+        }
+    }
+    state.meta = reused_files.empty() ? dsn::blob() : encode_file_names(reused_files);
+
     state.from_decree_excluded = 0;
     state.to_decree_included = ci;
 
-    LOG_INFO_PREFIX("get checkpoint succeed, from_decree_excluded = 0, to_decree_included = {}",
-                    state.to_decree_included);
+    LOG_INFO_PREFIX("get checkpoint succeed, from_decree_excluded = 0, to_decree_included = {}, "
+                    "copied_file_count = {}, reused_file_count = {}",
+                    state.to_decree_included,
+                    state.files.size(),
+                    reused_files.size());
     return ::dsn::ERR_OK;
 }
 
@@ -2283,6 +2680,33 @@ pegasus_server_impl::storage_apply_checkpoint(chkpt_apply_mode mode,
         return err;
     }
 
+    // link the SST files reused from the local db into the learned checkpoint, before the data
+    // dir is cleared.
+    if (!state.meta.empty()) {
+        std::vector<std::string> reused_files;
+        if (state.files.empty() || !decode_file_names(state.meta, reused_files)) {
+            LOG_ERROR_PREFIX("invalid learned state, file_count = {}, meta_size = {}",
+                             state.files.size(),
+                             state.meta.length());
+            return ::dsn::ERR_INVALID_DATA;
+        }
+
+        const auto learn_dir = ::dsn::utils::filesystem::remove_file_name(state.files[0]);
+        const auto rdb_dir =
+            ::dsn::utils::filesystem::path_combine(data_dir(), replication_app_base::kRdbDir);
+        for (const auto &file : reused_files) {
+            const auto src = ::dsn::utils::filesystem::path_combine(rdb_dir, file);
+            const auto target = ::dsn::utils::filesystem::path_combine(learn_dir, file);
+            // The file may have been compacted after the learning request was sent, the next
+            // learning round would copy it then.
+            if (!::dsn::utils::filesystem::link_file(src, target)) {
+                LOG_ERROR_PREFIX("link reused SST file {} to {} failed", src, target);
+                return ::dsn::ERR_FILE_OPERATION_FAILED;
+            }
+        }
+        LOG_INFO_PREFIX("link {} reused SST files into {}", reused_files.size(), learn_dir);
+    }
+
     if (_is_open) {
         err = stop(true);
         if (err != ::dsn::ERR_OK) {
@@ -2449,8 +2873,7 @@ void pegasus_server_impl::append_key_value(std::vector<::dsn::apps::key_value> &
 
     // extract value
     if (!no_value) {
-        std::string value_buf(value.data(), value.size());
-        pegasus_extract_user_data(_pegasus_data_version, std::move(value_buf), kv.value);
+        pegasus_copy_user_data(_pegasus_data_version, utils::to_string_view(value), kv.value);
     }
 
     kvs.emplace_back(std::move(kv));
@@ -2492,8 +2915,7 @@ range_iteration_state pegasus_server_impl::append_key_value_for_multi_get(
 
     // extract value
     if (!no_value) {
-        std::string value_buf(value.data(), value.size());
-        pegasus_extract_user_data(_pegasus_data_version, std::move(value_buf), kv.value);
+        pegasus_copy_user_data(_pegasus_data_version, utils::to_string_view(value), kv.value);
     }
 
     kvs.emplace_back(std::move(kv));
@@ -2526,6 +2948,28 @@ void pegasus_server_impl::update_replica_rocksdb_statistics()
         METRIC_VAR_SET(rdb_total_sst_size_mb, val / bytes_per_mb);
     }
 
+    // The blob files exist only if the key-value separation has ever been enabled, see
+    // dsn::replica_envs::ROCKSDB_ENABLE_BLOB_FILES.
+    if (_db->GetProperty(_data_cf, rocksdb::DB::Properties::kNumBlobFiles, &str_val) &&
+        dsn::buf2uint64(str_val, val)) {
+        METRIC_VAR_SET(rdb_total_blob_files, val);
+    }
+
+    if (_db->GetProperty(_data_cf, rocksdb::DB::Properties::kTotalBlobFileSize, &str_val) &&
+        dsn::buf2uint64(str_val, val)) {
+        static uint64_t bytes_per_mb = 1U << 20U;
+        METRIC_VAR_SET(rdb_total_blob_file_size_mb, val / bytes_per_mb);
+    }
+
+    if (_db->GetProperty(_data_cf, rocksdb::DB::Properties::kLiveBlobFileGarbageSize, &str_val) &&
+        dsn::buf2uint64(str_val, val)) {
+        static uint64_t bytes_per_mb = 1U << 20U;
+        METRIC_VAR_SET(rdb_blob_file_garbage_size_mb, val / bytes_per_mb);
+    }
+
+    // The blob garbage collection is done by the compactions on every replica.
+    GET_TICKER_COUNT_AND_SET_METRIC(BLOB_DB_GC_BYTES_RELOCATED, rdb_blob_gc_relocated_bytes);
+
     std::map<std::string, std::string> props;
     if (_db->GetMapProperty(_data_cf, "rocksdb.cfstats", &props)) {
         auto write_amplification_iter = props.find("compaction.Sum.WriteAmp");
@@ -2588,6 +3032,14 @@ void pegasus_server_impl::update_replica_rocksdb_statistics()
     auto block_cache_total = block_cache_hit + block_cache_miss;
     METRIC_VAR_SET(rdb_block_cache_total_count, block_cache_total);
 
+    GET_TICKER_COUNT_AND_SET_METRIC(SECONDARY_CACHE_HITS, rdb_secondary_cache_hit_count);
+
+    auto row_cache_hit = _statistics->getTickerCount(rocksdb::ROW_CACHE_HIT);
+    METRIC_VAR_SET(rdb_row_cache_hit_count, row_cache_hit);
+
+    auto row_cache_miss = _statistics->getTickerCount(rocksdb::ROW_CACHE_MISS);
+    METRIC_VAR_SET(rdb_row_cache_total_count, row_cache_hit + row_cache_miss);
+
     auto memtable_hit_count = _statistics->getTickerCount(rocksdb::MEMTABLE_HIT);
     METRIC_VAR_SET(rdb_memtable_hit_count, memtable_hit_count);
 
@@ -2609,6 +3061,35 @@ void pegasus_server_impl::update_server_rocksdb_statistics()
                        static_cast<int64_t>(_s_block_cache->GetUsage()));
     }
 
+    // The capacities of the caches could be changed at runtime, while the caches could not be
+    // created or removed once the server has started.
+    if (_s_secondary_cache) {
+        size_t capacity = 0;
+        if (_s_secondary_cache->GetCapacity(capacity).ok() &&
+            capacity != FLAGS_rocksdb_block_cache_compressed_secondary_capacity) {
+            auto s = _s_secondary_cache->SetCapacity(
+                static_cast<size_t>(FLAGS_rocksdb_block_cache_compressed_secondary_capacity));
+            LOG_INFO("set the capacity of rocksdb secondary cache from {} to {}: {}",
+                     capacity,
+                     FLAGS_rocksdb_block_cache_compressed_secondary_capacity,
+                     s.ToString());
+        }
+    }
+
+    // Disabling the row cache needs restarting the server, thus 0 is not applied to an enabled
+    // one, which would keep it attached but caching nothing.
+    if (_s_row_cache) {
+        if (FLAGS_rocksdb_row_cache_capacity > 0 &&
+            _s_row_cache->GetCapacity() != FLAGS_rocksdb_row_cache_capacity) {
+            LOG_INFO("set the capacity of rocksdb row cache from {} to {}",
+                     _s_row_cache->GetCapacity(),
+                     FLAGS_rocksdb_row_cache_capacity);
+            _s_row_cache->SetCapacity(static_cast<size_t>(FLAGS_rocksdb_row_cache_capacity));
+        }
+        METRIC_VAR_SET(rdb_row_cache_mem_usage_bytes,
+                       static_cast<int64_t>(_s_row_cache->GetUsage()));
+    }
+
     if (_s_write_buffer_manager) {
         METRIC_VAR_SET(rdb_wbm_total_mem_usage_bytes,
                        static_cast<int64_t>(_s_write_buffer_manager->memory_usage()));
@@ -2675,11 +3156,18 @@ void pegasus_server_impl::update_rocksdb_dynamic_options(
             continue;
         }
 
+        std::string value = find->second;
+        const auto &formatter = cf_opts_formatters.find(option);
+        if (formatter != cf_opts_formatters.end() && !formatter->second(find->second, value)) {
+            LOG_ERROR_PREFIX("{}={} is invalid.", find->first, find->second);
+            continue;
+        }
+
         std::vector<std::string> args;
         // split_args example: Parse "write_buffer_size" from "rocksdb.write_buffer_size"
         dsn::utils::split_args(option.c_str(), args, '.');
         CHECK_EQ(args.size(), 2);
-        new_options[args[1]] = find->second;
+        new_options[args[1]] = value;
     }
 
     // doing set option
@@ -2722,6 +3210,75 @@ void pegasus_server_impl::set_rocksdb_options_before_creating(
     }
 }
 
+void pegasus_server_impl::update_rocksdb_filter_policy(
+    const std::map<std::string, std::string> &envs)
+{
+    if (!_table_filter_policy) {
+        return;
+    }
+
+    // If not specified, the bloom filter with the configured bits per key is used.
+    std::string type = TableFilterPolicy::kBloom;
+    double bits_per_key = FLAGS_rocksdb_bloom_filter_bits_per_key;
+    auto find = envs.find(dsn::replica_envs::ROCKSDB_FILTER_POLICY);
+    if (find != envs.end()) {
+        if (!TableFilterPolicy::IsValidType(find->second)) {
+            LOG_ERROR_PREFIX("{}={} is invalid.", find->first, find->second);
+            return;
+        }
+        type = find->second;
+    }
+    find = envs.find(dsn::replica_envs::ROCKSDB_FILTER_BITS_PER_KEY);
+    if (find != envs.end()) {
+        if (!dsn::buf2double(find->second, bits_per_key) ||
+            !TableFilterPolicy::IsValidBitsPerKey(bits_per_key)) {
+            LOG_ERROR_PREFIX("{}={} is invalid.", find->first, find->second);
+            return;
+        }
+    }
+
+    const auto old_filter = _table_filter_policy->Current();
+    CHECK_PREFIX(_table_filter_policy->Reset(type, bits_per_key));
+    const auto new_filter = _table_filter_policy->Current();
+    if (new_filter != old_filter) {
+        LOG_INFO_PREFIX("update the filter policy of the new SST files from \"{}\" to \"{}\"",
+                        old_filter,
+                        new_filter);
+    }
+}
+
+void pegasus_server_impl::set_rocksdb_filter_type_before_opening(
+    const std::map<std::string, std::string> &envs)
+{
+    if (!_table_filter_policy) {
+        return;
+    }
+
+    std::string filter_type = FLAGS_rocksdb_filter_type;
+    const auto &find = envs.find(dsn::replica_envs::ROCKSDB_FILTER_TYPE);
+    if (find != envs.end()) {
+        if (find->second == "common" || find->second == "prefix") {
+            filter_type = find->second;
+        } else {
+            LOG_ERROR_PREFIX("{}={} is invalid.", find->first, find->second);
+        }
+    }
+
+    // The SST files built with another prefix extractor are read without their prefix filters,
+    // thus it's safe to change the filter type of an existing db.
+    if (filter_type == "prefix") {
+        // The prefix of a key is the hash key with its length, see pegasus_generate_key().
+        _data_cf_opts.prefix_extractor = std::make_shared<HashkeyTransform>();
+        _data_cf_opts.memtable_prefix_bloom_size_ratio = 0.1;
+        _data_cf_rd_opts.prefix_same_as_start = true;
+    } else {
+        _data_cf_opts.prefix_extractor.reset();
+        _data_cf_opts.memtable_prefix_bloom_size_ratio = 0;
+        _data_cf_rd_opts.prefix_same_as_start = false;
+    }
+    LOG_INFO_PREFIX("set the filter type to \"{}\"", filter_type);
+}
+
 void pegasus_server_impl::update_app_envs(const std::map<std::string, std::string> &envs)
 {
     update_usage_scenario(envs);
@@ -2735,6 +3292,7 @@ void pegasus_server_impl::update_app_envs(const std::map<std::string, std::strin
 
     update_throttling_controller(envs);
     update_rocksdb_dynamic_options(envs);
+    update_rocksdb_filter_policy(envs);
 }
 
 void pegasus_server_impl::update_app_envs_before_open_db(
@@ -2749,6 +3307,8 @@ void pegasus_server_impl::update_app_envs_before_open_db(
     update_user_specified_compaction(envs);
     _manual_compact_svc.start_manual_compact_if_needed(envs);
     set_rocksdb_options_before_creating(envs);
+    set_rocksdb_filter_type_before_opening(envs);
+    update_rocksdb_filter_policy(envs);
 }
 
 void pegasus_server_impl::query_app_envs(/*out*/ std::map<std::string, std::string> &envs)
@@ -2891,6 +3451,24 @@ void pegasus_server_impl::update_throttling_controller(
     }
 }
 
+void pegasus_server_impl::update_cu_budgets(int64_t read_cu_per_sec, int64_t write_cu_per_sec)
+{
+    bool changed = false;
+    _read_cu_throttling_controller->set_rate(std::max<int64_t>(read_cu_per_sec, 0), changed);
+    if (changed) {
+        LOG_DEBUG_PREFIX("switch read CU budget to {}/s", read_cu_per_sec);
+    }
+    _write_cu_throttling_controller->set_rate(std::max<int64_t>(write_cu_per_sec, 0), changed);
+    if (changed) {
+        LOG_DEBUG_PREFIX("switch write CU budget to {}/s", write_cu_per_sec);
+    }
+}
+
+bool pegasus_server_impl::is_write_cu_budget_exhausted() const
+{
+    return !_write_cu_throttling_controller->available();
+}
+
 void pegasus_server_impl::update_slow_query_threshold(
     const std::map<std::string, std::string> &envs)
 {
@@ -3180,6 +3758,15 @@ void pegasus_server_impl::reset_rocksdb_options(const rocksdb::ColumnFamilyOptio
     // aspect 2:
     target_cf_opts->num_levels = base_cf_opts.num_levels;
     target_cf_opts->write_buffer_size = base_cf_opts.write_buffer_size;
+    target_cf_opts->enable_blob_files = base_cf_opts.enable_blob_files;
+    target_cf_opts->min_blob_size = base_cf_opts.min_blob_size;
+    target_cf_opts->blob_file_size = base_cf_opts.blob_file_size;
+    target_cf_opts->blob_compression_type = base_cf_opts.blob_compression_type;
+    target_cf_opts->enable_blob_garbage_collection = base_cf_opts.enable_blob_garbage_collection;
+    target_cf_opts->blob_garbage_collection_age_cutoff =
+        base_cf_opts.blob_garbage_collection_age_cutoff;
+    target_cf_opts->blob_garbage_collection_force_threshold =
+        base_cf_opts.blob_garbage_collection_force_threshold;
 
     reset_allow_ingest_behind_option(base_db_opt, envs, target_db_opt);
 }
@@ -3569,4 +4156,13 @@ dsn::replication::manual_compaction_status::type pegasus_server_impl::query_comp
     return _manual_compact_svc.query_compact_status();
 }
 
+void pegasus_server_impl::query_load_stats(dsn::replication::replica_load_stats &stats) const
+{
+    stats.storage_mb = METRIC_VAR_VALUE(rdb_total_sst_size_mb);
+    if (_cu_calculator) {
+        stats.read_cu = _cu_calculator->read_capacity_units();
+        stats.write_cu = _cu_calculator->write_capacity_units();
+    }
+}
+
 } // namespace pegasus::server
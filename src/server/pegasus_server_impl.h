@@ -63,6 +63,7 @@ DSN_DECLARE_uint64(rocksdb_abnormal_multi_get_size_threshold);
 namespace pegasus {
 namespace server {
 class KeyWithTTLCompactionFilterFactory;
+class TableFilterPolicy;
 } // namespace server
 } // namespace pegasus
 namespace rocksdb {
@@ -70,6 +71,7 @@ class Cache;
 class ColumnFamilyHandle;
 class DB;
 class RateLimiter;
+class SecondaryCache;
 class Statistics;
 class WriteBufferManager;
 } // namespace rocksdb
@@ -162,10 +164,9 @@ public:
                                   int count,
                                   dsn::message_ex *original_request) override;
 
-    ::dsn::error_code prepare_get_checkpoint(dsn::blob &learn_req) override
-    {
-        return ::dsn::ERR_OK;
-    }
+    // put the names, sizes and checksums of the local SST files into "learn_req", thus the
+    // primary could exclude the files already existing on the learner from the checkpoint.
+    ::dsn::error_code prepare_get_checkpoint(dsn::blob &learn_req) override;
 
     // returns:
     //  - ERR_OK: checkpoint succeed
@@ -204,7 +205,9 @@ public:
     // get the last checkpoint
     // if succeed:
     //  - the checkpoint files path are put into "state.files"
-    //  - the checkpoint_info are serialized into "state.meta"
+    //  - the names of the SST files which are the same as the ones of the learner described
+    //    by "learn_request" are excluded from "state.files" and serialized into "state.meta",
+    //    to be linked from the local data dir of the learner
     //  - the "state.from_decree_excluded" and "state.to_decree_excluded" are set properly
     // returns:
     //  - ERR_OK
@@ -215,6 +218,8 @@ public:
                                      dsn::replication::learn_state &state) override;
 
     // apply checkpoint, this will clear and recreate the db
+    // in learn mode, the SST files listed in "state.meta" are linked from the local data dir
+    // into the learned checkpoint before it is applied.
     // if succeed:
     //  - last_committed_decree() == last_durable_decree()
     // returns:
@@ -340,6 +345,13 @@ private:
 
     void update_rocksdb_dynamic_options(const std::map<std::string, std::string> &envs);
 
+    // Update the filter policy of the SST files built later.
+    void update_rocksdb_filter_policy(const std::map<std::string, std::string> &envs);
+
+    // Set whether to filter by the hash keys for the prefix seeks, which could only be changed
+    // before the db is opened.
+    void set_rocksdb_filter_type_before_opening(const std::map<std::string, std::string> &envs);
+
     void set_rocksdb_options_before_creating(const std::map<std::string, std::string> &envs);
 
     void update_throttling_controller(const std::map<std::string, std::string> &envs);
@@ -470,6 +482,12 @@ private:
 
     dsn::replication::manual_compaction_status::type query_compact_status() const override;
 
+    void query_load_stats(/*out*/ dsn::replication::replica_load_stats &stats) const override;
+
+    void update_cu_budgets(int64_t read_cu_per_sec, int64_t write_cu_per_sec) override;
+
+    bool is_write_cu_budget_exhausted() const override;
+
     // Log expired keys for verbose mode.
     void log_expired_data(const char *op,
                           const dsn::rpc_address &addr,
@@ -479,7 +497,19 @@ private:
     void
     log_expired_data(const char *op, const dsn::rpc_address &addr, const rocksdb::Slice &key) const;
 
+    // Put the unfinished scan context into the cache and return its handle. The least recently
+    // used contexts would be evicted if there are too many.
+    int64_t put_scan_context(std::unique_ptr<pegasus_scan_context> context);
+
+    // Keep the iterator of a finished scan for reuse by the following scans.
+    void release_scan_iterator(uint32_t options_key, std::unique_ptr<rocksdb::Iterator> iterator);
+
+    // Evict the scan contexts and the pooled iterators which have been idle for too long, called
+    // periodically.
+    void evict_idle_scan_contexts();
+
     static const std::chrono::seconds kServerStatUpdateTimeSec;
+    static const std::chrono::seconds kScanContextEvictIntervalSec;
     static const std::string COMPRESSION_HEADER;
 
     dsn::gpid _gpid;
@@ -490,6 +520,9 @@ private:
     range_read_limiter_options _rng_rd_opts;
 
     std::shared_ptr<KeyWithTTLCompactionFilterFactory> _key_ttl_compaction_filter_factory;
+    // Shared by the table factories of the data and meta CFs, nullptr if
+    // FLAGS_rocksdb_disable_bloom_filter is set.
+    std::shared_ptr<TableFilterPolicy> _table_filter_policy;
     std::shared_ptr<rocksdb::Statistics> _statistics;
     rocksdb::DBOptions _db_opts;
     // The value of option in data_cf according to conf template file config.ini
@@ -510,6 +543,8 @@ private:
     rocksdb::ColumnFamilyHandle *_data_cf;
     rocksdb::ColumnFamilyHandle *_meta_cf;
     static std::shared_ptr<rocksdb::Cache> _s_block_cache;
+    static std::shared_ptr<rocksdb::SecondaryCache> _s_secondary_cache;
+    static std::shared_ptr<rocksdb::Cache> _s_row_cache;
     static std::shared_ptr<rocksdb::WriteBufferManager> _s_write_buffer_manager;
     static std::shared_ptr<rocksdb::RateLimiter> _s_rate_limiter;
     static int64_t _rocksdb_limiter_last_total_through;
@@ -528,6 +563,7 @@ private:
     std::deque<int64_t> _checkpoints;           // ordered checkpoints
 
     pegasus_context_cache _context_cache;
+    pegasus_iterator_pool _iterator_pool;
 
     ::dsn::task_ptr _update_replica_rdb_stat;
     static ::dsn::task_ptr _update_server_rdb_stat;
@@ -546,24 +582,33 @@ private:
     std::shared_ptr<hotkey_collector> _write_hotkey_collector;
 
     std::shared_ptr<throttling_controller> _read_size_throttling_controller;
+    // Throttle by the CU budgets distributed by meta server from the CU quotas of the table.
+    std::shared_ptr<throttling_controller> _read_cu_throttling_controller;
+    std::shared_ptr<throttling_controller> _write_cu_throttling_controller;
 
     METRIC_VAR_DECLARE_counter(get_requests);
     METRIC_VAR_DECLARE_counter(multi_get_requests);
     METRIC_VAR_DECLARE_counter(batch_get_requests);
     METRIC_VAR_DECLARE_counter(scan_requests);
 
-    METRIC_VAR_DECLARE_percentile_int64(get_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(multi_get_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(batch_get_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(scan_latency_ns);
+    METRIC_VAR_DECLARE_histogram_int64(get_latency_ns);
+    METRIC_VAR_DECLARE_histogram_int64(multi_get_latency_ns);
+    METRIC_VAR_DECLARE_histogram_int64(batch_get_latency_ns);
+    METRIC_VAR_DECLARE_histogram_int64(scan_latency_ns);
 
     METRIC_VAR_DECLARE_counter(read_expired_values);
     METRIC_VAR_DECLARE_counter(read_filtered_values);
     METRIC_VAR_DECLARE_counter(abnormal_read_requests);
     METRIC_VAR_DECLARE_counter(throttling_rejected_read_requests);
 
+    METRIC_VAR_DECLARE_gauge_int64(scan_contexts);
+    METRIC_VAR_DECLARE_counter(idle_evicted_scan_contexts);
+    METRIC_VAR_DECLARE_counter(capacity_evicted_scan_contexts);
+    METRIC_VAR_DECLARE_counter(reused_scan_iterators);
+
     // Server-level metrics for rocksdb.
     METRIC_VAR_DECLARE_gauge_int64(rdb_block_cache_mem_usage_bytes, static);
+    METRIC_VAR_DECLARE_gauge_int64(rdb_row_cache_mem_usage_bytes, static);
     METRIC_VAR_DECLARE_gauge_int64(rdb_wbm_total_mem_usage_bytes, static);
     METRIC_VAR_DECLARE_gauge_int64(rdb_wbm_mutable_mem_usage_bytes, static);
     METRIC_VAR_DECLARE_gauge_int64(rdb_write_rate_limiter_through_bytes_per_sec, static);
@@ -571,12 +616,19 @@ private:
     // Replica-level metrics for rocksdb.
     METRIC_VAR_DECLARE_gauge_int64(rdb_total_sst_files);
     METRIC_VAR_DECLARE_gauge_int64(rdb_total_sst_size_mb);
+    METRIC_VAR_DECLARE_gauge_int64(rdb_total_blob_files);
+    METRIC_VAR_DECLARE_gauge_int64(rdb_total_blob_file_size_mb);
+    METRIC_VAR_DECLARE_gauge_int64(rdb_blob_file_garbage_size_mb);
+    METRIC_VAR_DECLARE_gauge_int64(rdb_blob_gc_relocated_bytes);
     METRIC_VAR_DECLARE_gauge_int64(rdb_estimated_keys);
 
     METRIC_VAR_DECLARE_gauge_int64(rdb_index_and_filter_blocks_mem_usage_bytes);
     METRIC_VAR_DECLARE_gauge_int64(rdb_memtable_mem_usage_bytes);
     METRIC_VAR_DECLARE_gauge_int64(rdb_block_cache_hit_count);
     METRIC_VAR_DECLARE_gauge_int64(rdb_block_cache_total_count);
+    METRIC_VAR_DECLARE_gauge_int64(rdb_secondary_cache_hit_count);
+    METRIC_VAR_DECLARE_gauge_int64(rdb_row_cache_hit_count);
+    METRIC_VAR_DECLARE_gauge_int64(rdb_row_cache_total_count);
     METRIC_VAR_DECLARE_gauge_int64(rdb_memtable_hit_count);
     METRIC_VAR_DECLARE_gauge_int64(rdb_memtable_total_count);
     METRIC_VAR_DECLARE_gauge_int64(rdb_l0_hit_count);
@@ -19,9 +19,10 @@
 
 #include <fmt/core.h>
 #include <rocksdb/cache.h>
-#include <rocksdb/filter_policy.h>
+#include <rocksdb/file_checksum.h>
 #include <rocksdb/options.h>
 #include <rocksdb/rate_limiter.h>
+#include <rocksdb/secondary_cache.h>
 #include <rocksdb/statistics.h>
 #include <rocksdb/table.h>
 #include <rocksdb/write_buffer_manager.h>
@@ -38,7 +39,6 @@
 
 #include "base/meta_store.h" // IWYU pragma: keep
 #include "common/gpid.h"
-#include "hashkey_transform.h"
 #include "hotkey_collector.h"
 #include "pegasus_event_listener.h"
 #include "pegasus_server_impl.h"
@@ -51,6 +51,7 @@
 #include "server/pegasus_read_service.h"
 #include "server/pegasus_server_write.h" // IWYU pragma: keep
 #include "server/range_read_limiter.h"
+#include "server/table_filter_policy.h"
 #include "utils/env.h"
 #include "utils/flags.h"
 #include "utils/fmt_logging.h"
@@ -78,25 +79,25 @@ METRIC_DEFINE_counter(replica,
                       dsn::metric_unit::kRequests,
                       "The number of SCAN requests");
 
-METRIC_DEFINE_percentile_int64(replica,
-                               get_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of GET requests");
+METRIC_DEFINE_histogram_int64(replica,
+                              get_latency_ns,
+                              dsn::metric_unit::kNanoSeconds,
+                              "The latency of GET requests");
 
-METRIC_DEFINE_percentile_int64(replica,
-                               multi_get_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of MULTI_GET requests");
+METRIC_DEFINE_histogram_int64(replica,
+                              multi_get_latency_ns,
+                              dsn::metric_unit::kNanoSeconds,
+                              "The latency of MULTI_GET requests");
 
-METRIC_DEFINE_percentile_int64(replica,
-                               batch_get_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of BATCH_GET requests");
+METRIC_DEFINE_histogram_int64(replica,
+                              batch_get_latency_ns,
+                              dsn::metric_unit::kNanoSeconds,
+                              "The latency of BATCH_GET requests");
 
-METRIC_DEFINE_percentile_int64(replica,
-                               scan_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of SCAN requests");
+METRIC_DEFINE_histogram_int64(replica,
+                              scan_latency_ns,
+                              dsn::metric_unit::kNanoSeconds,
+                              "The latency of SCAN requests");
 
 METRIC_DEFINE_counter(replica,
                       read_expired_values,
@@ -115,6 +116,27 @@ METRIC_DEFINE_counter(replica,
 
 METRIC_DECLARE_counter(throttling_rejected_read_requests);
 
+METRIC_DEFINE_gauge_int64(replica,
+                          scan_contexts,
+                          dsn::metric_unit::kContexts,
+                          "The number of the scan contexts cached for the unfinished scans");
+
+METRIC_DEFINE_counter(replica,
+                      idle_evicted_scan_contexts,
+                      dsn::metric_unit::kContexts,
+                      "The number of the scan contexts evicted since they have been idle for "
+                      "too long");
+
+METRIC_DEFINE_counter(replica,
+                      capacity_evicted_scan_contexts,
+                      dsn::metric_unit::kContexts,
+                      "The number of the scan contexts evicted since there are too many");
+
+METRIC_DEFINE_counter(replica,
+                      reused_scan_iterators,
+                      dsn::metric_unit::kIterators,
+                      "The number of the rocksdb iterators reused by the new scans");
+
 METRIC_DEFINE_gauge_int64(replica,
                           rdb_total_sst_files,
                           dsn::metric_unit::kFiles,
@@ -125,6 +147,27 @@ METRIC_DEFINE_gauge_int64(replica,
                           dsn::metric_unit::kMegaBytes,
                           "The total size of rocksdb sst files");
 
+METRIC_DEFINE_gauge_int64(replica,
+                          rdb_total_blob_files,
+                          dsn::metric_unit::kFiles,
+                          "The total number of rocksdb blob files");
+
+METRIC_DEFINE_gauge_int64(replica,
+                          rdb_total_blob_file_size_mb,
+                          dsn::metric_unit::kMegaBytes,
+                          "The total size of rocksdb blob files");
+
+METRIC_DEFINE_gauge_int64(replica,
+                          rdb_blob_file_garbage_size_mb,
+                          dsn::metric_unit::kMegaBytes,
+                          "The total size of the garbage in the live rocksdb blob files");
+
+METRIC_DEFINE_gauge_int64(replica,
+                          rdb_blob_gc_relocated_bytes,
+                          dsn::metric_unit::kBytes,
+                          "The accumulated size of the blobs relocated by rocksdb blob garbage "
+                          "collection");
+
 METRIC_DEFINE_gauge_int64(replica,
                           rdb_estimated_keys,
                           dsn::metric_unit::kKeys,
@@ -150,6 +193,21 @@ METRIC_DEFINE_gauge_int64(replica,
                           dsn::metric_unit::kPointLookups,
                           "The total number of lookups on rocksdb block cache");
 
+METRIC_DEFINE_gauge_int64(replica,
+                          rdb_secondary_cache_hit_count,
+                          dsn::metric_unit::kPointLookups,
+                          "The hit number of lookups on rocksdb secondary block cache");
+
+METRIC_DEFINE_gauge_int64(replica,
+                          rdb_row_cache_hit_count,
+                          dsn::metric_unit::kPointLookups,
+                          "The hit number of lookups on rocksdb row cache");
+
+METRIC_DEFINE_gauge_int64(replica,
+                          rdb_row_cache_total_count,
+                          dsn::metric_unit::kPointLookups,
+                          "The total number of lookups on rocksdb row cache");
+
 METRIC_DEFINE_gauge_int64(replica,
                           rdb_memtable_hit_count,
                           dsn::metric_unit::kPointLookups,
@@ -237,6 +295,11 @@ METRIC_DEFINE_gauge_int64(server,
                           dsn::metric_unit::kBytes,
                           "The memory usage of rocksdb block cache");
 
+METRIC_DEFINE_gauge_int64(server,
+                          rdb_row_cache_mem_usage_bytes,
+                          dsn::metric_unit::kBytes,
+                          "The memory usage of rocksdb row cache");
+
 METRIC_DEFINE_gauge_int64(server,
                           rdb_wbm_total_mem_usage_bytes,
                           dsn::metric_unit::kBytes,
@@ -468,6 +531,15 @@ DSN_DEFINE_uint32(pegasus.server,
                   2,
                   "Minimum count of checkpoint to reserve.");
 DSN_TAG_VARIABLE(checkpoint_reserve_min_count, FT_MUTABLE);
+DSN_DEFINE_bool(pegasus.server,
+                learn_reuse_local_sst_files,
+                true,
+                "Whether to reuse the SST files the learner already has while learning app, "
+                "instead of copying all the checkpoint files from the primary. The SST files "
+                "are identified by their names, sizes and the crc32c checksums recorded by "
+                "RocksDB, which are only recorded for the SST files generated while it is "
+                "enabled.");
+DSN_TAG_VARIABLE(learn_reuse_local_sst_files, FT_MUTABLE);
 DSN_DEFINE_uint32(pegasus.server,
                   checkpoint_reserve_time_seconds,
                   1800,
@@ -534,6 +606,25 @@ DSN_DEFINE_uint64(
     rocksdb_block_cache_capacity,
     10 * 1024 * 1024 * 1024ULL,
     "The Block Cache capacity shared by all RocksDB instances in the process, in bytes");
+DSN_DEFINE_uint64(pegasus.server,
+                  rocksdb_block_cache_compressed_secondary_capacity,
+                  0,
+                  "The capacity of the compressed secondary cache under the Block Cache, shared "
+                  "by all RocksDB instances in the process, in bytes. The blocks evicted from the "
+                  "Block Cache would be kept compressed in it. 0 means the secondary cache is "
+                  "disabled, which could only be enabled by restarting the server, while the "
+                  "capacity of an enabled one could be changed at runtime");
+DSN_TAG_VARIABLE(rocksdb_block_cache_compressed_secondary_capacity, FT_MUTABLE);
+DSN_DEFINE_uint64(pegasus.server,
+                  rocksdb_row_cache_capacity,
+                  0,
+                  "The capacity of the Row Cache for the point lookups (i.e. get, multi_get with "
+                  "sort keys and batch_get) shared by all RocksDB instances in the process, in "
+                  "bytes. 0 means the row cache is disabled. Whether the row cache is enabled is "
+                  "decided when the first replica is opened, thus enabling or disabling it needs "
+                  "restarting the server, while the capacity of an enabled one could be changed "
+                  "at runtime");
+DSN_TAG_VARIABLE(rocksdb_row_cache_capacity, FT_MUTABLE);
 DSN_DEFINE_uint64(pegasus.server,
                   rocksdb_total_size_across_write_buffer,
                   0,
@@ -560,6 +651,9 @@ DSN_DEFINE_double(pegasus.server,
                   rocksdb_bloom_filter_bits_per_key,
                   10,
                   "average bits allocated per key in bloom filter");
+DSN_DEFINE_validator(rocksdb_bloom_filter_bits_per_key, [](double value) -> bool {
+    return pegasus::server::TableFilterPolicy::IsValidBitsPerKey(value);
+});
 DSN_DEFINE_string(pegasus.server,
                   rocksdb_compression_type,
                   "lz4",
@@ -627,13 +721,24 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
       METRIC_VAR_INIT_replica(read_filtered_values),
       METRIC_VAR_INIT_replica(abnormal_read_requests),
       METRIC_VAR_INIT_replica(throttling_rejected_read_requests),
+      METRIC_VAR_INIT_replica(scan_contexts),
+      METRIC_VAR_INIT_replica(idle_evicted_scan_contexts),
+      METRIC_VAR_INIT_replica(capacity_evicted_scan_contexts),
+      METRIC_VAR_INIT_replica(reused_scan_iterators),
       METRIC_VAR_INIT_replica(rdb_total_sst_files),
       METRIC_VAR_INIT_replica(rdb_total_sst_size_mb),
+      METRIC_VAR_INIT_replica(rdb_total_blob_files),
+      METRIC_VAR_INIT_replica(rdb_total_blob_file_size_mb),
+      METRIC_VAR_INIT_replica(rdb_blob_file_garbage_size_mb),
+      METRIC_VAR_INIT_replica(rdb_blob_gc_relocated_bytes),
       METRIC_VAR_INIT_replica(rdb_estimated_keys),
       METRIC_VAR_INIT_replica(rdb_index_and_filter_blocks_mem_usage_bytes),
       METRIC_VAR_INIT_replica(rdb_memtable_mem_usage_bytes),
       METRIC_VAR_INIT_replica(rdb_block_cache_hit_count),
       METRIC_VAR_INIT_replica(rdb_block_cache_total_count),
+      METRIC_VAR_INIT_replica(rdb_secondary_cache_hit_count),
+      METRIC_VAR_INIT_replica(rdb_row_cache_hit_count),
+      METRIC_VAR_INIT_replica(rdb_row_cache_total_count),
       METRIC_VAR_INIT_replica(rdb_memtable_hit_count),
       METRIC_VAR_INIT_replica(rdb_memtable_total_count),
       METRIC_VAR_INIT_replica(rdb_l0_hit_count),
@@ -657,6 +762,10 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
 
     _read_size_throttling_controller =
         std::make_shared<dsn::utils::token_bucket_throttling_controller>();
+    _read_cu_throttling_controller =
+        std::make_shared<dsn::utils::token_bucket_throttling_controller>();
+    _write_cu_throttling_controller =
+        std::make_shared<dsn::utils::token_bucket_throttling_controller>();
     _slow_query_threshold_ns = FLAGS_rocksdb_slow_query_threshold_ns;
     _rng_rd_opts.multi_get_max_iteration_count = FLAGS_rocksdb_multi_get_max_iteration_count;
     _rng_rd_opts.multi_get_max_iteration_size = FLAGS_rocksdb_multi_get_max_iteration_size;
@@ -680,6 +789,11 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
     _db_opts.statistics = _statistics;
 
     _db_opts.listeners.emplace_back(new pegasus_event_listener(this));
+    if (FLAGS_learn_reuse_local_sst_files) {
+        // Record the checksums of the SST files into the MANIFEST while they are being written,
+        // which identify the files could be reused by learning without reading them again.
+        _db_opts.file_checksum_gen_factory = rocksdb::GetFileChecksumGenCrc32cFactory();
+    }
     _db_opts.max_background_flushes = FLAGS_rocksdb_max_background_flushes;
     _db_opts.max_background_compactions = FLAGS_rocksdb_max_background_compactions;
     _db_opts.stats_dump_period_sec = FLAGS_stats_dump_period_sec;
@@ -723,8 +837,20 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
         static std::once_flag flag;
         std::call_once(flag, [&]() {
             // init block cache
-            _s_block_cache = rocksdb::NewLRUCache(FLAGS_rocksdb_block_cache_capacity,
-                                                  FLAGS_rocksdb_block_cache_num_shard_bits);
+            rocksdb::LRUCacheOptions cache_opts;
+            cache_opts.capacity = FLAGS_rocksdb_block_cache_capacity;
+            cache_opts.num_shard_bits = FLAGS_rocksdb_block_cache_num_shard_bits;
+            if (FLAGS_rocksdb_block_cache_compressed_secondary_capacity > 0) {
+                rocksdb::CompressedSecondaryCacheOptions secondary_cache_opts;
+                secondary_cache_opts.capacity =
+                    FLAGS_rocksdb_block_cache_compressed_secondary_capacity;
+                secondary_cache_opts.num_shard_bits = FLAGS_rocksdb_block_cache_num_shard_bits;
+                _s_secondary_cache = rocksdb::NewCompressedSecondaryCache(secondary_cache_opts);
+                cache_opts.secondary_cache = _s_secondary_cache;
+                LOG_INFO_PREFIX("rocksdb_block_cache_compressed_secondary_capacity = {}",
+                                FLAGS_rocksdb_block_cache_compressed_secondary_capacity);
+            }
+            _s_block_cache = rocksdb::NewLRUCache(cache_opts);
         });
 
         // every replica has the same block cache
@@ -769,6 +895,23 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
         _db_opts.write_buffer_manager = _s_write_buffer_manager;
     }
 
+    // The row cache is shared by all replicas on this server as the block cache. The values are
+    // cached with their expire_ts as they are stored, thus the expired ones would still be
+    // treated as not found by the read path.
+    // Whether it is enabled is decided only once, so that all replicas share the same view of
+    // it even if the capacity is changed at runtime.
+    static std::once_flag row_cache_flag;
+    std::call_once(row_cache_flag, [&]() {
+        if (FLAGS_rocksdb_row_cache_capacity > 0) {
+            LOG_INFO_PREFIX("rocksdb_row_cache_capacity = {}", FLAGS_rocksdb_row_cache_capacity);
+            _s_row_cache = rocksdb::NewLRUCache(FLAGS_rocksdb_row_cache_capacity,
+                                                FLAGS_rocksdb_block_cache_num_shard_bits);
+        }
+    });
+    if (_s_row_cache) {
+        _db_opts.row_cache = _s_row_cache;
+    }
+
     _db_opts.max_open_files = FLAGS_rocksdb_max_open_files;
     LOG_INFO_PREFIX("rocksdb_max_open_files = {}", _db_opts.max_open_files);
 
@@ -828,16 +971,14 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
         //                                 50         |      0.225453      |      ~0.00003
         // Recommend using no more than three decimal digits after the decimal point, as in 6.667.
         // More details: https://github.com/facebook/rocksdb/wiki/RocksDB-Bloom-Filter
+        //
+        // The filter policy and the filter type (i.e. FLAGS_rocksdb_filter_type) could also be
+        // specified for each table by app envs, see update_rocksdb_filter_policy() and
+        // set_rocksdb_filter_type_before_opening().
         _tbl_opts.format_version = FLAGS_rocksdb_format_version;
-        _tbl_opts.filter_policy.reset(
-            rocksdb::NewBloomFilterPolicy(FLAGS_rocksdb_bloom_filter_bits_per_key, false));
-
-        if (dsn::utils::equals(FLAGS_rocksdb_filter_type, "prefix")) {
-            _data_cf_opts.prefix_extractor.reset(new HashkeyTransform());
-            _data_cf_opts.memtable_prefix_bloom_size_ratio = 0.1;
-
-            _data_cf_rd_opts.prefix_same_as_start = true;
-        }
+        _table_filter_policy = std::make_shared<TableFilterPolicy>(
+            TableFilterPolicy::kBloom, FLAGS_rocksdb_bloom_filter_bits_per_key);
+        _tbl_opts.filter_policy = _table_filter_policy;
     }
 
     _data_cf_opts.table_factory.reset(NewBlockBasedTableFactory(_tbl_opts));
@@ -858,6 +999,7 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
     static std::once_flag flag;
     std::call_once(flag, [&]() {
         METRIC_VAR_ASSIGN_server(rdb_block_cache_mem_usage_bytes);
+        METRIC_VAR_ASSIGN_server(rdb_row_cache_mem_usage_bytes);
         METRIC_VAR_ASSIGN_server(rdb_wbm_total_mem_usage_bytes);
         METRIC_VAR_ASSIGN_server(rdb_wbm_mutable_mem_usage_bytes);
         METRIC_VAR_ASSIGN_server(rdb_write_rate_limiter_through_bytes_per_sec);
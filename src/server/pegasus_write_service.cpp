@@ -30,6 +30,7 @@
 #include "capacity_unit_calculator.h"
 #include "common/duplication_common.h"
 #include "common/replication.codes.h"
+#include "duplicate_compression.h"
 #include "duplication_internal_types.h"
 #include "pegasus_value_schema.h"
 #include "pegasus_write_service.h"
@@ -81,58 +82,58 @@ METRIC_DEFINE_counter(replica,
                       dsn::metric_unit::kRequests,
                       "The number of CHECK_AND_MUTATE requests");
 
-METRIC_DEFINE_percentile_int64(replica,
-                               make_incr_idempotent_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The duration that an incr request is made idempotent, "
-                               "including reading the current value from storage engine, "
-                               "increasing it by a given amount and translating the incr "
-                               "request into the single-put request. Only used for the "
-                               "primary replicas");
-
-METRIC_DEFINE_percentile_int64(replica,
-                               make_check_and_set_idempotent_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The duration that a check_and_set request is made "
-                               "idempotent, including reading the check value from "
-                               "storage engine, validating the check conditions and "
-                               "translating the check_and_set request into the single-put "
-                               "request. Only used for the primary replicas");
-
-METRIC_DEFINE_percentile_int64(replica,
-                               put_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of PUT requests");
-
-METRIC_DEFINE_percentile_int64(replica,
-                               multi_put_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of MULTI_PUT requests");
-
-METRIC_DEFINE_percentile_int64(replica,
-                               remove_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of REMOVE requests");
-
-METRIC_DEFINE_percentile_int64(replica,
-                               multi_remove_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of MULTI_REMOVE requests");
-
-METRIC_DEFINE_percentile_int64(replica,
-                               incr_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of INCR requests");
-
-METRIC_DEFINE_percentile_int64(replica,
-                               check_and_set_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of CHECK_AND_SET requests");
-
-METRIC_DEFINE_percentile_int64(replica,
-                               check_and_mutate_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of CHECK_AND_MUTATE requests");
+METRIC_DEFINE_histogram_int64(replica,
+                              make_incr_idempotent_latency_ns,
+                              dsn::metric_unit::kNanoSeconds,
+                              "The duration that an incr request is made idempotent, "
+                              "including reading the current value from storage engine, "
+                              "increasing it by a given amount and translating the incr "
+                              "request into the single-put request. Only used for the "
+                              "primary replicas");
+
+METRIC_DEFINE_histogram_int64(replica,
+                              make_check_and_set_idempotent_latency_ns,
+                              dsn::metric_unit::kNanoSeconds,
+                              "The duration that a check_and_set request is made "
+                              "idempotent, including reading the check value from "
+                              "storage engine, validating the check conditions and "
+                              "translating the check_and_set request into the single-put "
+                              "request. Only used for the primary replicas");
+
+METRIC_DEFINE_histogram_int64(replica,
+                              put_latency_ns,
+                              dsn::metric_unit::kNanoSeconds,
+                              "The latency of PUT requests");
+
+METRIC_DEFINE_histogram_int64(replica,
+                              multi_put_latency_ns,
+                              dsn::metric_unit::kNanoSeconds,
+                              "The latency of MULTI_PUT requests");
+
+METRIC_DEFINE_histogram_int64(replica,
+                              remove_latency_ns,
+                              dsn::metric_unit::kNanoSeconds,
+                              "The latency of REMOVE requests");
+
+METRIC_DEFINE_histogram_int64(replica,
+                              multi_remove_latency_ns,
+                              dsn::metric_unit::kNanoSeconds,
+                              "The latency of MULTI_REMOVE requests");
+
+METRIC_DEFINE_histogram_int64(replica,
+                              incr_latency_ns,
+                              dsn::metric_unit::kNanoSeconds,
+                              "The latency of INCR requests");
+
+METRIC_DEFINE_histogram_int64(replica,
+                              check_and_set_latency_ns,
+                              dsn::metric_unit::kNanoSeconds,
+                              "The latency of CHECK_AND_SET requests");
+
+METRIC_DEFINE_histogram_int64(replica,
+                              check_and_mutate_latency_ns,
+                              dsn::metric_unit::kNanoSeconds,
+                              "The latency of CHECK_AND_MUTATE requests");
 
 METRIC_DEFINE_counter(replica,
                       dup_requests,
@@ -446,6 +447,19 @@ int pegasus_write_service::duplicate(int64_t decree,
                                      const dsn::apps::duplicate_request &update,
                                      dsn::apps::duplicate_response &resp)
 {
+    if (update.__isset.compression_type &&
+        update.compression_type != dsn::apps::duplicate_compression_type::DCT_NONE) {
+        // Copying the request is cheap since the compressed entries are shared by blob.
+        dsn::apps::duplicate_request decompressed(update);
+        if (!decompress_duplicate_request(decompressed)) {
+            // Not an invalid argument, so that the source cluster would ship it again.
+            resp.__set_error(rocksdb::Status::kCorruption);
+            resp.__set_error_hint("failed to decompress the duplicated entries");
+            return empty_put(decree);
+        }
+        return duplicate(decree, decompressed, resp);
+    }
+
     // Verifies the cluster_id.
     for (const auto &request : update.entries) {
         if (!dsn::replication::is_dup_cluster_id_configured(request.cluster_id)) {
@@ -240,16 +240,16 @@ private:
     METRIC_VAR_DECLARE_counter(check_and_set_requests);
     METRIC_VAR_DECLARE_counter(check_and_mutate_requests);
 
-    METRIC_VAR_DECLARE_percentile_int64(make_incr_idempotent_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(make_check_and_set_idempotent_latency_ns);
-
-    METRIC_VAR_DECLARE_percentile_int64(put_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(multi_put_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(remove_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(multi_remove_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(incr_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(check_and_set_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(check_and_mutate_latency_ns);
+    METRIC_VAR_DECLARE_histogram_int64(make_incr_idempotent_latency_ns);
+    METRIC_VAR_DECLARE_histogram_int64(make_check_and_set_idempotent_latency_ns);
+
+    METRIC_VAR_DECLARE_histogram_int64(put_latency_ns);
+    METRIC_VAR_DECLARE_histogram_int64(multi_put_latency_ns);
+    METRIC_VAR_DECLARE_histogram_int64(remove_latency_ns);
+    METRIC_VAR_DECLARE_histogram_int64(multi_remove_latency_ns);
+    METRIC_VAR_DECLARE_histogram_int64(incr_latency_ns);
+    METRIC_VAR_DECLARE_histogram_int64(check_and_set_latency_ns);
+    METRIC_VAR_DECLARE_histogram_int64(check_and_mutate_latency_ns);
 
     METRIC_VAR_DECLARE_counter(dup_requests);
     METRIC_VAR_DECLARE_percentile_int64(dup_time_lag_ms);
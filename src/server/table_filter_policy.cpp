@@ -0,0 +1,94 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "server/table_filter_policy.h"
+
+#include <fmt/core.h>
+#include <utility>
+
+#include "utils/fmt_logging.h"
+
+namespace pegasus {
+namespace server {
+
+const std::string TableFilterPolicy::kNone("none");
+const std::string TableFilterPolicy::kBloom("bloom");
+const std::string TableFilterPolicy::kRibbon("ribbon");
+
+/*static*/ bool TableFilterPolicy::IsValidType(const std::string &type)
+{
+    return type == kNone || type == kBloom || type == kRibbon;
+}
+
+/*static*/ bool TableFilterPolicy::IsValidBitsPerKey(double bits_per_key)
+{
+    // The built-in policies take at most 100 bits per key.
+    return bits_per_key >= 1 && bits_per_key <= 100;
+}
+
+TableFilterPolicy::TableFilterPolicy(const std::string &type, double bits_per_key)
+    : _current_policy(nullptr), _reader(rocksdb::NewBloomFilterPolicy(10, false))
+{
+    CHECK(Reset(type, bits_per_key), "invalid filter {}:{}", type, bits_per_key);
+}
+
+bool TableFilterPolicy::Reset(const std::string &type, double bits_per_key)
+{
+    if (!IsValidType(type) || !IsValidBitsPerKey(bits_per_key)) {
+        return false;
+    }
+
+    const auto filter = type == kNone ? kNone : fmt::format("{}:{}", type, bits_per_key);
+    dsn::utils::auto_lock<dsn::utils::ex_lock_nr_spin> l(_lock);
+    if (filter == _current) {
+        return true;
+    }
+
+    const rocksdb::FilterPolicy *policy = nullptr;
+    if (type != kNone) {
+        auto &cached = _policies[filter];
+        if (!cached) {
+            // Use Bloom filters for the flushed SST files (i.e. bloom_before_level = 0) as
+            // RocksDB suggests, since Ribbon filters take more CPU to build, and the flushed
+            // files are soon compacted.
+            cached.reset(type == kBloom ? rocksdb::NewBloomFilterPolicy(bits_per_key, false)
+                                        : rocksdb::NewRibbonFilterPolicy(bits_per_key, 0));
+        }
+        policy = cached.get();
+    }
+    _current = filter;
+    _current_policy.store(policy, std::memory_order_release);
+    return true;
+}
+
+std::string TableFilterPolicy::Current() const
+{
+    dsn::utils::auto_lock<dsn::utils::ex_lock_nr_spin> l(_lock);
+    return _current;
+}
+
+rocksdb::FilterBitsBuilder *
+TableFilterPolicy::GetBuilderWithContext(const rocksdb::FilterBuildingContext &context) const
+{
+    const auto *policy = _current_policy.load(std::memory_order_acquire);
+    return policy == nullptr ? nullptr : policy->GetBuilderWithContext(context);
+}
+
+} // namespace server
+} // namespace pegasus
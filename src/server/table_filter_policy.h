@@ -0,0 +1,94 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/slice.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "utils/ports.h"
+#include "utils/synchronize.h"
+
+namespace pegasus {
+namespace server {
+
+// A filter policy whose underlying built-in policy could be switched while the db is running,
+// thus the filter of each table could be chosen by app envs (see
+// dsn::replica_envs::ROCKSDB_FILTER_POLICY and ROCKSDB_FILTER_BITS_PER_KEY).
+//
+// The switch only takes effect on the SST files built after it, e.g. by the next flush or
+// compaction. The filters of all of the built-in policies could be read by any built-in policy,
+// thus the SST files built before are still read with their own filters.
+//
+// Thread-safe.
+class TableFilterPolicy : public rocksdb::FilterPolicy
+{
+public:
+    static const std::string kNone;
+    static const std::string kBloom;
+    static const std::string kRibbon;
+
+    static bool IsValidType(const std::string &type);
+    static bool IsValidBitsPerKey(double bits_per_key);
+
+    // `type` and `bits_per_key` must be valid.
+    TableFilterPolicy(const std::string &type, double bits_per_key);
+
+    // Switch to the filter of `type` with `bits_per_key`, return false if any of them is invalid.
+    bool Reset(const std::string &type, double bits_per_key);
+
+    // The description of the current filter, e.g. "ribbon:10".
+    std::string Current() const;
+
+    // NOTE: You must change the name if the way choosing filters changed.
+    const char *Name() const override { return "pegasus.TableFilterPolicy"; }
+
+    // Use the compatibility name of the built-in policies, which is also used to locate the
+    // filter blocks in SST files, thus the SST files built by the built-in policies (i.e. before
+    // this policy is introduced) are still read with their filters, and vice versa.
+    const char *CompatibilityName() const override { return _reader->CompatibilityName(); }
+
+    // Return nullptr if the current type is kNone, then no filter is built for the new SST files.
+    rocksdb::FilterBitsBuilder *
+    GetBuilderWithContext(const rocksdb::FilterBuildingContext &context) const override;
+
+    rocksdb::FilterBitsReader *GetFilterBitsReader(const rocksdb::Slice &contents) const override
+    {
+        return _reader->GetFilterBitsReader(contents);
+    }
+
+private:
+    // The builders may refer to the policies creating them, thus the policies are never released
+    // and are reused once the same filter is chosen again.
+    mutable dsn::utils::ex_lock_nr_spin _lock;
+    std::map<std::string, std::unique_ptr<const rocksdb::FilterPolicy>> _policies;
+    std::string _current;
+    std::atomic<const rocksdb::FilterPolicy *> _current_policy;
+
+    const std::unique_ptr<const rocksdb::FilterPolicy> _reader;
+
+    DISALLOW_COPY_AND_ASSIGN(TableFilterPolicy);
+};
+
+} // namespace server
+} // namespace pegasus
@@ -78,6 +78,8 @@ public:
               r,
               std::make_shared<hotkey_collector>(dsn::replication::hotkey_type::READ, r),
               std::make_shared<hotkey_collector>(dsn::replication::hotkey_type::WRITE, r),
+              std::make_shared<dsn::utils::token_bucket_throttling_controller>(),
+              std::make_shared<dsn::utils::token_bucket_throttling_controller>(),
               std::make_shared<dsn::utils::token_bucket_throttling_controller>())
     {
     }
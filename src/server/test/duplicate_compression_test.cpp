@@ -0,0 +1,117 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+
+#include "duplication_internal_types.h"
+#include "gtest/gtest.h"
+#include "server/duplicate_compression.h"
+#include "utils/blob.h"
+
+namespace pegasus {
+namespace server {
+
+namespace {
+
+dsn::apps::duplicate_request generate_request(const std::string &raw_message, int count)
+{
+    dsn::apps::duplicate_request request;
+    for (int i = 0; i < count; ++i) {
+        dsn::apps::duplicate_entry entry;
+        entry.__set_timestamp(200 + i);
+        entry.__set_raw_message(dsn::blob::create_from_bytes(std::string(raw_message)));
+        entry.__set_cluster_id(1);
+        request.entries.emplace_back(std::move(entry));
+    }
+    return request;
+}
+
+} // anonymous namespace
+
+TEST(duplicate_compression_test, parse_type)
+{
+    dsn::apps::duplicate_compression_type::type type;
+    ASSERT_TRUE(parse_duplicate_compression_type("none", type));
+    ASSERT_EQ(dsn::apps::duplicate_compression_type::DCT_NONE, type);
+    ASSERT_TRUE(parse_duplicate_compression_type("lz4", type));
+    ASSERT_EQ(dsn::apps::duplicate_compression_type::DCT_LZ4, type);
+    ASSERT_TRUE(parse_duplicate_compression_type("zstd", type));
+    ASSERT_EQ(dsn::apps::duplicate_compression_type::DCT_ZSTD, type);
+    ASSERT_FALSE(parse_duplicate_compression_type("snappy", type));
+    ASSERT_FALSE(parse_duplicate_compression_type("", type));
+}
+
+TEST(duplicate_compression_test, compress_and_decompress)
+{
+    for (const auto type : {dsn::apps::duplicate_compression_type::DCT_LZ4,
+                            dsn::apps::duplicate_compression_type::DCT_ZSTD}) {
+        auto request = generate_request(std::string(1000, 'v'), 10);
+        size_t uncompressed_size = compress_duplicate_request(type, request);
+        ASSERT_GT(uncompressed_size, 10000);
+        ASSERT_TRUE(request.entries.empty());
+        ASSERT_EQ(type, request.compression_type);
+        ASSERT_EQ(uncompressed_size, static_cast<size_t>(request.uncompressed_size));
+        ASSERT_LT(request.compressed_entries.length(), uncompressed_size);
+
+        ASSERT_TRUE(decompress_duplicate_request(request));
+        ASSERT_EQ(generate_request(std::string(1000, 'v'), 10).entries, request.entries);
+
+        // Decompressing an uncompressed request is a no-op.
+        ASSERT_TRUE(decompress_duplicate_request(request));
+        ASSERT_EQ(10, request.entries.size());
+    }
+}
+
+TEST(duplicate_compression_test, not_compressed)
+{
+    // Nothing is done for DCT_NONE.
+    auto request = generate_request(std::string(1000, 'v'), 10);
+    compress_duplicate_request(dsn::apps::duplicate_compression_type::DCT_NONE, request);
+    ASSERT_EQ(10, request.entries.size());
+    ASSERT_FALSE(request.__isset.compressed_entries);
+
+    // Tiny entries are kept as they were since they could not be smaller after compression.
+    request = generate_request("v", 1);
+    compress_duplicate_request(dsn::apps::duplicate_compression_type::DCT_LZ4, request);
+    ASSERT_EQ(1, request.entries.size());
+    ASSERT_FALSE(request.__isset.compressed_entries);
+}
+
+TEST(duplicate_compression_test, decompress_corrupted)
+{
+    auto request = generate_request(std::string(1000, 'v'), 10);
+    compress_duplicate_request(dsn::apps::duplicate_compression_type::DCT_ZSTD, request);
+
+    auto mismatched_size = request;
+    mismatched_size.uncompressed_size += 1;
+    ASSERT_FALSE(decompress_duplicate_request(mismatched_size));
+
+    auto invalid_size = request;
+    invalid_size.uncompressed_size = -1;
+    ASSERT_FALSE(decompress_duplicate_request(invalid_size));
+
+    auto mismatched_type = request;
+    mismatched_type.compression_type = dsn::apps::duplicate_compression_type::DCT_LZ4;
+    ASSERT_FALSE(decompress_duplicate_request(mismatched_type));
+}
+
+} // namespace server
+} // namespace pegasus
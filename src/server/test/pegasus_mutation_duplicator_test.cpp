@@ -22,6 +22,7 @@
 #include <fmt/core.h>
 #include <pegasus/error.h>
 #include <sys/types.h>
+#include <map>
 #include <memory>
 #include <string_view>
 #include <tuple>
@@ -43,8 +44,13 @@
 #include "rrdb/rrdb.code.definition.h"
 #include "rrdb/rrdb_types.h"
 #include "runtime/message_utils.h"
+#include "server/duplicate_compression.h"
 #include "utils/blob.h"
 #include "utils/error_code.h"
+#include "utils/flags.h"
+#include "utils/metrics.h"
+
+DSN_DECLARE_string(dup_compression_type);
 
 namespace pegasus {
 namespace server {
@@ -66,7 +72,7 @@ public:
     void test_duplicate()
     {
         replica_base replica(dsn::gpid(1, 1), "fake_replica", "temp");
-        auto duplicator = new_mutation_duplicator(&replica, "onebox2", "temp");
+        auto duplicator = new_mutation_duplicator(&replica, 1, "onebox2", "temp");
         duplicator->set_task_environment(&_env);
 
         std::string sort_key;
@@ -116,7 +122,7 @@ public:
                 total_shipped_size +=
                     rpc.dsn_request()->body_size() + rpc.dsn_request()->header->hdr_length;
                 duplicator_impl->on_duplicate_reply(
-                    get_hash(rpc),
+                    get_lane(duplicator_impl, rpc),
                     [total_shipped_size](size_t final_size) {
                         ASSERT_EQ(total_shipped_size, final_size);
                     },
@@ -136,7 +142,7 @@ public:
     void test_duplicate_failed()
     {
         replica_base replica(dsn::gpid(1, 1), "fake_replica", "temp");
-        auto duplicator = new_mutation_duplicator(&replica, "onebox2", "temp");
+        auto duplicator = new_mutation_duplicator(&replica, 1, "onebox2", "temp");
         duplicator->set_task_environment(&_env);
 
         std::string sort_key;
@@ -177,12 +183,14 @@ public:
 
             // failed
             duplicator_impl->on_duplicate_reply(
-                get_hash(rpc), [](size_t) {}, rpc, dsn::ERR_TIMEOUT);
+                get_lane(duplicator_impl, rpc), [](size_t) {}, rpc, dsn::ERR_TIMEOUT);
 
             // schedule next round
             _tracker.wait_outstanding_tasks();
 
             // retry infinitely
+            auto lane = get_lane(duplicator_impl, rpc);
+            ASSERT_EQ(duplicator_impl->_retry_delays[lane], 100_ms);
             ASSERT_EQ(duplicator_impl->_inflights.size(), 1);
             ASSERT_EQ(duplicate_rpc::mail_box().size(), 1);
             ASSERT_EQ(duplicator_impl->_inflights.begin()->second.size(), batch_count - 1);
@@ -191,21 +199,32 @@ public:
             // with other error
             rpc.response().error = PERR_INVALID_ARGUMENT;
             duplicator_impl->on_duplicate_reply(
-                get_hash(rpc), [](size_t) {}, rpc, dsn::ERR_OK);
+                get_lane(duplicator_impl, rpc), [](size_t) {}, rpc, dsn::ERR_OK);
             _tracker.wait_outstanding_tasks();
             ASSERT_EQ(duplicator_impl->_inflights.size(), 1);
             ASSERT_EQ(duplicate_rpc::mail_box().size(), 1);
             ASSERT_EQ(duplicator_impl->_inflights.begin()->second.size(), batch_count - 1);
             duplicate_rpc::mail_box().clear();
 
+            // back off exponentially
+            ASSERT_EQ(duplicator_impl->_retry_delays[lane], 200_ms);
+
             // with other error
             rpc.response().error = PERR_OK;
             duplicator_impl->on_duplicate_reply(
-                get_hash(rpc), [](size_t) {}, rpc, dsn::ERR_IO_PENDING);
+                get_lane(duplicator_impl, rpc), [](size_t) {}, rpc, dsn::ERR_IO_PENDING);
             _tracker.wait_outstanding_tasks();
             ASSERT_EQ(duplicator_impl->_inflights.size(), 1);
             ASSERT_EQ(duplicate_rpc::mail_box().size(), 1);
             ASSERT_EQ(duplicator_impl->_inflights.begin()->second.size(), batch_count - 1);
+            ASSERT_EQ(duplicator_impl->_retry_delays[lane], 400_ms);
+            duplicate_rpc::mail_box().clear();
+
+            // the delay is reset once succeeded
+            rpc.response().error = PERR_OK;
+            duplicator_impl->on_duplicate_reply(lane, [](size_t) {}, rpc, dsn::ERR_OK);
+            _tracker.wait_outstanding_tasks();
+            ASSERT_EQ(duplicator_impl->_retry_delays.count(lane), 0);
             duplicate_rpc::mail_box().clear();
         }
     }
@@ -213,7 +232,7 @@ public:
     void test_duplicate_isolated_hashkeys()
     {
         replica_base replica(dsn::gpid(1, 1), "fake_replica", "temp");
-        auto duplicator = new_mutation_duplicator(&replica, "onebox2", "temp");
+        auto duplicator = new_mutation_duplicator(&replica, 1, "onebox2", "temp");
         duplicator->set_task_environment(&_env);
 
         size_t total_size = 4000;
@@ -223,8 +242,6 @@ public:
         }
 
         mutation_tuple_set muts;
-        uint total_bytes = 0;
-        uint batch_count = 0;
         for (uint64_t i = 0; i < total_size; i++) {
             uint64_t ts = 200 + i;
             dsn::task_code code = dsn::apps::RPC_RRDB_RRDB_PUT;
@@ -236,12 +253,6 @@ public:
             auto data = dsn::move_message_to_blob(msg.get());
 
             muts.insert(std::make_tuple(ts, code, data));
-            total_bytes += data.length();
-
-            if (total_bytes >= FLAGS_duplicate_log_batch_bytes) {
-                batch_count++;
-                total_bytes = 0;
-            }
         }
 
         auto duplicator_impl = dynamic_cast<pegasus_mutation_duplicator *>(duplicator.get());
@@ -249,39 +260,130 @@ public:
         {
             duplicator->duplicate(muts, [](size_t) {});
 
-            // ensure each bucket has only 1 batch request and each request is
-            // isolated with others.
-            ASSERT_EQ(duplicator_impl->_inflights.size(), batch_count);
-            ASSERT_EQ(duplicate_rpc::mail_box().size(), batch_count);
+            // ensure each lane has only 1 rpc in flight, and the lanes are shipped concurrently.
+            ASSERT_EQ(duplicator_impl->_inflights.size(), FLAGS_dup_max_inflight_rpcs);
+            ASSERT_EQ(duplicate_rpc::mail_box().size(), FLAGS_dup_max_inflight_rpcs);
+            size_t queued_count = 0;
             for (const auto &ents : duplicator_impl->_inflights) {
-                ASSERT_EQ(ents.second.size(), 0);
+                queued_count += ents.second.size();
             }
+            ASSERT_GT(queued_count, 0);
+
+            // reply with success until all the writes are shipped, each lane in mutation order.
+            size_t shipped_count = 0;
+            std::map<uint64_t, int64_t> last_timestamps; // lane -> timestamp
+            while (!duplicate_rpc::mail_box().empty()) {
+                auto rpc_list = std::move(duplicate_rpc::mail_box());
+                ASSERT_LE(rpc_list.size(), FLAGS_dup_max_inflight_rpcs);
+                for (const auto &rpc : rpc_list) {
+                    auto lane = get_lane(duplicator_impl, rpc);
+                    for (const auto &entry : rpc.request().entries) {
+                        ASSERT_EQ(lane,
+                                  get_hash_from_request(entry.task_code, entry.raw_message) %
+                                      FLAGS_dup_max_inflight_rpcs);
+                        ASSERT_LT(last_timestamps[lane], entry.timestamp);
+                        last_timestamps[lane] = entry.timestamp;
+                    }
+                    shipped_count += rpc.request().entries.size();
+
+                    rpc.response().error = dsn::ERR_OK;
+                    duplicator_impl->on_duplicate_reply(lane, [](size_t) {}, rpc, dsn::ERR_OK);
+                }
+                _tracker.wait_outstanding_tasks();
+            }
+            ASSERT_EQ(shipped_count, total_size);
+            ASSERT_EQ(duplicator_impl->_inflights.size(), 0);
+        }
+    }
 
-            // reply with success
-            auto rpc_list = std::move(duplicate_rpc::mail_box());
-            for (const auto &rpc : rpc_list) {
-                rpc.response().error = dsn::ERR_OK;
-                duplicator_impl->on_duplicate_reply(
-                    get_hash(rpc), [](size_t) {}, rpc, dsn::ERR_OK);
+    void test_duplicate_with_compression(const char *compression_type)
+    {
+        replica_base replica(dsn::gpid(1, 1), "fake_replica", "temp");
+        auto duplicator = new_mutation_duplicator(&replica, 1, "onebox2", "temp");
+        duplicator->set_task_environment(&_env);
+
+        mutation_tuple_set muts;
+        for (uint64_t i = 0; i < 100; i++) {
+            dsn::apps::update_request request;
+            pegasus::pegasus_generate_key(request.key, std::string("hash"), std::to_string(i));
+            request.value = dsn::blob::create_from_bytes(std::string(100, 'v'));
+            dsn::message_ptr msg =
+                dsn::from_thrift_request_to_received_message(request, dsn::apps::RPC_RRDB_RRDB_PUT);
+            muts.insert(std::make_tuple(200 + i,
+                                        dsn::apps::RPC_RRDB_RRDB_PUT,
+                                        dsn::move_message_to_blob(msg.get())));
+        }
+
+        auto reserved_compression_type = FLAGS_dup_compression_type;
+        FLAGS_dup_compression_type = compression_type;
+        auto duplicator_impl = dynamic_cast<pegasus_mutation_duplicator *>(duplicator.get());
+        RPC_MOCKING(duplicate_rpc)
+        {
+            bool shipped = false;
+            duplicator->duplicate(muts, [&shipped](size_t) { shipped = true; });
+
+            size_t shipped_count = 0;
+            while (!duplicate_rpc::mail_box().empty()) {
+                auto rpc_list = std::move(duplicate_rpc::mail_box());
+                for (const auto &rpc : rpc_list) {
+                    // The entries of the same hash key are highly compressible.
+                    ASSERT_TRUE(rpc.request().__isset.compressed_entries);
+                    ASSERT_TRUE(rpc.request().entries.empty());
+
+                    auto request = rpc.request();
+                    ASSERT_TRUE(decompress_duplicate_request(request));
+                    shipped_count += request.entries.size();
+
+                    duplicator_impl->on_duplicate_reply(
+                        get_hash_from_request(request.entries.back().task_code,
+                                              request.entries.back().raw_message) %
+                            FLAGS_dup_max_inflight_rpcs,
+                        [&shipped](size_t) { shipped = true; },
+                        rpc,
+                        dsn::ERR_OK);
+                }
+                _tracker.wait_outstanding_tasks();
             }
-            _tracker.wait_outstanding_tasks();
-            ASSERT_EQ(duplicate_rpc::mail_box().size(), 0);
+            ASSERT_TRUE(shipped);
+            ASSERT_EQ(shipped_count, muts.size());
             ASSERT_EQ(duplicator_impl->_inflights.size(), 0);
+            ASSERT_LT(duplicator_impl->METRIC_VAR_VALUE(dup_compression_ratio), 100);
         }
+        FLAGS_dup_compression_type = reserved_compression_type;
     }
 
     void test_create_duplicator()
     {
         replica_base replica(dsn::gpid(1, 1), "fake_replica", "temp");
-        auto duplicator = new_mutation_duplicator(&replica, "onebox2", "temp");
+        auto duplicator = new_mutation_duplicator(&replica, 1, "onebox2", "temp");
         duplicator->set_task_environment(&_env);
         auto duplicator_impl = dynamic_cast<pegasus_mutation_duplicator *>(duplicator.get());
         ASSERT_EQ(2, duplicator_impl->_remote_cluster_id);
         ASSERT_STREQ("onebox2", duplicator_impl->_remote_cluster.c_str());
         ASSERT_EQ(1, get_current_dup_cluster_id());
+
+        // The gauges of different duplications on the same replica are kept separately.
+        auto another_duplicator = new_mutation_duplicator(&replica, 2, "onebox2", "temp");
+        another_duplicator->set_task_environment(&_env);
+        auto another_duplicator_impl =
+            dynamic_cast<pegasus_mutation_duplicator *>(another_duplicator.get());
+        ASSERT_EQ("duplication@1.1.1", duplicator_impl->duplication_metric_entity()->id());
+        ASSERT_EQ("duplication@2.1.1", another_duplicator_impl->duplication_metric_entity()->id());
+        ASSERT_EQ("2",
+                  another_duplicator_impl->duplication_metric_entity()->attributes().at("dup_id"));
+
+        duplicator_impl->METRIC_VAR_NAME(dup_inflight_rpcs)->set(3);
+        ASSERT_EQ(3, duplicator_impl->METRIC_VAR_VALUE(dup_inflight_rpcs));
+        ASSERT_EQ(0, another_duplicator_impl->METRIC_VAR_VALUE(dup_inflight_rpcs));
     }
 
 private:
+    static uint64_t get_lane(const pegasus_mutation_duplicator *duplicator,
+                             const duplicate_rpc &rpc)
+    {
+        return get_hash(rpc) % duplicator->_max_inflight_rpcs;
+    }
+
     static uint64_t get_hash(const duplicate_rpc &rpc)
     {
         auto size = rpc.request().entries.size();
@@ -371,12 +473,18 @@ TEST_P(pegasus_mutation_duplicator_test, duplicate_isolated_hashkeys)
     test_duplicate_isolated_hashkeys();
 }
 
+TEST_P(pegasus_mutation_duplicator_test, duplicate_with_compression)
+{
+    test_duplicate_with_compression("lz4");
+    test_duplicate_with_compression("zstd");
+}
+
 TEST_P(pegasus_mutation_duplicator_test, create_duplicator) { test_create_duplicator(); }
 
 TEST_P(pegasus_mutation_duplicator_test, duplicate_duplicate)
 {
     replica_base replica(dsn::gpid(1, 1), "fake_replica", "temp");
-    auto duplicator = new_mutation_duplicator(&replica, "onebox2", "temp");
+    auto duplicator = new_mutation_duplicator(&replica, 1, "onebox2", "temp");
     duplicator->set_task_environment(&_env);
 
     dsn::apps::update_request request;
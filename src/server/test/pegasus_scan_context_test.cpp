@@ -0,0 +1,190 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <rocksdb/db.h>
+#include <rocksdb/iterator.h>
+#include <rocksdb/options.h>
+#include <rocksdb/status.h>
+#include <stdint.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "server/pegasus_scan_context.h"
+
+namespace pegasus {
+namespace server {
+
+std::unique_ptr<pegasus_scan_context> create_scan_context()
+{
+    return std::make_unique<pegasus_scan_context>(nullptr,
+                                                  "",
+                                                  true,
+                                                  dsn::apps::filter_type::FT_NO_FILTER,
+                                                  "",
+                                                  dsn::apps::filter_type::FT_NO_FILTER,
+                                                  "",
+                                                  100,
+                                                  false,
+                                                  false,
+                                                  false,
+                                                  false,
+                                                  nullptr);
+}
+
+TEST(pegasus_context_cache_test, put_and_fetch)
+{
+    pegasus_context_cache cache;
+    int64_t handle1 = cache.put(create_scan_context());
+    int64_t handle2 = cache.put(create_scan_context());
+    ASSERT_GT(handle1, 0);
+    ASSERT_LT(handle1, handle2);
+    ASSERT_EQ(2, cache.size());
+
+    ASSERT_NE(nullptr, cache.fetch(handle1));
+    ASSERT_EQ(nullptr, cache.fetch(handle1));
+    ASSERT_EQ(1, cache.size());
+
+    cache.clear();
+    ASSERT_EQ(0, cache.size());
+    ASSERT_EQ(nullptr, cache.fetch(handle2));
+}
+
+TEST(pegasus_context_cache_test, evict_idle)
+{
+    pegasus_context_cache cache;
+    int64_t handle1 = cache.put(create_scan_context());
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    int64_t handle2 = cache.put(create_scan_context());
+
+    ASSERT_EQ(1, cache.evict_idle(100));
+    ASSERT_EQ(1, cache.size());
+    ASSERT_EQ(nullptr, cache.fetch(handle1));
+    ASSERT_NE(nullptr, cache.fetch(handle2));
+}
+
+TEST(pegasus_context_cache_test, evict_exceeded)
+{
+    pegasus_context_cache cache;
+    std::vector<int64_t> handles;
+    for (int i = 0; i < 40; ++i) {
+        handles.push_back(cache.put(create_scan_context()));
+    }
+
+    ASSERT_EQ(0, cache.evict_exceeded(40));
+    ASSERT_EQ(30, cache.evict_exceeded(10));
+    ASSERT_EQ(10, cache.size());
+
+    // The least recently put ones are evicted.
+    for (int i = 0; i < 30; ++i) {
+        ASSERT_EQ(nullptr, cache.fetch(handles[i]));
+    }
+    for (int i = 30; i < 40; ++i) {
+        ASSERT_NE(nullptr, cache.fetch(handles[i]));
+    }
+}
+
+class pegasus_iterator_pool_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        rocksdb::Options options;
+        options.create_if_missing = true;
+        rocksdb::DB *db = nullptr;
+        ASSERT_TRUE(rocksdb::DB::Open(options, kDbPath, &db).ok());
+        _db.reset(db);
+        ASSERT_TRUE(_db->Put(rocksdb::WriteOptions(), "k1", "v1").ok());
+    }
+
+    void TearDown() override
+    {
+        _pool.clear();
+        _db.reset();
+        ASSERT_TRUE(rocksdb::DestroyDB(kDbPath, rocksdb::Options()).ok());
+    }
+
+    std::unique_ptr<rocksdb::Iterator> new_iterator()
+    {
+        return std::unique_ptr<rocksdb::Iterator>(_db->NewIterator(rocksdb::ReadOptions()));
+    }
+
+    const std::string kDbPath = "./pegasus_iterator_pool_test";
+    std::unique_ptr<rocksdb::DB> _db;
+    pegasus_iterator_pool _pool;
+};
+
+TEST_F(pegasus_iterator_pool_test, get_options_key)
+{
+    rocksdb::ReadOptions options1;
+    rocksdb::ReadOptions options2;
+    ASSERT_EQ(pegasus_iterator_pool::get_options_key(options1),
+              pegasus_iterator_pool::get_options_key(options2));
+
+    options2.total_order_seek = !options1.total_order_seek;
+    ASSERT_NE(pegasus_iterator_pool::get_options_key(options1),
+              pegasus_iterator_pool::get_options_key(options2));
+}
+
+TEST_F(pegasus_iterator_pool_test, take_and_put)
+{
+    ASSERT_EQ(nullptr, _pool.take(0));
+
+    _pool.put(0, new_iterator(), 2);
+    ASSERT_EQ(nullptr, _pool.take(1));
+
+    // The reused iterator could read the data written after it was put.
+    ASSERT_TRUE(_db->Put(rocksdb::WriteOptions(), "k2", "v2").ok());
+    auto it = _pool.take(0);
+    ASSERT_NE(nullptr, it);
+    it->Seek("k2");
+    ASSERT_TRUE(it->Valid());
+    ASSERT_EQ("v2", it->value().ToString());
+    ASSERT_EQ(nullptr, _pool.take(0));
+
+    // Nothing is kept if the capacity is 0.
+    _pool.put(0, std::move(it), 0);
+    ASSERT_EQ(nullptr, _pool.take(0));
+
+    // The oldest ones are evicted once exceeded.
+    _pool.put(0, new_iterator(), 2);
+    _pool.put(1, new_iterator(), 2);
+    _pool.put(1, new_iterator(), 2);
+    ASSERT_EQ(nullptr, _pool.take(0));
+    ASSERT_NE(nullptr, _pool.take(1));
+    ASSERT_NE(nullptr, _pool.take(1));
+}
+
+TEST_F(pegasus_iterator_pool_test, evict_idle)
+{
+    _pool.put(0, new_iterator(), 4);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    _pool.put(0, new_iterator(), 4);
+
+    ASSERT_EQ(1, _pool.evict_idle(100));
+    ASSERT_NE(nullptr, _pool.take(0));
+    ASSERT_EQ(nullptr, _pool.take(0));
+}
+
+} // namespace server
+} // namespace pegasus
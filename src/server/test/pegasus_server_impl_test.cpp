@@ -19,9 +19,12 @@
 
 // IWYU pragma: no_include <ext/alloc_traits.h>
 #include <base/pegasus_key_schema.h>
+#include <boost/algorithm/string/predicate.hpp>
 #include <fmt/core.h>
 #include <rocksdb/db.h>
 #include <rocksdb/options.h>
+#include <rocksdb/slice.h>
+#include <rocksdb/table_properties.h>
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
@@ -33,6 +36,7 @@
 #include <utility>
 #include <vector>
 
+#include "base/meta_store.h"
 #include "common/gpid.h"
 #include "common/replica_envs.h"
 #include "common/replication.codes.h"
@@ -47,17 +51,22 @@
 #include "rrdb/rrdb_types.h"
 #include "runtime/serverlet.h"
 #include "server/pegasus_read_service.h"
+#include "server/table_filter_policy.h"
 #include "test_util/test_util.h"
 #include "utils/autoref_ptr.h"
 #include "utils/blob.h"
 #include "utils/defer.h"
 #include "utils/error_code.h"
 #include "utils/filesystem.h"
+#include "utils/flags.h"
 #include "utils/fmt_logging.h"
 #include "utils/metrics.h"
 #include "utils/test_macros.h"
 #include "utils_types.h"
 
+DSN_DECLARE_bool(learn_reuse_local_sst_files);
+DSN_DECLARE_uint64(rocksdb_row_cache_capacity);
+
 namespace pegasus::server {
 
 class pegasus_server_impl_test : public pegasus_server_test_base
@@ -121,6 +130,13 @@ protected:
         } tests[] = {
             {"rocksdb.num_levels", "5", "5"},
             {"rocksdb.write_buffer_size", "33554432", "33554432"},
+            {"rocksdb.enable_blob_files", "true", "true"},
+            {"rocksdb.min_blob_size", "65536", "65536"},
+            {"rocksdb.blob_file_size", "134217728", "134217728"},
+            {"rocksdb.blob_compression_type", "zstd", "zstd"},
+            {"rocksdb.enable_blob_garbage_collection", "true", "true"},
+            {"rocksdb.blob_garbage_collection_age_cutoff", "0.5", "0.5"},
+            {"rocksdb.blob_garbage_collection_force_threshold", "0.8", "0.8"},
         };
 
         std::map<std::string, std::string> all_test_envs;
@@ -431,6 +447,210 @@ TEST_P(pegasus_server_impl_test, test_update_user_specified_compaction)
     ASSERT_EQ(user_specified_compaction, _server->_user_specified_compaction);
 }
 
+TEST_P(pegasus_server_impl_test, test_update_filter_policy)
+{
+    ASSERT_EQ(dsn::ERR_OK, start());
+
+    struct test_case
+    {
+        std::string policy;
+        std::string bits_per_key;
+        std::string expected_filter;
+        bool expected_has_filter;
+    } tests[] = {{"none", "", "none", false},
+                 {"bloom", "", "bloom:10", true},
+                 {"ribbon", "16", "ribbon:16", true},
+                 {"", "", "bloom:10", true}};
+
+    for (const auto &test : tests) {
+        std::map<std::string, std::string> envs;
+        _server->query_app_envs(envs);
+        if (!test.policy.empty()) {
+            envs[dsn::replica_envs::ROCKSDB_FILTER_POLICY] = test.policy;
+        }
+        if (!test.bits_per_key.empty()) {
+            envs[dsn::replica_envs::ROCKSDB_FILTER_BITS_PER_KEY] = test.bits_per_key;
+        }
+        _server->update_app_envs(envs);
+        ASSERT_EQ(test.expected_filter, _server->_table_filter_policy->Current());
+
+        // The filter policy takes effect on the newly flushed SST file.
+        dsn::blob key;
+        pegasus_generate_key(key, test.expected_filter, std::string("sort_key"));
+        ASSERT_TRUE(_server->_db
+                        ->Put(rocksdb::WriteOptions(),
+                              _server->_data_cf,
+                              rocksdb::Slice(key.data(), key.length()),
+                              "value")
+                        .ok());
+        ASSERT_TRUE(_server->_db->Flush(rocksdb::FlushOptions(), _server->_data_cf).ok());
+
+        rocksdb::TablePropertiesCollection props;
+        ASSERT_TRUE(_server->_db->GetPropertiesOfAllTables(_server->_data_cf, &props).ok());
+        std::shared_ptr<const rocksdb::TableProperties> newest;
+        for (const auto &[_, prop] : props) {
+            if (!newest || prop->orig_file_number > newest->orig_file_number) {
+                newest = prop;
+            }
+        }
+        ASSERT_TRUE(newest);
+        ASSERT_EQ(test.expected_has_filter, newest->filter_size > 0) << test.expected_filter;
+    }
+}
+
+TEST_P(pegasus_server_impl_test, test_row_cache)
+{
+    // The row cache is enabled by rocksdb_row_cache_capacity in config.ini of the test.
+    ASSERT_EQ(dsn::ERR_OK, start());
+    ASSERT_TRUE(_server->_s_row_cache);
+    ASSERT_EQ(_server->_s_row_cache, _server->_db->GetDBOptions().row_cache);
+
+    // Only the lookups on the SST files would go through the row cache.
+    dsn::blob key;
+    pegasus_generate_key(key, std::string("row_cache_hash_key"), std::string("sort_key"));
+    const rocksdb::Slice skey(key.data(), key.length());
+    ASSERT_TRUE(_server->_db->Put(rocksdb::WriteOptions(), _server->_data_cf, skey, "value").ok());
+    ASSERT_TRUE(_server->_db->Flush(rocksdb::FlushOptions(), _server->_data_cf).ok());
+
+    _server->update_replica_rocksdb_statistics();
+    const auto hit_before = _server->METRIC_VAR_VALUE(rdb_row_cache_hit_count);
+    const auto total_before = _server->METRIC_VAR_VALUE(rdb_row_cache_total_count);
+
+    // The first lookup misses and fills the row cache, while the second one hits it.
+    for (int i = 0; i < 2; ++i) {
+        std::string value;
+        ASSERT_TRUE(
+            _server->_db->Get(_server->_data_cf_rd_opts, _server->_data_cf, skey, &value).ok());
+        ASSERT_EQ("value", value);
+    }
+
+    _server->update_replica_rocksdb_statistics();
+    ASSERT_EQ(hit_before + 1, _server->METRIC_VAR_VALUE(rdb_row_cache_hit_count));
+    ASSERT_EQ(total_before + 2, _server->METRIC_VAR_VALUE(rdb_row_cache_total_count));
+    ASSERT_GT(_server->_s_row_cache->GetUsage(), 0);
+
+    // The capacity of the enabled row cache could be changed at runtime, while 0 is not applied.
+    const auto origin_capacity = FLAGS_rocksdb_row_cache_capacity;
+    FLAGS_rocksdb_row_cache_capacity = origin_capacity * 2;
+    pegasus_server_impl::update_server_rocksdb_statistics();
+    ASSERT_EQ(origin_capacity * 2, _server->_s_row_cache->GetCapacity());
+
+    FLAGS_rocksdb_row_cache_capacity = 0;
+    pegasus_server_impl::update_server_rocksdb_statistics();
+    ASSERT_EQ(origin_capacity * 2, _server->_s_row_cache->GetCapacity());
+
+    FLAGS_rocksdb_row_cache_capacity = origin_capacity;
+    pegasus_server_impl::update_server_rocksdb_statistics();
+    ASSERT_EQ(origin_capacity, _server->_s_row_cache->GetCapacity());
+}
+
+TEST_P(pegasus_server_impl_test, test_open_db_with_filter_type)
+{
+    std::map<std::string, std::string> envs;
+    envs[dsn::replica_envs::ROCKSDB_FILTER_TYPE] = "common";
+    ASSERT_EQ(dsn::ERR_OK, start(envs));
+    ASSERT_FALSE(_server->_data_cf_opts.prefix_extractor);
+    ASSERT_FALSE(_server->_data_cf_rd_opts.prefix_same_as_start);
+
+    // Reopen the db with the filter type of config.ini.
+    ASSERT_EQ(dsn::ERR_OK, _server->stop(false));
+    ASSERT_EQ(dsn::ERR_OK, start());
+    ASSERT_TRUE(_server->_data_cf_opts.prefix_extractor);
+    ASSERT_TRUE(_server->_data_cf_rd_opts.prefix_same_as_start);
+}
+
+TEST_P(pegasus_server_impl_test, test_learn_with_local_sst_files)
+{
+    ASSERT_EQ(dsn::ERR_OK, start());
+
+    // Generate 2 SST files with the last flushed decree 1, then reopen the db to checkpoint it.
+    for (const auto &hash_key : {"hash_key_1", "hash_key_2"}) {
+        dsn::blob key;
+        pegasus_generate_key(key, std::string(hash_key), std::string("sort_key"));
+        ASSERT_TRUE(_server->_db
+                        ->Put(rocksdb::WriteOptions(),
+                              _server->_data_cf,
+                              rocksdb::Slice(key.data(), key.length()),
+                              "value")
+                        .ok());
+        _server->_meta_store->set_last_flushed_decree(1);
+        ASSERT_TRUE(_server->_db
+                        ->Flush(rocksdb::FlushOptions(), {_server->_data_cf, _server->_meta_cf})
+                        .ok());
+    }
+    ASSERT_EQ(dsn::ERR_OK, _server->stop(false));
+    ASSERT_EQ(dsn::ERR_OK, start());
+    ASSERT_EQ(1, _server->last_durable_decree());
+
+    const auto get_sst_files = [](const std::vector<std::string> &files) {
+        std::vector<std::string> sst_files;
+        for (const auto &file : files) {
+            if (boost::algorithm::ends_with(file, ".sst")) {
+                sst_files.push_back(file);
+            }
+        }
+        return sst_files;
+    };
+
+    // All of the SST files are copied if the learner does not send its local SST files.
+    {
+        PRESERVE_FLAG(learn_reuse_local_sst_files);
+        FLAGS_learn_reuse_local_sst_files = false;
+        dsn::blob learn_req;
+        ASSERT_EQ(dsn::ERR_OK, _server->prepare_get_checkpoint(learn_req));
+        ASSERT_TRUE(learn_req.empty());
+
+        dsn::replication::learn_state state;
+        ASSERT_EQ(dsn::ERR_OK, _server->get_checkpoint(0, learn_req, state));
+        ASSERT_EQ(2, get_sst_files(state.files).size());
+        ASSERT_TRUE(state.meta.empty());
+    }
+
+    // The learner is the replica itself, thus all of the SST files are reused.
+    dsn::blob learn_req;
+    ASSERT_EQ(dsn::ERR_OK, _server->prepare_get_checkpoint(learn_req));
+    ASSERT_FALSE(learn_req.empty());
+
+    dsn::replication::learn_state state;
+    ASSERT_EQ(dsn::ERR_OK, _server->get_checkpoint(0, learn_req, state));
+    ASSERT_EQ(1, state.to_decree_included);
+    ASSERT_TRUE(get_sst_files(state.files).empty());
+    ASSERT_FALSE(state.files.empty());
+    ASSERT_FALSE(state.meta.empty());
+
+    // Mock copying the rest of the files into the learn dir, then apply the learned checkpoint
+    // with the SST files linked from the local db.
+    ASSERT_TRUE(dsn::utils::filesystem::remove_path(_server->learn_dir()));
+    ASSERT_TRUE(dsn::utils::filesystem::create_directory(_server->learn_dir()));
+    dsn::replication::learn_state learned_state;
+    learned_state.to_decree_included = state.to_decree_included;
+    learned_state.meta = state.meta;
+    for (const auto &file : state.files) {
+        const auto learned_file = dsn::utils::filesystem::path_combine(
+            _server->learn_dir(), dsn::utils::filesystem::get_file_name(file));
+        ASSERT_TRUE(dsn::utils::filesystem::link_file(file, learned_file));
+        learned_state.files.push_back(learned_file);
+    }
+    ASSERT_EQ(dsn::ERR_OK,
+              _server->storage_apply_checkpoint(
+                  dsn::replication::replication_app_base::chkpt_apply_mode::learn,
+                  learned_state));
+    ASSERT_EQ(1, _server->last_durable_decree());
+
+    for (const auto &hash_key : {"hash_key_1", "hash_key_2"}) {
+        dsn::blob key;
+        pegasus_generate_key(key, std::string(hash_key), std::string("sort_key"));
+        std::string value;
+        ASSERT_TRUE(_server->_db
+                        ->Get(rocksdb::ReadOptions(),
+                              _server->_data_cf,
+                              rocksdb::Slice(key.data(), key.length()),
+                              &value)
+                        .ok());
+        ASSERT_EQ("value", value);
+    }
+}
+
 TEST_P(pegasus_server_impl_test, test_load_from_duplication_data)
 {
     auto origin_file = fmt::format("{}/{}", _server->duplication_dir(), "checkpoint");
@@ -0,0 +1,82 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "server/table_filter_policy.h"
+
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/table.h>
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace pegasus {
+namespace server {
+
+TEST(TableFilterPolicyTest, Validate)
+{
+    ASSERT_TRUE(TableFilterPolicy::IsValidType("none"));
+    ASSERT_TRUE(TableFilterPolicy::IsValidType("bloom"));
+    ASSERT_TRUE(TableFilterPolicy::IsValidType("ribbon"));
+    ASSERT_FALSE(TableFilterPolicy::IsValidType(""));
+    ASSERT_FALSE(TableFilterPolicy::IsValidType("cuckoo"));
+
+    ASSERT_TRUE(TableFilterPolicy::IsValidBitsPerKey(1));
+    ASSERT_TRUE(TableFilterPolicy::IsValidBitsPerKey(6.667));
+    ASSERT_TRUE(TableFilterPolicy::IsValidBitsPerKey(100));
+    ASSERT_FALSE(TableFilterPolicy::IsValidBitsPerKey(0.5));
+    ASSERT_FALSE(TableFilterPolicy::IsValidBitsPerKey(101));
+}
+
+TEST(TableFilterPolicyTest, Reset)
+{
+    TableFilterPolicy policy(TableFilterPolicy::kBloom, 10);
+    ASSERT_EQ("bloom:10", policy.Current());
+
+    ASSERT_TRUE(policy.Reset(TableFilterPolicy::kRibbon, 6.667));
+    ASSERT_EQ("ribbon:6.667", policy.Current());
+
+    // The invalid filters are ignored.
+    ASSERT_FALSE(policy.Reset("cuckoo", 10));
+    ASSERT_FALSE(policy.Reset(TableFilterPolicy::kBloom, 0));
+    ASSERT_EQ("ribbon:6.667", policy.Current());
+
+    ASSERT_TRUE(policy.Reset(TableFilterPolicy::kNone, 10));
+    ASSERT_EQ("none", policy.Current());
+}
+
+TEST(TableFilterPolicyTest, NoFilter)
+{
+    TableFilterPolicy policy(TableFilterPolicy::kNone, 10);
+    rocksdb::BlockBasedTableOptions table_options;
+    ASSERT_EQ(nullptr, policy.GetBuilderWithContext(rocksdb::FilterBuildingContext(table_options)));
+}
+
+TEST(TableFilterPolicyTest, CompatibleWithBuiltinPolicies)
+{
+    // The SST files built by the built-in policies are read with their filters, and vice versa.
+    TableFilterPolicy policy(TableFilterPolicy::kRibbon, 10);
+    std::unique_ptr<const rocksdb::FilterPolicy> bloom(rocksdb::NewBloomFilterPolicy(10, false));
+    std::unique_ptr<const rocksdb::FilterPolicy> ribbon(rocksdb::NewRibbonFilterPolicy(10, 0));
+    ASSERT_STREQ(bloom->CompatibilityName(), policy.CompatibilityName());
+    ASSERT_STREQ(ribbon->CompatibilityName(), policy.CompatibilityName());
+}
+
+} // namespace server
+} // namespace pegasus
@@ -551,6 +551,24 @@ inline void scan_data_next(scan_data_context *context)
                     case SCAN_COUNT:
                         if (kv_count != -1) {
                             context->split_rows += kv_count;
+                            if (context->count_hash_key) {
+                                // The hash keys are counted on the server side if the scanner
+                                // returns aggregation, which is not supported by the old servers.
+                                pegasus::pegasus_client::scan_aggregation aggregation;
+                                int err = context->scanner->get_aggregation(aggregation);
+                                if (err != pegasus::PERR_OK) {
+                                    if (!context->split_completed.exchange(true)) {
+                                        fprintf(stderr,
+                                                "ERROR: split[%d] get aggregation failed: %s, "
+                                                "the server may be too old to count hash keys\n",
+                                                context->split_id,
+                                                context->client->get_error_string(err));
+                                        context->error_occurred->store(true);
+                                    }
+                                    break;
+                                }
+                                context->split_hash_key_count.store(aggregation.hash_key_count);
+                            }
                             scan_data_next(context);
                             break;
                         }
@@ -1372,6 +1390,31 @@ struct row_data
         return put_bytes + multi_put_bytes + check_and_set_bytes + check_and_mutate_bytes;
     }
 
+    // Get the kth percentile of a latency histogram (e.g. "get_latency_ns") in nanoseconds over
+    // the merged buckets, or 0 if there is not any observation.
+    double get_latency_percentile(const std::string &metric_name,
+                                  dsn::kth_percentile_type type) const
+    {
+        const auto iter = latency_buckets.find(metric_name);
+        if (iter == latency_buckets.end()) {
+            return 0;
+        }
+
+        return static_cast<double>(dsn::histogram_kth_percentile(iter->second, type));
+    }
+
+    // Merge the buckets of all latency histograms of `buckets` into this row.
+    void aggregate_latencies(
+        const std::map<std::string, dsn::metric_merged_histogram_buckets> &buckets)
+    {
+        for (const auto &latency : buckets) {
+            auto &to = latency_buckets[latency.first];
+            for (const auto &bucket : latency.second) {
+                to[bucket.first] += bucket.second;
+            }
+        }
+    }
+
     void aggregate(const row_data &row)
     {
         get_qps += row.get_qps;
@@ -1436,6 +1479,7 @@ struct row_data
         rdb_read_memtable_hit_count += row.rdb_read_memtable_hit_count;
         rdb_write_amplification += row.rdb_write_amplification;
         rdb_read_amplification += row.rdb_read_amplification;
+        aggregate_latencies(row.latency_buckets);
     }
 
     std::string row_name;
@@ -1500,6 +1544,11 @@ struct row_data
     double rdb_read_memtable_hit_count = 0;
     double rdb_write_amplification = 0;
     double rdb_read_amplification = 0;
+
+    // The buckets of latency histograms (see kRowLatencyMetrics), keyed by the metric name.
+    // Unlike the percentiles, the histograms of different replicas, partitions or tables could
+    // be merged by addition.
+    std::map<std::string, dsn::metric_merged_histogram_buckets> latency_buckets;
 };
 
 // TODO(wangdan): there are still dozens of fields to be added to the following functions.
@@ -1579,6 +1628,183 @@ inline dsn::metric_filters row_data_filters(int32_t table_id)
     return filters;
 }
 
+// The latency histograms of replicas which are aggregated into `row_data::latency_buckets`.
+const std::vector<std::string> kRowLatencyMetrics = {
+    "get_latency_ns",
+    "multi_get_latency_ns",
+    "batch_get_latency_ns",
+    "scan_latency_ns",
+    "put_latency_ns",
+    "multi_put_latency_ns",
+    "remove_latency_ns",
+    "multi_remove_latency_ns",
+    "incr_latency_ns",
+    "check_and_set_latency_ns",
+    "check_and_mutate_latency_ns",
+};
+
+// The latency histograms are queried separately from the other row data since only their
+// buckets are needed.
+inline dsn::metric_filters row_latency_filters()
+{
+    dsn::metric_filters filters;
+    filters.with_metric_fields = {dsn::kMetricNameField, dsn::kMetricBucketsField};
+    filters.entity_types = {"replica"};
+    filters.entity_metrics = kRowLatencyMetrics;
+    return filters;
+}
+
+inline dsn::metric_filters row_latency_filters(int32_t table_id)
+{
+    auto filters = row_latency_filters();
+    filters.entity_attrs = {"table_id", std::to_string(table_id)};
+    return filters;
+}
+
+// Given the attributes of a replica, decide which row its latencies are merged into, if any.
+// Otherwise, `*row` would be set to nullptr.
+using latency_row_selector =
+    std::function<dsn::error_s(const dsn::metric_entity::attr_map &, row_data **)>;
+
+// Merge the cumulative buckets of the latency histograms of the selected replicas into the rows.
+inline dsn::error_s aggregate_latency_buckets(const std::string &json_string,
+                                              const latency_row_selector &select_row)
+{
+    DESERIALIZE_METRIC_QUERY_BRIEF_SNAPSHOT(buckets, json_string, query_snapshot);
+
+    for (const auto &entity : query_snapshot.entities) {
+        row_data *row = nullptr;
+        RETURN_NOT_OK(select_row(entity.attributes, &row));
+        if (row == nullptr) {
+            continue;
+        }
+
+        for (const auto &m : entity.metrics) {
+            if (!dsn::merge_histogram_buckets(m.buckets, row->latency_buckets[m.name])) {
+                return FMT_ERR(dsn::ERR_INVALID_DATA,
+                               "invalid buckets of {} for replica {}",
+                               m.name,
+                               entity.id);
+            }
+        }
+    }
+
+    return dsn::error_s::ok();
+}
+
+// Merge the buckets of the latency histograms of the selected replicas into the rows, with only
+// the observations between both samples counted.
+inline dsn::error_s aggregate_latency_buckets(const std::string &json_string_start,
+                                              const std::string &json_string_end,
+                                              const latency_row_selector &select_row)
+{
+    dsn::metric_query_brief_buckets_snapshot query_snapshot_start;
+    dsn::metric_query_brief_buckets_snapshot query_snapshot_end;
+    RETURN_NOT_OK(dsn::deserialize_metric_query_2_samples(
+        json_string_start, json_string_end, query_snapshot_start, query_snapshot_end));
+
+    std::map<std::pair<std::string, std::string>, const dsn::metric_histogram_buckets *>
+        start_buckets;
+    for (const auto &entity : query_snapshot_start.entities) {
+        for (const auto &m : entity.metrics) {
+            start_buckets.emplace(std::make_pair(entity.id, m.name), &m.buckets);
+        }
+    }
+
+    for (const auto &entity : query_snapshot_end.entities) {
+        row_data *row = nullptr;
+        RETURN_NOT_OK(select_row(entity.attributes, &row));
+        if (row == nullptr) {
+            continue;
+        }
+
+        std::map<std::string, dsn::metric_merged_histogram_buckets> diffs;
+        for (const auto &m : entity.metrics) {
+            dsn::metric_merged_histogram_buckets start;
+            dsn::metric_merged_histogram_buckets end;
+            const auto iter = start_buckets.find(std::make_pair(entity.id, m.name));
+            if ((iter != start_buckets.end() &&
+                 !dsn::merge_histogram_buckets(*iter->second, start)) ||
+                !dsn::merge_histogram_buckets(m.buckets, end)) {
+                return FMT_ERR(dsn::ERR_INVALID_DATA,
+                               "invalid buckets of {} for replica {}",
+                               m.name,
+                               entity.id);
+            }
+
+            diffs.emplace(m.name, dsn::diff_histogram_buckets(start, end));
+        }
+        row->aggregate_latencies(diffs);
+    }
+
+    return dsn::error_s::ok();
+}
+
+// Select the row of the table for the replica whose partition has its primary on this node.
+inline latency_row_selector create_table_latency_row_selector(
+    const std::map<int32_t, std::vector<dsn::partition_configuration>> &pcs_by_appid,
+    const dsn::host_port &node,
+    std::vector<row_data> &rows)
+{
+    std::unordered_map<int32_t, row_data *> rows_by_table_id;
+    for (auto &row : rows) {
+        rows_by_table_id.emplace(row.app_id, &row);
+    }
+
+    return [&pcs_by_appid, node, rows_by_table_id](const dsn::metric_entity::attr_map &attrs,
+                                                   row_data **row) -> dsn::error_s {
+        *row = nullptr;
+
+        int32_t table_id = 0;
+        RETURN_NOT_OK(dsn::parse_metric_table_id(attrs, table_id));
+        int32_t partition_id = 0;
+        RETURN_NOT_OK(dsn::parse_metric_partition_id(attrs, partition_id));
+
+        const auto &pcs_iter = pcs_by_appid.find(table_id);
+        const auto &row_iter = rows_by_table_id.find(table_id);
+        if (pcs_iter == pcs_by_appid.end() || row_iter == rows_by_table_id.end() ||
+            partition_id < 0 ||
+            static_cast<size_t>(partition_id) >= pcs_iter->second.size() ||
+            pcs_iter->second[partition_id].hp_primary != node) {
+            // Ignore once the replica is not the primary of the partition.
+            return dsn::error_s::ok();
+        }
+
+        *row = row_iter->second;
+        return dsn::error_s::ok();
+    };
+}
+
+// Select the row of the partition for the replica whose partition has its primary on this node.
+inline latency_row_selector
+create_partition_latency_row_selector(const int32_t table_id,
+                                      const std::vector<dsn::partition_configuration> &pcs,
+                                      const dsn::host_port &node,
+                                      std::vector<row_data> &rows)
+{
+    CHECK_EQ(rows.size(), pcs.size());
+
+    return [table_id, &pcs, node, &rows](const dsn::metric_entity::attr_map &attrs,
+                                         row_data **row) -> dsn::error_s {
+        *row = nullptr;
+
+        int32_t metric_table_id = 0;
+        RETURN_NOT_OK(dsn::parse_metric_table_id(attrs, metric_table_id));
+        int32_t partition_id = 0;
+        RETURN_NOT_OK(dsn::parse_metric_partition_id(attrs, partition_id));
+
+        if (metric_table_id != table_id || partition_id < 0 ||
+            static_cast<size_t>(partition_id) >= pcs.size() ||
+            pcs[partition_id].hp_primary != node) {
+            // Ignore once the replica is not the primary of the partition.
+            return dsn::error_s::ok();
+        }
+
+        *row = &rows[partition_id];
+        return dsn::error_s::ok();
+    };
+}
+
 #define BIND_ROW(metric_name, member)                                                              \
     {                                                                                              \
 #metric_name, &row.member                                                                  \
@@ -2004,6 +2230,43 @@ inline bool get_app_partition_stat(shell_context *sc,
             }
         }
     }
+
+    // The latency histograms are not exposed as perf-counters, thus fetch their cumulative
+    // buckets from the metrics of the replicas.
+    const auto &latency_results = get_metrics(nodes, row_latency_filters().to_query_string());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        auto res = process_get_metrics_result(latency_results[i], nodes[i], "row latency");
+        if (res) {
+            res = aggregate_latency_buckets(
+                latency_results[i].body(),
+                [&](const dsn::metric_entity::attr_map &attrs, row_data **row) -> dsn::error_s {
+                    *row = nullptr;
+
+                    int32_t table_id = 0;
+                    RETURN_NOT_OK(dsn::parse_metric_table_id(attrs, table_id));
+                    int32_t partition_id = 0;
+                    RETURN_NOT_OK(dsn::parse_metric_partition_id(attrs, partition_id));
+
+                    // Only primary partitions will be counted.
+                    const auto pcs_iter = pcs_by_appid.find(table_id);
+                    const auto name_iter = app_id_name.find(table_id);
+                    if (pcs_iter == pcs_by_appid.end() || name_iter == app_id_name.end() ||
+                        partition_id < 0 ||
+                        static_cast<size_t>(partition_id) >= pcs_iter->second.size() ||
+                        pcs_iter->second[partition_id].hp_primary != nodes[i].hp) {
+                        return dsn::error_s::ok();
+                    }
+
+                    *row = &rows[name_iter->second][partition_id];
+                    return dsn::error_s::ok();
+                });
+        }
+
+        if (!res) {
+            LOG_ERROR("aggregate latencies from node {} failed: {}", nodes[i].hp, res);
+            return false;
+        }
+    }
     return true;
 }
 
@@ -2018,9 +2281,12 @@ get_table_stats(shell_context *sc, uint32_t sample_interval_ms, std::vector<row_
     }
 
     const auto &query_string = row_data_filters().to_query_string();
+    const auto &latency_query_string = row_latency_filters().to_query_string();
     const auto &results_start = get_metrics(nodes, query_string);
+    const auto &latency_results_start = get_metrics(nodes, latency_query_string);
     std::this_thread::sleep_for(std::chrono::milliseconds(sample_interval_ms));
     const auto &results_end = get_metrics(nodes, query_string);
+    const auto &latency_results_end = get_metrics(nodes, latency_query_string);
 
     std::map<int32_t, std::vector<dsn::partition_configuration>> pcs_by_appid;
     if (!get_app_partitions(sc, apps, pcs_by_appid)) {
@@ -2049,6 +2315,19 @@ get_table_stats(shell_context *sc, uint32_t sample_interval_ms, std::vector<row_
             calcs->aggregate_metrics(results_start[i].body(), results_end[i].body()),
             nodes[i],
             "aggregate row data requests");
+
+        RETURN_SHELL_IF_GET_METRICS_FAILED(
+            latency_results_start[i], nodes[i], "starting row latency requests");
+        RETURN_SHELL_IF_GET_METRICS_FAILED(
+            latency_results_end[i], nodes[i], "ending row latency requests");
+
+        RETURN_SHELL_IF_PARSE_METRICS_FAILED(
+            aggregate_latency_buckets(
+                latency_results_start[i].body(),
+                latency_results_end[i].body(),
+                create_table_latency_row_selector(pcs_by_appid, nodes[i].hp, rows)),
+            nodes[i],
+            "aggregate row latency requests");
     }
 
     return true;
@@ -2077,9 +2356,12 @@ inline bool get_partition_stats(shell_context *sc,
     CHECK_EQ(pcs.size(), partition_count);
 
     const auto &query_string = row_data_filters(table_id).to_query_string();
+    const auto &latency_query_string = row_latency_filters(table_id).to_query_string();
     const auto &results_start = get_metrics(nodes, query_string);
+    const auto &latency_results_start = get_metrics(nodes, latency_query_string);
     std::this_thread::sleep_for(std::chrono::milliseconds(sample_interval_ms));
     const auto &results_end = get_metrics(nodes, query_string);
+    const auto &latency_results_end = get_metrics(nodes, latency_query_string);
 
     rows.clear();
     rows.reserve(partition_count);
@@ -2100,6 +2382,24 @@ inline bool get_partition_stats(shell_context *sc,
             nodes[i],
             "aggregate row data requests for table(id={})",
             table_id);
+
+        RETURN_SHELL_IF_GET_METRICS_FAILED(latency_results_start[i],
+                                           nodes[i],
+                                           "starting row latency requests for table(id={})",
+                                           table_id);
+        RETURN_SHELL_IF_GET_METRICS_FAILED(latency_results_end[i],
+                                           nodes[i],
+                                           "ending row latency requests for table(id={})",
+                                           table_id);
+
+        RETURN_SHELL_IF_PARSE_METRICS_FAILED(
+            aggregate_latency_buckets(
+                latency_results_start[i].body(),
+                latency_results_end[i].body(),
+                create_partition_latency_row_selector(table_id, pcs, nodes[i].hp, rows)),
+            nodes[i],
+            "aggregate row latency requests for table(id={})",
+            table_id);
     }
 
     return true;
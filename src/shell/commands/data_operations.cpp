@@ -52,6 +52,7 @@
 #include "pegasus_utils.h"
 #include "rpc/rpc_host_port.h"
 #include "rrdb/rrdb_types.h"
+#include "scan_aggregator.h"
 #include "shell/args.h"
 #include "shell/command_executor.h"
 #include "shell/command_helper.h"
@@ -67,6 +68,7 @@
 #include "utils/metrics.h"
 #include "utils/output_utils.h"
 #include "utils/string_conv.h"
+#include "utils/time_utils.h"
 
 DSN_DEFINE_int32(threadpool.THREAD_POOL_DEFAULT,
                  worker_count,
@@ -78,7 +80,8 @@ print_current_scan_state(const std::vector<std::unique_ptr<scan_data_context>> &
                          const std::string &stop_desc,
                          bool stat_size,
                          std::shared_ptr<rocksdb::Statistics> statistics,
-                         bool count_hash_key);
+                         bool count_hash_key,
+                         bool aggregated);
 
 void escape_sds_argv(int argc, sds *argv);
 int mutation_check(int args_count, sds *args);
@@ -2536,10 +2539,15 @@ bool count_data(command_executor *e, shell_context *sc, arguments args)
 
     // Decide whether real data should be returned to client. Once the real data is
     // decided not to be returned to client side: option `only_return_count` will be
-    // used.
-    if (diff_hash_key || stat_size || value_filter_type != pegasus::pegasus_client::FT_NO_FILTER ||
-        sort_key_filter_type == pegasus::pegasus_client::FT_MATCH_EXACT) {
+    // used, or option `return_aggregation` will be used if the hash keys or the sizes
+    // are needed to be counted, which are computed on the server side then.
+    if (value_filter_type != pegasus::pegasus_client::FT_NO_FILTER ||
+        sort_key_filter_type == pegasus::pegasus_client::FT_MATCH_EXACT ||
+        (stat_size && top_count > 0)) {
         options.only_return_count = false;
+    } else if (diff_hash_key || stat_size) {
+        options.return_aggregation = true;
+        fprintf(stderr, "INFO: scanner only return aggregation, not return value\n");
     } else {
         options.only_return_count = true;
         fprintf(stderr, "INFO: scanner only return kv count, not return value\n");
@@ -2649,7 +2657,12 @@ bool count_data(command_executor *e, shell_context *sc, arguments args)
             break;
         last_total_rows = cur_total_rows;
         if (stat_size && sleep_seconds % 10 == 0) {
-            print_current_scan_state(contexts, "partially", stat_size, statistics, diff_hash_key);
+            print_current_scan_state(contexts,
+                                     "partially",
+                                     stat_size,
+                                     statistics,
+                                     diff_hash_key,
+                                     options.return_aggregation);
         }
     }
 
@@ -2672,7 +2685,8 @@ bool count_data(command_executor *e, shell_context *sc, arguments args)
         stop_desc = "done";
     }
 
-    print_current_scan_state(contexts, stop_desc, stat_size, statistics, diff_hash_key);
+    print_current_scan_state(
+        contexts, stop_desc, stat_size, statistics, diff_hash_key, options.return_aggregation);
 
     if (stat_size) {
         if (top_count > 0) {
@@ -2800,12 +2814,96 @@ int mutation_check(int args_count, sds *args)
     return ret;
 }
 
+// Merge the aggregations of all the scanners, return false if any of them is not supported.
+static bool merge_scan_aggregation(const std::vector<std::unique_ptr<scan_data_context>> &contexts,
+                                   dsn::apps::scan_aggregation &total)
+{
+    for (const auto &context : contexts) {
+        pegasus::pegasus_client::scan_aggregation aggregation;
+        int ret = context->scanner->get_aggregation(aggregation);
+        if (ret != pegasus::PERR_OK) {
+            fprintf(stderr,
+                    "ERROR: split[%d] get aggregation failed: %s\n",
+                    context->split_id,
+                    context->client->get_error_string(ret));
+            return false;
+        }
+
+        dsn::apps::scan_aggregation split_aggregation;
+        pegasus::scan_aggregation_from_client(aggregation, split_aggregation);
+        pegasus::scan_aggregation_merge(split_aggregation, total);
+    }
+    return true;
+}
+
+// Estimate the percentile by the linear interpolation in the bucket which it falls in.
+static double scan_size_percentile(const dsn::apps::scan_size_histogram &histogram, double p)
+{
+    double threshold = histogram.count * p / 100.0;
+    double cumulative = 0;
+    for (size_t i = 0; i < histogram.buckets.size(); ++i) {
+        if (histogram.buckets[i] == 0) {
+            continue;
+        }
+        double left = i == 0 ? 0 : static_cast<double>(1ULL << (i - 1));
+        double right = i == 0 ? 0 : static_cast<double>(1ULL << i);
+        if (cumulative + histogram.buckets[i] >= threshold) {
+            double r = left + (right - left) * (threshold - cumulative) / histogram.buckets[i];
+            return std::max(static_cast<double>(histogram.min),
+                            std::min(static_cast<double>(histogram.max), r));
+        }
+        cumulative += histogram.buckets[i];
+    }
+    return histogram.max;
+}
+
+static std::string
+scan_size_histogram_to_string(const dsn::apps::scan_size_histogram &histogram)
+{
+    std::string str;
+    if (histogram.count == 0) {
+        str = "Count: 0\n";
+        return str;
+    }
+
+    str += fmt::format("Count: {} Average: {:.4f}\n",
+                       histogram.count,
+                       static_cast<double>(histogram.sum) / histogram.count);
+    str += fmt::format("Min: {} Median: {:.4f} Max: {}\n",
+                       histogram.min,
+                       scan_size_percentile(histogram, 50),
+                       histogram.max);
+    str += fmt::format("Percentiles: P50: {:.2f} P75: {:.2f} P99: {:.2f} P99.9: {:.2f} "
+                       "P99.99: {:.2f}\n",
+                       scan_size_percentile(histogram, 50),
+                       scan_size_percentile(histogram, 75),
+                       scan_size_percentile(histogram, 99),
+                       scan_size_percentile(histogram, 99.9),
+                       scan_size_percentile(histogram, 99.99));
+    str += "------------------------------------------------------\n";
+    int64_t cumulative = 0;
+    for (size_t i = 0; i < histogram.buckets.size(); ++i) {
+        if (histogram.buckets[i] == 0) {
+            continue;
+        }
+        cumulative += histogram.buckets[i];
+        str += fmt::format("[ {:>10}, {:>10} ) {:>12} {:>7.3f}% {:>7.3f}%\n",
+                           i == 0 ? 0 : 1ULL << (i - 1),
+                           i == 0 ? 1 : 1ULL << i,
+                           histogram.buckets[i],
+                           100.0 * histogram.buckets[i] / histogram.count,
+                           100.0 * cumulative / histogram.count);
+    }
+    return str;
+}
+
 static void
 print_current_scan_state(const std::vector<std::unique_ptr<scan_data_context>> &contexts,
                          const std::string &stop_desc,
                          bool stat_size,
                          std::shared_ptr<rocksdb::Statistics> statistics,
-                         bool count_hash_key)
+                         bool count_hash_key,
+                         bool aggregated)
 {
     long total_rows = 0;
     long total_hash_key_count = 0;
@@ -2828,28 +2926,66 @@ print_current_scan_state(const std::vector<std::unique_ptr<scan_data_context>> &
         fprintf(stderr, "\n");
     }
 
-    if (stat_size) {
-        fprintf(stderr,
-                "\n============================[hash_key_size]============================\n"
-                "%s=======================================================================",
-                statistics->getHistogramString(static_cast<uint32_t>(histogram_type::HASH_KEY_SIZE))
-                    .c_str());
-        fprintf(stderr,
-                "\n============================[sort_key_size]============================\n"
-                "%s=======================================================================",
-                statistics->getHistogramString(static_cast<uint32_t>(histogram_type::SORT_KEY_SIZE))
-                    .c_str());
-        fprintf(stderr,
-                "\n==============================[value_size]=============================\n"
-                "%s=======================================================================",
-                statistics->getHistogramString(static_cast<uint32_t>(histogram_type::VALUE_SIZE))
-                    .c_str());
-        fprintf(stderr,
-                "\n===============================[row_size]==============================\n"
-                "%s=======================================================================\n\n",
-                statistics->getHistogramString(static_cast<uint32_t>(histogram_type::ROW_SIZE))
-                    .c_str());
+    if (!stat_size) {
+        return;
+    }
+
+    std::string hash_key_size_str;
+    std::string sort_key_size_str;
+    std::string value_size_str;
+    std::string row_size_str;
+    if (aggregated) {
+        dsn::apps::scan_aggregation aggregation;
+        if (!merge_scan_aggregation(contexts, aggregation)) {
+            return;
+        }
+        hash_key_size_str = scan_size_histogram_to_string(aggregation.hash_key_size);
+        sort_key_size_str = scan_size_histogram_to_string(aggregation.sort_key_size);
+        value_size_str = scan_size_histogram_to_string(aggregation.value_size);
+        row_size_str = scan_size_histogram_to_string(aggregation.row_size);
+
+        fprintf(stderr, "INFO: %ld rows with TTL", aggregation.ttl_kv_count);
+        if (aggregation.ttl_kv_count > 0) {
+            // expire_ts is unsigned in fact, though it's i32 in thrift.
+            fprintf(stderr,
+                    ", expire time in [%s, %s]",
+                    dsn::utils::time_s_to_date_time(
+                        pegasus::utils::epoch_begin +
+                        static_cast<uint32_t>(aggregation.min_expire_ts))
+                        .c_str(),
+                    dsn::utils::time_s_to_date_time(
+                        pegasus::utils::epoch_begin +
+                        static_cast<uint32_t>(aggregation.max_expire_ts))
+                        .c_str());
+        }
+        fprintf(stderr, "\n");
+    } else {
+        hash_key_size_str =
+            statistics->getHistogramString(static_cast<uint32_t>(histogram_type::HASH_KEY_SIZE));
+        sort_key_size_str =
+            statistics->getHistogramString(static_cast<uint32_t>(histogram_type::SORT_KEY_SIZE));
+        value_size_str =
+            statistics->getHistogramString(static_cast<uint32_t>(histogram_type::VALUE_SIZE));
+        row_size_str =
+            statistics->getHistogramString(static_cast<uint32_t>(histogram_type::ROW_SIZE));
     }
+
+    fprintf(stderr,
+            "\n============================[hash_key_size]============================\n"
+            "%s=======================================================================",
+            hash_key_size_str.c_str());
+    fprintf(stderr,
+            "\n============================[sort_key_size]============================\n"
+            "%s=======================================================================",
+            sort_key_size_str.c_str());
+    fprintf(stderr,
+            "\n==============================[value_size]=============================\n"
+            "%s=======================================================================",
+            value_size_str.c_str());
+    fprintf(stderr,
+            "\n===============================[row_size]==============================\n"
+            "%s=======================================================================\n\n",
+            row_size_str.c_str());
 }
 
 bool calculate_hash_value(command_executor *e, shell_context *sc, arguments args)
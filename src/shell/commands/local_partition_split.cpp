@@ -42,7 +42,7 @@
 
 #include "base/meta_store.h"
 #include "base/pegasus_key_schema.h"
-#include "base/value_schema_manager.h"
+#include "base/pegasus_utils.h"
 #include "client/partition_resolver.h"
 #include "client/replication_ddl_client.h"
 #include "common/gpid.h"
@@ -240,10 +240,11 @@ bool split_file(const LocalPartitionSplitContext &lpsc,
         const auto &svalue = iter->value();
         // Skip empty write, see:
         // https://pegasus.apache.org/zh/2018/03/07/last_flushed_decree.html.
-        if (skey.empty() && pegasus::value_schema_manager::instance()
-                                .get_value_schema(pegasus_data_version)
-                                ->extract_user_data(svalue.ToString())
-                                .empty()) {
+        if (skey.empty() &&
+            pegasus::visit_value_view(pegasus_data_version,
+                                      pegasus::utils::to_string_view(svalue),
+                                      [](auto view) { return view.user_data(); })
+                .empty()) {
             continue;
         }
 
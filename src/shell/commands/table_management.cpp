@@ -565,6 +565,7 @@ bool app_stat(command_executor *, shell_context *sc, arguments args)
         sum.rdb_bf_point_positive_true += row.rdb_bf_point_positive_true;
         sum.rdb_bf_point_positive_total += row.rdb_bf_point_positive_total;
         sum.rdb_bf_point_negatives += row.rdb_bf_point_negatives;
+        sum.aggregate_latencies(row.latency_buckets);
     }
 
     std::streambuf *buf;
@@ -603,6 +604,11 @@ bool app_stat(command_executor *, shell_context *sc, arguments args)
         tp.add_column("abnormal", tp_alignment::kRight);
         tp.add_column("delay", tp_alignment::kRight);
         tp.add_column("reject", tp_alignment::kRight);
+        tp.add_column("get_p99(ms)", tp_alignment::kRight);
+        tp.add_column("mget_p99(ms)", tp_alignment::kRight);
+        tp.add_column("bget_p99(ms)", tp_alignment::kRight);
+        tp.add_column("put_p99(ms)", tp_alignment::kRight);
+        tp.add_column("mput_p99(ms)", tp_alignment::kRight);
     }
     if (!only_qps) {
         tp.add_column("file_mb", tp_alignment::kRight);
@@ -640,6 +646,14 @@ bool app_stat(command_executor *, shell_context *sc, arguments args)
             tp.append_data(row.recent_abnormal_count);
             tp.append_data(row.recent_write_throttling_delay_count);
             tp.append_data(row.recent_write_throttling_reject_count);
+            for (const auto &metric_name : {"get_latency_ns",
+                                            "multi_get_latency_ns",
+                                            "batch_get_latency_ns",
+                                            "put_latency_ns",
+                                            "multi_put_latency_ns"}) {
+                tp.append_data(
+                    row.get_latency_percentile(metric_name, dsn::kth_percentile_type::P99) / 1e6);
+            }
         }
         if (!only_qps) {
             tp.append_data(row.storage_mb);
@@ -29,6 +29,7 @@
 // IWYU pragma: no_include <ext/alloc_traits.h>
 #include <limits.h>
 #include <mutex>
+#include <string>
 
 #include "fmt/core.h"
 #include "nlohmann/json.hpp"
@@ -51,6 +52,10 @@ using dsn::utils::factory_store;
 
 namespace dsn {
 
+namespace {
+const std::string kWorkStealingTaskQueueFactoryName("dsn::tools::work_stealing_task_queue");
+} // anonymous namespace
+
 task_worker_pool::task_worker_pool(const threadpool_spec &opts, task_engine *owner)
     : _spec(opts), _owner(owner), _node(owner->node()), _is_running(false)
 {
@@ -61,10 +66,15 @@ void task_worker_pool::create()
     if (_is_running)
         return;
 
-    int qCount = _spec.partitioned ? _spec.worker_count : 1;
+    // In work-stealing mode, all the workers share a single queue which keeps the tasks of the
+    // same hash executed serially by itself.
+    const bool work_stealing = _spec.partitioned && _spec.work_stealing;
+    int qCount = (_spec.partitioned && !work_stealing) ? _spec.worker_count : 1;
+    const std::string &queue_factory_name =
+        work_stealing ? kWorkStealingTaskQueueFactoryName : _spec.queue_factory_name;
     for (int i = 0; i < qCount; i++) {
         auto q = factory_store<task_queue>::create(
-            _spec.queue_factory_name.c_str(), PROVIDER_TYPE_MAIN, this, i, nullptr);
+            queue_factory_name.c_str(), PROVIDER_TYPE_MAIN, this, i, nullptr);
         for (auto it = _spec.queue_aspects.begin(); it != _spec.queue_aspects.end(); ++it) {
             q = factory_store<task_queue>::create(it->c_str(), PROVIDER_TYPE_ASPECT, this, i, q);
         }
@@ -108,13 +118,14 @@ void task_worker_pool::start()
 
     LOG_INFO(
         "[{}]: thread pool [{}] started, pool_code = {}, worker_count = {}, worker_share_core = "
-        "{}, partitioned = {}, ...",
+        "{}, partitioned = {}, work_stealing = {}, ...",
         _node->full_name(),
         _spec.name,
         _spec.pool_code,
         _spec.worker_count,
         _spec.worker_share_core ? "true" : "false",
-        _spec.partitioned ? "true" : "false");
+        _spec.partitioned ? "true" : "false",
+        _spec.partitioned && _spec.work_stealing ? "true" : "false");
 
     _is_running = true;
 }
@@ -172,7 +183,7 @@ bool task_worker_pool::shared_same_worker_with_current_task(task *tsk) const
             return false;
         else if (_workers.size() == 1)
             return true;
-        else if (_spec.partitioned) {
+        else if (_spec.partitioned && !_spec.work_stealing) {
             unsigned int sz = static_cast<unsigned int>(_workers.size());
             return static_cast<unsigned int>(current->hash()) % sz ==
                    static_cast<unsigned int>(tsk->hash()) % sz;
@@ -283,7 +294,9 @@ void task_engine::stop()
 volatile int *task_engine::get_task_queue_virtual_length_ptr(dsn::task_code code, int hash)
 {
     auto pl = get_pool(task_spec::get(code)->pool_code);
-    auto idx = (pl->spec().partitioned ? hash % pl->spec().worker_count : 0);
+    auto idx = (pl->spec().partitioned ? static_cast<unsigned int>(hash) %
+                                             static_cast<unsigned int>(pl->queues().size())
+                                       : 0);
     return pl->queues()[idx]->get_virtual_length_ptr();
 }
 
@@ -0,0 +1,201 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "runtime/service_engine.h"
+#include "task/async_calls.h"
+#include "task/task.h"
+#include "task/task_code.h"
+#include "task/task_engine.h"
+#include "task/task_tracker.h"
+#include "task/work_stealing_task_queue.h"
+#include "utils/autoref_ptr.h"
+#include "utils/thread_access_checker.h"
+#include "utils/threadpool_code.h"
+
+namespace dsn {
+
+DEFINE_THREAD_POOL_CODE(THREAD_POOL_FOR_TEST_3)
+DEFINE_TASK_CODE(LPC_WORK_STEALING_TEST, TASK_PRIORITY_COMMON, THREAD_POOL_FOR_TEST_3)
+
+class work_stealing_task_queue_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (service_engine::instance().spec().tool == "simulator") {
+            GTEST_SKIP() << "Skip the test in simulator mode, which schedules the tasks by itself.";
+        }
+    }
+
+    using mailbox = tools::work_stealing_task_queue::mailbox;
+
+    static void wait_ready(tools::work_stealing_task_queue &q) { q._ready_mailboxes.wait(); }
+
+    static mailbox *pop_ready(tools::work_stealing_task_queue &q, int worker_index)
+    {
+        return q.pop_ready(worker_index, false);
+    }
+
+    static mailbox *pop_any_ready(tools::work_stealing_task_queue &q, int worker_index)
+    {
+        return q.pop_any_ready(worker_index);
+    }
+
+    static const mailbox *mailbox_of(tools::work_stealing_task_queue &q, int hash)
+    {
+        return q._mailboxes[hash % q._mailboxes.size()].get();
+    }
+
+    task_tracker _tracker;
+};
+
+TEST_F(work_stealing_task_queue_test, single_shared_queue)
+{
+    auto *pool = task::get_current_node2()->computation()->get_pool(THREAD_POOL_FOR_TEST_3);
+    ASSERT_NE(nullptr, pool);
+    ASSERT_TRUE(pool->spec().partitioned);
+    ASSERT_TRUE(pool->spec().work_stealing);
+    ASSERT_EQ(1u, pool->queues().size());
+    ASSERT_EQ(2u, pool->workers().size());
+}
+
+TEST_F(work_stealing_task_queue_test, serial_per_hash)
+{
+    const int kHashCount = 4;
+    const int kTasksPerHash = 1000;
+
+    struct hash_state
+    {
+        std::atomic<bool> running{false};
+        std::vector<int> executed;
+        thread_access_checker checker;
+    } states[kHashCount];
+
+    std::atomic<int> concurrent_executions(0);
+    for (int i = 0; i < kTasksPerHash; ++i) {
+        for (int h = 0; h < kHashCount; ++h) {
+            auto &state = states[h];
+            tasking::enqueue(LPC_WORK_STEALING_TEST,
+                             &_tracker,
+                             [&state, &concurrent_executions, i]() {
+                                 if (state.running.exchange(true)) {
+                                     ++concurrent_executions;
+                                 }
+                                 // Would fail if the checker was not relaxed for the workers.
+                                 state.checker.only_one_thread_access();
+                                 state.executed.push_back(i);
+                                 state.running.store(false);
+                             },
+                             h);
+        }
+    }
+    _tracker.wait_outstanding_tasks();
+
+    ASSERT_EQ(0, concurrent_executions.load());
+    for (const auto &state : states) {
+        ASSERT_EQ(kTasksPerHash, static_cast<int>(state.executed.size()));
+        for (int i = 0; i < kTasksPerHash; ++i) {
+            ASSERT_EQ(i, state.executed[i]);
+        }
+    }
+}
+
+TEST_F(work_stealing_task_queue_test, steal_from_busy_worker)
+{
+    // Both hash 0 and hash 2 are bound to worker 0 in partitioned pools, thus the tasks of
+    // hash 2 could only be executed after the blocking task of hash 0 without stealing.
+    std::promise<void> unblock;
+    auto unblocked = unblock.get_future();
+    std::atomic<int> blocking_worker(-1);
+    auto blocking_task = tasking::enqueue(LPC_WORK_STEALING_TEST, &_tracker, [&]() {
+        blocking_worker.store(task::get_current_worker_index());
+        unblocked.wait_for(std::chrono::seconds(30));
+    });
+    while (blocking_worker.load() < 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::vector<int> workers;
+    task_ptr last_task;
+    for (int i = 0; i < 10; ++i) {
+        last_task = tasking::enqueue(LPC_WORK_STEALING_TEST,
+                                     &_tracker,
+                                     [&workers]() {
+                                         workers.push_back(task::get_current_worker_index());
+                                     },
+                                     2);
+    }
+
+    ASSERT_TRUE(last_task->wait(10000));
+    ASSERT_FALSE(blocking_task->wait(0));
+    ASSERT_EQ(10u, workers.size());
+    for (int worker : workers) {
+        ASSERT_NE(blocking_worker.load(), worker);
+    }
+
+    unblock.set_value();
+    _tracker.wait_outstanding_tasks();
+}
+
+TEST_F(work_stealing_task_queue_test, pop_own_ready_after_signal_taken)
+{
+    auto *pool = task::get_current_node2()->computation()->get_pool(THREAD_POOL_FOR_TEST_3);
+    ASSERT_NE(nullptr, pool);
+    ASSERT_EQ(2, pool->spec().worker_count);
+
+    // A standalone queue which is not dequeued by the workers of the pool, so that the
+    // interleaving of the 2 workers could be driven step by step. The tasks of hash 0 and 1
+    // are put to the ready lists of worker 0 and 1 respectively.
+    tools::work_stealing_task_queue q(pool, 1000, nullptr);
+    auto task0 = tasking::create_task(LPC_WORK_STEALING_TEST, nullptr, []() {}, 0);
+    auto task1 = tasking::create_task(LPC_WORK_STEALING_TEST, nullptr, []() {}, 1);
+
+    // Worker 0 is woken for the mailbox in the ready list of worker 1, while its own ready
+    // list is empty.
+    q.enqueue(task1.get());
+    wait_ready(q);
+    ASSERT_EQ(nullptr, pop_ready(q, 0));
+
+    // Then a mailbox is pushed to the ready list of worker 0, whose signal wakes worker 1,
+    // and worker 1 takes the mailbox in its own ready list.
+    q.enqueue(task0.get());
+    wait_ready(q);
+    ASSERT_EQ(mailbox_of(q, 1), pop_ready(q, 1));
+
+    // Worker 0 must find the mailbox left in its own ready list rather than spinning on the
+    // empty ready lists of the others.
+    auto popped = std::async(std::launch::async, [&q]() { return pop_any_ready(q, 0); });
+    if (popped.wait_for(std::chrono::seconds(10)) != std::future_status::ready) {
+        // Release the spinning worker before failing.
+        auto task3 = tasking::create_task(LPC_WORK_STEALING_TEST, nullptr, []() {}, 1);
+        q.enqueue(task3.get());
+        popped.wait();
+        FAIL() << "worker 0 did not pop the mailbox in its own ready list";
+    }
+    ASSERT_EQ(mailbox_of(q, 0), popped.get());
+}
+
+} // namespace dsn
@@ -0,0 +1,223 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "work_stealing_task_queue.h"
+
+#include "runtime/api_layer1.h"
+#include "task.h"
+#include "task_engine.h"
+#include "task_spec.h"
+#include "utils/fmt_logging.h"
+#include "utils/thread_access_checker.h"
+#include "utils/threadpool_spec.h"
+
+METRIC_DEFINE_histogram_int64(queue,
+                              queue_wait_latency_ns,
+                              dsn::metric_unit::kNanoSeconds,
+                              "The histogram of the latency it takes for each task to wait in the "
+                              "queue before being dequeued by a worker");
+
+METRIC_DEFINE_counter(queue,
+                      queue_stolen_tasks,
+                      dsn::metric_unit::kTasks,
+                      "The accumulative number of tasks executed by the workers other than "
+                      "their home workers");
+
+namespace dsn {
+namespace tools {
+
+namespace {
+
+// Using more mailboxes than workers makes stealing finer-grained: the hashes sharing a
+// worker in partitioned pools would not be stolen all together.
+const int kMailboxesPerWorker = 8;
+
+} // anonymous namespace
+
+work_stealing_task_queue::work_stealing_task_queue(task_worker_pool *pool,
+                                                   int index,
+                                                   task_queue *inner_provider)
+    : task_queue(pool, index, inner_provider),
+      _worker_count(pool->spec().worker_count),
+      METRIC_VAR_INIT_queue(queue_wait_latency_ns),
+      METRIC_VAR_INIT_queue(queue_stolen_tasks)
+{
+    CHECK_GT(_worker_count, 0);
+
+    // The home worker of a mailbox is just the worker that the tasks of its hashes would be
+    // bound to in partitioned pools, since `hash % (k * n) % n == hash % n`.
+    _mailboxes.reserve(_worker_count * kMailboxesPerWorker);
+    for (int i = 0; i < _worker_count * kMailboxesPerWorker; ++i) {
+        _mailboxes.emplace_back(std::make_unique<mailbox>());
+        _mailboxes.back()->home = i % _worker_count;
+    }
+
+    _slots.reserve(_worker_count);
+    for (int i = 0; i < _worker_count; ++i) {
+        _slots.emplace_back(std::make_unique<worker_slot>());
+    }
+}
+
+void work_stealing_task_queue::enqueue(task *task)
+{
+    auto &mb = *_mailboxes[static_cast<unsigned int>(task->hash()) % _mailboxes.size()];
+
+    bool need_schedule = false;
+    {
+        std::lock_guard<std::mutex> l(mb.mtx);
+        mb.tasks[task->spec().priority].emplace_back(task, dsn_now_ns());
+        need_schedule = !mb.scheduled;
+        mb.scheduled = true;
+    }
+
+    if (need_schedule) {
+        push_ready(&mb);
+    }
+}
+
+task *work_stealing_task_queue::dequeue(/*inout*/ int &batch_size)
+{
+    const int worker_index = task::get_current_worker_index();
+    CHECK(worker_index >= 0 && worker_index < _worker_count,
+          "{} should be dequeued by the workers of the pool, while current worker index is {}",
+          get_name(),
+          worker_index);
+
+    // The tasks of the same hash are executed serially, though maybe by different threads.
+    thread_access_checker::set_serialized_by_scheduler(true);
+
+    // All the tasks dequeued last time have been executed, thus the next tasks of the owned
+    // mailbox could be dequeued by any worker.
+    release_owned(worker_index);
+
+    _ready_mailboxes.wait();
+    mailbox *mb = pop_any_ready(worker_index);
+
+    task *head = nullptr;
+    task *last = nullptr;
+    int count = 0;
+    const uint64_t now_ns = dsn_now_ns();
+    {
+        std::lock_guard<std::mutex> l(mb->mtx);
+        for (int p = TASK_PRIORITY_COUNT - 1; p >= 0 && count < batch_size; --p) {
+            auto &tasks = mb->tasks[p];
+            while (!tasks.empty() && count < batch_size) {
+                task *t = tasks.front().first;
+                METRIC_VAR_SET(queue_wait_latency_ns,
+                               static_cast<int64_t>(now_ns - tasks.front().second));
+                tasks.pop_front();
+
+                t->next = nullptr;
+                if (last != nullptr) {
+                    last->next = t;
+                } else {
+                    head = t;
+                }
+                last = t;
+                ++count;
+            }
+        }
+    }
+    CHECK_GT_MSG(count, 0, "a ready mailbox of {} should not be empty", get_name());
+
+    if (mb->home != worker_index) {
+        METRIC_VAR_INCREMENT_BY(queue_stolen_tasks, count);
+    }
+
+    _slots[worker_index]->owned = mb;
+    batch_size = count;
+    return head;
+}
+
+void work_stealing_task_queue::push_ready(mailbox *mb)
+{
+    auto &slot = *_slots[mb->home];
+    {
+        std::lock_guard<std::mutex> l(slot.mtx);
+        slot.ready.push_back(mb);
+    }
+    _ready_mailboxes.signal();
+}
+
+work_stealing_task_queue::mailbox *work_stealing_task_queue::pop_ready(int worker_index,
+                                                                       bool stealing)
+{
+    auto &slot = *_slots[worker_index];
+    std::lock_guard<std::mutex> l(slot.mtx);
+    if (slot.ready.empty()) {
+        return nullptr;
+    }
+
+    // Steal from the tail, which is the least likely to be dequeued soon by the owner.
+    mailbox *mb = nullptr;
+    if (stealing) {
+        mb = slot.ready.back();
+        slot.ready.pop_back();
+    } else {
+        mb = slot.ready.front();
+        slot.ready.pop_front();
+    }
+    return mb;
+}
+
+work_stealing_task_queue::mailbox *work_stealing_task_queue::pop_any_ready(int worker_index)
+{
+    // The mailbox must be found in some ready list since it is pushed before signaled, though
+    // a few rounds may be needed if the other workers are popping meanwhile. Each round must
+    // check the own ready list as well: the mailbox signaled for this worker may have been
+    // taken by another one, while the mailbox left for this worker was pushed to its own list.
+    while (true) {
+        for (int i = 0; i < _worker_count; ++i) {
+            mailbox *mb = pop_ready((worker_index + i) % _worker_count, i != 0);
+            if (mb != nullptr) {
+                return mb;
+            }
+        }
+    }
+}
+
+void work_stealing_task_queue::release_owned(int worker_index)
+{
+    auto &slot = *_slots[worker_index];
+    mailbox *mb = slot.owned;
+    if (mb == nullptr) {
+        return;
+    }
+    slot.owned = nullptr;
+
+    bool need_schedule = false;
+    {
+        std::lock_guard<std::mutex> l(mb->mtx);
+        for (const auto &tasks : mb->tasks) {
+            if (!tasks.empty()) {
+                need_schedule = true;
+                break;
+            }
+        }
+        mb->scheduled = need_schedule;
+    }
+
+    // Put it to the tail so that the other mailboxes are not starved.
+    if (need_schedule) {
+        push_ready(mb);
+    }
+}
+
+} // namespace tools
+} // namespace dsn
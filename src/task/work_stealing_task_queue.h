@@ -0,0 +1,104 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "concurrentqueue/lightweightsemaphore.h"
+#include "task_code.h"
+#include "task_queue.h"
+#include "utils/metrics.h"
+
+namespace dsn {
+class task;
+class task_worker_pool;
+class work_stealing_task_queue_test;
+
+namespace tools {
+
+// The task queue shared by all the workers of a partitioned pool with work stealing enabled
+// (see threadpool_spec::work_stealing). As the partitioned pools do, the tasks of the same
+// hash are executed serially; however, an idle worker could steal the tasks of other hashes
+// from a busy worker rather than staying idle while a hot partition saturates its thread.
+//
+// The tasks are put into the mailboxes by their hashes, and each mailbox has a home worker
+// of `hash % worker_count`, just the worker the tasks would be bound to in partitioned pools.
+// A mailbox which has tasks is put into the ready list of its home worker, and is owned by
+// at most one worker at a time until that worker dequeues again, i.e. until all the tasks it
+// has dequeued from the mailbox are executed. A worker dequeues from its own ready list first,
+// otherwise it steals a whole mailbox from the tail of the ready list of another worker.
+class work_stealing_task_queue : public task_queue
+{
+public:
+    work_stealing_task_queue(task_worker_pool *pool, int index, task_queue *inner_provider);
+
+    ~work_stealing_task_queue() override = default;
+
+    void enqueue(task *task) override;
+
+    // Must be called by the workers of the pool, since the mailbox owned by the calling
+    // worker is released here.
+    task *dequeue(/*inout*/ int &batch_size) override;
+
+private:
+    struct mailbox
+    {
+        std::mutex mtx;
+        // The tasks along with the time (in nanoseconds) when they are enqueued.
+        std::deque<std::pair<task *, uint64_t>> tasks[TASK_PRIORITY_COUNT];
+        // Whether the mailbox is in a ready list or owned by a worker.
+        bool scheduled = false;
+        int home = 0;
+    };
+
+    struct worker_slot
+    {
+        std::mutex mtx;
+        std::deque<mailbox *> ready;
+        // Only accessed by the worker itself.
+        mailbox *owned = nullptr;
+    };
+
+    void push_ready(mailbox *mb);
+    mailbox *pop_ready(int worker_index, bool stealing);
+    // Pop a mailbox from the own ready list first, otherwise steal one from the others, after
+    // a ready mailbox has been acquired from `_ready_mailboxes`.
+    mailbox *pop_any_ready(int worker_index);
+    void release_owned(int worker_index);
+
+    friend class ::dsn::work_stealing_task_queue_test;
+
+    const int _worker_count;
+    std::vector<std::unique_ptr<mailbox>> _mailboxes;
+    std::vector<std::unique_ptr<worker_slot>> _slots;
+    // The number of the mailboxes in all the ready lists.
+    moodycamel::LightweightSemaphore _ready_mailboxes;
+
+    METRIC_VAR_DECLARE_histogram_int64(queue_wait_latency_ns);
+    METRIC_VAR_DECLARE_counter(queue_stolen_tasks);
+};
+
+} // namespace tools
+} // namespace dsn
@@ -28,6 +28,7 @@
 #include <map>
 #include <set>
 #include <sstream>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -36,6 +37,7 @@
 #include "runtime/app_model.h"
 #include "test/bench_test/config.h"
 #include "test/bench_test/statistics.h"
+#include "test/bench_test/workload.h"
 #include "utils/flags.h"
 #include "utils/fmt_logging.h"
 #include "utils/strings.h"
@@ -63,7 +65,11 @@ DSN_DEFINE_string(
     "\treadrandom_pegasus       -- pegasus read N times in random order\n"
     "\tdeleterandom_pegasus     -- pegasus delete N keys in random order\n"
     "\tmultisetrandom_pegasus   -- pegasus write N random values with multi_count hash keys list\n"
-    "\tmultigetrandom_pegasus   -- pegasus read N random keys with multi_count hash list\n");
+    "\tmultigetrandom_pegasus   -- pegasus read N random keys with multi_count hash list\n"
+    "\tworkload_load:<name>     -- insert the records of the workload defined by the section\n"
+    "\t                            [pegasus.benchmark.workload.<name>]\n"
+    "\tworkload_run:<name>      -- run the operations of the workload defined by the section\n"
+    "\t                            [pegasus.benchmark.workload.<name>]\n");
 
 DSN_DEFINE_validator(benchmarks,
                      [](const char *value) -> bool { return !dsn::utils::is_empty(value); });
@@ -95,6 +101,11 @@ DSN_DEFINE_group_validator(multi_count, [](std::string &message) -> bool {
 namespace pegasus {
 namespace test {
 
+namespace {
+const std::string kWorkloadLoadPrefix("workload_load:");
+const std::string kWorkloadRunPrefix("workload_run:");
+} // anonymous namespace
+
 benchmark::benchmark()
 {
     _client =
@@ -118,6 +129,20 @@ void benchmark::run()
     std::stringstream benchmark_stream(FLAGS_benchmarks);
     std::string name;
     while (std::getline(benchmark_stream, name, ',')) {
+        // run the specified workload
+        if (name.compare(0, kWorkloadLoadPrefix.size(), kWorkloadLoadPrefix) == 0) {
+            workload_runner runner(
+                _client, workload_profile::load(name.substr(kWorkloadLoadPrefix.size())));
+            runner.load();
+            continue;
+        }
+        if (name.compare(0, kWorkloadRunPrefix.size(), kWorkloadRunPrefix) == 0) {
+            workload_runner runner(
+                _client, workload_profile::load(name.substr(kWorkloadRunPrefix.size())));
+            runner.run();
+            continue;
+        }
+
         // run the specified benchmark
         operation_type op_type = get_operation_type(name);
         run_benchmark(FLAGS_threads, op_type);
@@ -0,0 +1,238 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "hdr_histogram.h"
+
+#include <fmt/core.h>
+#include <algorithm>
+#include <cmath>
+
+#include "utils/fmt_logging.h"
+
+namespace pegasus {
+namespace test {
+
+hdr_histogram::hdr_histogram(int64_t highest_trackable_value, int significant_digits)
+    : _highest_trackable_value(highest_trackable_value)
+{
+    CHECK_GE(highest_trackable_value, 2);
+    CHECK(significant_digits >= 1 && significant_digits <= 5,
+          "significant_digits({}) should be in [1, 5]",
+          significant_digits);
+
+    // The values below `largest_value_with_single_unit_resolution` are counted one by one.
+    const auto largest_value_with_single_unit_resolution =
+        2 * static_cast<int64_t>(std::pow(10, significant_digits));
+    const auto sub_bucket_count_magnitude =
+        static_cast<int>(std::ceil(std::log2(largest_value_with_single_unit_resolution)));
+    _sub_bucket_half_count_magnitude = std::max(sub_bucket_count_magnitude, 1) - 1;
+    const int64_t sub_bucket_count = 1LL << (_sub_bucket_half_count_magnitude + 1);
+    _sub_bucket_half_count = sub_bucket_count / 2;
+    _sub_bucket_mask = sub_bucket_count - 1;
+
+    int64_t smallest_untrackable_value = sub_bucket_count;
+    _bucket_count = 1;
+    while (smallest_untrackable_value <= highest_trackable_value) {
+        if (smallest_untrackable_value > INT64_MAX / 2) {
+            ++_bucket_count;
+            break;
+        }
+        smallest_untrackable_value <<= 1;
+        ++_bucket_count;
+    }
+
+    _counts_len = static_cast<int>((_bucket_count + 1) * _sub_bucket_half_count);
+    _counts = std::make_unique<std::atomic<int64_t>[]>(_counts_len);
+    for (int i = 0; i < _counts_len; ++i) {
+        _counts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void hdr_histogram::record(int64_t value)
+{
+    value = std::min(std::max<int64_t>(value, 0), _highest_trackable_value);
+    _counts[counts_index_for(value)].fetch_add(1, std::memory_order_relaxed);
+    _total_count.fetch_add(1, std::memory_order_relaxed);
+
+    auto current = _min.load(std::memory_order_relaxed);
+    while (value < current &&
+           !_min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+    current = _max.load(std::memory_order_relaxed);
+    while (value > current &&
+           !_max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+int64_t hdr_histogram::total_count() const { return _total_count.load(std::memory_order_relaxed); }
+
+int64_t hdr_histogram::min() const { return total_count() == 0 ? 0 : _min.load(); }
+
+int64_t hdr_histogram::max() const { return _max.load(); }
+
+double hdr_histogram::mean() const
+{
+    const auto total = total_count();
+    if (total == 0) {
+        return 0;
+    }
+
+    double sum = 0;
+    for (int i = 0; i < _counts_len; ++i) {
+        const auto count = _counts[i].load(std::memory_order_relaxed);
+        if (count != 0) {
+            const auto value = value_from_index(i);
+            sum += count * (value + size_of_equivalent_range(value) / 2);
+        }
+    }
+    return sum / total;
+}
+
+double hdr_histogram::stddev() const
+{
+    const auto total = total_count();
+    if (total == 0) {
+        return 0;
+    }
+
+    const auto avg = mean();
+    double sum = 0;
+    for (int i = 0; i < _counts_len; ++i) {
+        const auto count = _counts[i].load(std::memory_order_relaxed);
+        if (count != 0) {
+            const auto value = value_from_index(i);
+            const auto deviation = value + size_of_equivalent_range(value) / 2 - avg;
+            sum += count * deviation * deviation;
+        }
+    }
+    return std::sqrt(sum / total);
+}
+
+int64_t hdr_histogram::value_at_percentile(double percentile) const
+{
+    const auto total = total_count();
+    if (total == 0) {
+        return 0;
+    }
+
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+    const auto count_at_percentile =
+        std::max<int64_t>(static_cast<int64_t>(percentile / 100 * total + 0.5), 1);
+    int64_t cumulative_count = 0;
+    for (int i = 0; i < _counts_len; ++i) {
+        cumulative_count += _counts[i].load(std::memory_order_relaxed);
+        if (cumulative_count >= count_at_percentile) {
+            return highest_equivalent_value(value_from_index(i));
+        }
+    }
+    return max();
+}
+
+void hdr_histogram::output_percentile_distribution(FILE *out,
+                                                   int ticks_per_half_distance,
+                                                   double value_scale) const
+{
+    fmt::print(out,
+               "{:>12} {:>14} {:>10} {:>14}\n\n",
+               "Value",
+               "Percentile",
+               "TotalCount",
+               "1/(1-Percentile)");
+
+    const auto total = total_count();
+    double percentile_to_iterate_to = 0;
+    int64_t cumulative_count = 0;
+    for (int i = 0; i < _counts_len && total > 0; ++i) {
+        const auto count = _counts[i].load(std::memory_order_relaxed);
+        if (count == 0) {
+            continue;
+        }
+        cumulative_count += count;
+        const auto value = highest_equivalent_value(value_from_index(i)) / value_scale;
+
+        // Each half of the distance to 100% is reported by `ticks_per_half_distance` lines.
+        while (cumulative_count * 100.0 / total >= percentile_to_iterate_to) {
+            fmt::print(out,
+                       "{:12.3f} {:2.12f} {:10d} {:14.2f}\n",
+                       value,
+                       percentile_to_iterate_to / 100,
+                       cumulative_count,
+                       1 / (1 - percentile_to_iterate_to / 100));
+            if (cumulative_count >= total) {
+                fmt::print(out, "{:12.3f} {:2.12f} {:10d}\n", value, 1.0, cumulative_count);
+                break;
+            }
+            const auto reporting_ticks =
+                ticks_per_half_distance *
+                std::pow(2,
+                         std::floor(std::log2(100 / (100 - percentile_to_iterate_to))) + 1);
+            percentile_to_iterate_to += 100 / reporting_ticks;
+        }
+    }
+
+    fmt::print(out,
+               "#[Mean    = {:12.3f}, StdDeviation   = {:12.3f}]\n",
+               mean() / value_scale,
+               stddev() / value_scale);
+    fmt::print(out,
+               "#[Max     = {:12.3f}, Total count    = {:12d}]\n",
+               max() / value_scale,
+               total);
+    fmt::print(out,
+               "#[Buckets = {:12d}, SubBuckets     = {:12d}]\n",
+               _bucket_count,
+               _sub_bucket_half_count * 2);
+}
+
+int hdr_histogram::counts_index_for(int64_t value) const
+{
+    // The index of the bucket is the magnitude of the value beyond the first bucket.
+    const int pow2_ceiling = 64 - __builtin_clzll(value | _sub_bucket_mask);
+    const int bucket_index = pow2_ceiling - (_sub_bucket_half_count_magnitude + 1);
+    const int64_t sub_bucket_index = value >> bucket_index;
+    return static_cast<int>(((bucket_index + 1) << _sub_bucket_half_count_magnitude) +
+                            (sub_bucket_index - _sub_bucket_half_count));
+}
+
+int64_t hdr_histogram::value_from_index(int index) const
+{
+    int bucket_index = (index >> _sub_bucket_half_count_magnitude) - 1;
+    int64_t sub_bucket_index = (index & (_sub_bucket_half_count - 1)) + _sub_bucket_half_count;
+    if (bucket_index < 0) {
+        sub_bucket_index -= _sub_bucket_half_count;
+        bucket_index = 0;
+    }
+    return sub_bucket_index << bucket_index;
+}
+
+int64_t hdr_histogram::size_of_equivalent_range(int64_t value) const
+{
+    const int pow2_ceiling = 64 - __builtin_clzll(value | _sub_bucket_mask);
+    const int bucket_index = pow2_ceiling - (_sub_bucket_half_count_magnitude + 1);
+    return 1LL << bucket_index;
+}
+
+int64_t hdr_histogram::highest_equivalent_value(int64_t value) const
+{
+    const auto size = size_of_equivalent_range(value);
+    return (value & ~(size - 1)) + size - 1;
+}
+
+} // namespace test
+} // namespace pegasus
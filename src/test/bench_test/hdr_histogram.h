@@ -0,0 +1,76 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <memory>
+
+namespace pegasus {
+namespace test {
+// A histogram of latencies in the layout of HdrHistogram: the values are counted in buckets
+// whose widths grow by powers of 2, each of which is split into the sub-buckets enough to keep
+// `significant_digits` decimal digits of precision, thus the percentiles are accurate in the
+// full range of the values no matter how long the tail is.
+//
+// Values could be recorded concurrently, e.g. by the callbacks of the async client calls.
+class hdr_histogram
+{
+public:
+    hdr_histogram(int64_t highest_trackable_value, int significant_digits);
+
+    // The values out of [0, highest_trackable_value] are clamped.
+    void record(int64_t value);
+
+    int64_t total_count() const;
+    int64_t min() const;
+    int64_t max() const;
+    double mean() const;
+    double stddev() const;
+    // The highest value that is equivalent to the value at `percentile` (0 ~ 100).
+    int64_t value_at_percentile(double percentile) const;
+
+    // Output the percentile distribution in the .hgrm format of HdrHistogram, which could be
+    // plotted by its tools. The values are divided by `value_scale`, e.g. 1000 to output the
+    // microseconds as milliseconds.
+    void output_percentile_distribution(FILE *out,
+                                        int ticks_per_half_distance,
+                                        double value_scale) const;
+
+private:
+    int counts_index_for(int64_t value) const;
+    int64_t value_from_index(int index) const;
+    int64_t highest_equivalent_value(int64_t value) const;
+    int64_t size_of_equivalent_range(int64_t value) const;
+
+    int64_t _highest_trackable_value;
+    int _sub_bucket_half_count_magnitude;
+    int64_t _sub_bucket_half_count;
+    int64_t _sub_bucket_mask;
+    int _bucket_count;
+    int _counts_len;
+    std::unique_ptr<std::atomic<int64_t>[]> _counts;
+    std::atomic<int64_t> _total_count{0};
+    std::atomic<int64_t> _min{INT64_MAX};
+    std::atomic<int64_t> _max{0};
+};
+} // namespace test
+} // namespace pegasus
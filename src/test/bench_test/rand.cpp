@@ -35,6 +35,8 @@ uint64_t next_u64()
         thread_local_rng);
 }
 
+double next_double() { return std::uniform_real_distribution<double>(0, 1)(thread_local_rng); }
+
 std::string generate_string(uint64_t len)
 {
     std::string key;
@@ -24,6 +24,8 @@ namespace test {
 // Reseeds the RNG of current thread.
 extern void reseed_thread_local_rng(uint64_t seed);
 extern uint64_t next_u64();
+// Returns a uniformly distributed number in [0, 1).
+extern double next_double();
 extern std::string generate_string(uint64_t len);
 } // namespace test
 } // namespace pegasus
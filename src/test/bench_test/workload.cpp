@@ -0,0 +1,636 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "workload.h"
+
+#include <fmt/core.h>
+#include <pegasus/error.h>
+#include <rocksdb/env.h>
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "pegasus/client.h"
+#include "rand.h"
+#include "runtime/app_model.h"
+#include "test/bench_test/config.h"
+#include "utils/config_api.h"
+#include "utils/filesystem.h"
+#include "utils/flags.h"
+#include "utils/fmt_logging.h"
+
+DSN_DECLARE_uint64(benchmark_num);
+DSN_DECLARE_uint64(benchmark_seed);
+DSN_DECLARE_int32(pegasus_timeout_ms);
+DSN_DECLARE_int32(threads);
+DSN_DECLARE_int32(value_size);
+
+DSN_DEFINE_string(pegasus.benchmark,
+                  hdr_histogram_dir,
+                  "",
+                  "The directory to output the latency percentile distribution of each type of "
+                  "the operations of the workloads in the .hgrm format of HdrHistogram, nothing "
+                  "is output if it is empty");
+DSN_DEFINE_int32(pegasus.benchmark,
+                 hdr_histogram_significant_digits,
+                 3,
+                 "The number of significant decimal digits of the latency histograms");
+DSN_DEFINE_validator(hdr_histogram_significant_digits,
+                     [](int32_t value) -> bool { return value >= 1 && value <= 5; });
+
+namespace pegasus {
+namespace test {
+
+namespace {
+
+// The latencies above 1 hour are clamped.
+const int64_t kHighestTrackableLatencyUs = 3600LL * 1000 * 1000;
+
+const char *const kWorkloadOpNames[kWorkloadOpCount] = {
+    "read", "update", "insert", "scan", "read_modify_write"};
+
+uint64_t fnv_hash64(uint64_t value)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (int i = 0; i < 8; ++i) {
+        hash ^= value & 0xFF;
+        hash *= 0x100000001B3ULL;
+        value >>= 8;
+    }
+    return hash;
+}
+
+class constant_generator : public number_generator
+{
+public:
+    explicit constant_generator(uint64_t value) : _value(value) {}
+    uint64_t next() override { return _value; }
+
+private:
+    const uint64_t _value;
+};
+
+// Generates the numbers in [min, max] uniformly.
+class uniform_generator : public number_generator
+{
+public:
+    uniform_generator(uint64_t min, uint64_t max) : _min(min), _count(max - min + 1) {}
+    uint64_t next() override { return _min + next_u64() % _count; }
+
+private:
+    const uint64_t _min;
+    const uint64_t _count;
+};
+
+// Generates the numbers in [min, max] by the zipfian distribution, where min is the most popular
+// one, by the algorithm from "Quickly Generating Billion-Record Synthetic Databases" by Gray et
+// al, the same as YCSB. It takes O(max - min) to compute zeta once constructed.
+class zipfian_generator : public number_generator
+{
+public:
+    zipfian_generator(uint64_t min, uint64_t max, double constant)
+        : _min(min), _count(max - min + 1), _theta(constant)
+    {
+        _zetan = 0;
+        for (uint64_t i = 1; i <= _count; ++i) {
+            _zetan += 1 / std::pow(static_cast<double>(i), _theta);
+        }
+        _alpha = 1 / (1 - _theta);
+        const auto zeta2 = 1 + std::pow(0.5, _theta);
+        _eta = (1 - std::pow(2.0 / _count, 1 - _theta)) / (1 - zeta2 / _zetan);
+    }
+
+    uint64_t next() override
+    {
+        const auto u = next_double();
+        const auto uz = u * _zetan;
+        if (uz < 1) {
+            return _min;
+        }
+        if (uz < 1 + std::pow(0.5, _theta)) {
+            return std::min(_min + 1, _min + _count - 1);
+        }
+        const auto rank =
+            static_cast<uint64_t>(_count * std::pow(_eta * u - _eta + 1, _alpha));
+        return _min + std::min(rank, _count - 1);
+    }
+
+private:
+    const uint64_t _min;
+    const uint64_t _count;
+    const double _theta;
+    double _zetan;
+    double _alpha;
+    double _eta;
+};
+
+// Chooses the ids of the records below `inserted`, which grows as the records are inserted.
+class key_chooser : public number_generator
+{
+public:
+    explicit key_chooser(const std::atomic<uint64_t> &inserted) : _inserted(inserted) {}
+
+protected:
+    uint64_t limit() const { return std::max<uint64_t>(_inserted.load(), 1); }
+
+private:
+    const std::atomic<uint64_t> &_inserted;
+};
+
+class uniform_key_chooser : public key_chooser
+{
+public:
+    using key_chooser::key_chooser;
+    uint64_t next() override { return next_u64() % limit(); }
+};
+
+// The popular records are scattered by hashing rather than clustered at the small ids, thus they
+// are spread over the partitions.
+class scrambled_zipfian_key_chooser : public key_chooser
+{
+public:
+    scrambled_zipfian_key_chooser(const std::atomic<uint64_t> &inserted,
+                                  uint64_t record_count,
+                                  double constant)
+        : key_chooser(inserted), _zipfian(0, std::max<uint64_t>(record_count, 1) - 1, constant)
+    {
+    }
+    uint64_t next() override { return fnv_hash64(_zipfian.next()) % limit(); }
+
+private:
+    zipfian_generator _zipfian;
+};
+
+// The recently inserted records are the most popular ones.
+class latest_key_chooser : public key_chooser
+{
+public:
+    latest_key_chooser(const std::atomic<uint64_t> &inserted,
+                       uint64_t record_count,
+                       double constant)
+        : key_chooser(inserted), _zipfian(0, std::max<uint64_t>(record_count, 1) - 1, constant)
+    {
+    }
+    uint64_t next() override
+    {
+        const auto max_id = limit() - 1;
+        return max_id - std::min(_zipfian.next(), max_id);
+    }
+
+private:
+    zipfian_generator _zipfian;
+};
+
+// `opn_fraction` of the operations are on the hot set, which is `data_fraction` of the records.
+class hotspot_key_chooser : public key_chooser
+{
+public:
+    hotspot_key_chooser(const std::atomic<uint64_t> &inserted,
+                        double data_fraction,
+                        double opn_fraction)
+        : key_chooser(inserted), _data_fraction(data_fraction), _opn_fraction(opn_fraction)
+    {
+    }
+
+    uint64_t next() override
+    {
+        const auto count = limit();
+        const auto hot_count =
+            std::min(std::max<uint64_t>(static_cast<uint64_t>(count * _data_fraction), 1), count);
+        if (hot_count == count || next_double() < _opn_fraction) {
+            return next_u64() % hot_count;
+        }
+        return hot_count + next_u64() % (count - hot_count);
+    }
+
+private:
+    const double _data_fraction;
+    const double _opn_fraction;
+};
+
+std::unique_ptr<number_generator>
+create_length_generator(const std::string &distribution, uint64_t min, uint64_t max)
+{
+    if (distribution == "constant") {
+        return std::make_unique<constant_generator>(max);
+    }
+    if (distribution == "uniform") {
+        return std::make_unique<uniform_generator>(min, max);
+    }
+    if (distribution == "zipfian") {
+        return std::make_unique<zipfian_generator>(min, max, 0.99);
+    }
+    return nullptr;
+}
+
+[[noreturn]] void exit_for_invalid_profile(const std::string &name, const std::string &reason)
+{
+    fmt::print(stderr, "invalid workload '{}': {}\n", name, reason);
+    dsn_exit(1);
+}
+
+} // anonymous namespace
+
+workload_profile workload_profile::load(const std::string &name)
+{
+    const auto section = fmt::format("pegasus.benchmark.workload.{}", name);
+    std::vector<std::string> sections;
+    dsn_config_get_all_sections(sections);
+    if (std::find(sections.begin(), sections.end(), section) == sections.end()) {
+        exit_for_invalid_profile(name, fmt::format("section [{}] is not found", section));
+    }
+
+    const auto get_uint64 = [&section](const char *key, uint64_t default_value) {
+        return dsn_config_get_value_uint64(section.c_str(), key, default_value, "");
+    };
+    const auto get_double = [&section](const char *key, double default_value) {
+        return dsn_config_get_value_double(section.c_str(), key, default_value, "");
+    };
+    const auto get_string = [&section](const char *key, const char *default_value) {
+        return std::string(dsn_config_get_value_string(section.c_str(), key, default_value, ""));
+    };
+
+    workload_profile profile;
+    profile.name = name;
+    profile.record_count = get_uint64("record_count", FLAGS_benchmark_num);
+    profile.operation_count = get_uint64("operation_count", FLAGS_benchmark_num);
+    profile.duration_seconds = get_uint64("duration_seconds", 0);
+    profile.threads = get_uint64("threads", FLAGS_threads);
+    profile.target_ops_per_sec = get_uint64("target_ops_per_sec", 0);
+    // Keep the closed-loop threads one request at a time like the other benchmarks, while
+    // allow plenty of requests in flight to keep the open-loop rate.
+    profile.max_outstanding_per_thread =
+        get_uint64("max_outstanding_per_thread", profile.target_ops_per_sec == 0 ? 1 : 1000);
+    profile.timeout_ms = static_cast<int>(get_uint64("timeout_ms", FLAGS_pegasus_timeout_ms));
+
+    profile.proportions[kWorkloadRead] = get_double("read_proportion", 0.95);
+    profile.proportions[kWorkloadUpdate] = get_double("update_proportion", 0.05);
+    profile.proportions[kWorkloadInsert] = get_double("insert_proportion", 0);
+    profile.proportions[kWorkloadScan] = get_double("scan_proportion", 0);
+    profile.proportions[kWorkloadReadModifyWrite] =
+        get_double("read_modify_write_proportion", 0);
+    profile.request_distribution = get_string("request_distribution", "uniform");
+    profile.zipfian_constant = get_double("zipfian_constant", 0.99);
+    profile.hotspot_data_fraction = get_double("hotspot_data_fraction", 0.2);
+    profile.hotspot_opn_fraction = get_double("hotspot_opn_fraction", 0.8);
+
+    profile.sortkeys_per_hashkey = get_uint64("sortkeys_per_hashkey", 1);
+    profile.scan_length_distribution = get_string("scan_length_distribution", "uniform");
+    profile.max_scan_length = get_uint64("max_scan_length", 100);
+    profile.value_length_distribution = get_string("value_length_distribution", "constant");
+    profile.min_value_length = get_uint64("min_value_length", 1);
+    profile.max_value_length = get_uint64("max_value_length", FLAGS_value_size);
+
+    if (profile.record_count == 0) {
+        exit_for_invalid_profile(name, "record_count should be > 0");
+    }
+    if (profile.threads == 0 || profile.max_outstanding_per_thread == 0) {
+        exit_for_invalid_profile(name, "threads and max_outstanding_per_thread should be > 0");
+    }
+    double total_proportion = 0;
+    for (const auto proportion : profile.proportions) {
+        if (proportion < 0) {
+            exit_for_invalid_profile(name, "the proportions should be >= 0");
+        }
+        total_proportion += proportion;
+    }
+    if (total_proportion <= 0) {
+        exit_for_invalid_profile(name, "the sum of the proportions should be > 0");
+    }
+    if (profile.request_distribution != "uniform" && profile.request_distribution != "zipfian" &&
+        profile.request_distribution != "latest" && profile.request_distribution != "hotspot") {
+        exit_for_invalid_profile(
+            name, "request_distribution should be one of uniform, zipfian, latest and hotspot");
+    }
+    if (profile.zipfian_constant <= 0 || profile.zipfian_constant >= 1) {
+        exit_for_invalid_profile(name, "zipfian_constant should be in (0, 1)");
+    }
+    if (profile.hotspot_data_fraction < 0 || profile.hotspot_data_fraction > 1 ||
+        profile.hotspot_opn_fraction < 0 || profile.hotspot_opn_fraction > 1) {
+        exit_for_invalid_profile(name, "the hotspot fractions should be in [0, 1]");
+    }
+    if (profile.sortkeys_per_hashkey == 0 || profile.max_scan_length == 0) {
+        exit_for_invalid_profile(name, "sortkeys_per_hashkey and max_scan_length should be > 0");
+    }
+    if (profile.scan_length_distribution != "uniform" &&
+        profile.scan_length_distribution != "zipfian") {
+        exit_for_invalid_profile(name, "scan_length_distribution should be uniform or zipfian");
+    }
+    if (profile.min_value_length > profile.max_value_length) {
+        exit_for_invalid_profile(name, "min_value_length should be <= max_value_length");
+    }
+    if (profile.value_length_distribution != "constant" &&
+        profile.value_length_distribution != "uniform" &&
+        profile.value_length_distribution != "zipfian") {
+        exit_for_invalid_profile(
+            name, "value_length_distribution should be one of constant, uniform and zipfian");
+    }
+    return profile;
+}
+
+workload_runner::workload_runner(pegasus_client *client, const workload_profile &profile)
+    : _client(client), _profile(profile)
+{
+    CHECK_NOTNULL(_client, "");
+
+    if (_profile.request_distribution == "zipfian") {
+        _key_chooser = std::make_unique<scrambled_zipfian_key_chooser>(
+            _next_insert_id, _profile.record_count, _profile.zipfian_constant);
+    } else if (_profile.request_distribution == "latest") {
+        _key_chooser = std::make_unique<latest_key_chooser>(
+            _next_insert_id, _profile.record_count, _profile.zipfian_constant);
+    } else if (_profile.request_distribution == "hotspot") {
+        _key_chooser = std::make_unique<hotspot_key_chooser>(
+            _next_insert_id, _profile.hotspot_data_fraction, _profile.hotspot_opn_fraction);
+    } else {
+        _key_chooser = std::make_unique<uniform_key_chooser>(_next_insert_id);
+    }
+    _scan_length_generator =
+        create_length_generator(_profile.scan_length_distribution, 1, _profile.max_scan_length);
+    _value_length_generator = create_length_generator(
+        _profile.value_length_distribution, _profile.min_value_length, _profile.max_value_length);
+}
+
+void workload_runner::load() { run_phase(true); }
+
+void workload_runner::run() { run_phase(false); }
+
+void workload_runner::run_phase(bool is_load)
+{
+    for (int op = 0; op < kWorkloadOpCount; ++op) {
+        _histograms[op] = std::make_unique<hdr_histogram>(kHighestTrackableLatencyUs,
+                                                          FLAGS_hdr_histogram_significant_digits);
+        _errors[op] = 0;
+        _not_found[op] = 0;
+    }
+
+    // The records are assumed to be loaded before running.
+    const auto op_count = is_load ? _profile.record_count : _profile.operation_count;
+    _next_insert_id = is_load ? 0 : std::max(_next_insert_id.load(), _profile.record_count);
+
+    const auto &env = config::instance().env;
+    const auto start_us = env->NowMicros();
+    std::vector<std::unique_ptr<thread_context>> contexts;
+    for (uint64_t i = 0; i < _profile.threads; ++i) {
+        auto ctx = std::make_unique<thread_context>();
+        ctx->runner = this;
+        ctx->seed = i + (FLAGS_benchmark_seed == 0 ? 1000 : FLAGS_benchmark_seed);
+        ctx->op_count = op_count / _profile.threads + (i < op_count % _profile.threads ? 1 : 0);
+        ctx->is_load = is_load;
+        contexts.emplace_back(std::move(ctx));
+        env->StartThread(thread_body, contexts.back().get());
+    }
+    env->WaitForJoin();
+
+    report(is_load ? "load" : "run", env->NowMicros() - start_us);
+}
+
+void workload_runner::thread_body(void *v)
+{
+    auto *ctx = static_cast<thread_context *>(v);
+    reseed_thread_local_rng(ctx->seed);
+    ctx->runner->execute(ctx);
+}
+
+void workload_runner::execute(thread_context *ctx)
+{
+    const auto &env = config::instance().env;
+    const bool open_loop = _profile.target_ops_per_sec > 0;
+    const double interval_us =
+        open_loop ? 1e6 * _profile.threads / _profile.target_ops_per_sec : 0;
+    const auto begin_us = env->NowMicros();
+    const auto deadline_us = _profile.duration_seconds == 0 || ctx->is_load
+                                 ? UINT64_MAX
+                                 : begin_us + _profile.duration_seconds * 1000000;
+
+    for (uint64_t i = 0; i < ctx->op_count; ++i) {
+        // In the open-loop mode each operation is scheduled at a fixed time, and its latency is
+        // measured from then on, including the time it waits for a free slot.
+        uint64_t start_us = begin_us + static_cast<uint64_t>(i * interval_us);
+        auto now_us = env->NowMicros();
+        if (open_loop && now_us < start_us) {
+            env->SleepForMicroseconds(static_cast<int>(start_us - now_us));
+        }
+        while (ctx->outstanding.load() >= _profile.max_outstanding_per_thread) {
+            env->SleepForMicroseconds(10);
+        }
+        now_us = env->NowMicros();
+        if (now_us >= deadline_us) {
+            break;
+        }
+        if (!open_loop) {
+            start_us = now_us;
+        }
+
+        ctx->outstanding.fetch_add(1);
+        issue(ctx->is_load ? kWorkloadInsert : next_op(), start_us, ctx);
+    }
+
+    while (ctx->outstanding.load() > 0) {
+        env->SleepForMicroseconds(100);
+    }
+}
+
+workload_op workload_runner::next_op() const
+{
+    double total = 0;
+    for (const auto proportion : _profile.proportions) {
+        total += proportion;
+    }
+
+    auto r = next_double() * total;
+    for (int op = 0; op < kWorkloadOpCount; ++op) {
+        if (r < _profile.proportions[op]) {
+            return static_cast<workload_op>(op);
+        }
+        r -= _profile.proportions[op];
+    }
+    return kWorkloadRead;
+}
+
+uint64_t workload_runner::next_record_id() { return _key_chooser->next(); }
+
+void workload_runner::issue(workload_op op, uint64_t start_us, thread_context *ctx)
+{
+    const auto timeout_ms = _profile.timeout_ms;
+    switch (op) {
+    case kWorkloadRead: {
+        const auto id = next_record_id();
+        _client->async_get(
+            hashkey_of(id),
+            sortkey_of(id),
+            [=](int err, std::string &&, pegasus_client::internal_info &&) {
+                finish(op, err, start_us, ctx);
+            },
+            timeout_ms);
+        break;
+    }
+    case kWorkloadUpdate:
+    case kWorkloadInsert: {
+        const auto id = op == kWorkloadInsert ? _next_insert_id.fetch_add(1) : next_record_id();
+        _client->async_set(
+            hashkey_of(id),
+            sortkey_of(id),
+            next_value(),
+            [=](int err, pegasus_client::internal_info &&) { finish(op, err, start_us, ctx); },
+            timeout_ms);
+        break;
+    }
+    case kWorkloadScan: {
+        // Scan the consecutive records under the hash key from the chosen one, -1 means no
+        // limit of the size.
+        const auto id = next_record_id();
+        _client->async_multi_get(
+            hashkey_of(id),
+            sortkey_of(id),
+            "",
+            pegasus_client::multi_get_options(),
+            [=](int err, std::map<std::string, std::string> &&, pegasus_client::internal_info &&) {
+                finish(op, err == PERR_INCOMPLETE ? PERR_OK : err, start_us, ctx);
+            },
+            static_cast<int>(_scan_length_generator->next()),
+            -1,
+            timeout_ms);
+        break;
+    }
+    case kWorkloadReadModifyWrite: {
+        const auto id = next_record_id();
+        auto hashkey = hashkey_of(id);
+        auto sortkey = sortkey_of(id);
+        _client->async_get(
+            hashkey,
+            sortkey,
+            [=](int err, std::string &&, pegasus_client::internal_info &&) {
+                if (err != PERR_OK && err != PERR_NOT_FOUND) {
+                    finish(op, err, start_us, ctx);
+                    return;
+                }
+                _client->async_set(hashkey,
+                                   sortkey,
+                                   next_value(),
+                                   [=](int set_err, pegasus_client::internal_info &&) {
+                                       finish(op, set_err, start_us, ctx);
+                                   },
+                                   timeout_ms);
+            },
+            timeout_ms);
+        break;
+    }
+    default:
+        CHECK(false, "invalid workload op {}", static_cast<int>(op));
+    }
+}
+
+void workload_runner::finish(workload_op op, int err, uint64_t start_us, thread_context *ctx)
+{
+    // The failed operations are counted in the histograms too, otherwise the timeouts would be
+    // hidden from the tail latencies.
+    _histograms[op]->record(config::instance().env->NowMicros() - start_us);
+    if (err == PERR_NOT_FOUND) {
+        _not_found[op].fetch_add(1);
+    } else if (err != PERR_OK) {
+        _errors[op].fetch_add(1);
+    }
+
+    // Must be the last, since `ctx` is released once there is no outstanding operation.
+    ctx->outstanding.fetch_sub(1);
+}
+
+std::string workload_runner::hashkey_of(uint64_t id) const
+{
+    return fmt::format("user{:012}", id / _profile.sortkeys_per_hashkey);
+}
+
+std::string workload_runner::sortkey_of(uint64_t id) const
+{
+    return fmt::format("{:010}", id % _profile.sortkeys_per_hashkey);
+}
+
+std::string workload_runner::next_value() const
+{
+    return generate_string(_value_length_generator->next());
+}
+
+void workload_runner::report(const char *phase, uint64_t elapsed_us) const
+{
+    uint64_t total_ops = 0;
+    for (const auto &histogram : _histograms) {
+        total_ops += histogram->total_count();
+    }
+    const double elapsed = std::max<uint64_t>(elapsed_us, 1) * 1e-6;
+    fmt::print(stdout,
+               "Workload {} ({}): {} ops in {:.3f} s, {:.1f} ops/sec, {}\n",
+               _profile.name,
+               phase,
+               total_ops,
+               elapsed,
+               total_ops / elapsed,
+               _profile.target_ops_per_sec == 0
+                   ? std::string("closed-loop")
+                   : fmt::format("open-loop at {} ops/sec", _profile.target_ops_per_sec));
+
+    const std::string dir(FLAGS_hdr_histogram_dir);
+    if (!dir.empty() && !dsn::utils::filesystem::create_directory(dir)) {
+        fmt::print(stderr, "create directory {} failed\n", dir);
+    }
+
+    for (int op = 0; op < kWorkloadOpCount; ++op) {
+        const auto &histogram = _histograms[op];
+        if (histogram->total_count() == 0) {
+            continue;
+        }
+
+        fmt::print(stdout,
+                   "  {:<18} count {}, errors {}, not found {}, latency(us): min {}, mean {:.1f}, "
+                   "p50 {}, p90 {}, p99 {}, p99.9 {}, p99.99 {}, max {}\n",
+                   kWorkloadOpNames[op],
+                   histogram->total_count(),
+                   _errors[op].load(),
+                   _not_found[op].load(),
+                   histogram->min(),
+                   histogram->mean(),
+                   histogram->value_at_percentile(50),
+                   histogram->value_at_percentile(90),
+                   histogram->value_at_percentile(99),
+                   histogram->value_at_percentile(99.9),
+                   histogram->value_at_percentile(99.99),
+                   histogram->max());
+
+        if (dir.empty()) {
+            continue;
+        }
+        const auto path =
+            fmt::format("{}/{}.{}.{}.hgrm", dir, _profile.name, phase, kWorkloadOpNames[op]);
+        FILE *out = fopen(path.c_str(), "w");
+        if (out == nullptr) {
+            fmt::print(stderr, "open {} failed\n", path);
+            continue;
+        }
+        // Output in milliseconds as HdrHistogram does.
+        histogram->output_percentile_distribution(out, 5, 1000);
+        fclose(out);
+    }
+}
+
+} // namespace test
+} // namespace pegasus
@@ -0,0 +1,151 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "hdr_histogram.h"
+
+namespace pegasus {
+class pegasus_client;
+
+namespace test {
+
+enum workload_op
+{
+    kWorkloadRead = 0,
+    kWorkloadUpdate,
+    kWorkloadInsert,
+    kWorkloadScan,
+    kWorkloadReadModifyWrite,
+    kWorkloadOpCount
+};
+
+// Generates the numbers of a distribution, e.g. the ids of the records to operate on, the
+// lengths of the values and the scans. Thread-safe, since the random numbers are drawn from the
+// RNG of current thread.
+class number_generator
+{
+public:
+    virtual ~number_generator() = default;
+    virtual uint64_t next() = 0;
+};
+
+// A workload in the style of YCSB, which is loaded from the section
+// [pegasus.benchmark.workload.<name>] of the config file, see config.ini for the keys.
+//
+// The record of id `i` is put as the sort key `i % sortkeys_per_hashkey` of the hash key
+// `i / sortkeys_per_hashkey`, thus a scan reads the consecutive records under a hash key.
+struct workload_profile
+{
+    std::string name;
+
+    uint64_t record_count;
+    uint64_t operation_count;
+    // The run phase stops once either operation_count or duration_seconds is reached.
+    uint64_t duration_seconds;
+    uint64_t threads;
+    // The operations are issued at this fixed rate no matter how long they take if it is not 0,
+    // i.e. the load is open-loop, otherwise each thread issues an operation once one of its
+    // operations is done, i.e. the load is closed-loop.
+    uint64_t target_ops_per_sec;
+    uint64_t max_outstanding_per_thread;
+    int timeout_ms;
+
+    double proportions[kWorkloadOpCount];
+    // uniform, zipfian, latest or hotspot.
+    std::string request_distribution;
+    double zipfian_constant;
+    double hotspot_data_fraction;
+    double hotspot_opn_fraction;
+
+    uint64_t sortkeys_per_hashkey;
+    // uniform or zipfian.
+    std::string scan_length_distribution;
+    uint64_t max_scan_length;
+    // constant, uniform or zipfian.
+    std::string value_length_distribution;
+    uint64_t min_value_length;
+    uint64_t max_value_length;
+
+    // Exits if the profile does not exist or is invalid.
+    static workload_profile load(const std::string &name);
+};
+
+// Drives a workload against pegasus by the async client calls, and reports the latencies of
+// each type of the operations by HDR histograms.
+//
+// In the open-loop mode the latency of an operation is measured from the time it is scheduled
+// to be issued rather than the time it is actually issued, thus the time waiting for a slow
+// server is counted, i.e. the results do not suffer from coordinated omission.
+class workload_runner
+{
+public:
+    workload_runner(pegasus_client *client, const workload_profile &profile);
+    ~workload_runner() = default;
+
+    // Insert the records [0, record_count) in order.
+    void load();
+    // Issue the operations mixed by the proportions on the records.
+    void run();
+
+private:
+    struct thread_context
+    {
+        workload_runner *runner;
+        uint64_t seed;
+        uint64_t op_count;
+        bool is_load;
+        std::atomic<uint64_t> outstanding{0};
+    };
+
+    static void thread_body(void *v);
+    void execute(thread_context *ctx);
+    void run_phase(bool is_load);
+
+    workload_op next_op() const;
+    uint64_t next_record_id();
+    void issue(workload_op op, uint64_t start_us, thread_context *ctx);
+    void finish(workload_op op, int err, uint64_t start_us, thread_context *ctx);
+
+    std::string hashkey_of(uint64_t id) const;
+    std::string sortkey_of(uint64_t id) const;
+    std::string next_value() const;
+
+    void report(const char *phase, uint64_t elapsed_us) const;
+
+    pegasus_client *_client;
+    const workload_profile _profile;
+    std::unique_ptr<number_generator> _key_chooser;
+    std::unique_ptr<number_generator> _scan_length_generator;
+    std::unique_ptr<number_generator> _value_length_generator;
+
+    // The id of the next record to insert, and the records below it are read or updated.
+    std::atomic<uint64_t> _next_insert_id{0};
+
+    std::unique_ptr<hdr_histogram> _histograms[kWorkloadOpCount];
+    std::atomic<uint64_t> _errors[kWorkloadOpCount];
+    std::atomic<uint64_t> _not_found[kWorkloadOpCount];
+};
+} // namespace test
+} // namespace pegasus
@@ -23,7 +23,9 @@
 #include <rrdb/rrdb_types.h>
 #include <stdint.h>
 #include <chrono>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -32,6 +34,8 @@
 #include "client/partition_resolver.h"
 #include "gtest/gtest.h"
 #include "include/rrdb/rrdb.client.h"
+#include "pegasus/client.h"
+#include "pegasus/error.h"
 #include "test/function_test/utils/test_util.h"
 #include "utils/blob.h"
 #include "utils/error_code.h"
@@ -113,3 +117,31 @@ TEST_F(batch_get, set_and_then_batch_get)
         ASSERT_EQ(response.data[i].value.to_string(), test_data_values[i]);
     }
 }
+
+TEST_F(batch_get, batch_set_get_and_del_across_partitions)
+{
+    const int test_data_count = 200;
+    std::map<pegasus_client::full_key_t, std::string> kvs;
+    std::set<pegasus_client::full_key_t> keys;
+    for (int i = 0; i < test_data_count; ++i) {
+        pegasus_client::full_key_t key("batch_hash_key_" + std::to_string(i % 50),
+                                       "batch_sort_key_" + std::to_string(i));
+        kvs[key] = "batch_value_" + std::to_string(i);
+        keys.insert(key);
+    }
+    ASSERT_EQ(PERR_OK, client_->batch_set(kvs));
+
+    // The data not existed is not returned.
+    keys.emplace("batch_hash_key_no_exist", "batch_sort_key_no_exist");
+    std::map<pegasus_client::full_key_t, std::string> values;
+    ASSERT_EQ(PERR_OK, client_->batch_get(keys, values));
+    ASSERT_EQ(kvs, values);
+
+    ASSERT_EQ(PERR_OK, client_->batch_del(keys));
+    ASSERT_EQ(PERR_OK, client_->batch_get(keys, values));
+    ASSERT_TRUE(values.empty());
+
+    // Empty keys are allowed.
+    ASSERT_EQ(PERR_OK, client_->batch_get({}, values));
+    ASSERT_TRUE(values.empty());
+}
@@ -34,6 +34,8 @@
 namespace dsn {
 namespace utils {
 
+// The implementation is selected at runtime: the hardware-accelerated one (SSE4.2 crc32
+// instruction) if supported by the CPU, otherwise the table-driven one.
 uint32_t crc32_calc(const void *ptr, size_t size, uint32_t init_crc);
 
 //
@@ -53,6 +55,8 @@ uint32_t crc32_concat(uint32_t xy_init,
                       uint32_t y_final,
                       size_t y_size);
 
+// The implementation is selected at runtime: the hardware-accelerated one (PCLMULQDQ folding)
+// if supported by the CPU, otherwise the table-driven one.
 uint64_t crc64_calc(const void *ptr, size_t size, uint64_t init_crc);
 
 //
@@ -71,5 +75,15 @@ uint64_t crc64_concat(uint32_t xy_init,
                       uint64_t y_init,
                       uint64_t y_final,
                       size_t y_size);
+
+// The specific implementations of crc32_calc and crc64_calc, which are exposed for tests and
+// benchmarks. The *_hw ones fall back to the *_table ones if not supported by the CPU.
+bool crc32_hw_supported();
+uint32_t crc32_calc_table(const void *ptr, size_t size, uint32_t init_crc);
+uint32_t crc32_calc_hw(const void *ptr, size_t size, uint32_t init_crc);
+
+bool crc64_hw_supported();
+uint64_t crc64_calc_table(const void *ptr, size_t size, uint64_t init_crc);
+uint64_t crc64_calc_hw(const void *ptr, size_t size, uint64_t init_crc);
 } // namespace utils
 } // namespace dsn
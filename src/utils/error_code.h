@@ -189,6 +189,8 @@ DEFINE_ERR_CODE(ERR_HTTP_ERROR)
 
 DEFINE_ERR_CODE(ERR_NOT_MATCHED)
 
+DEFINE_ERR_CODE(ERR_STALE_REPLICA)
+
 } // namespace dsn
 
 USER_DEFINED_STRUCTURE_FORMATTER(::dsn::error_code);
@@ -57,6 +57,7 @@ namespace dsn {
 using namespace tools;
 DSN_REGISTER_COMPONENT_PROVIDER(screen_logger, "dsn::tools::screen_logger");
 DSN_REGISTER_COMPONENT_PROVIDER(simple_logger, "dsn::tools::simple_logger");
+DSN_REGISTER_COMPONENT_PROVIDER(async_logger, "dsn::tools::async_logger");
 
 std::function<std::string()> log_prefixed_message_func = []() -> std::string { return ": "; };
 
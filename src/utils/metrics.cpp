@@ -28,6 +28,8 @@
 #include <boost/system/detail/error_code.hpp>
 #include <fmt/core.h>
 #include <unistd.h>
+#include <algorithm>
+#include <map>
 #include <string_view>
 
 #include "http/http_method.h"
@@ -60,6 +62,15 @@ dsn::metric_entity_ptr server_metric_entity()
 
 namespace dsn {
 
+namespace {
+
+inline bool is_closeable_metric(metric_type type)
+{
+    return type == metric_type::kPercentile || type == metric_type::kHistogram;
+}
+
+} // anonymous namespace
+
 metric_entity::metric_entity(const metric_entity_prototype *prototype,
                              const std::string &id,
                              const attr_map &attrs)
@@ -85,7 +96,7 @@ void metric_entity::close(close_option option)
     // It's inefficient to wait for each metric to be closed one by one. Therefore, the metric is
     // not closed in its destructor.
     for (auto &m : _metrics) {
-        if (m.second->prototype()->type() == metric_type::kPercentile) {
+        if (is_closeable_metric(m.second->prototype()->type())) {
             auto p = down_cast<closeable_metric *>(m.second.get());
             p->close();
         }
@@ -97,7 +108,7 @@ void metric_entity::close(close_option option)
 
     // Wait for all of the close operations to be finished.
     for (auto &m : _metrics) {
-        if (m.second->prototype()->type() == metric_type::kPercentile) {
+        if (is_closeable_metric(m.second->prototype()->type())) {
             auto p = down_cast<closeable_metric *>(m.second.get());
             p->wait();
         }
@@ -281,6 +292,7 @@ const std::string metrics_http_service::kMetricsRootPath("");
 const std::string metrics_http_service::kMetricsQuerySubPath("metrics");
 const std::string
     metrics_http_service::kMetricsQueryPath('/' + metrics_http_service::kMetricsQuerySubPath);
+const std::string metrics_http_service::kMetricsPrometheusSubPath("metrics/prometheus");
 
 metrics_http_service::metrics_http_service(metric_registry *registry) : _registry(registry)
 {
@@ -293,6 +305,12 @@ metrics_http_service::metrics_http_service(metric_registry *registry) : _registr
                      "..][&attributes=attr1,value1,attr2,value2,...][&metrics=metric1,metric2,...]["
                      "&detail=true|false]"
                      "Query the node metrics.");
+    register_handler(kMetricsPrometheusSubPath,
+                     std::bind(&metrics_http_service::get_prometheus_metrics_handler,
+                               this,
+                               std::placeholders::_1,
+                               std::placeholders::_2),
+                     "Query the node metrics in Prometheus text exposition format.");
 }
 
 namespace {
@@ -385,6 +403,20 @@ void metrics_http_service::get_metrics_handler(const http_request &req, http_res
     resp.status_code = http_status_code::kOk;
 }
 
+void metrics_http_service::get_prometheus_metrics_handler(const http_request &req,
+                                                          http_response &resp)
+{
+    if (req.method != http_method::GET) {
+        resp.body = "please use 'GET' method while querying for metrics";
+        resp.status_code = http_status_code::kBadRequest;
+        return;
+    }
+
+    resp.body = _registry->take_prometheus_snapshot();
+    resp.content_type = "text/plain; version=0.0.4";
+    resp.status_code = http_status_code::kOk;
+}
+
 metric_registry::metric_registry() : _http_service(this)
 {
     // We should ensure that metric_registry is destructed before shared_io_service is destructed.
@@ -567,6 +599,100 @@ void metric_registry::take_snapshot(metric_json_writer &writer, const metric_fil
     writer.EndObject();
 }
 
+namespace {
+
+// Escape the label value in Prometheus text exposition format.
+std::string escape_prometheus_label_value(const std::string &value)
+{
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (const auto c : value) {
+        switch (c) {
+        case '\\':
+            escaped.append("\\\\");
+            break;
+        case '"':
+            escaped.append("\\\"");
+            break;
+        case '\n':
+            escaped.append("\\n");
+            break;
+        default:
+            escaped.push_back(c);
+        }
+    }
+    return escaped;
+}
+
+// Generate the labels for all samples of an entity, i.e. its type, id and attributes.
+std::string get_prometheus_labels(const metric_entity_ptr &entity)
+{
+    std::string labels(fmt::format("entity=\"{}\",id=\"{}\"",
+                                   entity->prototype()->name(),
+                                   escape_prometheus_label_value(entity->id())));
+
+    // Sort the attributes to keep the labels in the same order.
+    const auto attrs = entity->attributes();
+    const std::map<std::string, std::string> sorted_attrs(attrs.begin(), attrs.end());
+    for (const auto &attr : sorted_attrs) {
+        labels.append(fmt::format(
+            ",{}=\"{}\"", attr.first, escape_prometheus_label_value(attr.second)));
+    }
+    return labels;
+}
+
+// Return nullptr if the metric could not be exposed to Prometheus.
+const char *get_prometheus_type(metric_type type)
+{
+    switch (type) {
+    case metric_type::kGauge:
+        return "gauge";
+    case metric_type::kCounter:
+        return "counter";
+    case metric_type::kPercentile:
+        return "summary";
+    case metric_type::kHistogram:
+        return "histogram";
+    default:
+        return nullptr;
+    }
+}
+
+} // anonymous namespace
+
+std::string metric_registry::take_prometheus_snapshot() const
+{
+    // All samples of a metric should be grouped together following its HELP and TYPE lines, thus
+    // collect the samples for each metric from all entities firstly.
+    std::map<std::string_view, std::pair<const metric_prototype *, std::string>> families;
+    for (const auto &entity : entities()) {
+        const auto labels = get_prometheus_labels(entity.second);
+        for (const auto &m : entity.second->metrics()) {
+            if (get_prometheus_type(m.first->type()) == nullptr) {
+                continue;
+            }
+
+            auto &family = families[m.first->name()];
+            family.first = m.first;
+            m.second->take_prometheus_snapshot(labels, family.second);
+        }
+    }
+
+    std::string out;
+    for (const auto &family : families) {
+        const auto *prototype = family.second.first;
+        std::string help(prototype->description());
+        std::replace(help.begin(), help.end(), '\n', ' ');
+        out.append(fmt::format("# HELP {} {}\n# TYPE {} {}\n",
+                               prototype->name(),
+                               help,
+                               prototype->name(),
+                               get_prometheus_type(prototype->type())));
+        out.append(family.second.second);
+    }
+    return out;
+}
+
 metric_registry::collected_entities_info metric_registry::collect_stale_entities() const
 {
     collected_entities_info collected_info;
@@ -680,6 +806,262 @@ metric::metric(const metric_prototype *prototype) : _prototype(prototype) {}
 
 closeable_metric::closeable_metric(const metric_prototype *prototype) : metric(prototype) {}
 
+bool merge_histogram_buckets(const metric_histogram_buckets &from,
+                             metric_merged_histogram_buckets &to)
+{
+    for (const auto &bucket : from) {
+        if (dsn_unlikely(bucket.size() != 2)) {
+            return false;
+        }
+
+        to[bucket[0]] += bucket[1];
+    }
+
+    return true;
+}
+
+metric_merged_histogram_buckets diff_histogram_buckets(const metric_merged_histogram_buckets &start,
+                                                       const metric_merged_histogram_buckets &end)
+{
+    metric_merged_histogram_buckets diff;
+    for (const auto &bucket : end) {
+        auto count = bucket.second;
+        const auto iter = start.find(bucket.first);
+        if (iter != start.end() && iter->second <= count) {
+            count -= iter->second;
+        }
+
+        if (count > 0) {
+            diff.emplace(bucket.first, count);
+        }
+    }
+
+    return diff;
+}
+
+uint64_t histogram_kth_percentile(const metric_merged_histogram_buckets &buckets,
+                                  kth_percentile_type type)
+{
+    uint64_t total = 0;
+    for (const auto &bucket : buckets) {
+        total += bucket.second;
+    }
+
+    if (total == 0) {
+        return 0;
+    }
+
+    const auto nth = kth_percentile_to_nth_index(total, type);
+    uint64_t cumulative = 0;
+    for (const auto &bucket : buckets) {
+        cumulative += bucket.second;
+        if (cumulative > nth) {
+            return bucket.first;
+        }
+    }
+
+    return buckets.rbegin()->first;
+}
+
+histogram::histogram(const metric_prototype *prototype,
+                     uint64_t interval_ms,
+                     const std::set<kth_percentile_type> &kth_percentiles)
+    : closeable_metric(prototype),
+      _last_counts(kHistogramBucketCount, 0),
+      _kth_percentile_bitset(),
+      _kth_values(static_cast<size_t>(kth_percentile_type::COUNT)),
+      _timer()
+{
+    for (auto &s : _stripes) {
+        s.store(nullptr, std::memory_order_relaxed);
+    }
+
+    for (const auto &kth : kth_percentiles) {
+        _kth_percentile_bitset.set(static_cast<size_t>(kth));
+    }
+
+    for (auto &value : _kth_values) {
+        value.store(0, std::memory_order_relaxed);
+    }
+
+#ifdef MOCK_TEST
+    if (interval_ms == 0) {
+        // Timer is disabled.
+        return;
+    }
+#else
+    CHECK_GT(interval_ms, 0);
+#endif
+
+    // Increment ref count since the histogram will be referenced by timer, and decrement it in
+    // on_close(), see also the constructor of percentile.
+    add_ref();
+    _timer.reset(new metric_timer(interval_ms,
+                                  std::bind(&histogram::compute_kth_percentiles, this),
+                                  std::bind(&histogram::on_close, this)));
+}
+
+histogram::~histogram()
+{
+    for (auto &s : _stripes) {
+        delete s.load(std::memory_order_relaxed);
+    }
+}
+
+histogram::stripe *histogram::new_stripe(std::atomic<stripe *> &slot)
+{
+    // All counts are zero-initialized by value-initialization.
+    auto *s = new stripe();
+    stripe *expected = nullptr;
+    if (!slot.compare_exchange_strong(expected, s, std::memory_order_acq_rel)) {
+        // Another thread sharing the same slot has allocated the stripe.
+        delete s;
+        return expected;
+    }
+    return s;
+}
+
+std::vector<uint64_t> histogram::bucket_counts() const
+{
+    std::vector<uint64_t> counts(kHistogramBucketCount, 0);
+    for (const auto &slot : _stripes) {
+        const auto *s = slot.load(std::memory_order_acquire);
+        if (s == nullptr) {
+            continue;
+        }
+
+        for (size_t i = 0; i < kHistogramBucketCount; ++i) {
+            counts[i] += s->counts[i].load(std::memory_order_relaxed);
+        }
+    }
+    return counts;
+}
+
+int64_t histogram::sum() const
+{
+    int64_t total = 0;
+    for (const auto &slot : _stripes) {
+        const auto *s = slot.load(std::memory_order_acquire);
+        if (s != nullptr) {
+            total += s->sum.load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+void histogram::take_snapshot(metric_json_writer &writer, const metric_filters &filters)
+{
+    writer.StartObject();
+
+    encode_prototype(writer, filters);
+
+    const auto counts = bucket_counts();
+    uint64_t total = 0;
+    metric_histogram_buckets buckets;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (counts[i] == 0) {
+            continue;
+        }
+
+        total += counts[i];
+        buckets.push_back({histogram_bucket_upper_bound(i), counts[i]});
+    }
+
+    encode(writer, kMetricCountField, total, filters);
+    encode(writer, kMetricSumField, sum(), filters);
+    encode(writer, kMetricBucketsField, buckets, filters);
+
+    for (size_t i = 0; i < static_cast<size_t>(kth_percentile_type::COUNT); ++i) {
+        if (!_kth_percentile_bitset.test(i)) {
+            continue;
+        }
+
+        encode(writer, kAllKthPercentiles[i].name, value(i), filters);
+    }
+
+    writer.EndObject();
+}
+
+void histogram::take_prometheus_snapshot(const std::string &labels, std::string &out)
+{
+    // The buckets of Prometheus histograms are cumulative, i.e. each bucket counts all the
+    // observations less than or equal to its upper bound. Empty buckets are omitted, which is
+    // allowed since the buckets are always the same.
+    const auto counts = bucket_counts();
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (counts[i] == 0) {
+            continue;
+        }
+
+        cumulative += counts[i];
+        append_prometheus_sample(out,
+                                 "_bucket",
+                                 labels,
+                                 fmt::format("le=\"{}\"", histogram_bucket_upper_bound(i)),
+                                 cumulative);
+    }
+
+    append_prometheus_sample(out, "_bucket", labels, "le=\"+Inf\"", cumulative);
+    append_prometheus_sample(out, "_sum", labels, "", sum());
+    append_prometheus_sample(out, "_count", labels, "", cumulative);
+}
+
+void histogram::close()
+{
+    if (_timer) {
+        _timer->close();
+    }
+}
+
+void histogram::wait()
+{
+    if (_timer) {
+        _timer->wait();
+    }
+}
+
+void histogram::on_close()
+{
+    // The histogram is no longer needed by timer and can be destructed safely.
+    release_ref();
+}
+
+void histogram::compute_kth_percentiles()
+{
+    auto counts = bucket_counts();
+    std::vector<uint64_t> window(counts.size());
+    uint64_t total = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        window[i] = counts[i] - _last_counts[i];
+        total += window[i];
+    }
+    _last_counts = std::move(counts);
+
+    if (total == 0) {
+        // Keep the last kth percentiles since there has not been any observation during this
+        // interval, just like the percentile.
+        return;
+    }
+
+    for (size_t k = 0; k < static_cast<size_t>(kth_percentile_type::COUNT); ++k) {
+        if (!_kth_percentile_bitset.test(k)) {
+            continue;
+        }
+
+        const auto nth = kth_percentile_to_nth_index(total, k);
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < window.size(); ++i) {
+            cumulative += window[i];
+            if (cumulative > nth) {
+                _kth_values[k].store(static_cast<value_type>(histogram_bucket_upper_bound(i)),
+                                     std::memory_order_relaxed);
+                break;
+            }
+        }
+    }
+}
+
 uint64_t metric_timer::generate_initial_delay_ms(uint64_t interval_ms)
 {
     CHECK_GT(interval_ms, 0);
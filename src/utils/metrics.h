@@ -20,6 +20,7 @@
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/detail/impl/epoll_reactor.hpp>
 #include <boost/asio/detail/impl/timer_queue_ptime.ipp>
+#include <fmt/core.h>
 #include <rapidjson/ostreamwrapper.h>
 #include <stddef.h>
 #include <algorithm>
@@ -28,6 +29,7 @@
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <new>
 #include <ratio>
@@ -56,6 +58,7 @@
 #include "utils/macros.h"
 #include "utils/nth_element.h"
 #include "utils/ports.h"
+#include "utils/process_utils.h"
 #include "utils/singleton.h"
 #include "utils/string_conv.h"
 #include "utils/synchronize.h"
@@ -136,6 +139,12 @@ class error_code;
     dsn::floating_percentile_prototype<double> METRIC_##name(                                      \
         {#entity_type, dsn::metric_type::kPercentile, #name, unit, desc, ##__VA_ARGS__})
 
+// The histogram only supports int64 type, which is mainly used for latencies. Unlike percentiles,
+// histograms of different entities could be merged, see `histogram` for details.
+#define METRIC_DEFINE_histogram_int64(entity_type, name, unit, desc, ...)                          \
+    dsn::histogram_prototype METRIC_##name(                                                        \
+        {#entity_type, dsn::metric_type::kHistogram, #name, unit, desc, ##__VA_ARGS__})
+
 // The following macros act as forward declarations for entity types and metric prototypes.
 #define METRIC_DECLARE_entity(name) extern ::dsn::metric_entity_prototype METRIC_ENTITY_##name
 #define METRIC_DECLARE_gauge_int64(name) extern ::dsn::gauge_prototype<int64_t> METRIC_##name
@@ -152,6 +161,7 @@ class error_code;
     extern dsn::percentile_prototype<int64_t> METRIC_##name
 #define METRIC_DECLARE_percentile_double(name)                                                     \
     extern dsn::floating_percentile_prototype<double> METRIC_##name
+#define METRIC_DECLARE_histogram_int64(name) extern dsn::histogram_prototype METRIC_##name
 
 // Following METRIC_VAR* macros are introduced so that:
 // * only need to use prototype name to operate each metric variable;
@@ -172,6 +182,8 @@ class error_code;
     METRIC_VAR_DECLARE(name, __VA_ARGS__ dsn::counter_ptr<dsn::striped_long_adder, false>)
 #define METRIC_VAR_DECLARE_percentile_int64(name, ...)                                             \
     METRIC_VAR_DECLARE(name, __VA_ARGS__ dsn::percentile_ptr<int64_t>)
+#define METRIC_VAR_DECLARE_histogram_int64(name, ...)                                              \
+    METRIC_VAR_DECLARE(name, __VA_ARGS__ dsn::histogram_ptr)
 
 // Macro METRIC_VAR_DEFINE* are used for the metric that is a static member of a class:
 // * `clazz` is the name of the class;
@@ -183,6 +195,8 @@ class error_code;
     METRIC_VAR_DEFINE(name, clazz, __VA_ARGS__ dsn::counter_ptr<dsn::striped_long_adder, false>)
 #define METRIC_VAR_DEFINE_percentile_int64(name, clazz, ...)                                       \
     METRIC_VAR_DEFINE(name, clazz, __VA_ARGS__ dsn::percentile_ptr<int64_t>)
+#define METRIC_VAR_DEFINE_histogram_int64(name, clazz, ...)                                        \
+    METRIC_VAR_DEFINE(name, clazz, __VA_ARGS__ dsn::histogram_ptr)
 
 // Initialize a metric variable in user class:
 // * macros METRIC_VAR_INIT* could be used to initialize metric variables in member initializer
@@ -201,6 +215,7 @@ class error_code;
 #define METRIC_VAR_INIT_partition(name, ...) METRIC_VAR_INIT(name, partition, ##__VA_ARGS__)
 #define METRIC_VAR_INIT_backup_policy(name, ...) METRIC_VAR_INIT(name, backup_policy, ##__VA_ARGS__)
 #define METRIC_VAR_INIT_queue(name, ...) METRIC_VAR_INIT(name, queue, ##__VA_ARGS__)
+#define METRIC_VAR_INIT_duplication(name, ...) METRIC_VAR_INIT(name, duplication, ##__VA_ARGS__)
 #define METRIC_VAR_ASSIGN_profiler(name, ...) METRIC_VAR_ASSIGN(name, profiler, ##__VA_ARGS__)
 #define METRIC_VAR_INIT_latency_tracer(name, ...)                                                  \
     METRIC_VAR_INIT(name, latency_tracer, ##__VA_ARGS__)
@@ -229,18 +244,19 @@ class error_code;
 // Perform decrement() operations on gauges.
 #define METRIC_VAR_DECREMENT(name) METRIC_VAR_NAME(name)->decrement()
 
-// Perform set() operations on gauges and percentiles.
+// Perform set() operations on gauges, percentiles and histograms.
 //
 // There are 2 kinds of invocations of set() for a metric:
-// * set(val): set a single value for a metric, such as gauge, percentile;
+// * set(val): set a single value for a metric, such as gauge, percentile, histogram;
 // * set(n, val): set multiple repeated values (the number of duplicates is n) for a metric,
-// such as percentile.
+// such as percentile, histogram.
 #define METRIC_VAR_SET(name, ...) METRIC_VAR_NAME(name)->set(__VA_ARGS__)
 
 // Read the current measurement of gauges and counters.
 #define METRIC_VAR_VALUE(name) METRIC_VAR_NAME(name)->value()
 
-// Convenient macro that is used to compute latency automatically, which is dedicated to percentile.
+// Convenient macro that is used to compute latency automatically, which is dedicated to percentile
+// and histogram.
 #define METRIC_VAR_AUTO_LATENCY(name, ...)                                                         \
     dsn::auto_latency __##name##_auto_latency(METRIC_VAR_NAME(name), ##__VA_ARGS__)
 
@@ -580,19 +596,24 @@ public:
     static const std::string kMetricsRootPath;
     static const std::string kMetricsQuerySubPath;
     static const std::string kMetricsQueryPath;
+    static const std::string kMetricsPrometheusSubPath;
 
     explicit metrics_http_service(metric_registry *registry);
     ~metrics_http_service() = default;
 
-    // There is only one API now whose URI is "/metrics", thus just make
-    // this URI as sub path while leaving the root path empty.
+    // The APIs are "/metrics" and "/metrics/prometheus", thus just make these URIs as sub paths
+    // while leaving the root path empty.
     std::string path() const override { return kMetricsRootPath; }
 
 private:
     friend void test_get_metrics_handler(const http_request &req, http_response &resp);
+    friend void test_get_prometheus_metrics_handler(const http_request &req, http_response &resp);
 
     void get_metrics_handler(const http_request &req, http_response &resp);
 
+    // Expose all metrics in Prometheus text exposition format.
+    void get_prometheus_metrics_handler(const http_request &req, http_response &resp);
+
     metric_registry *_registry;
 
     DISALLOW_COPY_AND_ASSIGN(metrics_http_service);
@@ -691,6 +712,11 @@ public:
 
     void take_snapshot(metric_json_writer &writer, const metric_filters &filters) const;
 
+    // Take snapshot of all metrics in Prometheus text exposition format, where the samples of the
+    // same metric from all entities are grouped together, each of which is labeled by the type,
+    // id and attributes of its entity.
+    std::string take_prometheus_snapshot() const;
+
 private:
     friend class metric_entity_prototype;
     friend class utils::singleton<metric_registry>;
@@ -758,7 +784,8 @@ private:
     DEF(Gauge)                                                                                     \
     DEF(Counter)                                                                                   \
     DEF(VolatileCounter)                                                                           \
-    DEF(Percentile)
+    DEF(Percentile)                                                                                \
+    DEF(Histogram)
 
 enum class metric_type
 {
@@ -811,7 +838,10 @@ ENUM_END(metric_type)
     DEF(FileLoads)                                                                                 \
     DEF(FileUploads)                                                                               \
     DEF(BulkLoads)                                                                                 \
-    DEF(Beacons)
+    DEF(Beacons)                                                                                   \
+    DEF(Contexts)                                                                                  \
+    DEF(Iterators)                                                                                 \
+    DEF(Allocations)
 
 enum class metric_unit : size_t
 {
@@ -931,6 +961,9 @@ const std::string kMetricNameField = "name";
 const std::string kMetricUnitField = "unit";
 const std::string kMetricDescField = "desc";
 const std::string kMetricSingleValueField = "value";
+const std::string kMetricCountField = "count";
+const std::string kMetricSumField = "sum";
+const std::string kMetricBucketsField = "buckets";
 
 // Base class for each type of metric.
 // Every metric class should inherit from this class.
@@ -950,10 +983,34 @@ public:
     // by `filters`.
     virtual void take_snapshot(metric_json_writer &writer, const metric_filters &filters) = 0;
 
+    // Append the samples of each metric to `out` in Prometheus text exposition format, each of
+    // which is labeled by `labels` (e.g. `entity="replica",id="1.2"`). A metric that could not
+    // be exposed to Prometheus will append nothing, which is also the default behaviour.
+    virtual void take_prometheus_snapshot(const std::string &labels, std::string &out) {}
+
 protected:
     explicit metric(const metric_prototype *prototype);
     virtual ~metric() = default;
 
+    // Append a sample of the metric as `<name><suffix>{<labels>,<extra_label>} <value>` to `out`,
+    // where `suffix` and `extra_label` are optional, such as "_bucket" and `le="1024"` for
+    // histograms.
+    template <typename T>
+    void append_prometheus_sample(std::string &out,
+                                  std::string_view suffix,
+                                  const std::string &labels,
+                                  std::string_view extra_label,
+                                  const T &value) const
+    {
+        out.append(fmt::format("{}{}{{{}{}{}}} {}\n",
+                               prototype()->name(),
+                               suffix,
+                               labels,
+                               labels.empty() || extra_label.empty() ? "" : ",",
+                               extra_label,
+                               value));
+    }
+
     // Encode a metric field specified by `field_name` as json format. However, once the field
     // are not chosen by `filters`, this function will do nothing.
     template <typename T>
@@ -1077,6 +1134,11 @@ public:
         writer.EndObject();
     }
 
+    void take_prometheus_snapshot(const std::string &labels, std::string &out) override
+    {
+        append_prometheus_sample(out, "", labels, "", value());
+    }
+
     void set(const value_type &val) { _value.store(val, std::memory_order_relaxed); }
 
     template <typename Int = value_type,
@@ -1194,6 +1256,15 @@ public:
         writer.EndObject();
     }
 
+    // A volatile counter is not exposed to Prometheus, since it would be reset once read, which
+    // would break the values fetched by other monitoring systems.
+    void take_prometheus_snapshot(const std::string &labels, std::string &out) override
+    {
+        if constexpr (!IsVolatile) {
+            append_prometheus_sample(out, "", labels, "", value());
+        }
+    }
+
     // NOTICE: x MUST be a non-negative integer.
     void increment_by(int64_t x)
     {
@@ -1391,6 +1462,23 @@ public:
         writer.EndObject();
     }
 
+    // A percentile is exposed to Prometheus as a summary with only quantiles, since neither the
+    // sum nor the count of the observations is recorded.
+    void take_prometheus_snapshot(const std::string &labels, std::string &out) override
+    {
+        for (size_t i = 0; i < static_cast<size_t>(kth_percentile_type::COUNT); ++i) {
+            if (!_kth_percentile_bitset.test(i)) {
+                continue;
+            }
+
+            append_prometheus_sample(out,
+                                     "",
+                                     labels,
+                                     fmt::format("quantile=\"{}\"", kAllKthPercentiles[i].decimal),
+                                     value(i));
+        }
+    }
+
     bool timer_enabled() const { return !!_timer; }
 
     uint64_t get_initial_delay_ms() const
@@ -1589,35 +1677,247 @@ template <typename T,
 using floating_percentile_prototype =
     metric_prototype_with<floating_percentile<T, NthElementFinder>>;
 
-// Compute latency automatically at the end of the scope, which is set to percentile which it has
-// bound to.
-class auto_latency
+// The log-linear buckets shared by all histograms, in the same way as HdrHistogram: each value
+// less than kHistogramSubBucketCount has its own bucket, while the values in [2^e, 2^(e+1)) are
+// counted into kHistogramSubBucketCount linear sub-buckets, thus the relative error is less than
+// 1 / kHistogramSubBucketCount (i.e. 6.25%). The values greater than kHistogramMaxValue (about
+// 36 minutes in nanoseconds) are counted into the last bucket, and the negative ones into the
+// first bucket.
+const int kHistogramSubBucketBits = 4;
+const uint64_t kHistogramSubBucketCount = 1ULL << kHistogramSubBucketBits;
+const int kHistogramMaxExponent = 40;
+const uint64_t kHistogramMaxValue = (1ULL << (kHistogramMaxExponent + 1)) - 1;
+const size_t kHistogramBucketCount =
+    kHistogramSubBucketCount * (kHistogramMaxExponent - kHistogramSubBucketBits + 2);
+
+// Get the index of the bucket which the value falls in.
+inline size_t histogram_bucket_index(int64_t value)
+{
+    if (value < static_cast<int64_t>(kHistogramSubBucketCount)) {
+        return value < 0 ? 0 : static_cast<size_t>(value);
+    }
+
+    if (static_cast<uint64_t>(value) > kHistogramMaxValue) {
+        return kHistogramBucketCount - 1;
+    }
+
+    const int exponent = 63 - __builtin_clzll(static_cast<uint64_t>(value));
+    const auto sub_bucket = static_cast<size_t>(value >> (exponent - kHistogramSubBucketBits)) -
+                            kHistogramSubBucketCount;
+    return kHistogramSubBucketCount * (exponent - kHistogramSubBucketBits + 1) + sub_bucket;
+}
+
+// Get the max value that could be counted into the bucket, which is used as the value of the
+// bucket (i.e. `le` in Prometheus).
+inline uint64_t histogram_bucket_upper_bound(size_t index)
+{
+    CHECK_LT(index, kHistogramBucketCount);
+    if (index < kHistogramSubBucketCount) {
+        return index;
+    }
+
+    const int exponent =
+        static_cast<int>(index / kHistogramSubBucketCount) + kHistogramSubBucketBits - 1;
+    const uint64_t sub_bucket = kHistogramSubBucketCount + index % kHistogramSubBucketCount;
+    return ((sub_bucket + 1) << (exponent - kHistogramSubBucketBits)) - 1;
+}
+
+// The buckets of a histogram in json format, i.e. the pairs of [upper_bound, count] for all
+// non-empty buckets in ascending order of upper bounds.
+using metric_histogram_buckets = std::vector<std::vector<uint64_t>>;
+
+// The buckets merged from the histograms of multiple entities, which maps upper bound to count.
+using metric_merged_histogram_buckets = std::map<uint64_t, uint64_t>;
+
+// Merge the buckets of a histogram (e.g. of a replica) into `to` (e.g. of a table or a cluster).
+// Return false if `from` is malformed.
+bool merge_histogram_buckets(const metric_histogram_buckets &from,
+                             metric_merged_histogram_buckets &to);
+
+// Get the observations between 2 samples of the cumulative buckets (e.g. of a replica). A bucket
+// whose count decreases between both samples (e.g. the replica was reopened) is taken as a new one.
+metric_merged_histogram_buckets diff_histogram_buckets(const metric_merged_histogram_buckets &start,
+                                                       const metric_merged_histogram_buckets &end);
+
+// Compute the kth percentile over the merged buckets, i.e. the upper bound of the bucket which
+// the kth percentile falls in. Return 0 if there is not any observation.
+uint64_t histogram_kth_percentile(const metric_merged_histogram_buckets &buckets,
+                                  kth_percentile_type type);
+
+// The histogram is a metric type that counts all observations into the log-linear buckets above,
+// which is mainly used for latencies.
+//
+// Unlike the percentile which samples observations, the bucket counts of histograms of different
+// entities (e.g. all replicas of a table, or all servers of a cluster) could be merged by addition
+// since all of them share the same buckets, from which the kth percentiles over all of these
+// entities could be computed correctly (see merge_histogram_buckets() and
+// histogram_kth_percentile()). Both the json snapshot and Prometheus exposition provide the
+// cumulative bucket counts since the histogram is created.
+//
+// Each thread updates its own stripe of buckets without any lock. The stripes are allocated
+// lazily once they are updated, thus a histogram that is always updated by the same thread (e.g.
+// the one executing the requests of a replica) consumes only one stripe (about 5 KB).
+//
+// Meanwhile, like the percentile, the configured kth percentiles over the observations during
+// each interval are also computed periodically, so that a histogram could be used in place of a
+// percentile without breaking the consumers of kth percentiles.
+class histogram : public closeable_metric
 {
 public:
-    auto_latency(const percentile_ptr<int64_t> &p) : _percentile(p) {}
+    using value_type = int64_t;
+
+    void set(const value_type &val) { set(1, val); }
+
+    // Set the same value for n times, see also percentile::set(n, val).
+    void set(size_t n, const value_type &val)
+    {
+        auto *s = get_stripe();
+        s->counts[histogram_bucket_index(val)].fetch_add(n, std::memory_order_relaxed);
+        s->sum.fetch_add(val * static_cast<value_type>(n), std::memory_order_relaxed);
+    }
+
+    // If `type` is not configured, it will return false with zero value stored in `val`;
+    // otherwise, it will always return true with the value corresponding to `type`.
+    bool get(kth_percentile_type type, value_type &val) const
+    {
+        const auto index = static_cast<size_t>(type);
+        CHECK_LT(index, static_cast<size_t>(kth_percentile_type::COUNT));
+
+        val = value(index);
+        return _kth_percentile_bitset.test(index);
+    }
+
+    // The cumulative count of each bucket since the histogram is created, indexed by
+    // histogram_bucket_index().
+    std::vector<uint64_t> bucket_counts() const;
 
-    auto_latency(const percentile_ptr<int64_t> &p, std::function<void(uint64_t)> callback)
-        : _percentile(p), _callback(std::move(callback))
+    // The sum of all observations since the histogram is created.
+    int64_t sum() const;
+
+    // The snapshot collected has following json format:
+    // {
+    //     "name": "<metric_name>",
+    //     "count": ...,
+    //     "sum": ...,
+    //     "buckets": [[<upper_bound>, <count>], ...],
+    //     "p50": ...,
+    //     "p90": ...,
+    //     ...
+    // }
+    // where "count", "sum" and "buckets" are cumulative since the histogram is created, with only
+    // non-empty buckets included, while each configured kth percentile is computed over the last
+    // interval, just the same as the percentile.
+    void take_snapshot(metric_json_writer &writer, const metric_filters &filters) override;
+
+    void take_prometheus_snapshot(const std::string &labels, std::string &out) override;
+
+    bool timer_enabled() const { return !!_timer; }
+
+    uint64_t get_initial_delay_ms() const
+    {
+        return timer_enabled() ? _timer->get_initial_delay_ms() : 0;
+    }
+
+protected:
+    // interval_ms is the interval between the computations for kth percentiles, see also the
+    // constructor of percentile.
+    histogram(const metric_prototype *prototype,
+              uint64_t interval_ms = 10000,
+              const std::set<kth_percentile_type> &kth_percentiles = kAllKthPercentileTypes);
+
+    ~histogram() override;
+
+private:
+    friend class metric_entity;
+    friend class ref_ptr<histogram>;
+    friend class MetricVarTest;
+
+    struct stripe
+    {
+        std::atomic<uint64_t> counts[kHistogramBucketCount];
+        std::atomic<int64_t> sum;
+    };
+
+    static const size_t kStripeCount = 8;
+
+    stripe *get_stripe()
+    {
+        auto &slot = _stripes[static_cast<size_t>(utils::get_current_tid()) % kStripeCount];
+        auto *s = slot.load(std::memory_order_acquire);
+        if (dsn_likely(s != nullptr)) {
+            return s;
+        }
+        return new_stripe(slot);
+    }
+
+    stripe *new_stripe(std::atomic<stripe *> &slot);
+
+    void close() override;
+
+    void wait() override;
+
+    void on_close();
+
+    value_type value(size_t index) const
     {
+        return _kth_values[index].load(std::memory_order_relaxed);
     }
 
-    auto_latency(const percentile_ptr<int64_t> &p, uint64_t start_time_ns)
-        : _percentile(p), _chrono(start_time_ns)
+    // Compute the kth percentiles over the observations since the last computation.
+    void compute_kth_percentiles();
+
+    std::atomic<stripe *> _stripes[kStripeCount];
+
+    // The bucket counts at the last computation, only accessed by the timer.
+    std::vector<uint64_t> _last_counts;
+
+    std::bitset<static_cast<size_t>(kth_percentile_type::COUNT)> _kth_percentile_bitset;
+    std::vector<std::atomic<value_type>> _kth_values;
+
+    std::unique_ptr<metric_timer> _timer;
+
+    DISALLOW_COPY_AND_ASSIGN(histogram);
+};
+
+using histogram_ptr = ref_ptr<histogram>;
+using histogram_prototype = metric_prototype_with<histogram>;
+
+// Compute latency automatically at the end of the scope, which is set to percentile or histogram
+// which it has bound to.
+class auto_latency
+{
+public:
+    template <typename MetricPtr>
+    auto_latency(const MetricPtr &p) { bind(p); }
+
+    template <typename MetricPtr>
+    auto_latency(const MetricPtr &p, std::function<void(uint64_t)> callback)
+        : _callback(std::move(callback))
     {
+        bind(p);
     }
 
-    auto_latency(const percentile_ptr<int64_t> &p,
+    template <typename MetricPtr>
+    auto_latency(const MetricPtr &p, uint64_t start_time_ns) : _chrono(start_time_ns) { bind(p); }
+
+    template <typename MetricPtr>
+    auto_latency(const MetricPtr &p,
                  uint64_t start_time_ns,
                  std::function<void(uint64_t)> callback)
-        : _percentile(p), _chrono(start_time_ns), _callback(std::move(callback))
+        : _chrono(start_time_ns), _callback(std::move(callback))
     {
+        bind(p);
     }
 
     ~auto_latency()
     {
-        auto latency =
-            convert_metric_latency_from_ns(_chrono.duration_ns(), _percentile->prototype()->unit());
-        _percentile->set(static_cast<int64_t>(latency));
+        const auto *prototype = _percentile ? _percentile->prototype() : _histogram->prototype();
+        auto latency = convert_metric_latency_from_ns(_chrono.duration_ns(), prototype->unit());
+        if (_percentile) {
+            _percentile->set(static_cast<int64_t>(latency));
+        } else {
+            _histogram->set(static_cast<int64_t>(latency));
+        }
 
         if (_callback) {
             _callback(latency);
@@ -1627,7 +1927,12 @@ public:
     inline uint64_t duration_ns() const { return _chrono.duration_ns(); }
 
 private:
+    void bind(const percentile_ptr<int64_t> &p) { _percentile = p; }
+
+    void bind(const histogram_ptr &h) { _histogram = h; }
+
     percentile_ptr<int64_t> _percentile;
+    histogram_ptr _histogram;
     utils::chronograph _chrono;
     std::function<void(uint64_t)> _callback;
 
@@ -1704,6 +2009,21 @@ DEF_ALL_METRIC_BRIEF_SNAPSHOTS(value);
 
 DEF_ALL_METRIC_BRIEF_SNAPSHOTS(p99);
 
+// The brief snapshot of a histogram, which could be merged with the ones of other entities by
+// merge_histogram_buckets().
+struct metric_brief_buckets_snapshot
+{
+    std::string name;
+    uint64_t count = 0;
+    int64_t sum = 0;
+    metric_histogram_buckets buckets;
+
+    DEFINE_JSON_SERIALIZATION(name, count, sum, buckets)
+};
+
+DEF_METRIC_ENTITY_BRIEF_SNAPSHOT(buckets);
+DEF_METRIC_QUERY_BRIEF_SNAPSHOT(buckets);
+
 // Deserialize the json string into the snapshot.
 template <typename TMetricSnapshot>
 inline error_s deserialize_metric_snapshot(const std::string &json_string,
@@ -33,6 +33,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <ctime>
 #include <functional>
@@ -100,12 +101,21 @@ DSN_DEFINE_validator(stderr_start_level, [](const char *value) -> bool {
 
 DSN_DEFINE_string(tools.simple_logger, base_name, "pegasus", "The default base name for log file");
 
+DSN_DEFINE_uint32(tools.async_logger,
+                  ring_capacity,
+                  64 * 1024,
+                  "The maximum number of log lines buffered in memory by async_logger, which must "
+                  "be a power of 2. The lines below LOG_LEVEL_ERROR are dropped once exceeded");
+DSN_DEFINE_validator(ring_capacity, [](uint32_t value) -> bool {
+    return value > 0 && (value & (value - 1)) == 0;
+});
+
 DSN_DECLARE_string(logging_start_level);
 
 namespace dsn {
 namespace tools {
 namespace {
-int print_header(FILE *fp, log_level_t stderr_start_level, log_level_t log_level)
+std::string format_header(log_level_t log_level)
 {
     // The leading character of each log line, corresponding to the log level
     // D: Debug
@@ -120,8 +130,18 @@ int print_header(FILE *fp, log_level_t stderr_start_level, log_level_t log_level
     dsn::utils::time_ms_to_string(ts / 1000000, time_str);
 
     int tid = dsn::utils::get_current_tid();
-    const auto header = fmt::format(
+    return fmt::format(
         "{}{} ({} {}) {}", s_level_char[log_level], time_str, ts, tid, log_prefixed_message_func());
+}
+
+std::string format_long_header(const char *file, const char *function, const int line)
+{
+    return fmt::format("{}:{}:{}(): ", file, line, function);
+}
+
+int print_header(FILE *fp, log_level_t stderr_start_level, log_level_t log_level)
+{
+    const auto header = format_header(log_level);
     const int written_size = fmt::fprintf(fp, "%s", header.c_str());
     if (log_level >= stderr_start_level) {
         fmt::fprintf(stderr, "%s", header.c_str());
@@ -141,7 +161,7 @@ int print_long_header(FILE *fp,
         return 0;
     }
 
-    const auto long_header = fmt::format("{}:{}:{}(): ", file, line, function);
+    const auto long_header = format_long_header(file, function, line);
     const int written_size = fmt::fprintf(fp, "%s", long_header.c_str());
     if (log_level >= stderr_start_level) {
         fmt::fprintf(stderr, "%s", long_header.c_str());
@@ -176,6 +196,21 @@ inline void process_fatal_log(log_level_t log_level)
     }
 }
 
+// The maximum number of lines written by async_logger in a batch, before checking whether
+// to flush.
+const size_t kMaxBatchRecords = 1024;
+
+// The maximum interval to check whether there are lines to be written by async_logger, in
+// case the wakeup is missed.
+const auto kConsumerWaitInterval = std::chrono::milliseconds(10);
+
+// Whether current thread is the background thread of async_logger.
+thread_local bool is_consumer_thread = false;
+
+// The buffer to format the lines, which is swapped with the one in the ring on pushing, so
+// that the buffers are reused without allocation.
+thread_local std::string line_buffer;
+
 } // anonymous namespace
 
 screen_logger::screen_logger(const char *, const char *)
@@ -222,9 +257,9 @@ void screen_logger::flush() { ::fflush(stdout); }
 
 simple_logger::simple_logger(const char *log_dir, const char *role_name)
     : logging_provider(enum_from_string(FLAGS_stderr_start_level, LOG_LEVEL_INVALID)),
-      _log_dir(std::string(log_dir)),
       _log(nullptr),
-      _file_bytes(0)
+      _file_bytes(0),
+      _log_dir(std::string(log_dir))
 {
     // Use 'role_name' if it is specified, otherwise use 'base_name'.
     const std::string symlink_name(
@@ -423,5 +458,217 @@ void simple_logger::log(
     }
 }
 
+async_logger::async_logger(const char *log_dir, const char *role_name)
+    : simple_logger(log_dir, role_name),
+      _mask(FLAGS_ring_capacity - 1),
+      _records(new record[FLAGS_ring_capacity]),
+      _push_pos(0),
+      _pop_pos(0),
+      _reported_dropped_records(0),
+      _dropped_records(0),
+      _consumer_waiting(false),
+      _flush_requested_pos(0),
+      _flushed_pos(0),
+      _stopping(false)
+{
+    for (uint64_t i = 0; i <= _mask; ++i) {
+        _records[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    _consumer = std::thread([this]() {
+        is_consumer_thread = true;
+        consume();
+    });
+}
+
+async_logger::~async_logger()
+{
+    {
+        std::lock_guard<std::mutex> l(_mtx);
+        _stopping = true;
+    }
+    _consumer_cv.notify_one();
+    _consumer.join();
+}
+
+void async_logger::log(
+    const char *file, const char *function, const int line, log_level_t log_level, const char *str)
+{
+    if (dsn_unlikely(is_consumer_thread)) {
+        // Logged by the background thread itself, e.g. failed to create a new log file, just
+        // write it to stderr since the background thread could not wait for itself.
+        fmt::print(stderr,
+                   "{}{}{}\n",
+                   format_header(log_level),
+                   format_long_header(file, function, line),
+                   str);
+        process_fatal_log(log_level);
+        return;
+    }
+
+    auto &buf = line_buffer;
+    buf.clear();
+    buf.append(format_header(log_level));
+    if (!FLAGS_short_header) {
+        buf.append(format_long_header(file, function, line));
+    }
+    buf.append(str);
+    buf.push_back('\n');
+
+    // The ERROR and FATAL lines are never dropped, and they must be durable before return,
+    // especially before coredump for the FATAL ones.
+    const bool durable = log_level >= LOG_LEVEL_ERROR;
+    uint64_t pos = 0;
+    while (!try_push(log_level, buf, pos)) {
+        if (!durable) {
+            _dropped_records.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        _consumer_cv.notify_one();
+        std::this_thread::yield();
+    }
+
+    if (_consumer_waiting.load(std::memory_order_relaxed)) {
+        _consumer_cv.notify_one();
+    }
+
+    if (durable) {
+        wait_flushed(pos + 1);
+    }
+
+    process_fatal_log(log_level);
+}
+
+void async_logger::flush()
+{
+    if (!is_consumer_thread) {
+        wait_flushed(_push_pos.load(std::memory_order_relaxed));
+    }
+    ::fflush(stderr);
+    ::fflush(stdout);
+}
+
+bool async_logger::try_push(log_level_t log_level, std::string &line, uint64_t &pos)
+{
+    record *r = nullptr;
+    pos = _push_pos.load(std::memory_order_relaxed);
+    while (true) {
+        r = &_records[pos & _mask];
+        const uint64_t seq = r->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+        if (diff == 0) {
+            // 'pos' would be reloaded on failure.
+            if (_push_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The ring is full.
+            return false;
+        } else {
+            pos = _push_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    r->log_level = log_level;
+    r->line.swap(line);
+    r->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+async_logger::record *async_logger::front()
+{
+    record *r = &_records[_pop_pos & _mask];
+    if (r->sequence.load(std::memory_order_acquire) != _pop_pos + 1) {
+        return nullptr;
+    }
+    return r;
+}
+
+void async_logger::pop()
+{
+    _records[_pop_pos & _mask].sequence.store(_pop_pos + _mask + 1, std::memory_order_release);
+    ++_pop_pos;
+}
+
+void async_logger::consume()
+{
+    while (true) {
+        bool error_written = false;
+        const size_t count = write_records(error_written);
+
+        std::unique_lock<std::mutex> l(_mtx);
+        const bool flush_requested =
+            _flush_requested_pos > _flushed_pos && _pop_pos >= _flush_requested_pos;
+        // Also flush once all the lines are written, thus the lines would not stay in the
+        // stdio buffer for long while the logging is not busy.
+        if (flush_requested || FLAGS_fast_flush || error_written ||
+            (count == 0 && _flushed_pos < _pop_pos)) {
+            ::fflush(_log);
+            _flushed_pos = _pop_pos;
+            _flushed_cv.notify_all();
+        }
+
+        if (count > 0) {
+            continue;
+        }
+
+        if (_stopping) {
+            break;
+        }
+
+        _consumer_waiting.store(true, std::memory_order_relaxed);
+        _consumer_cv.wait_for(l, kConsumerWaitInterval);
+        _consumer_waiting.store(false, std::memory_order_relaxed);
+    }
+}
+
+size_t async_logger::write_records(bool &error_written)
+{
+    size_t count = 0;
+    record *r = nullptr;
+    while (count < kMaxBatchRecords && (r = front()) != nullptr) {
+        write_line(r->line, r->log_level);
+        error_written = error_written || r->log_level >= LOG_LEVEL_ERROR;
+        pop();
+        ++count;
+    }
+
+    const auto dropped_records = _dropped_records.load(std::memory_order_relaxed);
+    if (dsn_unlikely(dropped_records != _reported_dropped_records)) {
+        write_line(fmt::format("{}{} log lines have been dropped since the buffer is full\n",
+                               format_header(LOG_LEVEL_WARNING),
+                               dropped_records - _reported_dropped_records),
+                   LOG_LEVEL_WARNING);
+        _reported_dropped_records = dropped_records;
+    }
+
+    return count;
+}
+
+void async_logger::write_line(const std::string &line, log_level_t log_level)
+{
+    add_bytes_if_valid(static_cast<int>(::fwrite(line.data(), 1, line.size(), _log)));
+    if (log_level >= _stderr_start_level) {
+        ::fwrite(line.data(), 1, line.size(), stderr);
+    }
+
+    if (_file_bytes >= FLAGS_max_log_file_bytes) {
+        create_log_file();
+    }
+}
+
+void async_logger::wait_flushed(uint64_t pos)
+{
+    std::unique_lock<std::mutex> l(_mtx);
+    if (_flushed_pos >= pos) {
+        return;
+    }
+
+    _flush_requested_pos = std::max(_flush_requested_pos, pos);
+    _consumer_cv.notify_one();
+    _flushed_cv.wait(l, [this, pos]() { return _flushed_pos >= pos || _stopping; });
+}
+
 } // namespace tools
 } // namespace dsn
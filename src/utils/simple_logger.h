@@ -26,9 +26,14 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdio>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 #include "utils/api_utilities.h"
 #include "utils/logging_provider.h"
@@ -87,14 +92,7 @@ public:
 
     void flush() override;
 
-private:
-    void print_header(log_level_t log_level);
-    void print_long_header(const char *file,
-                           const char *function,
-                           const int line,
-                           log_level_t log_level);
-    void print_body(const char *body, log_level_t log_level);
-
+protected:
     inline void add_bytes_if_valid(int bytes)
     {
         if (dsn_likely(bytes > 0)) {
@@ -102,7 +100,22 @@ private:
         }
     }
 
+    // Close the current log file (if any) and open a new one.
     void create_log_file();
+
+    // The current log file descriptor.
+    FILE *_log;
+    // The byte size of the current log file.
+    uint64_t _file_bytes;
+
+private:
+    void print_header(log_level_t log_level);
+    void print_long_header(const char *file,
+                           const char *function,
+                           const int line,
+                           log_level_t log_level);
+    void print_body(const char *body, log_level_t log_level);
+
     void remove_redundant_files();
 
 private:
@@ -115,10 +128,73 @@ private:
     // The prefix of the log file names. The actual log files are prefixed by '_file_name_prefix'
     // and postfixed by timestamp.
     std::string _file_name_prefix;
-    // The current log file descriptor.
-    FILE *_log;
-    // The byte size of the current log file.
-    uint64_t _file_bytes;
+};
+
+/*
+ * async_logger provides a logger which writes to file as simple_logger does, while the log
+ * lines are formatted by the calling threads, pushed into a bounded lock-free ring and
+ * written by a background thread in batches, so that the calling threads never contend on
+ * the file. Once the ring is full, the lines below LOG_LEVEL_ERROR are dropped and counted,
+ * while the ERROR and FATAL lines are waited until flushed to the file.
+ */
+class async_logger : public simple_logger
+{
+public:
+    async_logger(const char *log_dir, const char *role_name);
+    ~async_logger() override;
+
+    void log(const char *file,
+             const char *function,
+             const int line,
+             log_level_t log_level,
+             const char *str) override;
+
+    // Wait until all the lines logged before are written and flushed to the file.
+    void flush() override;
+
+    uint64_t dropped_records() const { return _dropped_records.load(std::memory_order_relaxed); }
+
+private:
+    struct record
+    {
+        std::atomic<uint64_t> sequence;
+        log_level_t log_level;
+        std::string line;
+    };
+
+    // Bounded MPSC ring, see https://www.1024cores.net/home/lock-free-algorithms/queues.
+    // The line is swapped into the ring, so that the buffers are reused by the callers.
+    bool try_push(log_level_t log_level, std::string &line, uint64_t &pos);
+    record *front();
+    void pop();
+
+    // Write the lines in the ring in batches, run by the background thread.
+    void consume();
+    size_t write_records(bool &error_written);
+    void write_line(const std::string &line, log_level_t log_level);
+
+    // Wait until the lines before 'pos' are flushed.
+    void wait_flushed(uint64_t pos);
+
+    const uint64_t _mask;
+    std::unique_ptr<record[]> _records;
+    std::atomic<uint64_t> _push_pos;
+    // Only accessed by the background thread.
+    uint64_t _pop_pos;
+    uint64_t _reported_dropped_records;
+
+    std::atomic<uint64_t> _dropped_records;
+    std::atomic<bool> _consumer_waiting;
+
+    std::mutex _mtx;
+    std::condition_variable _consumer_cv;
+    std::condition_variable _flushed_cv;
+    // The following are protected by '_mtx'.
+    uint64_t _flush_requested_pos;
+    uint64_t _flushed_pos;
+    bool _stopping;
+
+    std::thread _consumer;
 };
 } // namespace tools
 } // namespace dsn
@@ -0,0 +1,160 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <fmt/core.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "runtime/api_layer1.h"
+#include "utils/crc.h"
+#include "utils/rand.h"
+#include "utils/string_conv.h"
+#include "utils/strings.h"
+
+void print_usage(const char *cmd)
+{
+    fmt::print("USAGE: {} <total_bytes> [sizes]\n", cmd);
+    fmt::print("Run a simple benchmark that compares the table-driven and the hardware-\n"
+               "accelerated implementations of crc32 and crc64.\n\n");
+
+    fmt::print("    <total_bytes>          the total bytes computed for each message size.\n");
+    fmt::print("    [sizes]                the message size list, separated by comma(,) if more\n"
+               "                           than one element, e.g., \"16,4096\"; if this arg is\n"
+               "                           missing, 16B, 64B, 256B, 1KB, 4KB, 64KB and 1MB will\n"
+               "                           be used.\n");
+}
+
+template <typename TCrc>
+int64_t run_crc(const std::vector<uint8_t> &buffer,
+                size_t size,
+                uint64_t total_bytes,
+                const std::function<TCrc(const void *, size_t, TCrc)> &calc,
+                TCrc &crc)
+{
+    const size_t num_operations = std::max<uint64_t>(total_bytes / size, 1);
+    const size_t num_slots = buffer.size() / size;
+
+    auto start = dsn_now_ns();
+    for (size_t i = 0; i < num_operations; ++i) {
+        crc = calc(buffer.data() + (i % num_slots) * size, size, crc);
+    }
+    auto end = dsn_now_ns();
+
+    return static_cast<int64_t>(end - start);
+}
+
+template <typename TCrc>
+void run_bench(const std::string &name,
+               const std::vector<uint8_t> &buffer,
+               size_t size,
+               uint64_t total_bytes,
+               const std::function<TCrc(const void *, size_t, TCrc)> &table_calc,
+               const std::function<TCrc(const void *, size_t, TCrc)> &hw_calc)
+{
+    TCrc table_crc = 0;
+    TCrc hw_crc = 0;
+    auto table_ns = run_crc(buffer, size, total_bytes, table_calc, table_crc);
+    auto hw_ns = run_crc(buffer, size, total_bytes, hw_calc, hw_crc);
+    if (table_crc != hw_crc) {
+        fmt::print(stderr, "{}: table_crc({:#x}) != hw_crc({:#x})\n", name, table_crc, hw_crc);
+        ::exit(-1);
+    }
+
+    auto throughput = [total_bytes](int64_t ns) {
+        return ns == 0 ? 0.0 : static_cast<double>(total_bytes) * 1000 / ns;
+    };
+    fmt::print("{:<6} {:>10} {:>16.1f} {:>16.1f} {:>10.2f}\n",
+               name,
+               size,
+               throughput(table_ns),
+               throughput(hw_ns),
+               hw_ns == 0 ? 0.0 : static_cast<double>(table_ns) / hw_ns);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    uint64_t total_bytes;
+    if (!dsn::buf2uint64(argv[1], total_bytes) || total_bytes == 0) {
+        fmt::print(stderr, "Invalid total_bytes: {}\n\n", argv[1]);
+
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    std::vector<size_t> sizes;
+    if (argc >= 3) {
+        std::vector<std::string> size_strs;
+        dsn::utils::split_args(argv[2], size_strs, ',');
+        for (const auto &s : size_strs) {
+            uint64_t size;
+            if (!dsn::buf2uint64(s, size) || size == 0) {
+                fmt::print(stderr, "Invalid size: {}\n\n", s);
+
+                print_usage(argv[0]);
+                ::exit(-1);
+            }
+            sizes.push_back(size);
+        }
+    } else {
+        sizes = {16, 64, 256, 1024, 4096, 64 * 1024, 1024 * 1024};
+    }
+
+    size_t max_size = *std::max_element(sizes.begin(), sizes.end());
+    // Use a buffer larger than the L2 cache to make the large messages computed from memory.
+    std::vector<uint8_t> buffer(std::max<size_t>(max_size, 16 * 1024 * 1024));
+    for (auto &b : buffer) {
+        b = static_cast<uint8_t>(dsn::rand::next_u32(0, 255));
+    }
+
+    fmt::print("crc32 hardware supported: {}, crc64 hardware supported: {}\n",
+               dsn::utils::crc32_hw_supported(),
+               dsn::utils::crc64_hw_supported());
+    fmt::print("{:<6} {:>10} {:>16} {:>16} {:>10}\n",
+               "crc",
+               "size(B)",
+               "table(MB/s)",
+               "hardware(MB/s)",
+               "speedup");
+    for (auto size : sizes) {
+        run_bench<uint32_t>("crc32",
+                            buffer,
+                            size,
+                            total_bytes,
+                            dsn::utils::crc32_calc_table,
+                            dsn::utils::crc32_calc_hw);
+    }
+    for (auto size : sizes) {
+        run_bench<uint64_t>("crc64",
+                            buffer,
+                            size,
+                            total_bytes,
+                            dsn::utils::crc64_calc_table,
+                            dsn::utils::crc64_calc_hw);
+    }
+
+    return 0;
+}
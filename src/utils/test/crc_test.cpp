@@ -0,0 +1,94 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "utils/crc.h"
+#include "utils/rand.h"
+
+namespace dsn {
+namespace utils {
+
+TEST(crc_test, check_value)
+{
+    const char *data = "123456789";
+    ASSERT_EQ(0xe3069283, crc32_calc_table(data, 9, 0));
+    ASSERT_EQ(0xe3069283, crc32_calc_hw(data, 9, 0));
+    ASSERT_EQ(0xe3069283, crc32_calc(data, 9, 0));
+
+    ASSERT_EQ(0xae8b14860a799888, crc64_calc_table(data, 9, 0));
+    ASSERT_EQ(0xae8b14860a799888, crc64_calc_hw(data, 9, 0));
+    ASSERT_EQ(0xae8b14860a799888, crc64_calc(data, 9, 0));
+}
+
+TEST(crc_test, hw_equals_table)
+{
+    std::vector<uint8_t> buffer(64 * 1024 + 16);
+    for (auto &b : buffer) {
+        b = static_cast<uint8_t>(rand::next_u32(0, 255));
+    }
+
+    // Cover the unaligned heads, the short tails and the interleaved/folded bodies.
+    std::vector<size_t> sizes;
+    for (size_t size = 0; size <= 256; ++size) {
+        sizes.push_back(size);
+    }
+    for (size_t size : {1023, 1024, 3071, 3072, 3073, 4096, 6144 + 7, 16 * 1024, 64 * 1024}) {
+        sizes.push_back(size);
+    }
+
+    for (size_t offset = 0; offset < 16; ++offset) {
+        for (size_t size : sizes) {
+            const uint8_t *data = buffer.data() + offset;
+            const uint32_t init32 = rand::next_u32();
+            const uint64_t init64 = rand::next_u64();
+            ASSERT_EQ(crc32_calc_table(data, size, init32), crc32_calc_hw(data, size, init32))
+                << "offset = " << offset << ", size = " << size;
+            ASSERT_EQ(crc64_calc_table(data, size, init64), crc64_calc_hw(data, size, init64))
+                << "offset = " << offset << ", size = " << size;
+        }
+    }
+}
+
+TEST(crc_test, concat)
+{
+    std::vector<uint8_t> buffer(10000);
+    for (auto &b : buffer) {
+        b = static_cast<uint8_t>(rand::next_u32(0, 255));
+    }
+
+    for (size_t x_size : {0, 1, 15, 64, 4000}) {
+        const size_t y_size = buffer.size() - x_size;
+        const uint8_t *y = buffer.data() + x_size;
+
+        auto x32 = crc32_calc(buffer.data(), x_size, 0);
+        auto y32 = crc32_calc(y, y_size, 0);
+        ASSERT_EQ(crc32_calc(buffer.data(), buffer.size(), 0),
+                  crc32_concat(0, 0, x32, x_size, 0, y32, y_size));
+
+        auto x64 = crc64_calc(buffer.data(), x_size, 0);
+        auto y64 = crc64_calc(y, y_size, 0);
+        ASSERT_EQ(crc64_calc(buffer.data(), buffer.size(), 0),
+                  crc64_concat(0, 0, x64, x_size, 0, y64, y_size));
+    }
+}
+
+} // namespace utils
+} // namespace dsn
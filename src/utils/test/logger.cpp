@@ -26,6 +26,7 @@
 
 #include <fmt/core.h>
 #include <unistd.h>
+#include <fstream>
 #include <memory>
 #include <regex>
 #include <set>
@@ -41,6 +42,7 @@
 #include "utils/simple_logger.h"
 #include "utils/test_macros.h"
 
+DSN_DECLARE_uint32(ring_capacity);
 DSN_DECLARE_uint64(max_number_of_log_files_on_disk);
 
 namespace dsn {
@@ -119,6 +121,22 @@ public:
         ASSERT_TRUE(dsn::utils::filesystem::create_directory(test_dir)) << test_dir;
     }
 
+    // Count the lines containing 'str' in the latest log file of 'role_name'.
+    void count_lines(const std::string &role_name, const std::string &str, uint64_t &count)
+    {
+        std::ifstream in(
+            utils::filesystem::path_combine(test_dir, fmt::format("{}.log", role_name)));
+        ASSERT_TRUE(in.is_open());
+
+        count = 0;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.find(str) != std::string::npos) {
+                ++count;
+            }
+        }
+    }
+
     void remove_test_dir()
     {
         ASSERT_TRUE(dsn::utils::filesystem::remove_path(test_dir)) << test_dir;
@@ -166,5 +184,49 @@ TEST_F(logger_test, redundant_log_test)
     ASSERT_EQ(FLAGS_max_number_of_log_files_on_disk, files.size());
 }
 
+TEST_F(logger_test, async_logger_test)
+{
+    auto logger = std::make_unique<async_logger>(test_dir.c_str(), "AsyncLogger");
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&logger]() {
+            for (int j = 0; j < 1000; ++j) {
+                LOG_PRINT(logger.get(), "{}", "test_print");
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    logger->flush();
+
+    // Nothing is dropped since the ring is large enough.
+    ASSERT_EQ(0u, logger->dropped_records());
+    uint64_t count = 0;
+    NO_FATALS(count_lines("AsyncLogger", "test_print", count));
+    ASSERT_EQ(4000u, count);
+}
+
+TEST_F(logger_test, async_logger_drop_test)
+{
+    const auto ring_capacity = FLAGS_ring_capacity;
+    FLAGS_ring_capacity = 2;
+    auto logger = std::make_unique<async_logger>(test_dir.c_str(), "AsyncLogger");
+    FLAGS_ring_capacity = ring_capacity;
+
+    for (int i = 0; i < 1000; ++i) {
+        LOG_PRINT(logger.get(), "{}", "test_print");
+    }
+    // The ERROR lines are never dropped and are flushed before return.
+    logger->log(__FILE__, __FUNCTION__, __LINE__, LOG_LEVEL_ERROR, "test_error");
+    uint64_t count = 0;
+    NO_FATALS(count_lines("AsyncLogger", "test_error", count));
+    ASSERT_EQ(1u, count);
+
+    logger->flush();
+    NO_FATALS(count_lines("AsyncLogger", "test_print", count));
+    ASSERT_EQ(1000u, count + logger->dropped_records());
+}
+
 } // namespace tools
 } // namespace dsn
@@ -177,6 +177,16 @@ METRIC_DEFINE_percentile_double(my_server,
                                 dsn::metric_unit::kNanoSeconds,
                                 "a server-level percentile of double type for test");
 
+METRIC_DEFINE_histogram_int64(my_server,
+                              test_server_histogram_int64,
+                              dsn::metric_unit::kNanoSeconds,
+                              "a server-level histogram of int64 type for test");
+
+METRIC_DEFINE_histogram_int64(my_replica,
+                              test_replica_histogram_int64_us,
+                              dsn::metric_unit::kMicroSeconds,
+                              "a replica-level histogram of int64 type in microseconds for test");
+
 METRIC_DEFINE_percentile_int64(my_replica,
                                test_replica_percentile_int64_ns,
                                dsn::metric_unit::kNanoSeconds,
@@ -1454,6 +1464,157 @@ TEST(metrics_test, take_snapshot_percentile_double)
                                        compare_floating_metric_value_map);
 }
 
+TEST(metrics_test, histogram_bucket)
+{
+    // Each value less than the number of sub-buckets has its own bucket.
+    for (int64_t value = 0; value < static_cast<int64_t>(kHistogramSubBucketCount); ++value) {
+        ASSERT_EQ(static_cast<size_t>(value), histogram_bucket_index(value));
+        ASSERT_EQ(static_cast<uint64_t>(value), histogram_bucket_upper_bound(value));
+    }
+
+    ASSERT_EQ(0, histogram_bucket_index(-1));
+    ASSERT_EQ(kHistogramBucketCount - 1, histogram_bucket_index(kHistogramMaxValue));
+    ASSERT_EQ(kHistogramBucketCount - 1, histogram_bucket_index(INT64_MAX));
+    ASSERT_EQ(kHistogramMaxValue, histogram_bucket_upper_bound(kHistogramBucketCount - 1));
+
+    // The buckets are contiguous, and each value falls in the bucket whose upper bound is not
+    // less than it with the relative error less than 1 / kHistogramSubBucketCount.
+    for (size_t i = 1; i < kHistogramBucketCount; ++i) {
+        const auto lower_bound = histogram_bucket_upper_bound(i - 1) + 1;
+        const auto upper_bound = histogram_bucket_upper_bound(i);
+        ASSERT_LE(lower_bound, upper_bound);
+        ASSERT_EQ(i, histogram_bucket_index(static_cast<int64_t>(lower_bound)));
+        ASSERT_EQ(i, histogram_bucket_index(static_cast<int64_t>(upper_bound)));
+        ASSERT_LT(static_cast<double>(upper_bound - lower_bound) / lower_bound,
+                  1.0 / kHistogramSubBucketCount);
+    }
+}
+
+TEST(metrics_test, histogram_merge)
+{
+    metric_merged_histogram_buckets merged;
+    ASSERT_EQ(0, histogram_kth_percentile(merged, kth_percentile_type::P99));
+
+    // The buckets of 2 replicas: one is busy and fast while the other is idle and slow.
+    ASSERT_TRUE(merge_histogram_buckets({{10, 150}, {100, 40}}, merged));
+    ASSERT_TRUE(merge_histogram_buckets({{100, 9}, {1000, 1}}, merged));
+
+    const metric_histogram_buckets malformed = {std::vector<uint64_t>{10}};
+    ASSERT_FALSE(merge_histogram_buckets(malformed, merged));
+
+    ASSERT_EQ(3, merged.size());
+    ASSERT_EQ(49, merged[100]);
+    ASSERT_EQ(10, histogram_kth_percentile(merged, kth_percentile_type::P50));
+    ASSERT_EQ(100, histogram_kth_percentile(merged, kth_percentile_type::P90));
+    ASSERT_EQ(100, histogram_kth_percentile(merged, kth_percentile_type::P99));
+    ASSERT_EQ(1000, histogram_kth_percentile(merged, kth_percentile_type::P999));
+}
+
+TEST(metrics_test, histogram_diff)
+{
+    ASSERT_TRUE(diff_histogram_buckets({}, {}).empty());
+
+    // Without the starting sample, all observations of the ending sample are kept.
+    const metric_merged_histogram_buckets end = {{10, 5}, {100, 3}, {1000, 1}};
+    ASSERT_EQ(end, diff_histogram_buckets({}, end));
+
+    // Only the observations between both samples are kept, while the bucket whose count
+    // decreases is taken as a new one.
+    const metric_merged_histogram_buckets start = {{10, 2}, {100, 3}, {1000, 4}, {10000, 1}};
+    const metric_merged_histogram_buckets expected = {{10, 3}, {1000, 1}};
+    ASSERT_EQ(expected, diff_histogram_buckets(start, end));
+}
+
+TEST(metrics_test, histogram_int64)
+{
+    auto my_server_entity = METRIC_ENTITY_my_server.instantiate("histogram_server");
+    const uint64_t interval_ms = 50;
+    auto my_metric = METRIC_test_server_histogram_int64.instantiate(
+        my_server_entity, interval_ms, std::set<kth_percentile_type>{kth_percentile_type::P50});
+    ASSERT_TRUE(my_metric->timer_enabled());
+
+    // Observations from multiple threads are all counted.
+    execute(4, [&my_metric](int) {
+        for (int64_t i = 1; i <= 1000; ++i) {
+            my_metric->set(i);
+        }
+    });
+    my_metric->set(10, 2000);
+
+    auto counts = my_metric->bucket_counts();
+    ASSERT_EQ(kHistogramBucketCount, counts.size());
+    uint64_t total = 0;
+    for (const auto &count : counts) {
+        total += count;
+    }
+    ASSERT_EQ(4010, total);
+    ASSERT_EQ(10, counts[histogram_bucket_index(2000)]);
+    ASSERT_EQ(4 * 500500 + 10 * 2000, my_metric->sum());
+
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(my_metric->get_initial_delay_ms() + interval_ms * 3));
+
+    int64_t value = 0;
+    ASSERT_TRUE(my_metric->get(kth_percentile_type::P50, value));
+    ASSERT_EQ(histogram_bucket_upper_bound(histogram_bucket_index(500)), value);
+    ASSERT_FALSE(my_metric->get(kth_percentile_type::P99, value));
+    ASSERT_EQ(0, value);
+
+    // Buckets in json snapshot could be merged into the same counts.
+    metric_filters filters;
+    filters.with_metric_fields = {
+        kMetricNameField, kMetricCountField, kMetricSumField, kMetricBucketsField};
+    const auto json_string = take_snapshot_as_json(my_metric.get(), filters);
+    metric_brief_buckets_snapshot snapshot;
+    ASSERT_TRUE(deserialize_metric_snapshot(json_string, snapshot));
+    ASSERT_EQ("test_server_histogram_int64", snapshot.name);
+    ASSERT_EQ(4010, snapshot.count);
+    ASSERT_EQ(my_metric->sum(), snapshot.sum);
+
+    metric_merged_histogram_buckets merged;
+    ASSERT_TRUE(merge_histogram_buckets(snapshot.buckets, merged));
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (counts[i] > 0) {
+            ASSERT_EQ(counts[i], merged[histogram_bucket_upper_bound(i)]);
+        }
+    }
+    ASSERT_EQ(value, histogram_kth_percentile(merged, kth_percentile_type::P50));
+}
+
+TEST(metrics_test, take_prometheus_snapshot)
+{
+    auto my_server_entity = METRIC_ENTITY_my_server.instantiate("prometheus_server",
+                                                                {{"name", "a\"b"}, {"host", "h"}});
+    auto my_gauge = METRIC_test_server_gauge_int64.instantiate(my_server_entity);
+    my_gauge->set(5);
+    auto my_histogram = METRIC_test_server_histogram_int64.instantiate(my_server_entity, 0);
+    my_histogram->set(3);
+    my_histogram->set(2, 100);
+
+    const auto out = metric_registry::instance().take_prometheus_snapshot();
+    const std::string labels(R"(entity="my_server",id="prometheus_server",host="h",name="a\"b")");
+
+    ASSERT_NE(std::string::npos, out.find("# TYPE test_server_gauge_int64 gauge\n"));
+    ASSERT_NE(std::string::npos, out.find("test_server_gauge_int64{" + labels + "} 5\n"));
+
+    ASSERT_NE(std::string::npos, out.find("# TYPE test_server_histogram_int64 histogram\n"));
+    ASSERT_NE(std::string::npos,
+              out.find("test_server_histogram_int64_bucket{" + labels + ",le=\"3\"} 1\n"));
+    ASSERT_NE(std::string::npos,
+              out.find(fmt::format("test_server_histogram_int64_bucket{{{},le=\"{}\"}} 3\n",
+                                   labels,
+                                   histogram_bucket_upper_bound(histogram_bucket_index(100)))));
+    ASSERT_NE(std::string::npos,
+              out.find("test_server_histogram_int64_bucket{" + labels + ",le=\"+Inf\"} 3\n"));
+    ASSERT_NE(std::string::npos,
+              out.find("test_server_histogram_int64_sum{" + labels + "} 203\n"));
+    ASSERT_NE(std::string::npos,
+              out.find("test_server_histogram_int64_count{" + labels + "} 3\n"));
+
+    // Volatile counters are not exposed since they would be reset once read.
+    ASSERT_EQ(std::string::npos, out.find("# TYPE test_server_volatile_counter"));
+}
+
 const std::unordered_set<std::string> kAllMetricEntityFields = {kMetricEntityTypeField,
                                                                 kMetricEntityIdField,
                                                                 kMetricEntityAttrsField,
@@ -3220,6 +3381,7 @@ protected:
     METRIC_VAR_DECLARE_percentile_int64(test_replica_percentile_int64_us);
     METRIC_VAR_DECLARE_percentile_int64(test_replica_percentile_int64_ms);
     METRIC_VAR_DECLARE_percentile_int64(test_replica_percentile_int64_s);
+    METRIC_VAR_DECLARE_histogram_int64(test_replica_histogram_int64_us);
 
     DISALLOW_COPY_AND_ASSIGN(MetricVarTest);
 };
@@ -3231,7 +3393,8 @@ MetricVarTest::MetricVarTest()
       METRIC_VAR_INIT_my_replica(test_replica_percentile_int64_ns),
       METRIC_VAR_INIT_my_replica(test_replica_percentile_int64_us),
       METRIC_VAR_INIT_my_replica(test_replica_percentile_int64_ms),
-      METRIC_VAR_INIT_my_replica(test_replica_percentile_int64_s)
+      METRIC_VAR_INIT_my_replica(test_replica_percentile_int64_s),
+      METRIC_VAR_INIT_my_replica(test_replica_histogram_int64_us)
 {
 }
 
@@ -3347,6 +3510,22 @@ TEST_F(MetricVarTest, AutoLatencyMilliSeconds) { TEST_METRIC_VAR_AUTO_LATENCY(ms
 
 TEST_F(MetricVarTest, AutoLatencySeconds) { TEST_METRIC_VAR_AUTO_LATENCY(s, 1000 * 1000 * 1000); }
 
+TEST_F(MetricVarTest, AutoLatencyHistogram)
+{
+    uint64_t actual_latency_us = 0;
+    {
+        METRIC_VAR_AUTO_LATENCY(test_replica_histogram_int64_us,
+                                [&actual_latency_us](uint64_t latency) mutable {
+                                    actual_latency_us = latency;
+                                });
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    ASSERT_GE(actual_latency_us, 2000);
+    const auto counts = METRIC_VAR_NAME(test_replica_histogram_int64_us)->bucket_counts();
+    ASSERT_EQ(1, counts[histogram_bucket_index(static_cast<int64_t>(actual_latency_us))]);
+}
+
 TEST_F(MetricVarTest, AutoCount) { ASSERT_NO_FATAL_FAILURE(test_auto_count()); }
 
 } // namespace dsn
@@ -181,6 +181,29 @@ TEST_F(token_bucket_throttling_controller_test, test_parse_env_basic_token_bucke
 
 TEST_F(token_bucket_throttling_controller_test, throttle_test) { throttle_test(); }
 
+TEST_F(token_bucket_throttling_controller_test, set_rate)
+{
+    bool changed = false;
+    cntl.set_rate(0, changed);
+    ASSERT_FALSE(changed);
+    ASSERT_TRUE(cntl.consume_token(1000000));
+
+    cntl.set_rate(100, changed);
+    ASSERT_TRUE(changed);
+    ASSERT_EQ("100", cntl.env_value());
+    cntl.set_rate(100, changed);
+    ASSERT_FALSE(changed);
+
+    // The tokens borrowed from the future make the bucket unavailable.
+    ASSERT_TRUE(cntl.consume_token(100));
+    ASSERT_FALSE(cntl.consume_token(100));
+    ASSERT_FALSE(cntl.available());
+
+    cntl.set_rate(0, changed);
+    ASSERT_TRUE(changed);
+    ASSERT_TRUE(cntl.available());
+}
+
 TEST_F(token_bucket_throttling_controller_test, parse_unit_test)
 {
     std::string max_minus_1 = std::to_string(std::numeric_limits<uint64_t>::max() - 1);
@@ -30,13 +30,26 @@
 
 namespace dsn {
 
+namespace {
+thread_local bool serialized_by_scheduler = false;
+} // anonymous namespace
+
 thread_access_checker::thread_access_checker() { _access_thread_id_inited = false; }
 
 thread_access_checker::~thread_access_checker() { _access_thread_id_inited = false; }
 
+/*static*/ void thread_access_checker::set_serialized_by_scheduler(bool serialized)
+{
+    serialized_by_scheduler = serialized;
+}
+
 void thread_access_checker::only_one_thread_access()
 {
-    if (_access_thread_id_inited) {
+    if (serialized_by_scheduler) {
+        // Just follow the thread which is accessing now.
+        _access_thread_id = ::dsn::utils::get_current_tid();
+        _access_thread_id_inited = true;
+    } else if (_access_thread_id_inited) {
         CHECK_EQ_MSG(::dsn::utils::get_current_tid(),
                      _access_thread_id,
                      "the service is assumed to be accessed by one thread only!");
@@ -40,6 +40,11 @@ public:
 
     void only_one_thread_access();
 
+    // Set by the threads whose tasks of the same hash are serialized by the scheduler rather
+    // than bound to a single thread (e.g. the workers of work-stealing pools), on which the
+    // checked object is allowed to be accessed by another thread one after another.
+    static void set_serialized_by_scheduler(bool serialized);
+
 private:
     // TODO: the implementation is not thread safe. use atomic variable to reimplement this
     int _access_thread_id;
@@ -64,6 +64,7 @@ struct threadpool_spec
     uint64_t worker_affinity_mask;
     int dequeue_batch_size;
     bool partitioned; // false by default
+    bool work_stealing; // false by default, only for partitioned pools
     std::string queue_factory_name;
     std::string worker_factory_name;
     std::list<std::string> queue_aspects;
@@ -106,6 +107,14 @@ CONFIG_FLD(bool,
            "Whether each thread has its own task queue, and tasks are assigned to a specific "
            "thread for execution based on a hash rule to reduce lock contention. Otherwise, "
            "the threads share a single queue")
+CONFIG_FLD(bool,
+           bool,
+           work_stealing,
+           false,
+           "Only for partitioned pools. Whether an idle thread could steal the tasks of other "
+           "hashes from a busy thread, while the tasks of the same hash are still executed "
+           "serially (though maybe by different threads), so that a hot partition would not "
+           "saturate a single thread")
 CONFIG_FLD_STRING(queue_factory_name, "", "task queue provider name")
 CONFIG_FLD_STRING(worker_factory_name, "", "task worker provider name")
 CONFIG_FLD_STRING_LIST(queue_aspects, "task queue aspects names, usually for tooling purpose")
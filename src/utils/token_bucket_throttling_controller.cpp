@@ -102,6 +102,22 @@ bool token_bucket_throttling_controller::parse_from_env(const std::string &env_v
     return true;
 }
 
+void token_bucket_throttling_controller::set_rate(uint64_t rate, bool &changed)
+{
+    if (rate == 0) {
+        std::string old_env_value;
+        reset(changed, old_env_value);
+        return;
+    }
+
+    changed = !_enabled || _rate != rate;
+    _enabled = true;
+    _env_value = std::to_string(rate);
+    _partition_count = 1;
+    _rate = rate;
+    _burstsize = rate;
+}
+
 bool token_bucket_throttling_controller::validate(const std::string &env, std::string &hint_message)
 {
     uint64_t temp;
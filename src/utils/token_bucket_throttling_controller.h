@@ -85,6 +85,10 @@ public:
                         bool &changed,
                         std::string &old_env_value);
 
+    // Configures throttling by the rate of request units per second directly, e.g. the budget
+    // distributed by meta server, 0 means no throttling. 'changed' is set if the rate changes.
+    void set_rate(uint64_t rate, bool &changed);
+
     // wrapper of transform_env_string, check if the env string is validated.
     static bool validate(const std::string &env, std::string &hint_message);
 